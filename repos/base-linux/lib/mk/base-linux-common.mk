@@ -13,3 +13,4 @@ SRC_CC += rpc_dispatch_loop.cc
 SRC_CC += thread_env.cc
 SRC_CC += capability.cc
 SRC_CC += native_thread.cc
+SRC_CC += signal_transmitter.cc
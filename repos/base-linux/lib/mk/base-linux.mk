@@ -10,5 +10,5 @@ LIBS   += startup-linux base-linux-common cxx seccomp
 SRC_CC += thread.cc thread_myself.cc thread_linux.cc
 SRC_CC += capability_space.cc capability_raw.cc
 SRC_CC += attach_stack_area.cc
-SRC_CC += signal_transmitter.cc signal.cc
+SRC_CC += signal.cc
 SRC_CC += platform.cc
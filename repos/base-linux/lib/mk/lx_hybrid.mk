@@ -1,5 +1,5 @@
 SRC_CC += lx_hybrid.cc new_delete.cc capability_space.cc
-SRC_CC += signal_transmitter.cc signal.cc
+SRC_CC += signal.cc
 SRC_C  += libgcc.c
 
 vpath new_delete.cc $(BASE_DIR)/src/lib/cxx
@@ -42,6 +42,12 @@ inline int lx_ftruncate(int fd, unsigned long length)
 }
 
 
+inline int lx_memfd_create(const char *name, unsigned flags)
+{
+	return lx_syscall(SYS_memfd_create, name, flags);
+}
+
+
 inline int lx_unlink(const char *fname)
 {
 	return lx_syscall(SYS_unlink, fname);
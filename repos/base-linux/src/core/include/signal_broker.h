@@ -0,0 +1,64 @@
+/*
+ * \brief  Linux-specific signal-delivery mechanism
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * On Linux, signal contexts are implemented by the receiving components as
+ * datagram socket pairs. Signals are transmitted directly between the
+ * components. Core solely accounts for the capabilities of the contexts.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _CORE__INCLUDE__SIGNAL_BROKER_H_
+#define _CORE__INCLUDE__SIGNAL_BROKER_H_
+
+/* Genode includes */
+#include <base/rpc_server.h>
+#include <base/signal.h>
+#include <signal_source/capability.h>
+
+namespace Genode { class Signal_broker; }
+
+
+class Genode::Signal_broker
+{
+	public:
+
+		class Invalid_signal_source : public Exception { };
+
+		Signal_broker(Allocator &, Rpc_entrypoint &, Rpc_entrypoint &) { }
+
+		Signal_source_capability alloc_signal_source() {
+			return Signal_source_capability(); }
+
+		void free_signal_source(Signal_source_capability) { }
+
+		Signal_context_capability
+		alloc_context(Signal_source_capability, unsigned long)
+		{
+			/*
+			 * The capability is created by the receiving component, see
+			 * 'Signal_receiver::manage'.
+			 */
+			return Signal_context_capability();
+		}
+
+		void free_context(Signal_context_capability) { }
+
+		void submit(Signal_context_capability cap, unsigned cnt)
+		{
+			/*
+			 * Signals are usually submitted directly. Support the
+			 * submission via core for completeness.
+			 */
+			Signal_transmitter(cap).submit(cnt);
+		}
+};
+
+#endif /* _CORE__INCLUDE__SIGNAL_BROKER_H_ */
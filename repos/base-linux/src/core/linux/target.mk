@@ -29,7 +29,7 @@ SRC_CC        = main.cc \
                 io_port_session_support.cc \
                 irq_session_component.cc \
                 signal_source_component.cc \
-                signal_transmitter_proxy.cc \
+                signal_transmitter_noinit.cc \
                 signal_receiver.cc \
                 trace_session_component.cc \
                 thread_linux.cc \
@@ -65,7 +65,7 @@ vpath pd_session_support.cc        $(GEN_CORE_DIR)
 vpath capability_space.cc          $(GEN_CORE_DIR)
 vpath ram_dataspace_factory.cc     $(GEN_CORE_DIR)
 vpath signal_source_component.cc   $(GEN_CORE_DIR)
-vpath signal_transmitter_proxy.cc  $(GEN_CORE_DIR)
+vpath signal_transmitter_noinit.cc $(GEN_CORE_DIR)
 vpath signal_receiver.cc           $(GEN_CORE_DIR)
 vpath trace_session_component.cc   $(GEN_CORE_DIR)
 vpath default_log.cc               $(GEN_CORE_DIR)
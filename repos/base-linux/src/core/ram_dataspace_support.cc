@@ -33,18 +33,36 @@ using namespace Genode;
 
 static int ram_ds_cnt = 0;  /* counter for creating unique dataspace IDs */
 
-void Ram_dataspace_factory::_export_ram_ds(Dataspace_component &ds)
+
+/**
+ * Create anonymous file via 'memfd_create'
+ *
+ * \return  file descriptor, or negative value if the kernel lacks support
+ */
+static int anonymous_file()
+{
+	static bool supported = true;
+	if (!supported)
+		return -1;
+
+	int const fd = lx_memfd_create("ds", MFD_CLOEXEC);
+	if (fd < 0)
+		supported = false;
+
+	return fd;
+}
+
+
+/**
+ * Create file using a unique file name in the resource path
+ */
+static int named_file()
 {
 	char fname[Linux_dataspace::FNAME_LEN];
 
-	/* create file using a unique file name in the resource path */
 	snprintf(fname, sizeof(fname), "%s/ds-%d", resource_path(), ram_ds_cnt++);
 	lx_unlink(fname);
 	int const fd = lx_open(fname, O_CREAT|O_RDWR|O_TRUNC|LX_O_CLOEXEC, S_IRWXU);
-	lx_ftruncate(fd, ds.size());
-
-	/* remember file descriptor in dataspace component object */
-	ds.fd(fd);
 
 	/*
 	 * Wipe the file from the Linux file system. The kernel will still keep the
@@ -53,6 +71,25 @@ void Ram_dataspace_factory::_export_ram_ds(Dataspace_component &ds)
 	 * w/o the right file descriptor won't be able to open and access the file.
 	 */
 	lx_unlink(fname);
+
+	return fd;
+}
+
+
+void Ram_dataspace_factory::_export_ram_ds(Dataspace_component &ds)
+{
+	/*
+	 * An anonymous file does not involve the file system at all. The named
+	 * file serves as fallback for kernels older than 3.17.
+	 */
+	int fd = anonymous_file();
+	if (fd < 0)
+		fd = named_file();
+
+	lx_ftruncate(fd, ds.size());
+
+	/* remember file descriptor in dataspace component object */
+	ds.fd(fd);
 }
 
 
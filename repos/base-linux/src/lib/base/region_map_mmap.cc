@@ -156,6 +156,18 @@ void *Region_map_mmap::_map_local(Dataspace_capability ds,
 		throw Region_map::Region_conflict();
 	}
 
+	/*
+	 * Let the kernel back large mappings with transparent huge pages to
+	 * relieve the TLB, e.g., for packet buffers and framebuffers. The
+	 * advice takes effect only if huge pages for shared memory are enabled
+	 * at '/sys/kernel/mm/transparent_hugepage/shmem_enabled' and is
+	 * silently ignored otherwise. The seccomp policy permits 'madvise'
+	 * with this advice only.
+	 */
+	enum { HUGE_PAGE_SIZE = 2*1024*1024 };
+	if (size >= HUGE_PAGE_SIZE)
+		lx_madvise(addr_out, size, MADV_HUGEPAGE);
+
 	return addr_out;
 }
 
@@ -0,0 +1,402 @@
+/*
+ * \brief  Linux-specific implementation parts of the signaling framework
+ * \author Norman Feske
+ * \author Johannes Schlatow
+ * \date   2008-09-16
+ *
+ * Each signal context is backed by a datagram socket pair created by the
+ * receiving component. The capability of the context refers to the remote
+ * end of the socket pair. The local end is watched by the signal-handler
+ * thread. Signals are transmitted directly from the sender to the receiver
+ * without involving core.
+ */
+
+/*
+ * Copyright (C) 2008-2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <util/retry.h>
+#include <base/env.h>
+#include <base/signal.h>
+#include <base/thread.h>
+#include <base/sleep.h>
+#include <base/trace/events.h>
+#include <util/reconstructible.h>
+#include <deprecated/env.h>
+
+/* base-internal includes */
+#include <base/internal/globals.h>
+#include <base/internal/unmanaged_singleton.h>
+#include <base/internal/native_thread.h>
+#include <base/internal/capability_space_tpl.h>
+
+using namespace Genode;
+
+class Signal_handler_thread : Thread, Blockade
+{
+	private:
+
+		void entry() override
+		{
+			wakeup();
+			Signal_receiver::dispatch_signals(nullptr);
+		}
+
+		enum { STACK_SIZE = 4*1024*sizeof(addr_t) };
+
+	public:
+
+		/**
+		 * Constructor
+		 */
+		Signal_handler_thread(Env &env)
+		: Thread(env, "signal handler", STACK_SIZE)
+		{
+			start();
+
+			/*
+			 * Make sure the signal handler polls for signals before
+			 * proceeding with the use of signals.
+			 */
+			block();
+		}
+
+		/**
+		 * Create socket pair for signal context, watched by the thread
+		 */
+		Native_capability alloc_channel() { return native_thread().epoll.alloc_rpc_cap(); }
+
+		/**
+		 * Stop watching the socket pair of a signal context
+		 */
+		void free_channel(Native_capability cap) { native_thread().epoll.free_rpc_cap(cap); }
+};
+
+
+/*
+ * The signal-handler thread will be constructed before global constructors are
+ * called and, consequently, must not be a global static object. Otherwise, the
+ * 'Constructible' constructor will be executed twice.
+ */
+static Constructible<Signal_handler_thread> & signal_handler_thread()
+{
+	return *unmanaged_singleton<Constructible<Signal_handler_thread> >();
+}
+
+
+namespace Genode {
+
+	/*
+	 * Initialize the component-local signal-handling thread
+	 *
+	 * This function is called once at the startup of the component. It must
+	 * be called before creating the first signal receiver.
+	 *
+	 * We allow this function to be overridden in to enable core to omit the
+	 * creation of the signal thread.
+	 */
+	void init_signal_thread(Env &env) __attribute__((weak));
+	void init_signal_thread(Env &env)
+	{
+		signal_handler_thread().construct(env);
+	}
+
+	void destroy_signal_thread()
+	{
+		signal_handler_thread().destruct();
+	}
+}
+
+
+/********************
+ ** Signal_context **
+ ********************/
+
+void Signal_context::local_submit()
+{
+	if (_receiver) {
+		/* construct and locally submit signal object */
+		Signal::Data signal(this, 1);
+		_receiver->local_submit(signal);
+	}
+}
+
+
+/*****************************
+ ** Signal context registry **
+ *****************************/
+
+namespace Genode {
+
+	/**
+	 * Facility to validate the liveliness of signal contexts
+	 *
+	 * After dissolving a 'Signal_context' from a 'Signal_receiver', a signal
+	 * belonging to the context may still in flight, i.e., currently processed
+	 * within core or the kernel. Hence, after having received a signal, we
+	 * need to manually check for the liveliness of the associated context.
+	 * Because we cannot trust the signal imprint to represent a valid pointer,
+	 * we need an associative data structure to validate the value. That is the
+	 * role of the 'Signal_context_registry'.
+	 */
+	class Signal_context_registry
+	{
+		private:
+
+			/*
+			 * Currently, the registry is just a linked list. If this becomes a
+			 * scalability problem, we might introduce a more sophisticated
+			 * associative data structure.
+			 */
+			Mutex mutable                       _mutex { };
+			List<List_element<Signal_context> > _list { };
+
+		public:
+
+			void insert(List_element<Signal_context> *le)
+			{
+				Mutex::Guard guard(_mutex);
+				_list.insert(le);
+			}
+
+			void remove(List_element<Signal_context> *le)
+			{
+				Mutex::Guard guard(_mutex);
+				_list.remove(le);
+			}
+
+			/**
+			 * Look up and lock the context whose socket pair has the
+			 * specified local end
+			 *
+			 * \return  context or nullptr if no such context exists
+			 */
+			Signal_context *test_and_lock(Lx_sd local) const
+			{
+				Mutex::Guard guard(_mutex);
+
+				/* search list for context */
+				List_element<Signal_context> const *le = _list.first();
+				for ( ; le; le = le->next()) {
+
+					Signal_context &context = *le->object();
+
+					int const local_socket =
+						Capability_space::ipc_cap_data(context._cap).rpc_obj_key.value();
+
+					if (local_socket == local.value) {
+						/* acquire the object */
+						context._mutex.acquire();
+						return &context;
+					}
+				}
+				return nullptr;
+			}
+	};
+}
+
+
+/**
+ * Return process-wide registry of registered signal contexts
+ */
+Genode::Signal_context_registry *signal_context_registry()
+{
+	static Signal_context_registry inst;
+	return &inst;
+}
+
+
+/*********************
+ ** Signal receiver **
+ *********************/
+
+Signal_receiver::Signal_receiver() { }
+
+
+Signal_context_capability Signal_receiver::manage(Signal_context *context)
+{
+	if (context->_receiver)
+		throw Context_already_in_use();
+
+	context->_receiver = this;
+
+	Mutex::Guard contexts_guard(_contexts_mutex);
+
+	/* insert context into context list */
+	_contexts.insert_as_tail(context);
+
+	/* allocate the context at core, to allow accounting of caps */
+	for (;;) {
+
+		Ram_quota ram_upgrade { 0 };
+		Cap_quota cap_upgrade { 0 };
+
+		try {
+			env_deprecated()->pd_session()->alloc_context(_cap, (long)context);
+			break;
+		}
+		catch (Out_of_ram)  { ram_upgrade = Ram_quota { 1024*sizeof(long) }; }
+		catch (Out_of_caps) { cap_upgrade = Cap_quota { 4 }; }
+
+		log("upgrading quota donation for PD session "
+		    "(", ram_upgrade, " bytes, ", cap_upgrade, " caps)");
+
+		env_deprecated()->parent()->upgrade(Parent::Env::pd(),
+		                                    String<100>("ram_quota=", ram_upgrade, ", "
+		                                                "cap_quota=", cap_upgrade).string());
+	}
+
+	context->_cap = reinterpret_cap_cast<Signal_context>(
+		signal_handler_thread()->alloc_channel());
+
+	/* register context at process-wide registry */
+	signal_context_registry()->insert(&context->_registry_le);
+
+	return context->_cap;
+}
+
+
+void Signal_receiver::block_for_signal()
+{
+	_signal_available.down();
+}
+
+
+Signal Signal_receiver::pending_signal()
+{
+	Mutex::Guard contexts_guard(_contexts_mutex);
+	Signal::Data result;
+	_contexts.for_each_locked([&] (Signal_context &context) -> bool {
+
+		if (!context._pending) return false;
+
+		_contexts.head(context._next);
+		context._pending     = false;
+		result               = context._curr_signal;
+		context._curr_signal = Signal::Data(0, 0);
+
+		Trace::Signal_received trace_event(context, result.num);
+		return true;
+	});
+	if (result.context) {
+		Mutex::Guard context_guard(result.context->_mutex);
+		if (result.num == 0)
+			warning("returning signal with num == 0");
+
+		return result;
+	}
+
+	/*
+	 * Normally, we should never arrive at this point because that would
+	 * mean, the '_signal_available' semaphore was increased without
+	 * registering the signal in any context associated to the receiver.
+	 *
+	 * However, if a context gets dissolved right after submitting a
+	 * signal, we may have increased the semaphore already. In this case
+	 * the signal-causing context is absent from the list.
+	 */
+	return Signal();
+}
+
+void Signal_receiver::unblock_signal_waiter(Rpc_entrypoint &)
+{
+	_signal_available.up();
+}
+
+
+void Signal_receiver::local_submit(Signal::Data data)
+{
+	Signal_context *context = data.context;
+
+	/*
+	 * Replace current signal of the context by signal with accumulated
+	 * counters. In the common case, the current signal is an invalid
+	 * signal with a counter value of zero.
+	 */
+	unsigned num = context->_curr_signal.num + data.num;
+	context->_curr_signal = Signal::Data(context, num);
+
+	/* wake up the receiver if the context becomes pending */
+	if (!context->_pending) {
+		context->_pending = true;
+		_signal_available.up();
+	}
+}
+
+
+void Signal_receiver::dispatch_signals(Signal_source *)
+{
+	Native_thread::Epoll &epoll = Thread::myself()->native_thread().epoll;
+
+	for (;;) {
+		Lx_sd const local = epoll.poll();
+
+		Signal_context * const context = signal_context_registry()->test_and_lock(local);
+
+		/*
+		 * Sum up the signals received so far, each datagram carries the
+		 * number of signals submitted by one 'Signal_transmitter::submit'
+		 */
+		unsigned num = 0;
+		for (;;) {
+			unsigned cnt = 0;
+
+			struct iovec iovec { };
+			iovec.iov_base = &cnt;
+			iovec.iov_len  = sizeof(cnt);
+
+			struct msghdr msg { };
+			msg.msg_iov    = &iovec;
+			msg.msg_iovlen = 1;
+
+			if (lx_recvmsg(local, &msg, MSG_DONTWAIT) != sizeof(cnt))
+				break;
+
+			num += cnt;
+		}
+
+		/*
+		 * The context got dissolved while the signal was in flight. The
+		 * signals are dropped.
+		 */
+		if (!context)
+			continue;
+
+		if (context->_receiver && num) {
+			/* construct and locally submit signal object */
+			Signal::Data signal(context, num);
+			context->_receiver->local_submit(signal);
+		}
+
+		/* free context mutex that was taken by 'test_and_lock' */
+		context->_mutex.release();
+	}
+}
+
+
+void Signal_receiver::_platform_begin_dissolve(Signal_context *context)
+{
+	/*
+	 * Because the 'remove' operation takes the registry mutex, the context
+	 * must not be acquired when calling this method. See the comment in
+	 * 'Signal_receiver::dissolve'.
+	 */
+	signal_context_registry()->remove(&context->_registry_le);
+
+	/*
+	 * Stop watching the socket pair. Once the last reference to the
+	 * capability is gone, the socket pair is closed and the submission of
+	 * signals to the context fails.
+	 */
+	signal_handler_thread()->free_channel(context->_cap);
+}
+
+
+void Signal_receiver::_platform_finish_dissolve(Signal_context *) { }
+
+
+void Signal_receiver::_platform_destructor() { }
@@ -0,0 +1,60 @@
+/*
+ * \brief  Linux-specific implementation of the signal transmitter
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The capability of a signal context refers to a datagram socket of the
+ * receiving component. A signal is submitted by sending the number of
+ * signals to this socket, which does not involve core.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/signal.h>
+#include <base/trace/events.h>
+
+/* base-internal includes */
+#include <base/internal/globals.h>
+#include <base/internal/capability_space_tpl.h>
+
+/* Linux includes */
+#include <linux_syscalls.h>
+
+using namespace Genode;
+
+
+void Genode::init_signal_transmitter(Env &) { }
+
+
+void Signal_transmitter::submit(unsigned cnt)
+{
+	{
+		Trace::Signal_submit trace_event(cnt);
+	}
+
+	if (!_context.valid())
+		return;
+
+	struct iovec iovec { };
+	iovec.iov_base = &cnt;
+	iovec.iov_len  = sizeof(cnt);
+
+	struct msghdr msg { };
+	msg.msg_iov    = &iovec;
+	msg.msg_iovlen = 1;
+
+	/*
+	 * The sender must never block. If the socket buffer of the receiver is
+	 * exhausted, the context is pending already and only the signal count
+	 * is lost. If the context got dissolved, the socket is closed or no
+	 * longer watched by the receiver and the signal is dropped.
+	 */
+	(void)lx_sendmsg(Capability_space::ipc_cap_data(_context).dst.socket,
+	                 &msg, MSG_DONTWAIT);
+}
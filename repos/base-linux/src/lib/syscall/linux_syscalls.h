@@ -303,6 +303,12 @@ inline int lx_munmap(void *addr, Genode::size_t length)
 }
 
 
+inline int lx_madvise(void *addr, Genode::size_t length, int advice)
+{
+	return lx_syscall(SYS_madvise, addr, length, advice);
+}
+
+
 /***********************************************************************
  ** Functions used by thread lib and core's cancel-blocking mechanism **
  ***********************************************************************/
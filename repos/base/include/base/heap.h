@@ -34,9 +34,30 @@ namespace Genode {
  * The heap class provides an allocator that uses a list of dataspaces of a RAM
  * allocator as backing store. One dataspace may be used for holding multiple
  * blocks.
+ *
+ * Small blocks are rounded up to size classes. Freed blocks of a size class
+ * are kept in a free list of their class, which serves subsequent
+ * allocations of the class without searching the AVL tree. Each free list
+ * holds at most 'MAX_FREE_BYTES_PER_CLASS' bytes. Blocks beyond this bound
+ * are returned to the AVL tree, where they can be merged and reused by
+ * allocations of other sizes. Dataspaces of
+ * freed big allocations are kept in a small cache for reuse instead of being
+ * returned to the RAM allocator right away.
  */
 class Genode::Heap : public Allocator
 {
+	public:
+
+		enum {
+			MAX_SIZE_CLASS   = 2048,  /* largest block size served from class */
+			NUM_SIZE_CLASSES = 24,
+
+			MAX_FREE_BYTES_PER_CLASS = 16*1024,
+
+			MAX_CACHED_DATASPACES = 4,
+			MAX_CACHED_BYTES      = 2*1024*1024,
+		};
+
 	private:
 
 		class Dataspace : public List<Dataspace>::Element
@@ -89,12 +110,59 @@ class Genode::Heap : public Allocator
 					ram_alloc = ram, region_map = rm; }
 		};
 
+		/**
+		 * Freed block of a size class, still allocated at '_alloc'
+		 */
+		struct Free_block { Free_block *next; };
+
 		Mutex                  mutable _mutex { };
 		Reconstructible<Allocator_avl> _alloc;        /* local allocator    */
 		Dataspace_pool                 _ds_pool;      /* list of dataspaces */
+		Dataspace_pool                 _ds_cache;     /* released big ones  */
 		size_t                         _quota_limit { 0 };
 		size_t                         _quota_used  { 0 };
 		size_t                         _chunk_size  { 0 };
+		size_t                         _cached_size { 0 };
+		unsigned                       _num_cached  { 0 };
+
+		Free_block *_free_blocks[NUM_SIZE_CLASSES] { };
+		size_t      _free_bytes [NUM_SIZE_CLASSES] { };
+
+		/*
+		 * Noncopyable
+		 */
+		Heap(Heap const &);
+		Heap &operator = (Heap const &);
+
+		/**
+		 * Return size class for block size, or -1 if size exceeds classes
+		 */
+		static int _size_class(size_t size);
+
+		/**
+		 * Return block size of size class
+		 */
+		static size_t _class_size(unsigned size_class);
+
+		/**
+		 * Return blocks of all free lists to the local allocator
+		 */
+		void _flush_free_blocks();
+
+		/**
+		 * Return cached dataspace of at least 'size' bytes, or nullptr
+		 */
+		Heap::Dataspace *_cached_dataspace(size_t size);
+
+		/**
+		 * Keep dataspace of a freed big allocation for reuse
+		 */
+		void _cache_dataspace(Dataspace &);
+
+		/**
+		 * Release dataspaces of the cache to the RAM allocator
+		 */
+		void _flush_ds_cache();
 
 		/**
 		 * Allocate a new dataspace of the specified size
@@ -148,11 +216,17 @@ class Genode::Heap : public Allocator
 		/**
 		 * Re-assign RAM allocator and region map
 		 */
-		void reassign_resources(Ram_allocator *ram, Region_map *rm) {
-			_ds_pool.reassign_resources(ram, rm); }
+		void reassign_resources(Ram_allocator *ram, Region_map *rm)
+		{
+			_ds_pool .reassign_resources(ram, rm);
+			_ds_cache.reassign_resources(ram, rm);
+		}
 
 		/**
 		 * Call 'fn' with the start and size of each backing-store region
+		 *
+		 * The regions include the dataspaces held in the cache of freed big
+		 * allocations.
 		 */
 		template <typename FN>
 		void for_each_region(FN const &fn) const
@@ -160,6 +234,8 @@ class Genode::Heap : public Allocator
 			Mutex::Guard guard(_mutex);
 			for (Dataspace const *ds = _ds_pool.first(); ds; ds = ds->next())
 				fn(ds->local_addr, ds->size);
+			for (Dataspace const *ds = _ds_cache.first(); ds; ds = ds->next())
+				fn(ds->local_addr, ds->size);
 		}
 
 
@@ -16,6 +16,7 @@
 
 #include <util/string.h>
 #include <util/print_lines.h>
+#include <util/interface.h>
 #include <base/snprintf.h>
 
 namespace Genode { class Xml_generator; }
@@ -30,8 +31,66 @@ class Genode::Xml_generator
 		 */
 		class Buffer_exceeded { };
 
+		/**
+		 * Interface of an output buffer that can grow during the generation
+		 *
+		 * With an expandable buffer, the generator completes in one pass
+		 * instead of requiring the caller to start over with a larger buffer
+		 * whenever 'Buffer_exceeded' occurs.
+		 */
+		struct Expandable_buffer : Interface
+		{
+			struct Range { char *start; size_t num_bytes; };
+
+			/**
+			 * Return current buffer
+			 */
+			virtual Range range() = 0;
+
+			/**
+			 * Expand buffer to at least 'min_size' bytes
+			 *
+			 * The content of the current buffer must be preserved but the
+			 * buffer may be relocated.
+			 *
+			 * \throw Buffer_exceeded
+			 */
+			virtual void expand(size_t min_size) = 0;
+		};
+
 	private:
 
+		/**
+		 * Backing store of all output buffers
+		 *
+		 * Output buffers refer to the store by offsets such that the store
+		 * can be relocated when expanded.
+		 */
+		struct Store
+		{
+			char              *base;
+			size_t             capacity;
+			Expandable_buffer *expandable;
+
+			void ensure(size_t const end)
+			{
+				if (end <= capacity)
+					return;
+
+				if (!expandable)
+					throw Buffer_exceeded();
+
+				expandable->expand(max(end, 2*capacity));
+
+				Expandable_buffer::Range const range = expandable->range();
+				if (range.num_bytes < end)
+					throw Buffer_exceeded();
+
+				base     = range.start;
+				capacity = range.num_bytes;
+			}
+		};
+
 		/**
 		 * Buffer descriptor where the XML output goes to
 		 *
@@ -39,20 +98,34 @@ class Genode::Xml_generator
 		 */
 		class Out_buffer
 		{
+			public:
+
+				/*
+				 * Limit of a buffer that extends to the end of the store
+				 */
+				enum : size_t { UNLIMITED = ~(size_t)0 };
+
 			private:
 
-				char  *_dst;
-				size_t _capacity;
+				Store *_store;
+				size_t _offset;
+				size_t _limit;
 				size_t _used = 0;
 
-				void _check_advance(size_t const len) const {
-					if (_used + len > _capacity)
-						throw Buffer_exceeded(); }
+				char *_dst() const { return _store->base + _offset; }
+
+				void _check_advance(size_t const len) const
+				{
+					if (_limit != UNLIMITED && _used + len > _limit)
+						throw Buffer_exceeded();
+
+					_store->ensure(_offset + _used + len);
+				}
 
 			public:
 
-				Out_buffer(char *dst, size_t capacity)
-				: _dst(dst), _capacity(capacity) { }
+				Out_buffer(Store &store, size_t offset, size_t limit)
+				: _store(&store), _offset(offset), _limit(limit) { }
 
 				void advance(size_t const len)
 				{
@@ -69,21 +142,28 @@ class Genode::Xml_generator
 				void append(char const c)
 				{
 					_check_advance(1);
-					_dst[_used] = c;
-					advance(1);
+					_dst()[_used++] = c;
 				}
 
 				/**
 				 * Append character 'n' times
 				 */
-				void append(char const c, size_t n) {
-					for (; n--; append(c)); }
+				void append(char const c, size_t n)
+				{
+					_check_advance(n);
+					memset(_dst() + _used, c, n);
+					_used += n;
+				}
 
 				/**
 				 * Append character buffer
 				 */
-				void append(char const *src, size_t len) {
-					for (; len--; append(*src++)); }
+				void append(char const *src, size_t len)
+				{
+					_check_advance(len);
+					memcpy(_dst() + _used, src, len);
+					_used += len;
+				}
 
 				/**
 				 * Append null-terminated string
@@ -117,8 +197,11 @@ class Genode::Xml_generator
 				/**
 				 * Return unused part of the buffer
 				 */
-				Out_buffer remainder() const {
-					return Out_buffer(_dst + _used, _capacity - _used); }
+				Out_buffer remainder() const
+				{
+					return Out_buffer(*_store, _offset + _used,
+					                  _limit == UNLIMITED ? UNLIMITED : _limit - _used);
+				}
 
 				/**
 				 * Insert gap into already populated part of the buffer
@@ -129,18 +212,18 @@ class Genode::Xml_generator
 				{
 					/* don't allow the insertion into non-populated part */
 					if (at > _used)
-						return Out_buffer(_dst + at, 0);
+						return Out_buffer(*_store, _offset + at, 0);
 
 					_check_advance(len);
-					memmove(_dst + at + len, _dst + at, _used - at);
+					memmove(_dst() + at + len, _dst() + at, _used - at);
 					advance(len);
 
-					return Out_buffer(_dst + at, len);
+					return Out_buffer(*_store, _offset + at, len);
 				}
 
 				bool has_trailing_newline() const
 				{
-					return (_used > 1) && (_dst[_used - 1] == '\n');
+					return (_used > 1) && (_dst()[_used - 1] == '\n');
 				}
 
 				/**
@@ -150,7 +233,7 @@ class Genode::Xml_generator
 
 				void discard_trailing_whitespace()
 				{
-					for (; _used > 0 && is_whitespace(_dst[_used - 1]); _used--);
+					for (; _used > 0 && is_whitespace(_dst()[_used - 1]); _used--);
 				}
 		};
 
@@ -323,23 +406,43 @@ class Genode::Xml_generator
 				bool is_indented() { return _is_indented; }
 		};
 
-		Out_buffer _out_buffer;
+		Store      _store;
+		Out_buffer _out_buffer { _store, 0, Out_buffer::UNLIMITED };
 		Node      *_curr_node   = 0;
 		unsigned   _curr_indent = 0;
 
+		template <typename FUNC>
+		void _generate(char const *name, FUNC const &func)
+		{
+			node(name, func);
+			_out_buffer.append('\n');
+			_out_buffer.append('\0');
+		}
+
 	public:
 
 		template <typename FUNC>
 		Xml_generator(char *dst, size_t dst_len,
 		              char const *name, FUNC const &func)
 		:
-			_out_buffer(dst, dst_len)
+			_store { dst, dst_len, nullptr }
 		{
-			if (dst) {
-				node(name, func);
-				_out_buffer.append('\n');
-				_out_buffer.append('\0');
-			}
+			if (dst)
+				_generate(name, func);
+		}
+
+		/**
+		 * Constructor for generating XML into an expandable buffer
+		 *
+		 * \throw Buffer_exceeded  buffer could not be expanded as needed
+		 */
+		template <typename FUNC>
+		Xml_generator(Expandable_buffer &buffer,
+		              char const *name, FUNC const &func)
+		:
+			_store { buffer.range().start, buffer.range().num_bytes, &buffer }
+		{
+			_generate(name, func);
 		}
 
 		template <typename FUNC>
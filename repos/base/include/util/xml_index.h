@@ -0,0 +1,628 @@
+/*
+ * \brief  Structural index of XML data
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * An 'Xml_node' validates its whole subtree at construction time and each
+ * navigation step ('sub_node', 'next', 'last', 'for_each_sub_node') creates
+ * new 'Xml_node' objects that scan their subtrees again. For large XML data
+ * such as multi-megabyte reports, walking the tree is thereby superlinear.
+ *
+ * The 'Xml_index' parses the XML data once and records the offsets of all
+ * nodes along with their parent and sibling relations as well as the span of
+ * their attributes. Navigating the index via 'Xml_index::Node' never scans
+ * the XML data again. Attributes are parsed within the recorded span of the
+ * start tag only.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__UTIL__XML_INDEX_H_
+#define _INCLUDE__UTIL__XML_INDEX_H_
+
+#include <base/allocator.h>
+#include <util/xml_node.h>
+
+namespace Genode { class Xml_index; }
+
+
+class Genode::Xml_index : Noncopyable
+{
+	public:
+
+		typedef Xml_node::Invalid_syntax       Invalid_syntax;
+		typedef Xml_node::Nonexistent_sub_node Nonexistent_sub_node;
+
+		class Node;
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Xml_index(Xml_index const &);
+		Xml_index &operator = (Xml_index const &);
+
+		typedef Xml_node::Token   Token;
+		typedef Xml_node::Tag     Tag;
+		typedef Xml_node::Comment Comment;
+
+		enum { INVALID = ~0U, INITIAL_CAPACITY = 64 };
+
+		/*
+		 * All offsets are relative to the start of the XML data
+		 */
+		struct Entry
+		{
+			size_t   offset;          /* start of the start tag */
+			size_t   size;            /* size including start and end tags */
+			size_t   content_offset;  /* first character after the start tag */
+			size_t   content_size;
+			size_t   attr_offset;     /* first character after the tag name */
+			unsigned attr_len;        /* up to the closing tag delimiter */
+			unsigned name_len;
+
+			unsigned parent;
+			unsigned first_child;
+			unsigned last_child;
+			unsigned next_sibling;
+			unsigned num_sub_nodes;
+		};
+
+		Allocator  &_alloc;
+		char const *_base;
+
+		Entry    *_entries  = nullptr;
+		unsigned  _count    = 0;
+		unsigned  _capacity = 0;
+
+		/**
+		 * Return first '<', '"', or null character within [s, end)
+		 *
+		 * These are the only characters that can start a tag or a token
+		 * spanning over a '<' character. Hence, the content between tags is
+		 * skipped word by word rather than token by token.
+		 */
+		static char const *_next_delimiter(char const *s, char const *end)
+		{
+			typedef unsigned long __attribute__((may_alias)) Word;
+
+			auto delimiter = [] (char c) { return c == '<' || c == '"' || c == 0; };
+
+			/* advance byte by byte up to the first word boundary */
+			for (; s < end && ((addr_t)s & (sizeof(Word) - 1)); s++)
+				if (delimiter(*s))
+					return s;
+
+			/*
+			 * Test all bytes of a word at once. A byte of 'w' is zero if and
+			 * only if the corresponding bit of 'zero_byte(w)' is set.
+			 */
+			Word const lsb = ~0UL / 0xff, msb = lsb << 7;
+
+			auto zero_byte = [&] (Word w) { return (w - lsb) & ~w & msb; };
+
+			for (; (size_t)(end - s) >= sizeof(Word); s += sizeof(Word)) {
+				Word const w = *(Word const *)s;
+				if (zero_byte(w) | zero_byte(w ^ (lsb*'<')) | zero_byte(w ^ (lsb*'"')))
+					break;
+			}
+
+			for (; s < end; s++)
+				if (delimiter(*s))
+					return s;
+
+			return end;
+		}
+
+		unsigned _append(Entry const &entry)
+		{
+			if (_count == _capacity) {
+				unsigned const capacity = _capacity ? 2*_capacity : INITIAL_CAPACITY;
+
+				Entry * const entries = (Entry *)_alloc.alloc(sizeof(Entry)*capacity);
+				if (_entries) {
+					memcpy(entries, _entries, sizeof(Entry)*_count);
+					_alloc.free(_entries, sizeof(Entry)*_capacity);
+				}
+				_entries  = entries;
+				_capacity = capacity;
+			}
+
+			_entries[_count] = entry;
+			return _count++;
+		}
+
+		void _add_node(Tag const &tag, unsigned &open)
+		{
+			char const * const start = tag.token().start();
+			char const * const end   = tag.next_token().start();
+			char const * const attr  = tag.name().start() + tag.name().len();
+
+			unsigned const id = _append(Entry {
+				.offset         = (size_t)(start - _base),
+				.size           = (size_t)(end - start),
+				.content_offset = (size_t)(end - _base),
+				.content_size   = 0,
+				.attr_offset    = (size_t)(attr - _base),
+				.attr_len       = (unsigned)(end - 1 - attr),
+				.name_len       = (unsigned)tag.name().len(),
+				.parent         = open,
+				.first_child    = INVALID,
+				.last_child     = INVALID,
+				.next_sibling   = INVALID,
+				.num_sub_nodes  = 0 });
+
+			if (open != INVALID) {
+				Entry &parent = _entries[open];
+
+				if (parent.last_child == INVALID)
+					parent.first_child = id;
+				else
+					_entries[parent.last_child].next_sibling = id;
+
+				parent.last_child = id;
+				parent.num_sub_nodes++;
+			}
+
+			if (tag.type() == Tag::START)
+				open = id;
+		}
+
+		/**
+		 * Complete the innermost open node
+		 *
+		 * \throw Invalid_syntax  end tag does not match the start tag
+		 */
+		void _close_node(Tag const &tag, unsigned &open)
+		{
+			if (open == INVALID)
+				throw Invalid_syntax();
+
+			Entry &entry = _entries[open];
+
+			Token const name = tag.name();
+			if (name.len() != entry.name_len
+			 || strcmp(name.start(), _base + entry.offset + 1, entry.name_len))
+				throw Invalid_syntax();
+
+			char const * const end = tag.next_token().start();
+
+			entry.size         = end - (_base + entry.offset);
+			entry.content_size = tag.token().start() - (_base + entry.content_offset);
+
+			open = entry.parent;
+		}
+
+		/**
+		 * Index the first XML node found in the data in one pass
+		 *
+		 * Characters that are not part of a tag are skipped the same way as
+		 * done by 'Xml_node'. In contrast to 'Xml_node', which merely compares
+		 * the end tag of the node at hand, all end tags must match their
+		 * start tags.
+		 */
+		void _build(size_t const max_len)
+		{
+			char const * const end = _base + max_len;
+			char const *       s   = _base;
+
+			unsigned open = INVALID;
+
+			for (;;) {
+
+				s = _next_delimiter(s, end);
+				if (s == end || *s == 0)
+					break;
+
+				Token const token(s, end - s);
+
+				/* skip quoted string, stop at incomplete string */
+				if (*s == '"') {
+					if (token.type() != Token::STRING)
+						break;
+
+					s += token.len();
+					continue;
+				}
+
+				Comment const comment(token);
+				if (comment.valid()) {
+					s = comment.next_token().start();
+					continue;
+				}
+
+				Tag const tag(token);
+
+				switch (tag.type()) {
+				case Tag::INVALID: s += token.len(); continue;
+				case Tag::END:     _close_node(tag, open); break;
+				case Tag::START:
+				case Tag::EMPTY:   _add_node(tag, open); break;
+				}
+
+				/* the first node is complete */
+				if (open == INVALID)
+					return;
+
+				s = tag.next_token().start();
+			}
+
+			/* no node found or the first node is incomplete */
+			throw Invalid_syntax();
+		}
+
+		void _destroy()
+		{
+			if (_entries)
+				_alloc.free(_entries, sizeof(Entry)*_capacity);
+		}
+
+		void _build_or_destroy(size_t max_len)
+		{
+			try { _build(max_len); }
+			catch (...) { _destroy(); throw; }
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param xml      XML data, e.g., the content of a ROM dataspace
+		 * \param max_len  size of the XML data in bytes
+		 *
+		 * The index refers to the XML data, which must stay unmodified during
+		 * the lifetime of the index.
+		 *
+		 * \throw Invalid_syntax
+		 * \throw Out_of_ram
+		 * \throw Out_of_caps
+		 */
+		Xml_index(Allocator &alloc, char const *xml, size_t max_len)
+		:
+			_alloc(alloc), _base(xml)
+		{
+			_build_or_destroy(max_len);
+		}
+
+		/**
+		 * Constructor
+		 *
+		 * Note that creating the 'Xml_node' already scans the node. Data
+		 * that is not yet wrapped by an 'Xml_node' should be indexed directly
+		 * via the constructor above.
+		 */
+		Xml_index(Allocator &alloc, Xml_node const &node)
+		:
+			_alloc(alloc), _base(node._addr)
+		{
+			_build_or_destroy(node.size());
+		}
+
+		~Xml_index() { _destroy(); }
+
+		/**
+		 * Return number of indexed nodes
+		 */
+		unsigned num_nodes() const { return _count; }
+
+		inline Node root() const;
+};
+
+
+/**
+ * Indexed XML node
+ *
+ * The interface corresponds to the one of 'Xml_node'. The node is a
+ * light-weight reference into an 'Xml_index' and must not outlive it.
+ */
+class Genode::Xml_index::Node
+{
+	private:
+
+		friend class Xml_index;
+
+		Xml_index const *_index;
+		unsigned         _id;
+
+		Node(Xml_index const &index, unsigned id) : _index(&index), _id(id) { }
+
+		Entry const &_entry() const { return _index->_entries[_id]; }
+
+		char const *_addr() const { return _index->_base + _entry().offset; }
+
+		Node _node(unsigned id) const
+		{
+			if (id == INVALID)
+				throw Nonexistent_sub_node();
+
+			return Node(*_index, id);
+		}
+
+		/**
+		 * Return token sequence of the attributes
+		 */
+		Token _attributes() const {
+			return Token(_index->_base + _entry().attr_offset, _entry().attr_len); }
+
+		bool _has_attribute() const { return Xml_attribute::_valid(_attributes()); }
+
+		/**
+		 * Return first sibling starting at 'id' with the specified type
+		 */
+		unsigned _first(unsigned id, char const *type) const
+		{
+			for (; id != INVALID; id = _index->_entries[id].next_sibling)
+				if (!type || Node(*_index, id).has_type(type))
+					return id;
+
+			return INVALID;
+		}
+
+	public:
+
+		typedef Xml_node::Type Type;
+
+		/**
+		 * Return size of node including start and end tags in bytes
+		 */
+		size_t size() const { return _entry().size; }
+
+		/**
+		 * Return size of node content
+		 */
+		size_t content_size() const { return _entry().content_size; }
+
+		Type type() const { return Type(Cstring(_addr() + 1, _entry().name_len)); }
+
+		/**
+		 * Return true if node is of specified type
+		 */
+		bool has_type(char const *type) const
+		{
+			size_t const len = _entry().name_len;
+			return strlen(type) == len && !strcmp(type, _addr() + 1, len);
+		}
+
+		/**
+		 * Call functor 'fn' with the node data '(char const *, size_t)'
+		 */
+		template <typename FN>
+		void with_raw_node(FN const &fn) const { fn(_addr(), size()); }
+
+		/**
+		 * Call functor 'fn' with content '(char const *, size_t)' as argument
+		 */
+		template <typename FN>
+		void with_raw_content(FN const &fn) const
+		{
+			fn(_index->_base + _entry().content_offset, content_size());
+		}
+
+		/**
+		 * Return node as 'Xml_node'
+		 *
+		 * This is meant for interfacing with code that expects an 'Xml_node',
+		 * e.g., for decoding the content. Note that the 'Xml_node' scans the
+		 * node once more.
+		 */
+		Xml_node xml() const { return Xml_node(_addr(), size()); }
+
+		/**
+		 * Return the number of the node's immediate sub nodes
+		 */
+		size_t num_sub_nodes() const { return _entry().num_sub_nodes; }
+
+		/**
+		 * Return true if node is the outermost node of the index
+		 */
+		bool root() const { return _entry().parent == INVALID; }
+
+		/**
+		 * Call functor 'fn' with the parent node as argument
+		 *
+		 * The functor is not called for the root node.
+		 */
+		template <typename FN>
+		void with_parent(FN const &fn) const
+		{
+			if (!root())
+				fn(Node(*_index, _entry().parent));
+		}
+
+		/**
+		 * Return node following the current one
+		 *
+		 * \param type  type of node, or nullptr for matching any type
+		 *
+		 * \throw Nonexistent_sub_node  subsequent node does not exist
+		 */
+		Node next(char const *type = nullptr) const {
+			return _node(_first(_entry().next_sibling, type)); }
+
+		/**
+		 * Return true if node is the last of a node sequence
+		 */
+		bool last(char const *type = nullptr) const {
+			return _first(_entry().next_sibling, type) == INVALID; }
+
+		/**
+		 * Return sub node with specified index
+		 *
+		 * \throw Nonexistent_sub_node  no such sub node exists
+		 */
+		Node sub_node(unsigned idx = 0U) const
+		{
+			unsigned id = _entry().first_child;
+			for (; id != INVALID && idx > 0; idx--)
+				id = _index->_entries[id].next_sibling;
+
+			return _node(id);
+		}
+
+		/**
+		 * Return first sub node that matches the specified type
+		 *
+		 * \throw Nonexistent_sub_node  no such sub node exists
+		 */
+		Node sub_node(char const *type) const {
+			return _node(_first(_entry().first_child, type)); }
+
+		/**
+		 * Return true if sub node of specified type exists
+		 */
+		bool has_sub_node(char const *type) const {
+			return _first(_entry().first_child, type) != INVALID; }
+
+		/**
+		 * Apply functor 'fn' to first sub node of specified type
+		 *
+		 * If no matching sub node exists, the functor is not called.
+		 */
+		template <typename FN>
+		void with_sub_node(char const *type, FN const &fn) const
+		{
+			unsigned const id = _first(_entry().first_child, type);
+			if (id != INVALID)
+				fn(Node(*_index, id));
+		}
+
+		/**
+		 * Execute functor 'fn' for each sub node of specified type
+		 */
+		template <typename FN>
+		void for_each_sub_node(char const *type, FN const &fn) const
+		{
+			for (unsigned id = _first(_entry().first_child, type); id != INVALID;
+			     id = _first(_index->_entries[id].next_sibling, type))
+				fn(Node(*_index, id));
+		}
+
+		/**
+		 * Execute functor 'fn' for each sub node
+		 */
+		template <typename FN>
+		void for_each_sub_node(FN const &fn) const
+		{
+			for_each_sub_node(nullptr, fn);
+		}
+
+		/**
+		 * Return Nth attribute of node
+		 *
+		 * \throw Nonexistent_attribute  no such attribute exists
+		 */
+		Xml_attribute attribute(unsigned idx) const
+		{
+			Xml_attribute attr(_attributes());
+			for (unsigned i = 0; i < idx; i++)
+				attr = Xml_attribute(attr._next_token());
+
+			return attr;
+		}
+
+		/**
+		 * Return attribute of specified type
+		 *
+		 * \throw Nonexistent_attribute  no such attribute exists
+		 */
+		Xml_attribute attribute(char const *type) const
+		{
+			for (Xml_attribute attr(_attributes()); ;) {
+				if (attr.has_type(type))
+					return attr;
+
+				attr = Xml_attribute(attr._next_token());
+			}
+		}
+
+		/**
+		 * Read attribute value from node
+		 *
+		 * \return  attribute value or specified default value
+		 */
+		template <typename T>
+		T attribute_value(char const *type, T const default_value) const
+		{
+			T result = default_value;
+
+			if (!_has_attribute())
+				return result;
+
+			for (Xml_attribute attr(_attributes()); ; ) {
+
+				if (attr.has_type(type)) {
+					attr.value(result);
+					return result;
+				}
+
+				Token const next = attr._next_token();
+				if (!Xml_attribute::_valid(next))
+					return result;
+
+				attr = Xml_attribute(next);
+			}
+		}
+
+		/**
+		 * Return true if attribute of specified type exists
+		 */
+		bool has_attribute(char const *type) const
+		{
+			if (!_has_attribute())
+				return false;
+
+			if (type == nullptr)
+				return true;
+
+			for (Xml_attribute attr(_attributes()); ; ) {
+				if (attr.has_type(type))
+					return true;
+
+				Token const next = attr._next_token();
+				if (!Xml_attribute::_valid(next))
+					return false;
+
+				attr = Xml_attribute(next);
+			}
+		}
+
+		/**
+		 * Execute functor 'fn' for each attribute of the node
+		 */
+		template <typename FN>
+		void for_each_attribute(FN const &fn) const
+		{
+			if (!_has_attribute())
+				return;
+
+			for (Xml_attribute attr(_attributes()); ; ) {
+				fn(attr);
+
+				Token const next = attr._next_token();
+				if (!Xml_attribute::_valid(next))
+					return;
+
+				attr = Xml_attribute(next);
+			}
+		}
+
+		void print(Output &output) const { output.out_string(_addr(), size()); }
+};
+
+
+Genode::Xml_index::Node Genode::Xml_index::root() const
+{
+	if (_count == 0)
+		throw Nonexistent_sub_node();
+
+	return Node(*this, 0);
+}
+
+#endif /* _INCLUDE__UTIL__XML_INDEX_H_ */
@@ -22,6 +22,7 @@
 namespace Genode {
 	class Xml_attribute;
 	class Xml_node;
+	class Xml_index;
 	class Xml_unquoted;
 }
 
@@ -75,6 +76,8 @@ class Genode::Xml_attribute
 		 */
 		friend class Tag;
 
+		friend class Xml_index;
+
 		/**
 		 * Return true if token refers to a valid attribute
 		 */
@@ -213,6 +216,7 @@ class Genode::Xml_node
 		class Tag;
 
 		friend class Xml_unquoted;
+		friend class Xml_index;
 
 	public:
 
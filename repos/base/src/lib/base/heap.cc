@@ -28,7 +28,8 @@ namespace {
 		 * Allocation sizes >= this value are considered as big
 		 * allocations, which get their own dataspace. In contrast
 		 * to smaller allocations, this memory is released to
-		 * the RAM session when 'free()' is called.
+		 * the RAM session when 'free()' is called, unless the
+		 * dataspace is kept in the cache for reuse.
 		 */
 		BIG_ALLOCATION_THRESHOLD = 64*1024 /* in bytes */
 	};
@@ -69,6 +70,117 @@ Heap::Dataspace_pool::~Dataspace_pool()
 }
 
 
+int Heap::_size_class(size_t size)
+{
+	if (size == 0 || size > MAX_SIZE_CLASS)
+		return -1;
+
+	/* classes in steps of 16 bytes up to 128 bytes */
+	if (size <= 128)
+		return (int)((size - 1) / 16);
+
+	/* four classes per power of two above */
+	unsigned const msb  = log2(size - 1);
+	unsigned const step = msb - 2;
+
+	return (int)(8 + (msb - 7)*4 + ((size - 1) >> step) - 4);
+}
+
+
+size_t Heap::_class_size(unsigned size_class)
+{
+	if (size_class < 8)
+		return (size_class + 1)*16;
+
+	unsigned const msb = 7 + (size_class - 8) / 4;
+	unsigned const sub = (size_class - 8) % 4;
+
+	return (size_t)(5 + sub) << (msb - 2);
+}
+
+
+void Heap::_flush_free_blocks()
+{
+	for (unsigned i = 0; i < NUM_SIZE_CLASSES; i++) {
+		while (Free_block * const block = _free_blocks[i]) {
+			_free_blocks[i] = block->next;
+			_alloc->free(block);
+		}
+		_free_bytes[i] = 0;
+	}
+}
+
+
+Heap::Dataspace *Heap::_cached_dataspace(size_t size)
+{
+	/* pick the smallest cached dataspace that is not more than twice as big */
+	Dataspace *best = nullptr;
+	for (Dataspace *ds = _ds_cache.first(); ds; ds = ds->next())
+		if (ds->size >= size && ds->size < 2*size)
+			if (!best || ds->size < best->size)
+				best = ds;
+
+	if (!best)
+		return nullptr;
+
+	_ds_cache.remove(best);
+	_cached_size -= best->size;
+	_num_cached--;
+
+	_ds_pool.insert(best);
+	return best;
+}
+
+
+void Heap::_cache_dataspace(Dataspace &ds)
+{
+	/* cached dataspaces still count against the quota limit */
+	if (ds.size > MAX_CACHED_BYTES
+	 || _quota_used + _cached_size + ds.size > _quota_limit) {
+		_ds_pool.remove_and_free(ds);
+		_alloc->free(&ds);
+		return;
+	}
+
+	/*
+	 * Evict the least recently cached dataspaces to make room. New entries
+	 * are inserted at the head of the list, so the oldest one is the last.
+	 * The cache holds only a few entries, which keeps the walk cheap.
+	 */
+	while (_num_cached == MAX_CACHED_DATASPACES
+	    || _cached_size + ds.size > MAX_CACHED_BYTES) {
+
+		Dataspace *oldest = _ds_cache.first();
+		while (oldest->next())
+			oldest = oldest->next();
+
+		Dataspace &victim = *oldest;
+		_cached_size -= victim.size;
+		_num_cached--;
+
+		_ds_cache.remove_and_free(victim);
+		_alloc->free(&victim);
+	}
+
+	_ds_pool.remove(&ds);
+	_ds_cache.insert(&ds);
+	_cached_size += ds.size;
+	_num_cached++;
+}
+
+
+void Heap::_flush_ds_cache()
+{
+	for (Dataspace *ds; (ds = _ds_cache.first()); ) {
+		_ds_cache.remove_and_free(*ds);
+		_alloc->free(ds);
+	}
+
+	_cached_size = 0;
+	_num_cached  = 0;
+}
+
+
 int Heap::quota_limit(size_t new_quota_limit)
 {
 	if (new_quota_limit < _quota_used) return -1;
@@ -107,7 +219,23 @@ Heap::Dataspace *Heap::_allocate_dataspace(size_t size, bool enforce_separate_me
 			return nullptr;
 		}
 	}
-	catch (Out_of_ram)  { return nullptr; }
+	catch (Out_of_ram) {
+
+		/* retry after releasing the memory held by the dataspace cache */
+		if (!_ds_cache.first())
+			return nullptr;
+
+		_flush_ds_cache();
+		return _allocate_dataspace(size, enforce_separate_metadata);
+	}
+	catch (Out_of_caps) {
+
+		if (!_ds_cache.first())
+			throw;
+
+		_flush_ds_cache();
+		return _allocate_dataspace(size, enforce_separate_metadata);
+	}
 
 	if (enforce_separate_metadata) {
 
@@ -163,7 +291,9 @@ bool Heap::_unsynchronized_alloc(size_t size, void **out_addr)
 		/* align to 4K page */
 		dataspace_size = align_addr(size, 12);
 
-		Heap::Dataspace *ds = _allocate_dataspace(dataspace_size, true);
+		Heap::Dataspace *ds = _cached_dataspace(dataspace_size);
+		if (!ds)
+			ds = _allocate_dataspace(dataspace_size, true);
 
 		if (!ds) {
 			warning("could not allocate dataspace");
@@ -177,10 +307,29 @@ bool Heap::_unsynchronized_alloc(size_t size, void **out_addr)
 		return true;
 	}
 
+	/* round small blocks up to their size class, reuse freed block if any */
+	int const size_class = _size_class(size);
+	if (size_class >= 0) {
+		size = _class_size(size_class);
+
+		if (Free_block * const block = _free_blocks[size_class]) {
+			_free_blocks[size_class] = block->next;
+			_free_bytes[size_class] -= size;
+			_quota_used += size;
+			*out_addr = block;
+			return true;
+		}
+	}
+
 	/* try allocation at our local allocator */
 	if (_try_local_alloc(size, out_addr))
 		return true;
 
+	/* blocks held in the free lists may satisfy the request once merged */
+	_flush_free_blocks();
+	if (_try_local_alloc(size, out_addr))
+		return true;
+
 	/*
 	 * Calculate block size of needed backing store. The block must hold the
 	 * requested 'size' and we add some space for meta data
@@ -229,6 +378,9 @@ bool Heap::alloc(size_t size, void **out_addr)
 	if (size + _quota_used > _quota_limit)
 		return false;
 
+	if (size + _quota_used + _cached_size > _quota_limit)
+		_flush_ds_cache();
+
 	return _unsynchronized_alloc(size, out_addr);
 }
 
@@ -243,9 +395,21 @@ void Heap::free(void *addr, size_t)
 
 	if (size != 0) {
 
+		_quota_used -= size;
+
+		/* keep block of a size class for reuse unless its free list is full */
+		int const size_class = _size_class(size);
+		if (size_class >= 0 && _class_size(size_class) == size
+		 && _free_bytes[size_class] + size <= MAX_FREE_BYTES_PER_CLASS) {
+			Free_block * const block = construct_at<Free_block>(addr);
+			block->next = _free_blocks[size_class];
+			_free_blocks[size_class] = block;
+			_free_bytes[size_class] += size;
+			return;
+		}
+
 		/* forward request to our local allocator */
 		_alloc->free(addr, size);
-		_quota_used -= size;
 		return;
 	}
 
@@ -265,10 +429,9 @@ void Heap::free(void *addr, size_t)
 		return;
 	}
 
-	_ds_pool.remove_and_free(*ds);
-	_alloc->free(ds);
-
 	_quota_used -= ds->size;
+
+	_cache_dataspace(*ds);
 }
 
 
@@ -280,6 +443,7 @@ Heap::Heap(Ram_allocator *ram_alloc,
 :
 	_alloc(nullptr),
 	_ds_pool(ram_alloc, region_map),
+	_ds_cache(ram_alloc, region_map),
 	_quota_limit(quota_limit), _quota_used(0),
 	_chunk_size(MIN_CHUNK_SIZE)
 {
@@ -290,6 +454,8 @@ Heap::Heap(Ram_allocator *ram_alloc,
 
 Heap::~Heap()
 {
+	_flush_free_blocks();
+
 	/*
 	 * Revert allocations of heap-internal 'Dataspace' objects. Otherwise, the
 	 * subsequent destruction of the 'Allocator_avl' would detect those blocks
@@ -302,6 +468,8 @@ Heap::~Heap()
 	 */
 	for (Heap::Dataspace *ds = _ds_pool.first(); ds; ds = ds->next())
 		_alloc->free(ds, sizeof(Dataspace));
+	for (Heap::Dataspace *ds = _ds_cache.first(); ds; ds = ds->next())
+		_alloc->free(ds, sizeof(Dataspace));
 
 	/*
 	 * Destruct 'Allocator_avl' before destructing the dataspace pool. This
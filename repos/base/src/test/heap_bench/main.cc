@@ -0,0 +1,136 @@
+/*
+ * \brief  Allocation rate of the heap
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The test measures the allocation rate of the heap for two workloads:
+ *
+ * # Small blocks of pseudo-random sizes up to 2 KiB, allocated and freed in
+ *   a sliding window as typical for meta data of sessions and VFS handles
+ * # Big blocks between 64 KiB and 1 MiB that are repeatedly allocated and
+ *   freed, e.g., buffers of packet streams or XML reports
+ *
+ * The big-block workload is repeated with a sliced heap for comparison.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection _timer { _env };
+
+	unsigned const _small_rounds =
+		_config.xml().attribute_value("small_rounds", 1000000U);
+
+	unsigned const _big_rounds =
+		_config.xml().attribute_value("big_rounds", 2000U);
+
+	enum { WINDOW = 256 };
+
+	/* linear congruential generator, sufficient for picking block sizes */
+	unsigned _seed = 1;
+
+	unsigned _random()
+	{
+		_seed = _seed*1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	uint64_t _us_since(uint64_t start_us) {
+		return max(_timer.elapsed_us() - start_us, (uint64_t)1); }
+
+	void _small(Allocator &alloc)
+	{
+		void *blocks[WINDOW] { };
+
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < _small_rounds; i++) {
+			void *&slot = blocks[i % WINDOW];
+			if (slot)
+				alloc.free(slot, 0);
+
+			size_t const size = 16 + _random() % 2032;
+			if (!alloc.alloc(size, &slot)) {
+				error("small allocation of ", size, " bytes failed");
+				throw Exception();
+			}
+		}
+
+		for (void *block : blocks)
+			if (block)
+				alloc.free(block, 0);
+
+		uint64_t const us = _us_since(start_us);
+
+		log("small blocks:        ", _small_rounds, " allocations in ",
+		    us / 1000, " ms, ", (uint64_t)_small_rounds*1000000 / us, " per second");
+	}
+
+	void _big(Allocator &alloc, char const *what)
+	{
+		size_t const sizes[] = { 64*1024, 256*1024, 128*1024, 1024*1024 };
+
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < _big_rounds; i++) {
+			size_t const size = sizes[i % (sizeof(sizes)/sizeof(sizes[0]))];
+
+			void *block = nullptr;
+			if (!alloc.alloc(size, &block)) {
+				error("big allocation of ", size, " bytes failed");
+				throw Exception();
+			}
+
+			/* touch the block like a real buffer user would */
+			*(char *)block = 1;
+
+			alloc.free(block, size);
+		}
+
+		uint64_t const us = _us_since(start_us);
+
+		log(what, _big_rounds, " allocations in ",
+		    us / 1000, " ms, ", (uint64_t)_big_rounds*1000000 / us, " per second");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		{
+			Heap heap { _env.ram(), _env.rm() };
+			_small(heap);
+			_big(heap, "big blocks (heap):   ");
+		}
+
+		{
+			Sliced_heap sliced_heap { _env.ram(), _env.rm() };
+			_big(sliced_heap, "big blocks (sliced): ");
+		}
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
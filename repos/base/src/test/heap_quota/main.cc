@@ -0,0 +1,90 @@
+/*
+ * \brief  Return of freed heap blocks to the heap's quota
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The test allocates and frees many blocks of alternating size classes. The
+ * free lists of the size classes must not retain the freed blocks. Hence,
+ * the consumed quota must drop to zero after each round and the RAM of the
+ * backing store must not grow beyond the amount needed for the first round
+ * of each size.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	enum { ROUNDS = 64, NUM_BLOCKS = 1024 };
+
+	Ram_quota_guard           _ram_guard { Ram_quota { 4*1024*1024 } };
+	Cap_quota_guard           _cap_guard { Cap_quota { 64 } };
+	Constrained_ram_allocator _ram { _env.ram(), _ram_guard, _cap_guard };
+
+	Heap _heap { _ram, _env.rm() };
+
+	void _round(size_t size)
+	{
+		void *blocks[NUM_BLOCKS] { };
+
+		for (void *&block : blocks)
+			if (!_heap.alloc(size, &block)) {
+				error("allocation of ", size, " bytes failed");
+				throw Exception();
+			}
+
+		for (void *block : blocks)
+			_heap.free(block, size);
+
+		if (_heap.consumed() != 0) {
+			error("heap consumes ", _heap.consumed(), " bytes after freeing "
+			      "all blocks of ", size, " bytes");
+			throw Exception();
+		}
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		size_t const sizes[] = { 32, 2048, 128, 1024 };
+		unsigned const num_sizes = sizeof(sizes)/sizeof(sizes[0]);
+
+		/* warm up the backing store with one round per size */
+		for (size_t size : sizes)
+			_round(size);
+
+		size_t const ram_used = _ram_guard.used().value;
+
+		for (unsigned i = 0; i < ROUNDS; i++) {
+			_round(sizes[i % num_sizes]);
+
+			if (_ram_guard.used().value > ram_used) {
+				error("backing store grew from ", ram_used, " to ",
+				      _ram_guard.used().value, " bytes in round ", i);
+				throw Exception();
+			}
+		}
+
+		log("backing store: ", ram_used, " bytes after ", (unsigned)ROUNDS, " rounds");
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-heap_quota
+SRC_CC = main.cc
+LIBS   = base
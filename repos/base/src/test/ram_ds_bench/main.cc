@@ -0,0 +1,109 @@
+/*
+ * \brief  Allocation rate and memcpy throughput of RAM dataspaces
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The test measures how many RAM dataspaces of different sizes can be
+ * allocated, attached, detached, and freed per second. Afterwards, it copies
+ * between two large dataspaces to reveal the effect of the page size used
+ * for backing the dataspaces.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/attached_ram_dataspace.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <timer_session/connection.h>
+#include <util/string.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection _timer { _env };
+
+	unsigned const _iterations =
+		_config.xml().attribute_value("iterations", 1000U);
+
+	size_t const _copy_size =
+		_config.xml().attribute_value("copy_size", Number_of_bytes(32*1024*1024));
+
+	unsigned const _copy_rounds =
+		_config.xml().attribute_value("copy_rounds", 16U);
+
+	uint64_t _us_since(uint64_t start_us) { return _timer.elapsed_us() - start_us; }
+
+	void _alloc_attach_free(size_t size)
+	{
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < _iterations; i++) {
+			Ram_dataspace_capability const ds = _env.ram().alloc(size);
+
+			/* touch the first and the last page */
+			char * const ptr = _env.rm().attach(ds);
+			ptr[0] = 1;
+			ptr[size - 1] = 1;
+
+			_env.rm().detach(ptr);
+			_env.ram().free(ds);
+		}
+
+		uint64_t const us = max(_us_since(start_us), (uint64_t)1);
+
+		log("alloc/attach/free ", Number_of_bytes(size), ": ",
+		    _iterations, " iterations in ", us / 1000, " ms, ",
+		    (uint64_t)_iterations*1000000 / us, " per second");
+	}
+
+	void _copy()
+	{
+		Attached_ram_dataspace src { _env.ram(), _env.rm(), _copy_size };
+		Attached_ram_dataspace dst { _env.ram(), _env.rm(), _copy_size };
+
+		/* populate both buffers before measuring */
+		memset(src.local_addr<void>(), 0x55, _copy_size);
+		memset(dst.local_addr<void>(), 0,    _copy_size);
+
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < _copy_rounds; i++)
+			memcpy(dst.local_addr<void>(), src.local_addr<void>(), _copy_size);
+
+		uint64_t const us = max(_us_since(start_us), (uint64_t)1);
+		uint64_t const mib = (uint64_t)_copy_size*_copy_rounds / (1024*1024);
+
+		log("memcpy ", Number_of_bytes(_copy_size), ": ", _copy_rounds,
+		    " rounds in ", us / 1000, " ms, ", mib*1000000 / us, " MiB/s");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		size_t const sizes[] = { 4*1024, 64*1024, 1024*1024, 4*1024*1024 };
+
+		for (size_t size : sizes)
+			_alloc_attach_free(size);
+
+		_copy();
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-ram_ds_bench
+SRC_CC = main.cc
+LIBS   = base
@@ -22,6 +22,7 @@
 #include <vfs/directory_service.h>
 #include <vfs/file_io_service.h>
 #include <vfs/file_system_factory.h>
+#include <vfs/socket_datagram.h>
 #include <vfs/vfs_handle.h>
 #include <timer_session/connection.h>
 
@@ -130,6 +131,7 @@ namespace Vfs {
 	class Lxip_local_file;
 	class Lxip_remote_file;
 	class Lxip_peek_file;
+	class Lxip_datagram_file;
 
 	class Lxip_socket_dir;
 	struct Lxip_socket_handle;
@@ -568,6 +570,115 @@ class Vfs::Lxip_peek_file final : public Vfs::Lxip_file
 };
 
 
+/**
+ * Binary file carrying the peer address and payload of each datagram
+ *
+ * See 'vfs/socket_datagram.h' for the record format.
+ */
+class Vfs::Lxip_datagram_file final : public Vfs::Lxip_file
+{
+	private:
+
+		bool _dgram() const {
+			return _parent.parent().type() == Lxip::Protocol_dir::TYPE_DGRAM; }
+
+	public:
+
+		Lxip_datagram_file(Lxip::Socket_dir &p, Linux::socket &s)
+		: Lxip_file(p, s, "datagram") { }
+
+		/********************
+		 ** File interface **
+		 ********************/
+
+		bool poll() override
+		{
+			using namespace Linux;
+
+			file f;
+			f.f_flags = 0;
+			return (_sock.ops->poll(&f, &_sock, nullptr) & (POLLIN_SET));
+		}
+
+		Lxip::ssize_t write(Lxip_vfs_file_handle &,
+		                    char const *src, Genode::size_t len,
+		                    file_size /* ignored */) override
+		{
+			using namespace Linux;
+
+			if (!_sock_valid() || !_dgram()) return -1;
+
+			Lxip::ssize_t res = 0;
+
+			Genode::size_t const consumed = Socket_datagram::for_each_record(src, len,
+				[&] (Socket_datagram const &header, char const *payload) {
+
+					sockaddr_in addr { };
+					addr.sin_family = AF_INET;
+					addr.sin_port   = header.port;
+					Genode::memcpy(&addr.sin_addr.s_addr, header.addr,
+					               sizeof(header.addr));
+
+					iovec iov { const_cast<char *>(payload), header.length };
+
+					msghdr msg = create_msghdr(&addr, sizeof(sockaddr_in),
+					                           header.length, &iov);
+
+					res = _sock.ops->sendmsg(&_sock, &msg, header.length);
+					return res >= 0;
+				});
+
+			/* report error only if no datagram was sent at all */
+			if (res < 0 && consumed == 0) {
+				_write_err = res;
+				return res;
+			}
+
+			return consumed;
+		}
+
+		Lxip::ssize_t read(Lxip_vfs_file_handle &handle,
+		                   char *dst, Genode::size_t len,
+		                   file_size /* ignored */) override
+		{
+			using namespace Linux;
+
+			if (!_sock_valid() || !_dgram()) return -1;
+
+			if (len < sizeof(Socket_datagram)) return -1;
+
+			sockaddr_storage addr_storage;
+			sockaddr_in *addr = (sockaddr_in *)&addr_storage;
+
+			Genode::size_t const max_payload = len - sizeof(Socket_datagram);
+
+			iovec iov { dst + sizeof(Socket_datagram), max_payload };
+
+			msghdr msg = create_msghdr(addr, sizeof(addr_storage), max_payload, &iov);
+
+			/*
+			 * The remainder of a truncated datagram is discarded. With
+			 * MSG_TRUNC, the size of the whole datagram is returned.
+			 */
+			Lxip::ssize_t ret = _sock.ops->recvmsg(&_sock, &msg, max_payload,
+			                                       MSG_DONTWAIT | MSG_TRUNC);
+			if (ret == -EAGAIN) {
+				handle.io_enqueue(*_io_progress_waiters_ptr);
+				throw Would_block();
+			}
+			if (ret < 0) return -1;
+
+			Socket_datagram header { };
+			Genode::memcpy(header.addr, &addr->sin_addr.s_addr, sizeof(header.addr));
+			header.port   = addr->sin_port;
+			header.length = ret;
+			header.write_to(dst);
+
+			return sizeof(Socket_datagram) + Genode::min((Genode::size_t)ret, max_payload);
+		}
+};
+
+
 class Vfs::Lxip_bind_file final : public Vfs::Lxip_file
 {
 	private:
@@ -986,7 +1097,7 @@ class Vfs::Lxip_socket_dir final : public Lxip::Socket_dir
 
 		enum {
 			ACCEPT_NODE, BIND_NODE, CONNECT_NODE,
-			DATA_NODE, PEEK_NODE,
+			DATA_NODE, PEEK_NODE, DATAGRAM_NODE,
 			LOCAL_NODE, LISTEN_NODE, REMOTE_NODE,
 			ACCEPT_SOCKET_NODE,
 			MAX_FILES
@@ -1015,6 +1126,7 @@ class Vfs::Lxip_socket_dir final : public Lxip::Socket_dir
 		Lxip_data_file    _data_file    { *this, _sock };
 		Lxip_peek_file    _peek_file    { *this, _sock };
 		Lxip_listen_file  _listen_file  { *this, _sock };
+		Lxip_datagram_file _datagram_file { *this, _sock };
 		Lxip_local_file   _local_file   { *this, _sock };
 		Lxip_remote_file  _remote_file  { *this, _sock };
 
@@ -1052,6 +1164,7 @@ class Vfs::Lxip_socket_dir final : public Lxip::Socket_dir
 			_files[CONNECT_NODE] = &_connect_file;
 			_files[DATA_NODE]    = &_data_file;
 			_files[PEEK_NODE]    = &_peek_file;
+			_files[DATAGRAM_NODE] = &_datagram_file;
 			_files[LISTEN_NODE]  = &_listen_file;
 			_files[LOCAL_NODE]   = &_local_file;
 			_files[REMOTE_NODE]  = &_remote_file;
@@ -1064,6 +1177,7 @@ class Vfs::Lxip_socket_dir final : public Lxip::Socket_dir
 			_connect_file.dissolve_handles();
 			_data_file.dissolve_handles();
 			_peek_file.dissolve_handles();
+			_datagram_file.dissolve_handles();
 			_listen_file.dissolve_handles();
 			_local_file.dissolve_handles();
 			_remote_file.dissolve_handles();
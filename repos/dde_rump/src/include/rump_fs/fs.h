@@ -13,6 +13,8 @@
 #ifndef _INCLUDE__RUMP_FS__FS_H_
 #define _INCLUDE__RUMP_FS__FS_H_
 
+#include <base/stdint.h>
+
 /**
  * File to upon the back-end will open a block session
  */
@@ -29,7 +31,13 @@
 #define GENODE_MOUNT_DIR     "/mnt"
 
 
-void rump_io_backend_init();
+/**
+ * Initialize I/O back-end
+ *
+ * \param io_buffer_size  size of the block-session I/O buffer
+ * \param queue_depth     maximum number of block requests in flight
+ */
+void rump_io_backend_init(Genode::size_t io_buffer_size, unsigned queue_depth);
 
 /**
  * Sync I/O back-end with underlying Genode subsystems
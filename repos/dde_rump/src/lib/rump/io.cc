@@ -2,6 +2,11 @@
  * \brief  Connect rump kernel to Genode's block interface
  * \author Sebastian Sumpf
  * \date   2013-12-16
+ *
+ * Block I/O requests of the rump kernel are handed over to the block session
+ * without waiting for their completion. A dedicated thread picks up the
+ * acknowledgements and completes the requests via 'rump_biodone'. Hence, up
+ * to 'queue_depth' requests may be in flight at a time.
  */
 
 /*
@@ -13,9 +18,11 @@
 
 #include "sched.h"
 #include <base/allocator_avl.h>
+#include <base/semaphore.h>
 #include <block_session/connection.h>
 #include <rump/env.h>
 #include <rump_fs/fs.h>
+#include <util/hard_context.h>
 
 
 static const bool verbose = false;
@@ -29,82 +36,307 @@ class Backend
 {
 	private:
 
+		/*
+		 * Noncopyable
+		 */
+		Backend(Backend const &);
+		Backend &operator = (Backend const &);
+
+		using Packet_descriptor = Block::Packet_descriptor;
+
+		/*
+		 * A request occupies at most one packet-stream slot at a time, so
+		 * that the completion thread never blocks when issuing the sync
+		 * operation of a synchronous write.
+		 */
+		enum { MAX_QUEUE_DEPTH = Block::Session::TX_QUEUE_SIZE / 2 };
+
+		struct Request
+		{
+			bool            in_use    = false;
+			int             op        = 0;
+			void           *data      = nullptr;
+			size_t          length    = 0;
+			rump_biodone_fn biodone   = nullptr;
+			void           *donearg   = nullptr;
+			bool            syncing   = false;
+			bool            succeeded = false;
+
+			/* completion state of requests without 'biodone' callback */
+			bool            done      = false;
+		};
+
 		Genode::Allocator_avl _alloc { &Rump::env().heap() };
-		Block::Connection<>   _session { Rump::env().env(), &_alloc };
+		Block::Connection<>   _session;
 		Block::Session::Info  _info { _session.info() };
-		Genode::Mutex         _session_mutex;
 
-		void _sync()
+		unsigned  const _queue_depth;
+		Request * const _requests;
+
+		/*
+		 * The mutex protects the request slots and the packet allocator,
+		 * which are shared by the rump threads submitting requests and the
+		 * completion thread.
+		 */
+		Genode::Mutex     _mutex      { };
+		unsigned          _in_flight  { 0 };
+		unsigned          _waiters    { 0 };
+		Genode::Semaphore _completion { };
+
+		bool _lwp_created = false;
+
+		Hard_context_thread _completion_thread {
+			"rump_bio", &Backend::_completion_entry, this, 0 };
+
+		/*
+		 * The following methods must be called with '_mutex' acquired
+		 */
+
+		Request *_alloc_request()
+		{
+			for (unsigned i = 0; i < _queue_depth; i++) {
+				if (_requests[i].in_use)
+					continue;
+
+				_requests[i] = Request();
+				_requests[i].in_use = true;
+				_in_flight++;
+				return &_requests[i];
+			}
+			return nullptr;
+		}
+
+		void _free_request(Request &request)
+		{
+			request.in_use = false;
+			_in_flight--;
+		}
+
+		Block::Session::Tag _tag(Request const &request) const {
+			return Block::Session::Tag { (unsigned long)(&request - _requests) }; }
+
+		void _wait_for_completion()
 		{
-			using Block::Session;
+			_waiters++;
+			_mutex.release();
+			_completion.down();
+			_mutex.acquire();
+		}
+
+		void _wake_up_waiters()
+		{
+			for (; _waiters; _waiters--)
+				_completion.up();
+		}
+
+		void _submit_sync(Request &request)
+		{
+			request.syncing = true;
+			_session.tx()->submit_packet(
+				Block::Session::sync_all_packet_descriptor(_info, _tag(request)));
+		}
+
+		/*
+		 * Completion thread
+		 */
 
-			Session::Tag const tag { 0 };
-			_session.tx()->submit_packet(Session::sync_all_packet_descriptor(_info, tag));
-			_session.tx()->get_acked_packet();
+		static void *_completion_entry(void *arg)
+		{
+			static_cast<Backend *>(arg)->_handle_completions();
+			return nullptr;
+		}
+
+		void _biodone(rump_biodone_fn biodone, void *donearg,
+		              size_t length, bool succeeded)
+		{
+			/* the rump kernel must know the thread before scheduling it */
+			if (!_lwp_created) {
+				_rump_upcalls.hyp_schedule();
+				_rump_upcalls.hyp_lwproc_newlwp(0);
+				_rump_upcalls.hyp_unschedule();
+				_lwp_created = true;
+			}
+
+			_rump_upcalls.hyp_schedule();
+			biodone(donearg, succeeded ? length : 0, succeeded ? 0 : EIO);
+			_rump_upcalls.hyp_unschedule();
+		}
+
+		void _handle_completions()
+		{
+			for (;;) {
+				Packet_descriptor const packet = _session.tx()->get_acked_packet();
+
+				_mutex.acquire();
+
+				unsigned long const index = packet.tag().value;
+				if (index >= _queue_depth || !_requests[index].in_use) {
+					Genode::warning("spurious block-operation acknowledgement");
+					_mutex.release();
+					continue;
+				}
+
+				Request &request = _requests[index];
+
+				request.succeeded = packet.succeeded();
+
+				if (!request.syncing) {
+
+					/* in packet */
+					if (packet.succeeded() && packet.operation() == Packet_descriptor::READ)
+						Genode::memcpy(request.data,
+						               _session.tx()->packet_content(packet),
+						               request.length);
+
+					_session.tx()->release_packet(packet);
+
+					/* sync request, complete once the data is stable */
+					if (request.succeeded && (request.op & RUMPUSER_BIO_SYNC)) {
+						_submit_sync(request);
+						_mutex.release();
+						continue;
+					}
+				}
+
+				rump_biodone_fn const biodone   = request.biodone;
+				void          * const donearg   = request.donearg;
+				size_t          const length    = request.length;
+				bool            const succeeded = request.succeeded;
+
+				if (biodone)
+					_free_request(request);
+				else
+					request.done = true;
+
+				_wake_up_waiters();
+				_mutex.release();
+
+				if (biodone)
+					_biodone(biodone, donearg, length, succeeded);
+			}
 		}
 
 	public:
 
+		Backend(Genode::size_t io_buffer_size, unsigned queue_depth)
+		:
+			_session(Rump::env().env(), &_alloc, io_buffer_size),
+			_queue_depth(Genode::max(1U, Genode::min(queue_depth,
+			                                         (unsigned)MAX_QUEUE_DEPTH))),
+			_requests(new (Rump::env().heap()) Request[_queue_depth])
+		{ }
+
 		uint64_t block_count() const { return _info.block_count; }
 		size_t   block_size()  const { return _info.block_size; }
 		bool     writable()    const { return _info.writeable; }
 
-		void sync()
+		/**
+		 * Make all data written so far stable
+		 *
+		 * In line with the rump kernel's sync semantics, outstanding
+		 * requests are completed before the sync operation is issued.
+		 */
+		bool sync()
 		{
-			Genode::Mutex::Guard guard(_session_mutex);
-			_sync();
+			Genode::Mutex::Guard guard(_mutex);
+
+			while (_in_flight)
+				_wait_for_completion();
+
+			Request &request = *_alloc_request();
+
+			_submit_sync(request);
+
+			while (!request.done)
+				_wait_for_completion();
+
+			bool const succeeded = request.succeeded;
+			_free_request(request);
+			return succeeded;
 		}
 
-		bool submit(int op, int64_t offset, size_t length, void *data)
+		/**
+		 * Submit block request
+		 *
+		 * The request is completed asynchronously by calling 'biodone'.
+		 * If 'biodone' is not defined, the method blocks until the request
+		 * is completed.
+		 *
+		 * \return  false if the request could not be submitted or, for
+		 *          requests without 'biodone' callback, failed
+		 */
+		bool submit(int op, int64_t offset, size_t length, void *data,
+		            rump_biodone_fn biodone, void *donearg)
 		{
 			using namespace Block;
 
-			Genode::Mutex::Guard guard(_session_mutex);
-
 			Packet_descriptor::Opcode opcode;
 			opcode = op & RUMPUSER_BIO_WRITE ? Packet_descriptor::WRITE :
 			                                   Packet_descriptor::READ;
-			/* allocate packet */
-			try {
-				Packet_descriptor packet( _session.alloc_packet(length),
-				                         opcode, offset / _info.block_size,
-				                         length / _info.block_size);
-
-				/* out packet -> copy data */
-				if (opcode == Packet_descriptor::WRITE)
-					Genode::memcpy(_session.tx()->packet_content(packet), data, length);
-
-				_session.tx()->submit_packet(packet);
-			} catch(Block::Session::Tx::Source::Packet_alloc_failed) {
-				Genode::error("I/O back end: Packet allocation failed!");
-				return false;
-			}
 
-			/* wait and process result */
-			Packet_descriptor packet = _session.tx()->get_acked_packet();
+			Genode::Mutex::Guard guard(_mutex);
 
-			/* in packet */
-			if (opcode == Packet_descriptor::READ)
-				Genode::memcpy(data, _session.tx()->packet_content(packet), length);
+			for (;;) {
 
-			bool succeeded = packet.succeeded();
-			_session.tx()->release_packet(packet);
+				Request *request = _alloc_request();
 
-			/* sync request */
-			if (op & RUMPUSER_BIO_SYNC) {
-				_sync();
-			}
+				/* all request slots are in use */
+				if (!request) {
+					_wait_for_completion();
+					continue;
+				}
 
-			return succeeded;
+				try {
+					Packet_descriptor packet(_session.alloc_packet(length),
+					                         opcode, offset / _info.block_size,
+					                         length / _info.block_size,
+					                         _tag(*request));
+
+					request->op      = op;
+					request->data    = data;
+					request->length  = length;
+					request->biodone = biodone;
+					request->donearg = donearg;
+
+					/* out packet -> copy data */
+					if (opcode == Packet_descriptor::WRITE)
+						Genode::memcpy(_session.tx()->packet_content(packet), data, length);
+
+					_session.tx()->submit_packet(packet);
+
+				} catch (Block::Session::Tx::Source::Packet_alloc_failed) {
+
+					_free_request(*request);
+
+					/* the request does not fit into the I/O buffer at all */
+					if (!_in_flight) {
+						Genode::error("I/O back end: Packet allocation failed!");
+						return false;
+					}
+
+					/* wait for completed requests to free the I/O buffer */
+					_wait_for_completion();
+					continue;
+				}
+
+				if (biodone)
+					return true;
+
+				while (!request->done)
+					_wait_for_completion();
+
+				bool const succeeded = request->succeeded;
+				_free_request(*request);
+				return succeeded;
+			}
 		}
 };
 
 
-static Backend &backend()
-{
-	static Backend _b;
-	return _b;
-}
+static Genode::Constructible<Backend> _backend;
+
+
+static Backend &backend() { return *_backend; }
 
 
 int rumpuser_getfileinfo(const char *name, uint64_t *size, int *type)
@@ -151,12 +383,14 @@ void rumpuser_bio(int fd, int op, void *data, size_t dlen, int64_t off,
 		            "bio ",   donearg, " "
 		            "sync: ", !!(op & RUMPUSER_BIO_SYNC));
 
-	bool succeeded = backend().submit(op, off, dlen, data);
+	bool const submitted = backend().submit(op, off, dlen, data,
+	                                        biodone, donearg);
 
 	rumpkern_sched(nlocks, 0);
 
-	if (biodone)
-		biodone(donearg, dlen, succeeded ? 0 : EIO);
+	/* requests that are not submitted are not completed asynchronously */
+	if (biodone && !submitted)
+		biodone(donearg, 0, EIO);
 }
 
 
@@ -179,7 +413,7 @@ extern "C" void rumpns_modctor_msdos(void);
 extern "C" void rumpns_modctor_wapbl(void);
 
 
-void rump_io_backend_init()
+void rump_io_backend_init(Genode::size_t io_buffer_size, unsigned queue_depth)
 {
 	/* call init/constructor functions of rump_fs.lib.so (order is important!) */
 	rumpcompctor_RUMP_COMPONENT_KERN_SYSCALL();
@@ -194,7 +428,7 @@ void rump_io_backend_init()
 	rumpns_modctor_cd9660();
 
 	/* create back end */
-	backend();
+	_backend.construct(io_buffer_size, queue_depth);
 }
 
 
@@ -862,7 +862,11 @@ class Rump_factory : public Vfs::File_system_factory
 		{
 			Rump::construct_env(env);
 
-			rump_io_backend_init();
+			Genode::Number_of_bytes const io_buffer_size =
+				config.attribute_value("io_buffer", Genode::Number_of_bytes(1024*1024));
+
+			rump_io_backend_init(io_buffer_size,
+			                     config.attribute_value("queue_depth", 16U));
 
 			/* limit RAM consumption */
 			if (!config.has_attribute("ram")) {
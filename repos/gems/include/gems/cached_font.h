@@ -108,6 +108,25 @@ class Genode::Cached_font : public Text_painter::Font
 
 		Cache mutable _cache;
 
+		/*
+		 * Advance information of the most common codepoints
+		 *
+		 * Text measurements query the advance of each character. Keeping
+		 * the values of the first codepoints in a directly indexed table
+		 * avoids the lookup in the glyph cache, which may even require the
+		 * rasterization of the glyph in the case of a cache miss.
+		 */
+		enum { NUM_CACHED_ADVANCES = 256 };
+
+		struct Cached_advance
+		{
+			bool                          valid   = false;
+			unsigned                      width   = 0;
+			Text_painter::Fixpoint_number advance { 0 };
+		};
+
+		Cached_advance mutable _advances[NUM_CACHED_ADVANCES] { };
+
 		/**
 		 * Return number of cache elements that fit in 'avail_bytes'
 		 */
@@ -170,12 +189,23 @@ class Genode::Cached_font : public Text_painter::Font
 
 		Advance_info advance_info(Codepoint c) const override
 		{
+			bool const cacheable = c.value < NUM_CACHED_ADVANCES;
+
+			if (cacheable && _advances[c.value].valid)
+				return Advance_info { .width   = _advances[c.value].width,
+				                      .advance = _advances[c.value].advance };
+
 			unsigned                      width = 0;
 			Text_painter::Fixpoint_number advance { 0 };
 
 			Font::apply_glyph(c, [&] (Glyph const &glyph) {
 				width = glyph.width, advance = glyph.advance; });
 
+			if (cacheable)
+				_advances[c.value] = Cached_advance { .valid   = true,
+				                                      .width   = width,
+				                                      .advance = advance };
+
 			return Advance_info { .width = width, .advance = advance };
 		}
 
@@ -98,28 +98,39 @@ struct Gui_buffer
 		fn(pixel, alpha);
 	}
 
-	void reset_surface()
+	void reset_surface(Rect const rect)
 	{
+		Rect const clipped = Rect::intersect(rect, Rect(Point(0, 0), size()));
+		if (!clipped.valid())
+			return;
+
 		Pixel_surface pixel(pixel_surface_ds.local_addr<Pixel_rgb888>(), size());
 		Alpha_surface alpha(alpha_surface_ds.local_addr<Pixel_alpha8>(), size());
 
-		Genode::size_t const num_pixels = size().count();
-		Genode::memset(alpha.addr(), 0, num_pixels);
-
 		/*
 		 * Initialize color buffer with 50% gray
 		 *
 		 * We do not use black to limit the bleeding of black into antialiased
 		 * drawing operations applied onto an initially transparent background.
 		 */
-		Pixel_rgb888 *dst = pixel.addr();
-
 		Pixel_rgb888 const gray(127, 127, 127, 255);
 
-		for (unsigned n = num_pixels; n; n--)
-			*dst++ = gray;
+		unsigned const line_len = size().w();
+
+		for (int y = clipped.y1(); y <= clipped.y2(); y++) {
+
+			Genode::size_t const offset = y*line_len + clipped.x1();
+
+			Genode::memset(alpha.addr() + offset, 0, clipped.w());
+
+			Pixel_rgb888 *dst = pixel.addr() + offset;
+			for (unsigned n = clipped.w(); n; n--)
+				*dst++ = gray;
+		}
 	}
 
+	void reset_surface() { reset_surface(Rect(Point(0, 0), size())); }
+
 	template <typename DST_PT, typename SRC_PT>
 	void _convert_back_to_front(DST_PT                        *front_base,
 	                            Genode::Texture<SRC_PT> const &texture,
@@ -132,7 +143,7 @@ struct Gui_buffer
 		Blit_painter::paint(surface, texture, Point());
 	}
 
-	void _update_input_mask()
+	void _update_input_mask(Rect const rect)
 	{
 		unsigned const num_pixels = size().count();
 
@@ -141,9 +152,6 @@ struct Gui_buffer
 
 		unsigned char * const input_base = alpha_base + num_pixels;
 
-		unsigned char const *src = alpha_base;
-		unsigned char       *dst = input_base;
-
 		/*
 		 * Set input mask for all pixels where the alpha value is above a
 		 * given threshold. The threshold is defines such that typical
@@ -151,12 +159,29 @@ struct Gui_buffer
 		 */
 		unsigned char const threshold = 100;
 
-		for (unsigned i = 0; i < num_pixels; i++)
-			*dst++ = (*src++) > threshold;
+		unsigned const line_len = size().w();
+
+		for (int y = rect.y1(); y <= rect.y2(); y++) {
+
+			Genode::size_t const offset = y*line_len + rect.x1();
+
+			unsigned char const *src = alpha_base + offset;
+			unsigned char       *dst = input_base + offset;
+
+			for (unsigned i = 0; i < rect.w(); i++)
+				*dst++ = (*src++) > threshold;
+		}
 	}
 
-	void flush_surface()
+	/**
+	 * Transfer the content of 'rect' from the back buffer to the GUI buffer
+	 */
+	void flush_surface(Rect const rect)
 	{
+		Rect const clip_rect = Rect::intersect(rect, Rect(Point(0, 0), size()));
+		if (!clip_rect.valid())
+			return;
+
 		/* represent back buffer as texture */
 		Genode::Texture<Pixel_rgb888>
 			pixel_texture(pixel_surface_ds.local_addr<Pixel_rgb888>(),
@@ -166,9 +191,6 @@ struct Gui_buffer
 			alpha_texture(alpha_surface_ds.local_addr<Pixel_alpha8>(),
 			              nullptr, size());
 
-		// XXX track dirty rectangles
-		Rect const clip_rect(Genode::Surface_base::Point(0, 0), size());
-
 		Pixel_rgb888 *pixel_base = fb_ds.local_addr<Pixel_rgb888>();
 		Pixel_alpha8 *alpha_base = fb_ds.local_addr<Pixel_alpha8>()
 		                         + mode.bytes_per_pixel()*size().count();
@@ -176,8 +198,10 @@ struct Gui_buffer
 		_convert_back_to_front(pixel_base, pixel_texture, clip_rect);
 		_convert_back_to_front(alpha_base, alpha_texture, clip_rect);
 
-		_update_input_mask();
+		_update_input_mask(clip_rect);
 	}
+
+	void flush_surface() { flush_surface(Rect(Point(0, 0), size())); }
 };
 
 #endif /* _INCLUDE__GEMS__GUI_BUFFER_H_ */
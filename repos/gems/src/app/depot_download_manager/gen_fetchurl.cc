@@ -24,6 +24,14 @@ void Depot_download_manager::gen_fetchurl_start_content(Xml_generator &xml,
 	                         Cap_quota{500}, Ram_quota{8*1024*1024});
 
 	xml.node("config", [&] () {
+
+		/*
+		 * Fetch archives concurrently and continue the partial downloads of
+		 * a fetchurl instance that got stuck and was replaced
+		 */
+		xml.attribute("parallel", 4);
+		xml.attribute("resume", "yes");
+
 		xml.node("libc", [&] () {
 			xml.attribute("stdout", "/dev/log");
 			xml.attribute("stderr", "/dev/log");
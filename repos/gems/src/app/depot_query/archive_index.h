@@ -0,0 +1,382 @@
+/*
+ * \brief  Index of the meta-data files of depot archives
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The index holds the content of the 'archives', 'runtime', and 'used_apis'
+ * files of the archives consulted by depot_query. Each entry is validated
+ * against the file status (size, modification time, inode) once per run of
+ * depot_query. The index can be serialized to and restored from XML such
+ * that it survives restarts of the component.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _ARCHIVE_INDEX_H_
+#define _ARCHIVE_INDEX_H_
+
+/* Genode includes */
+#include <util/avl_tree.h>
+#include <util/xml_generator.h>
+#include <os/vfs.h>
+#include <depot/archive.h>
+
+namespace Depot_query {
+
+	using namespace Depot;
+
+	class Archive_index;
+}
+
+
+class Depot_query::Archive_index : Noncopyable
+{
+	public:
+
+		typedef Directory::Path Path;
+
+		/**
+		 * Interface of indexed file content, modelled after 'File_content'
+		 */
+		class Content
+		{
+			private:
+
+				char const * const _ptr;
+				size_t       const _size;
+
+			public:
+
+				Content(char const *ptr, size_t size) : _ptr(ptr), _size(size) { }
+
+				template <typename FN>
+				void xml(FN const &fn) const
+				{
+					try {
+						if (_size) {
+							fn(Xml_node(_ptr, _size));
+							return;
+						}
+					}
+					catch (Xml_node::Invalid_syntax) { }
+
+					fn(Xml_node("<empty/>"));
+				}
+
+				template <typename STRING, typename FN>
+				void for_each_line(FN const &fn) const
+				{
+					char const *src           = _ptr;
+					char const *curr_line     = src;
+					size_t      curr_line_len = 0;
+
+					for (size_t n = 0; ; n++) {
+
+						char const c = (n == _size) ? 0 : *src++;
+						bool const end_of_data = (c == 0);
+						bool const end_of_line = (c == '\n');
+
+						if (!end_of_data && !end_of_line) {
+							curr_line_len++;
+							continue;
+						}
+
+						if (!end_of_data || curr_line_len > 0)
+							fn(STRING(Cstring(curr_line, curr_line_len)));
+
+						if (end_of_data)
+							break;
+
+						curr_line     = src;
+						curr_line_len = 0;
+					}
+				}
+		};
+
+		struct Limit { size_t value; };
+
+		struct Stats
+		{
+			unsigned hits, misses, invalidated;
+
+			void print(Output &out) const
+			{
+				Genode::print(out, "hits: ", hits, ", misses: ", misses,
+				              ", invalidated: ", invalidated);
+			}
+		};
+
+	private:
+
+		struct File_status
+		{
+			Vfs::file_size size;
+			Genode::int64_t modification_time;
+			unsigned long   inode;
+
+			bool operator == (File_status const &other) const
+			{
+				return size == other.size
+				    && modification_time == other.modification_time
+				    && inode == other.inode;
+			}
+		};
+
+		class Entry : public Avl_node<Entry>
+		{
+			private:
+
+				/*
+				 * Noncopyable
+				 */
+				Entry(Entry const &);
+				Entry &operator = (Entry const &);
+
+				Allocator &_alloc;
+
+			public:
+
+				Path        const path;
+				File_status const status;
+				size_t      const size;
+				char      * const ptr;
+
+				/* entry was checked against the file status in this run */
+				bool validated;
+
+				Entry(Allocator &alloc, Path const &path, File_status status,
+				      size_t size, bool validated)
+				:
+					_alloc(alloc), path(path), status(status), size(size),
+					ptr(size ? (char *)alloc.alloc(size) : nullptr),
+					validated(validated)
+				{ }
+
+				~Entry() { if (ptr) _alloc.free(ptr, size); }
+
+				Content content() const { return Content(ptr, size); }
+
+				/**
+				 * Avl_node interface
+				 */
+				bool higher(Entry *other) const
+				{
+					return strcmp(other->path.string(), path.string()) > 0;
+				}
+
+				Entry *find(Path const &p)
+				{
+					if (p == path) return this;
+
+					Entry *e = Avl_node<Entry>::child(strcmp(p.string(), path.string()) > 0);
+					return e ? e->find(p) : nullptr;
+				}
+		};
+
+		Allocator &_alloc;
+
+		Vfs::File_system &_fs;
+
+		Path const _depot_path;   /* absolute VFS path of the depot */
+
+		Avl_tree<Entry> _entries { };
+
+		bool _modified = false;
+
+		Stats _stats { };
+
+		Entry *_lookup(Path const &path)
+		{
+			return _entries.first() ? _entries.first()->find(path) : nullptr;
+		}
+
+		void _remove(Entry &entry)
+		{
+			_entries.remove(&entry);
+			destroy(_alloc, &entry);
+			_modified = true;
+		}
+
+		/**
+		 * Obtain status of file
+		 *
+		 * \throw Directory::Nonexistent_file
+		 */
+		File_status _status(Path const &path)
+		{
+			Vfs::Directory_service::Stat stat { };
+
+			if (_fs.stat(Directory::join(_depot_path, path).string(), stat)
+			     != Vfs::Directory_service::STAT_OK)
+				throw Directory::Nonexistent_file();
+
+			if (stat.type != Vfs::Node_type::CONTINUOUS_FILE
+			 && stat.type != Vfs::Node_type::TRANSACTIONAL_FILE)
+				throw Directory::Nonexistent_file();
+
+			return { .size              = stat.size,
+			         .modification_time = stat.modification_time.value,
+			         .inode             = stat.inode };
+		}
+
+		/**
+		 * Read file into new index entry
+		 *
+		 * \throw Directory::Nonexistent_file
+		 * \throw Directory::Nonexistent_directory
+		 * \throw File::Truncated_during_read
+		 */
+		Entry &_read(Directory const &depot, Path const &path, Limit limit)
+		{
+			File_status const status = _status(path);
+
+			File_content const file(_alloc, depot, path, File_content::Limit{limit.value});
+
+			size_t size = 0;
+			file.bytes([&] (char const *, size_t n) { size = n; });
+
+			Entry &entry = *new (_alloc) Entry(_alloc, path, status, size, true);
+			file.bytes([&] (char const *src, size_t n) { memcpy(entry.ptr, src, n); });
+
+			_entries.insert(&entry);
+			_modified = true;
+			return entry;
+		}
+
+		/*
+		 * Archives of the 'local' depot user may change at any time
+		 */
+		static bool _indexed(Path const &path)
+		{
+			return Archive::user(path) != "local";
+		}
+
+	public:
+
+		Archive_index(Allocator &alloc, Vfs::File_system &fs, Path const &depot_path)
+		:
+			_alloc(alloc), _fs(fs), _depot_path(depot_path)
+		{ }
+
+		~Archive_index()
+		{
+			while (Entry *e = _entries.first())
+				_remove(*e);
+		}
+
+		/**
+		 * Call 'fn' with the 'Content' of the file 'name' of an archive
+		 *
+		 * \throw Directory::Nonexistent_file
+		 * \throw Directory::Nonexistent_directory
+		 * \throw File::Truncated_during_read
+		 */
+		template <typename FN>
+		void with_content(Directory const &depot, Archive::Path const &archive,
+		                  char const *name, Limit limit, FN const &fn)
+		{
+			Path const path(archive, "/", name);
+
+			if (!_indexed(path)) {
+				File_content const file(_alloc, depot, path, File_content::Limit{limit.value});
+				size_t size = 0;
+				char const *ptr = nullptr;
+				file.bytes([&] (char const *src, size_t n) { ptr = src; size = n; });
+				fn(Content(ptr, size));
+				return;
+			}
+
+			Entry *entry = _lookup(path);
+
+			/* validate entry restored from a previous run */
+			if (entry && !entry->validated) {
+				bool valid = false;
+				try { valid = (_status(path) == entry->status); }
+				catch (Directory::Nonexistent_file) { }
+
+				if (valid) {
+					entry->validated = true;
+				} else {
+					_remove(*entry);
+					entry = nullptr;
+					_stats.invalidated++;
+				}
+			}
+
+			if (entry)
+				_stats.hits++;
+			else
+				_stats.misses++;
+
+			fn((entry ? *entry : _read(depot, path, limit)).content());
+		}
+
+		/**
+		 * Return true if the index changed since the last call of 'serialize'
+		 */
+		bool modified() const { return _modified; }
+
+		Stats stats() const { return _stats; }
+
+		/**
+		 * Restore index from XML as produced by 'serialize'
+		 */
+		void restore(Xml_node const &index)
+		{
+			index.for_each_sub_node("file", [&] (Xml_node const &node) {
+
+				Path const path = node.attribute_value("path", Path());
+				if (!path.valid() || !_indexed(path) || _lookup(path))
+					return;
+
+				File_status const status {
+					.size              = node.attribute_value("size",  (Vfs::file_size)0),
+					.modification_time = node.attribute_value("mtime", 0L),
+					.inode             = node.attribute_value("inode", 0UL) };
+
+				size_t const size = node.attribute_value("length", (size_t)0);
+
+				/* the decoded content cannot be larger than the encoded one */
+				if (size > node.content_size())
+					return;
+
+				Entry &entry = *new (_alloc) Entry(_alloc, path, status, size, false);
+
+				if (node.decoded_content(entry.ptr, size) != size) {
+					destroy(_alloc, &entry);
+					return;
+				}
+				_entries.insert(&entry);
+			});
+
+			_modified = false;
+		}
+
+		/**
+		 * Generate XML representation of the index
+		 */
+		void serialize(Xml_generator &xml)
+		{
+			if (_entries.first())
+				_entries.first()->for_each([&] (Entry const &entry) {
+					xml.node("file", [&] () {
+						xml.attribute("path",   entry.path);
+						xml.attribute("size",   entry.status.size);
+						xml.attribute("mtime",  (long)entry.status.modification_time);
+						xml.attribute("inode",  entry.status.inode);
+						xml.attribute("length", entry.size);
+						if (entry.size)
+							xml.append_sanitized(entry.ptr, entry.size);
+					});
+				});
+
+			_modified = false;
+		}
+};
+
+#endif /* _ARCHIVE_INDEX_H_ */
@@ -17,12 +17,16 @@
 #include <base/attached_rom_dataspace.h>
 #include <os/reporter.h>
 #include <os/vfs.h>
+#include <os/buffered_xml.h>
 #include <depot/archive.h>
 #include <gems/lru_cache.h>
 
 /* fs_query includes */
 #include <for_each_subdir_name.h>
 
+/* local includes */
+#include <archive_index.h>
+
 namespace Depot_query {
 
 	using namespace Depot;
@@ -336,6 +340,21 @@ struct Depot_query::Main : private Rom_query
 
 	Stat_cache _depot_stat_cache { _depot_dir, _heap, _config.xml() };
 
+	/*
+	 * Content of the archives' meta-data files, optionally kept in the
+	 * file specified by the 'index' config attribute across restarts
+	 */
+	Archive_index _archive_index { _heap, _root.root_dir(), "/depot" };
+
+	typedef Directory::Path Index_path;
+
+	Index_path _index_path { };
+
+	bool _index_restored = false;
+
+	void _restore_index();
+	void _store_index();
+
 	Signal_handler<Main> _config_handler {
 		_env.ep(), *this, &Main::_handle_config };
 
@@ -369,9 +388,8 @@ struct Depot_query::Main : private Rom_query
 	void _with_file_content(Directory::Path const &path, char const *name, FN const &fn)
 	{
 		try {
-			File_content const content(_heap, Directory(_depot_dir, path),
-			                           name, File_content::Limit{16*1024});
-			fn(content);
+			_archive_index.with_content(_depot_dir, path, name,
+			                            Archive_index::Limit{16*1024}, fn);
 		}
 		catch (File_content::Nonexistent_file)   { }
 		catch (Directory::Nonexistent_directory) { }
@@ -465,6 +483,22 @@ struct Depot_query::Main : private Rom_query
 		if (query.has_type("empty"))
 			return;
 
+		Index_path const index_path = config.attribute_value("index", Index_path());
+		if (index_path != _index_path) {
+			_index_path     = index_path;
+			_index_restored = false;
+		}
+
+		/*
+		 * The index is restored at the first query, not at construction
+		 * time, to pick up the index stored by another instance in the
+		 * meantime.
+		 */
+		if (!_index_restored) {
+			_restore_index();
+			_index_restored = true;
+		}
+
 		if (!query.has_attribute("arch"))
 			warning("query lacks 'arch' attribute");
 
@@ -522,6 +556,9 @@ struct Depot_query::Main : private Rom_query
 				             node.attribute_value("version", Archive::Version()),
 				             node.attribute_value("content", false),
 				             xml); }); });
+
+		if (_archive_index.modified())
+			_store_index();
 	}
 
 	Main(Env &env) : _env(env)
@@ -537,18 +574,16 @@ Depot_query::Main::find_rom_in_pkg(Directory::Path const &pkg_path,
                                    Rom_label       const &rom_label,
                                    Recursion_limit        recursion_limit)
 {
-	/*
-	 * \throw Directory::Nonexistent_directory
-	 */
-	Directory pkg_dir(_depot_dir, pkg_path);
+	Archive::Path result;
 
 	/*
+	 * \throw Directory::Nonexistent_directory
 	 * \throw Directory::Nonexistent_file
 	 * \throw File::Truncated_during_read
 	 */
-	File_content archives(_heap, pkg_dir, "archives", File_content::Limit{16*1024});
-
-	Archive::Path result;
+	_archive_index.with_content(_depot_dir, pkg_path, "archives",
+	                            Archive_index::Limit{16*1024},
+	                            [&] (Archive_index::Content const &archives) {
 
 	archives.for_each_line<Archive::Path>([&] (Archive::Path const &archive_path) {
 
@@ -592,6 +627,7 @@ Depot_query::Main::find_rom_in_pkg(Directory::Path const &pkg_path,
 			break;
 		}
 	});
+	});
 	return result;
 }
 
@@ -648,7 +684,7 @@ void Depot_query::Main::_gen_inherited_rom_path_nodes(Xml_generator       &xml,
                                                       Archive::Path const &pkg_path,
                                                       Recursion_limit      recursion_limit)
 {
-	_with_file_content(pkg_path, "archives", [&] (File_content const &archives) {
+	_with_file_content(pkg_path, "archives", [&] (Archive_index::Content const &archives) {
 		archives.for_each_line<Archive::Path>([&] (Archive::Path const &archive_path) {
 
 			/* early return if archive path is not a valid pkg path */
@@ -658,7 +694,7 @@ void Depot_query::Main::_gen_inherited_rom_path_nodes(Xml_generator       &xml,
 			}
 			catch (Archive::Unknown_archive_type) { return; }
 
-			_with_file_content(archive_path, "runtime" , [&] (File_content const &runtime) {
+			_with_file_content(archive_path, "runtime" , [&] (Archive_index::Content const &runtime) {
 				runtime.xml([&] (Xml_node node) {
 					_gen_rom_path_nodes(xml, env_xml, pkg_path, node); }); });
 
@@ -670,9 +706,9 @@ void Depot_query::Main::_gen_inherited_rom_path_nodes(Xml_generator       &xml,
 
 void Depot_query::Main::_query_blueprint(Directory::Path const &pkg_path, Xml_generator &xml)
 {
-	Directory pkg_dir(_root, Directory::Path("depot/", pkg_path));
-
-	File_content runtime(_heap, pkg_dir, "runtime", File_content::Limit{16*1024});
+	_archive_index.with_content(_depot_dir, pkg_path, "runtime",
+	                            Archive_index::Limit{16*1024},
+	                            [&] (Archive_index::Content const &runtime) {
 
 	runtime.xml([&] (Xml_node node) {
 
@@ -699,6 +735,7 @@ void Depot_query::Main::_query_blueprint(Directory::Path const &pkg_path, Xml_ge
 			xml.append("\n");
 		});
 	});
+	});
 }
 
 
@@ -717,7 +754,7 @@ void Depot_query::Main::_collect_source_dependencies(Archive::Path const &path,
 	switch (Archive::type(path)) {
 
 	case Archive::PKG: {
-		_with_file_content(path, "archives", [&] (File_content const &archives) {
+		_with_file_content(path, "archives", [&] (Archive_index::Content const &archives) {
 			archives.for_each_line<Archive::Path>([&] (Archive::Path const &path) {
 				_collect_source_dependencies(path, dependencies, recursion_limit); }); });
 		break;
@@ -725,7 +762,7 @@ void Depot_query::Main::_collect_source_dependencies(Archive::Path const &path,
 
 	case Archive::SRC: {
 		typedef String<160> Api;
-		_with_file_content(path, "used_apis", [&] (File_content const &used_apis) {
+		_with_file_content(path, "used_apis", [&] (Archive_index::Content const &used_apis) {
 			used_apis.for_each_line<Archive::Path>([&] (Api const &api) {
 				dependencies.record(Archive::Path(Archive::user(path), "/api/", api)); }); });
 		break;
@@ -752,7 +789,7 @@ void Depot_query::Main::_collect_binary_dependencies(Archive::Path const &path,
 	case Archive::PKG:
 		dependencies.record(path);
 
-		_with_file_content(path, "archives", [&] (File_content const &archives) {
+		_with_file_content(path, "archives", [&] (Archive_index::Content const &archives) {
 			archives.for_each_line<Archive::Path>([&] (Archive::Path const &archive_path) {
 				_collect_binary_dependencies(archive_path, dependencies, recursion_limit); }); });
 		break;
@@ -771,6 +808,88 @@ void Depot_query::Main::_collect_binary_dependencies(Archive::Path const &path,
 }
 
 
+void Depot_query::Main::_restore_index()
+{
+	if (!_index_path.valid())
+		return;
+
+	try {
+		File_content const content(_heap, _root, _index_path,
+		                           File_content::Limit{_config.xml().attribute_value("index_limit",
+		                                                   Number_of_bytes(16*1024*1024))});
+		content.xml([&] (Xml_node node) {
+			if (node.has_type("archive_index"))
+				_archive_index.restore(node); });
+	}
+	catch (File_content::Nonexistent_file) { }
+	catch (File_content::Truncated_during_read) {
+		warning("failed to read archive index '", _index_path, "'"); }
+	catch (Out_of_ram)  { warning("restored archive index exceeds RAM quota"); }
+	catch (Out_of_caps) { warning("restored archive index exceeds cap quota"); }
+}
+
+
+void Depot_query::Main::_store_index()
+{
+	if (!_index_path.valid())
+		return;
+
+	using DS     = Vfs::Directory_service;
+	using Result = Vfs::File_io_service::Write_result;
+
+	Vfs::File_system &fs = _root.root_dir();
+
+	Vfs::Vfs_handle *handle = nullptr;
+	if (fs.open(_index_path.string(), DS::OPEN_MODE_WRONLY | DS::OPEN_MODE_CREATE,
+	            &handle, _heap) != DS::OPEN_OK
+	 && fs.open(_index_path.string(), DS::OPEN_MODE_WRONLY,
+	            &handle, _heap) != DS::OPEN_OK) {
+		warning("failed to open archive index '", _index_path, "' for writing");
+		return;
+	}
+
+	try {
+		Buffered_xml const index(_heap, "archive_index", [&] (Xml_generator &xml) {
+			_archive_index.serialize(xml); }, Buffered_xml::Min_size{64*1024});
+
+		index.with_xml_node([&] (Xml_node const &node) {
+			node.with_raw_node([&] (char const *start, size_t length) {
+
+				fs.ftruncate(handle, 0);
+
+				while (length) {
+					Vfs::file_size out = 0;
+					Result result = Result::WRITE_ERR_INVALID;
+					try {
+						result = fs.write(handle, start, length, out);
+					} catch (Vfs::File_io_service::Insufficient_buffer) {
+						result = Result::WRITE_ERR_WOULD_BLOCK;
+					}
+
+					if (result == Result::WRITE_ERR_WOULD_BLOCK) {
+						_env.ep().wait_and_dispatch_one_io_signal();
+						continue;
+					}
+
+					if (result != Result::WRITE_OK) {
+						warning("failed to write archive index '", _index_path, "'");
+						break;
+					}
+
+					start  += out;
+					length -= out;
+					handle->advance_seek(out);
+				}
+			});
+		});
+	}
+	catch (Out_of_ram)  { warning("archive index exceeds RAM quota"); }
+	catch (Out_of_caps) { warning("archive index exceeds cap quota"); }
+
+	fs.close(handle);
+}
+
+
 void Depot_query::Main::_query_user(Archive::User const &user, Xml_generator &xml)
 {
 	xml.attribute("name", user);
@@ -2,3 +2,4 @@ TARGET  := depot_query
 SRC_CC  := main.cc
 LIBS    += base vfs
 INC_DIR += $(REP_DIR)/src/app/fs_query
+INC_DIR += $(PRG_DIR)
@@ -21,7 +21,7 @@
 #include <os/vfs.h>
 
 /* local includes */
-#include <for_each_subdir_name.h>
+#include <sorted_for_each.h>
 
 namespace Fs_query {
 	using namespace Genode;
@@ -32,7 +32,13 @@ namespace Fs_query {
 }
 
 
-struct Fs_query::Watched_file
+/**
+ * File of a watched directory
+ *
+ * The file content is read on demand and cached until the file's watch
+ * handle reports a modification.
+ */
+struct Fs_query::Watched_file : Vfs::Watch_response_handler
 {
 	File_content::Path const _name;
 
@@ -44,23 +50,77 @@ struct Fs_query::Watched_file
 		return (strcmp(other._name.string(), _name.string()) > 0);
 	}
 
-	Node_rwx const _rwx;
+	/*
+	 * Node properties used to detect the replacement of the file by another
+	 * file of the same name, which is not reported by the file's watch
+	 * handle but by the one of the directory. File systems that do not
+	 * provide inode numbers leave the file unidentifiable.
+	 */
+	struct Key
+	{
+		Node_rwx       rwx;
+		unsigned long  inode;
+		Vfs::file_size size;
+		Vfs::Timestamp modification_time;
+
+		bool operator == (Key const &other) const
+		{
+			return inode != 0
+			    && rwx.readable   == other.rwx.readable
+			    && rwx.writeable  == other.rwx.writeable
+			    && rwx.executable == other.rwx.executable
+			    && inode == other.inode && size == other.size
+			    && modification_time.value == other.modification_time.value;
+		}
+	};
+
+	Key const _key;
+
+	Vfs::Watch_response_handler &_update_handler;
 
 	Watcher _watcher;
 
-	Watched_file(Directory const &dir, File_content::Path name, Node_rwx rwx,
-	             Vfs::Watch_response_handler &handler)
-	: _name(name), _rwx(rwx), _watcher(dir, name, handler) { }
+	Constructible<File_content> _content { };
+
+	bool _content_stale = true;
+
+	/* used for detecting vanished files while re-scanning the directory */
+	bool _present = true;
+
+	Watched_file(Directory const &dir, File_content::Path name, Key key,
+	             Vfs::Watch_response_handler &update_handler)
+	:
+		_name(name), _key(key), _update_handler(update_handler),
+		_watcher(dir, name, *this)
+	{ }
 
 	virtual ~Watched_file() { }
 
-	void _gen_content(Xml_generator &xml, Allocator &alloc, Directory const &dir) const
+	/**
+	 * Vfs::Watch_response_handler interface
+	 */
+	void watch_response() override
+	{
+		_content_stale = true;
+		_update_handler.watch_response();
+	}
+
+	bool has_name(Directory::Entry::Name const &name) const
+	{
+		return _name == name;
+	}
+
+	void _gen_content(Xml_generator &xml, Allocator &alloc, Directory const &dir)
 	{
-		File_content content(alloc, dir, _name, File_content::Limit{4*1024});
+		if (_content_stale || !_content.constructed()) {
+			_content.destruct();
+			_content.construct(alloc, dir, _name, File_content::Limit{4*1024});
+			_content_stale = false;
+		}
 
 		bool content_is_xml = false;
 
-		content.xml([&] (Xml_node node) {
+		_content->xml([&] (Xml_node node) {
 			if (!node.has_type("empty")) {
 				xml.attribute("xml", "yes");
 				xml.append("\n");
@@ -71,19 +131,19 @@ struct Fs_query::Watched_file
 		});
 
 		if (!content_is_xml) {
-			content.bytes([&] (char const *base, size_t len) {
+			_content->bytes([&] (char const *base, size_t len) {
 				xml.append_sanitized(base, len); });
 		}
 	}
 
 	void gen_query_response(Xml_generator &xml, Xml_node query,
-	                        Allocator &alloc, Directory const &dir) const
+	                        Allocator &alloc, Directory const &dir)
 	{
 		try {
 			xml.node("file", [&] () {
 				xml.attribute("name", _name);
 
-				if (_rwx.writeable)
+				if (_key.rwx.writeable)
 					xml.attribute("writeable", "yes");
 
 				if (query.attribute_value("content", false))
@@ -103,57 +163,163 @@ struct Fs_query::Watched_file
 };
 
 
-struct Fs_query::Watched_directory
+/**
+ * Watched directory
+ *
+ * The list of entries is obtained only initially and whenever the watch
+ * handle of the directory fires. Files that remain unchanged keep their
+ * cached content.
+ */
+struct Fs_query::Watched_directory : Vfs::Watch_response_handler
 {
 	Allocator &_alloc;
 
+	Vfs::File_system &_fs;
+
 	Directory::Path const _rel_path;
 
 	Directory const _dir;
 
+	Vfs::Watch_response_handler &_update_handler;
+
 	Watcher _watcher;
 
 	Registry<Registered<Watched_file> > _files { };
 
-	Watched_directory(Allocator &alloc, Directory &other, Directory::Path const &rel_path,
-	                  Vfs::Watch_response_handler &handler)
-	:
-		_alloc(alloc), _rel_path(rel_path),
-		_dir(other, rel_path), _watcher(other, rel_path, handler)
+	struct Subdir_name : Interface
 	{
+		Directory::Entry::Name const name;
+
+		Subdir_name(Directory::Entry::Name const &name) : name(name) { }
+
+		/**
+		 * Support for 'sorted_for_each'
+		 */
+		bool higher(Subdir_name const &other) const
+		{
+			return (strcmp(other.name.string(), name.string()) > 0);
+		}
+	};
+
+	Registry<Registered<Subdir_name> > _subdirs { };
+
+	bool _entries_stale = false;
+
+	Watched_file::Key _file_key(Directory::Entry const &entry) const
+	{
+		Vfs::Directory_service::Stat stat { };
+		stat.modification_time.value = Vfs::Timestamp::INVALID;
+
+		_fs.stat(Directory::join(_rel_path, entry.name()).string(), stat);
+
+		return { .rwx               = entry.rwx(),
+		         .inode             = stat.inode,
+		         .size              = stat.size,
+		         .modification_time = stat.modification_time };
+	}
+
+	void _scan_entries()
+	{
+		_subdirs.for_each([&] (Registered<Subdir_name> &subdir) {
+			destroy(_alloc, &subdir); });
+
+		_files.for_each([&] (Watched_file &file) { file._present = false; });
+
 		_dir.for_each_entry([&] (Directory::Entry const &entry) {
 
+			if (entry.dir()) {
+				new (_alloc) Registered<Subdir_name>(_subdirs, entry.name());
+				return;
+			}
+
 			using Dirent_type = Vfs::Directory_service::Dirent_type;
 			bool const file = (entry.type() == Dirent_type::CONTINUOUS_FILE)
 			               || (entry.type() == Dirent_type::TRANSACTIONAL_FILE);
-			if (file) {
-				try {
-					new (_alloc) Registered<Watched_file>(_files, _dir, entry.name(),
-					                                      entry.rwx(), handler);
-				} catch (...) { }
-			}
+			if (!file)
+				return;
+
+			Watched_file::Key const key = _file_key(entry);
+
+			/* keep unchanged file including its cached content */
+			bool known = false;
+			_files.for_each([&] (Registered<Watched_file> &watched) {
+				if (!watched.has_name(entry.name()))
+					return;
+
+				if (watched._key == key) {
+					watched._present = true;
+					known = true;
+				}
+			});
+
+			if (known)
+				return;
+
+			try {
+				new (_alloc) Registered<Watched_file>(_files, _dir, entry.name(),
+				                                      key, _update_handler);
+			} catch (...) { }
 		});
+
+		/* destroy vanished and replaced files */
+		_files.for_each([&] (Registered<Watched_file> &file) {
+			if (!file._present)
+				destroy(_alloc, &file); });
+	}
+
+	Watched_directory(Allocator &alloc, Vfs::File_system &fs, Directory &other,
+	                  Directory::Path const &rel_path,
+	                  Vfs::Watch_response_handler &update_handler)
+	:
+		_alloc(alloc), _fs(fs), _rel_path(rel_path),
+		_dir(other, rel_path), _update_handler(update_handler),
+		_watcher(other, rel_path, *this)
+	{
+		_scan_entries();
 	}
 
 	virtual ~Watched_directory()
 	{
 		_files.for_each([&] (Registered<Watched_file> &file) {
 			destroy(_alloc, &file); });
+
+		_subdirs.for_each([&] (Registered<Subdir_name> &subdir) {
+			destroy(_alloc, &subdir); });
+	}
+
+	/**
+	 * Vfs::Watch_response_handler interface
+	 */
+	void watch_response() override
+	{
+		_entries_stale = true;
+		_update_handler.watch_response();
 	}
 
 	bool has_name(Directory::Path const &name) const { return _rel_path == name; }
 
-	void gen_query_response(Xml_generator &xml, Xml_node query) const
+	void update()
+	{
+		if (!_entries_stale)
+			return;
+
+		_entries_stale = false;
+		_scan_entries();
+	}
+
+	void gen_query_response(Xml_generator &xml, Xml_node query)
 	{
 		xml.node("dir", [&] () {
 			xml.attribute("path", _rel_path);
 
-			for_each_subdir_name(_alloc, _dir, [&] (Directory::Entry::Name const &name) {
+			sorted_for_each(_alloc, _subdirs, [&] (Subdir_name const &subdir) {
 				xml.node("dir", [&] () {
-					xml.attribute("name", name); }); });
+					xml.attribute("name", subdir.name); }); });
 
+			/* 'sorted_for_each' hands out const references */
 			sorted_for_each(_alloc, _files, [&] (Watched_file const &file) {
-				file.gen_query_response(xml, query, _alloc, _dir); });
+				const_cast<Watched_file &>(file).gen_query_response(xml, query,
+				                                                    _alloc, _dir); });
 		});
 	}
 };
@@ -171,10 +337,14 @@ struct Fs_query::Main : Vfs::Watch_response_handler
 
 	/**
 	 * Vfs::Watch_response_handler interface
+	 *
+	 * Called by the watched directories and files after marking themselves
+	 * as stale. The update is deferred to the signal handler because the
+	 * watch response is delivered from within the VFS.
 	 */
 	void watch_response() override
 	{
-		Signal_transmitter(_config_handler).submit();
+		Signal_transmitter(_update_handler).submit();
 	}
 
 	struct Vfs_env : Vfs::Env
@@ -197,21 +367,39 @@ struct Fs_query::Main : Vfs::Watch_response_handler
 	Signal_handler<Main> _config_handler {
 		_env.ep(), *this, &Main::_handle_config };
 
+	Signal_handler<Main> _update_handler {
+		_env.ep(), *this, &Main::_handle_update };
+
 	Expanding_reporter _reporter { _env, "listing", "listing" };
 
 	Registry<Registered<Watched_directory> > _dirs { };
 
-	void _gen_listing(Xml_generator &xml, Xml_node config) const
+	void _gen_listing(Xml_generator &xml, Xml_node config)
 	{
 		config.for_each_sub_node("query", [&] (Xml_node query) {
 			Directory::Path const path = query.attribute_value("path", Directory::Path());
-			_dirs.for_each([&] (Watched_directory const &dir) {
+			_dirs.for_each([&] (Watched_directory &dir) {
 				if (dir.has_name(path))
 					dir.gen_query_response(xml, query);
 			});
 		});
 	}
 
+	void _generate_report()
+	{
+		Xml_node const config = _config.xml();
+
+		_reporter.generate([&] (Xml_generator &xml) {
+			_gen_listing(xml, config); });
+	}
+
+	void _handle_update()
+	{
+		_dirs.for_each([&] (Watched_directory &dir) { dir.update(); });
+
+		_generate_report();
+	}
+
 	void _handle_config()
 	{
 		_config.update();
@@ -225,11 +413,11 @@ struct Fs_query::Main : Vfs::Watch_response_handler
 
 		config.for_each_sub_node("query", [&] (Xml_node query) {
 			Directory::Path const path = query.attribute_value("path", Directory::Path());
-			new (_heap) Registered<Watched_directory>(_dirs, _heap, _root_dir, path, *this);
+			new (_heap) Registered<Watched_directory>(_dirs, _heap, _root_dir_fs,
+			                                          _root_dir, path, *this);
 		});
 
-		_reporter.generate([&] (Xml_generator &xml) {
-			_gen_listing(xml, config); });
+		_generate_report();
 	}
 
 	Main(Env &env) : _env(env)
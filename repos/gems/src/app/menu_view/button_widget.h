@@ -194,6 +194,9 @@ struct Menu_view::Button_widget : Widget, Animator::Item
 	}
 
 
+	bool _content_animated() const override { return animated(); }
+
+
 	/******************************
 	 ** Animator::Item interface **
 	 ******************************/
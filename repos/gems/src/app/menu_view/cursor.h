@@ -93,6 +93,8 @@ class Menu_view::Cursor : List_model<Cursor>::Element
 		}
 
 
+		bool animated() const { return _position.animated(); }
+
 		void draw(Surface<Pixel_rgb888> &pixel_surface,
 		          Surface<Pixel_alpha8> &alpha_surface,
 		          Point at, unsigned height) const
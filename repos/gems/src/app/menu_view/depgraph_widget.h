@@ -713,6 +713,25 @@ struct Menu_view::Depgraph_widget : Widget
 		});
 	}
 
+	/*
+	 * The connections depend on the <dep> nodes of the children
+	 */
+	unsigned long _node_checksum(Xml_node node) const override
+	{
+		return _subtree_checksum(node);
+	}
+
+	bool _content_animated() const override
+	{
+		bool result = false;
+		_nodes.for_each([&] (Node const &node) {
+			node._deps.for_each([&] (Node::Dependency const &dep) {
+				result = result || dep.animated(); }); });
+		return result;
+	}
+
+	bool _draws_between_children() const override { return true; }
+
 	void draw(Surface<Pixel_rgb888> &pixel_surface,
 	          Surface<Pixel_alpha8> &alpha_surface,
 	          Point at) const override
@@ -35,6 +35,11 @@ struct Menu_view::Label_widget : Widget, Cursor::Glyph_position
 	int _min_width  = 0;
 	int _min_height = 0;
 
+	/*
+	 * Width of '_text' when rendered with '_font', measured at update time
+	 */
+	int _text_width = 0;
+
 	Cursor::Model_update_policy         _cursor_update_policy;
 	Text_selection::Model_update_policy _selection_update_policy;
 
@@ -71,6 +76,8 @@ struct Menu_view::Label_widget : Widget, Cursor::Glyph_position
 			_min_height = _font->height();
 		}
 
+		_text_width = _font ? _font->string_width(_text.string()).decimal() : 0;
+
 		unsigned const min_ex = node.attribute_value("min_ex", 0U);
 		if (min_ex) {
 			Glyph_painter::Fixpoint_number min_w_px = _font->string_width("x");
@@ -87,8 +94,7 @@ struct Menu_view::Label_widget : Widget, Cursor::Glyph_position
 		if (!_font)
 			return Area(0, 0);
 
-		return Area(max(_font->string_width(_text.string()).decimal(), _min_width),
-		            _min_height);
+		return Area(max(_text_width, _min_width), _min_height);
 	}
 
 	void draw(Surface<Pixel_rgb888> &pixel_surface,
@@ -124,6 +130,22 @@ struct Menu_view::Label_widget : Widget, Cursor::Glyph_position
 			cursor.draw(pixel_surface, alpha_surface, at, text_size.h()); });
 	}
 
+	/*
+	 * Cursors and selections are sub nodes of the label node
+	 */
+	unsigned long _node_checksum(Xml_node node) const override
+	{
+		return _subtree_checksum(node);
+	}
+
+	bool _content_animated() const override
+	{
+		bool result = _color.animated();
+		_cursors.for_each([&] (Cursor const &cursor) {
+			result = result || cursor.animated(); });
+		return result;
+	}
+
 	/**
 	 * Cursor::Glyph_position interface
 	 */
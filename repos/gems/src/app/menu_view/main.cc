@@ -164,8 +164,19 @@ struct Menu_view::Main
 
 	void _update_hover_report();
 
+	/*
+	 * Report of the duration and damaged area of each redraw, enabled via
+	 * '<report frame_time="yes"/>'
+	 */
+	Genode::Reporter _frame_time_reporter = { _env, "frame_time" };
+
 	bool _schedule_redraw = false;
 
+	/**
+	 * Set if the whole buffer must be redrawn at the next redraw
+	 */
+	bool _redraw_all = true;
+
 	/**
 	 * Frame of last call of 'handle_frame_timer'
 	 */
@@ -224,7 +235,8 @@ void Menu_view::Main::_update_hover_report()
 
 void Menu_view::Main::_handle_dialog_update()
 {
-	_styles.flush_outdated_styles();
+	if (_styles.flush_outdated_styles())
+		_redraw_all = true;
 
 	try {
 		Xml_node const config = _config.xml();
@@ -272,12 +284,16 @@ void Menu_view::Main::_handle_config()
 	_config.update();
 
 	try {
-		_hover_reporter.enabled(_config.xml().sub_node("report")
-		                                     .attribute_value("hover", false));
+		Xml_node const report = _config.xml().sub_node("report");
+		_hover_reporter     .enabled(report.attribute_value("hover",      false));
+		_frame_time_reporter.enabled(report.attribute_value("frame_time", false));
 	} catch (...) {
-		_hover_reporter.enabled(false);
+		_hover_reporter     .enabled(false);
+		_frame_time_reporter.enabled(false);
 	}
 
+	_redraw_all = true;
+
 	_config.xml().with_sub_node("vfs", [&] (Xml_node const &vfs_node) {
 		_vfs_env.root_dir().apply_config(vfs_node); });
 
@@ -338,6 +354,8 @@ void Menu_view::Main::_handle_frame_timer()
 
 		_frame_cnt = 0;
 
+		Genode::uint64_t const start_us = _timer.elapsed_us();
+
 		Area const size = _root_widget_size();
 
 		unsigned const buffer_w = _buffer.constructed() ? _buffer->size().w() : 0,
@@ -348,25 +366,60 @@ void Menu_view::Main::_handle_frame_timer()
 		bool const size_increased = (max_size.w() > buffer_w)
 		                         || (max_size.h() > buffer_h);
 
-		if (!_buffer.constructed() || size_increased)
+		if (!_buffer.constructed() || size_increased) {
 			_buffer.construct(_gui, max_size, _env.ram(), _env.rm());
-		else
-			_buffer->reset_surface();
+			_redraw_all = true;
+		}
 
 		_root_widget.position(Point(0, 0));
 
-		// XXX restrict redraw to dirty regions
-		//     don't perform a full dialog update
-		_buffer->apply_to_surface([&] (Surface<Pixel_rgb888> &pixel,
-		                               Surface<Pixel_alpha8> &alpha) {
-			_root_widget.draw(pixel, alpha, Point(0, 0));
+		Widget_factory::Damage &damage = _widget_factory.damage;
+
+		_root_widget.collect_damage(Point(0, 0));
+
+		Rect const buffer_rect(Point(0, 0), _buffer->size());
+
+		if (_redraw_all)
+			damage.mark_as_dirty(buffer_rect);
+
+		_redraw_all = false;
+
+		unsigned long damaged_pixels = 0;
+
+		damage.flush([&] (Rect const &dirty) {
+
+			Rect const rect = Rect::intersect(dirty, buffer_rect);
+			if (!rect.valid())
+				return;
+
+			_buffer->reset_surface(rect);
+
+			_buffer->apply_to_surface([&] (Surface<Pixel_rgb888> &pixel,
+			                               Surface<Pixel_alpha8> &alpha) {
+				pixel.clip(rect);
+				alpha.clip(rect);
+				_root_widget.draw(pixel, alpha, Point(0, 0));
+			});
+
+			_buffer->flush_surface(rect);
+			_gui.framebuffer()->refresh(rect.x1(), rect.y1(), rect.w(), rect.h());
+
+			damaged_pixels += rect.area().count();
 		});
 
-		_buffer->flush_surface();
-		_gui.framebuffer()->refresh(0, 0, _buffer->size().w(), _buffer->size().h());
 		_update_view(Rect(_position, size));
 
 		_schedule_redraw = false;
+
+		if (_frame_time_reporter.enabled()) {
+			Genode::uint64_t const duration_us = _timer.elapsed_us() - start_us;
+
+			Genode::Reporter::Xml_generator xml(_frame_time_reporter, [&] () {
+				xml.attribute("us",      duration_us);
+				xml.attribute("damaged", damaged_pixels);
+				xml.attribute("total",   buffer_rect.area().count());
+			});
+		}
 	}
 
 	/*
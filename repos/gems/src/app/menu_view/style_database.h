@@ -56,6 +56,9 @@ class Menu_view::Style_database
 		 */
 		bool mutable _out_of_date = false;
 
+		/* incremented whenever styles are flushed */
+		unsigned _generation = 0;
+
 		typedef String<PATH_MAX_LEN> Path;
 
 		typedef ::File::Reading_failed Reading_failed;
@@ -293,10 +296,15 @@ class Menu_view::Style_database
 			fn(_label_style(node));
 		}
 
-		void flush_outdated_styles()
+		/**
+		 * Flush styles that changed since the last call
+		 *
+		 * \return true if any style got flushed
+		 */
+		bool flush_outdated_styles()
 		{
 			if (!_out_of_date)
-				return;
+				return false;
 
 			/* flush fonts that are marked as out of date */
 			for (Font_entry *font = _fonts.first(), *next = nullptr; font; ) {
@@ -309,7 +317,17 @@ class Menu_view::Style_database
 				font = next;
 			}
 			_out_of_date = false;
+			_generation++;
+			return true;
 		}
+
+		/**
+		 * Return version of the style database
+		 *
+		 * Widgets must re-obtain their styles if the generation changed
+		 * since their last update.
+		 */
+		unsigned generation() const { return _generation; }
 };
 
 #endif /* _STYLE_DATABASE_H_ */
@@ -125,19 +125,48 @@ class Menu_view::Widget : List_model<Widget>::Element
 		{
 			Widget_factory &_factory;
 
+			/*
+			 * Set whenever child widgets are added, removed, or updated
+			 */
+			bool children_changed = false;
+
 			Model_update_policy(Widget_factory &factory) : _factory(factory) { }
 
-			void destroy_element(Widget &w) { _factory.destroy(&w); }
+			void destroy_element(Widget &w)
+			{
+				children_changed = true;
+				_factory.destroy(&w);
+			}
 
 			Widget &create_element(Xml_node elem_node)
 			{
+				children_changed = true;
+
 				if (Widget *w = _factory.create(elem_node))
 					return *w;
 
 				throw Unknown_element_type();
 			}
 
-			void update_element(Widget &w, Xml_node node) { w.update(node); }
+			void update_element(Widget &w, Xml_node node)
+			{
+				/* skip subtrees that are unchanged since the last update */
+				unsigned long const subtree_hash = _subtree_checksum(node);
+				unsigned const style_generation  = _factory.styles.generation();
+
+				if (w._updated && subtree_hash     == w._subtree_hash
+				               && style_generation == w._style_generation)
+					return;
+
+				w._updated          = true;
+				w._subtree_hash     = subtree_hash;
+				w._style_generation = style_generation;
+				w._layout_needed    = true;
+				children_changed    = true;
+
+				w._track_content_change(node);
+				w.update(node);
+			}
 
 			static bool element_matches_xml_node(Widget const &w, Xml_node node)
 			{
@@ -148,9 +177,27 @@ class Menu_view::Widget : List_model<Widget>::Element
 
 		} _model_update_policy { _factory };
 
+		/*
+		 * State of the incremental update
+		 *
+		 * The checksum of the widget's XML subtree at the last update
+		 * allows for skipping the update of unchanged subtrees. The
+		 * layout of a widget is only recomputed if its size changed or
+		 * its subtree got updated.
+		 */
+		bool          _updated          = false;
+		unsigned long _subtree_hash     = 0;
+		unsigned      _style_generation = 0;
+		bool          _layout_needed    = true;
+
 		inline void _update_children(Xml_node node)
 		{
+			_model_update_policy.children_changed = false;
+
 			_children.update_from_xml(_model_update_policy, node);
+
+			if (_model_update_policy.children_changed)
+				_layout_needed = true;
 		}
 
 		void _draw_children(Surface<Pixel_rgb888> &pixel_surface,
@@ -158,7 +205,15 @@ class Menu_view::Widget : List_model<Widget>::Element
 		                    Point at) const
 		{
 			_children.for_each([&] (Widget const &w) {
-				w.draw(pixel_surface, alpha_surface, at + w._animated_geometry.p1()); });
+
+				Point const child_at = at + w._animated_geometry.p1();
+
+				/* skip children outside the redrawn area */
+				Rect const child_rect(child_at, w._animated_geometry.area());
+				if (!Rect::intersect(child_rect, pixel_surface.clip()).valid())
+					return;
+
+				w.draw(pixel_surface, alpha_surface, child_at); });
 		}
 
 		virtual void _layout() { }
@@ -186,6 +241,83 @@ class Menu_view::Widget : List_model<Widget>::Element
 				_animated_geometry.move_to(_geometry, motion_steps());
 		}
 
+		/*
+		 * Damage tracking
+		 *
+		 * A widget is redrawn if its XML node changed in a way that affects
+		 * its appearance, if it is in the middle of an animation, or if its
+		 * absolute position differs from the one at the last redraw.
+		 */
+		unsigned long _content_hash    = 0;
+		bool          _content_changed = true;
+		Rect          _drawn_rect { };
+
+		/**
+		 * Return checksum of the part of 'node' that affects the widget
+		 *
+		 * By default, only the start tag with the widget's attributes is
+		 * considered. Widgets that are drawn according to non-widget sub
+		 * nodes must include those in the checksum.
+		 */
+		virtual unsigned long _node_checksum(Xml_node node) const
+		{
+			return _start_tag_checksum(node);
+		}
+
+		/**
+		 * Return true while the widget's appearance is animated
+		 */
+		virtual bool _content_animated() const { return false; }
+
+		/**
+		 * Return true if the widget draws between its children
+		 *
+		 * For such widgets, any damage of a child damages the whole widget.
+		 */
+		virtual bool _draws_between_children() const { return false; }
+
+		static unsigned long _checksum(unsigned long hash, char const *s, size_t len)
+		{
+			for (size_t i = 0; i < len; i++)
+				hash = hash*33 + (unsigned char)s[i];
+			return hash;
+		}
+
+		static unsigned long _start_tag_checksum(Xml_node node)
+		{
+			unsigned long hash = 5381;
+			node.with_raw_node([&] (char const *start, size_t len) {
+
+				/* find end of start tag, skipping quoted attribute values */
+				bool quoted = false;
+				size_t n = 0;
+				for (; n < len; n++) {
+					if (start[n] == '"') quoted = !quoted;
+					if (start[n] == '>' && !quoted) break;
+				}
+				hash = _checksum(hash, start, n);
+			});
+			return hash;
+		}
+
+		static unsigned long _subtree_checksum(Xml_node node)
+		{
+			unsigned long hash = 5381;
+			node.with_raw_node([&] (char const *start, size_t len) {
+				hash = _checksum(hash, start, len); });
+			return hash;
+		}
+
+		void _track_content_change(Xml_node node)
+		{
+			unsigned long const hash = _node_checksum(node);
+
+			if (hash != _content_hash)
+				_content_changed = true;
+
+			_content_hash = hash;
+		}
+
 		void _gen_common_hover_attr(Xml_generator &xml) const
 		{
 			xml.attribute("name",   _name.string());
@@ -225,6 +357,10 @@ class Menu_view::Widget : List_model<Widget>::Element
 		virtual ~Widget()
 		{
 			_children.destroy_all_elements(_model_update_policy);
+
+			/* reveal the area formerly covered by the widget */
+			if (_drawn_rect.valid())
+				_factory.damage.mark_as_dirty(_drawn_rect);
 		}
 
 		bool has_name(Name const &name) const { return name == _name; }
@@ -242,9 +378,14 @@ class Menu_view::Widget : List_model<Widget>::Element
 		 */
 		void size(Area size)
 		{
+			bool const size_changed = (size != _geometry.area());
+
 			_geometry = Rect(_geometry.p1(), size);
 
-			_layout();
+			if (size_changed || _layout_needed)
+				_layout();
+
+			_layout_needed = false;
 
 			_trigger_geometry_animation();
 		}
@@ -254,6 +395,40 @@ class Menu_view::Widget : List_model<Widget>::Element
 			_geometry = Rect(position, _geometry.area());
 		}
 
+		/**
+		 * Mark areas affected by changes since the last call as damaged
+		 *
+		 * \param at  absolute position of the widget
+		 * \return    true if the widget or any of its children got damaged
+		 */
+		bool collect_damage(Point at)
+		{
+			Rect const rect(at, _animated_geometry.area());
+
+			bool const damaged = _content_changed
+			                  || _content_animated()
+			                  || rect.p1() != _drawn_rect.p1()
+			                  || rect.p2() != _drawn_rect.p2();
+			if (damaged) {
+				if (_drawn_rect.valid())
+					_factory.damage.mark_as_dirty(_drawn_rect);
+				_factory.damage.mark_as_dirty(rect);
+			}
+
+			bool children_damaged = false;
+			_children.for_each([&] (Widget &w) {
+				if (w.collect_damage(at + w._animated_geometry.p1()))
+					children_damaged = true; });
+
+			if (children_damaged && _draws_between_children())
+				_factory.damage.mark_as_dirty(rect);
+
+			_drawn_rect      = rect;
+			_content_changed = false;
+
+			return damaged || children_damaged;
+		}
+
 		static Point _at_child(Point at, Widget const &w)
 		{
 			return at - w.geometry().p1();
@@ -17,6 +17,9 @@
 /* local includes */
 #include "style_database.h"
 
+/* Genode includes */
+#include <util/dirty_rect.h>
+
 /* gems includes */
 #include <gems/animator.h>
 
@@ -39,6 +42,13 @@ class Menu_view::Widget_factory
 		Style_database &styles;
 		Animator       &animator;
 
+		/*
+		 * Areas to be redrawn, populated by the widgets
+		 */
+		typedef Dirty_rect<Rect, 4> Damage;
+
+		Damage damage { };
+
 		Widget_factory(Allocator &alloc, Style_database &styles, Animator &animator)
 		:
 			alloc(alloc), styles(styles), animator(animator)
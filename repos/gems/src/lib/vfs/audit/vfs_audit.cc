@@ -101,6 +101,12 @@ class Vfs_audit::File_system : public Vfs::File_system
 				Vfs_handle::handler(rh);
 				if (audit) audit->handler(rh);
 			}
+
+			void observer(Handle_observer *observer) override
+			{
+				Vfs_handle::observer(observer);
+				if (audit) audit->observer(observer);
+			}
 		};
 
 	public:
@@ -256,6 +262,32 @@ class Vfs_audit::File_system : public Vfs::File_system
 			return h.audit->fs().notify_read_ready(h.audit);
 		}
 
+		bool write_ready(Vfs_handle *vfs_handle) override
+		{
+			Handle &h = *static_cast<Handle*>(vfs_handle);
+			h.sync_state();
+			return h.audit->fs().write_ready(h.audit);
+		}
+
+		bool notify_write_ready(Vfs_handle *vfs_handle) override
+		{
+			Handle &h = *static_cast<Handle*>(vfs_handle);
+			h.sync_state();
+			return h.audit->fs().notify_write_ready(h.audit);
+		}
+
+		file_size read_available(Vfs_handle *vfs_handle) override
+		{
+			Handle &h = *static_cast<Handle*>(vfs_handle);
+			return h.audit->fs().read_available(h.audit);
+		}
+
+		file_size write_available(Vfs_handle *vfs_handle) override
+		{
+			Handle &h = *static_cast<Handle*>(vfs_handle);
+			return h.audit->fs().write_available(h.audit);
+		}
+
 		Ftruncate_result ftruncate(Vfs_handle *vfs_handle,
 		                           file_size len) override
 		{
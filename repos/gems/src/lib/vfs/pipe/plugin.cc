@@ -78,6 +78,8 @@ struct Vfs_pipe::Pipe_handle : Vfs::Vfs_handle, private Pipe_handle_registry_ele
 
 	bool read_ready();
 	bool notify_read_ready();
+	bool write_ready();
+	bool notify_write_ready();
 };
 
 
@@ -222,7 +224,7 @@ struct Vfs_pipe::Pipe
 		}
 
 		out_count = out;
-		if (out < count)
+		if (out < count && !handle.io_progress_elem.enqueued())
 			io_progress_waiters.enqueue(handle.io_progress_elem);
 
 		if (notify)
@@ -294,6 +296,20 @@ Vfs_pipe::Pipe_handle::notify_read_ready()
 }
 
 
+bool
+Vfs_pipe::Pipe_handle::write_ready() {
+	return writer && pipe.buffer.avail_capacity() > 0; }
+
+
+bool
+Vfs_pipe::Pipe_handle::notify_write_ready()
+{
+	if (writer && !io_progress_elem.enqueued())
+		pipe.io_progress_waiters.enqueue(io_progress_elem);
+	return true;
+}
+
+
 struct Vfs_pipe::New_pipe_handle : Vfs::Vfs_handle
 {
 	Pipe &pipe;
@@ -604,6 +620,36 @@ class Vfs_pipe::File_system : public Vfs::File_system
 			return false;
 		}
 
+		bool write_ready(Vfs_handle *vfs_handle) override
+		{
+			if (Pipe_handle *handle = dynamic_cast<Pipe_handle*>(vfs_handle))
+				return handle->write_ready();
+			return true;
+		}
+
+		bool notify_write_ready(Vfs_handle *vfs_handle) override
+		{
+			if (Pipe_handle *handle = dynamic_cast<Pipe_handle*>(vfs_handle))
+				return handle->notify_write_ready();
+			return false;
+		}
+
+		file_size read_available(Vfs_handle *vfs_handle) override
+		{
+			if (Pipe_handle *handle = dynamic_cast<Pipe_handle*>(vfs_handle))
+				if (!handle->writer)
+					return PIPE_BUF_SIZE - handle->pipe.buffer.avail_capacity();
+			return 0;
+		}
+
+		file_size write_available(Vfs_handle *vfs_handle) override
+		{
+			if (Pipe_handle *handle = dynamic_cast<Pipe_handle*>(vfs_handle))
+				if (handle->writer)
+					return handle->pipe.buffer.avail_capacity();
+			return 0;
+		}
+
 		Ftruncate_result ftruncate(Vfs_handle*, file_size) override {
 			return FTRUNCATE_ERR_NO_PERM; }
 
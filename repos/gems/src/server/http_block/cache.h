@@ -0,0 +1,143 @@
+/*
+ * \brief  In-RAM cache of remote-file chunks
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The cache holds a fixed number of equally sized chunks of the remote
+ * file. If all slots are occupied, the least recently used chunk is
+ * replaced.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+/* Genode includes */
+#include <base/attached_ram_dataspace.h>
+#include <base/allocator.h>
+
+namespace Http_block { class Cache; }
+
+
+class Http_block::Cache : Genode::Noncopyable
+{
+	public:
+
+		typedef Genode::uint64_t Chunk_nr;
+
+	private:
+
+		typedef Genode::size_t   size_t;
+		typedef Genode::uint64_t uint64_t;
+
+		struct Entry
+		{
+			Chunk_nr chunk_nr;
+			size_t   length;     /* valid bytes, less than chunk size at EOF */
+			uint64_t last_used;
+			bool     valid;
+		};
+
+		Genode::Allocator &_alloc;
+
+		size_t   const _chunk_size;
+		unsigned const _num_entries;
+
+		Genode::Attached_ram_dataspace _ds;
+
+		Entry * const _entries;
+
+		uint64_t _now = 0;
+
+		char *_data(unsigned i) { return _ds.local_addr<char>() + i*_chunk_size; }
+
+		Entry *_lookup(Chunk_nr chunk_nr)
+		{
+			for (unsigned i = 0; i < _num_entries; i++)
+				if (_entries[i].valid && _entries[i].chunk_nr == chunk_nr)
+					return &_entries[i];
+
+			return nullptr;
+		}
+
+		/*
+		 * Noncopyable
+		 */
+		Cache(Cache const &);
+		Cache &operator = (Cache const &);
+
+	public:
+
+		Cache(Genode::Ram_allocator &ram, Genode::Region_map &rm,
+		      Genode::Allocator &alloc, size_t chunk_size, unsigned num_entries)
+		:
+			_alloc(alloc), _chunk_size(chunk_size),
+			_num_entries(Genode::max(num_entries, 1U)),
+			_ds(ram, rm, _num_entries*_chunk_size),
+			_entries((Entry *)alloc.alloc(_num_entries*sizeof(Entry)))
+		{
+			for (unsigned i = 0; i < _num_entries; i++)
+				_entries[i] = Entry { 0, 0, 0, false };
+		}
+
+		~Cache() { _alloc.free(_entries, _num_entries*sizeof(Entry)); }
+
+		size_t   chunk_size() const { return _chunk_size; }
+		unsigned capacity()   const { return _num_entries; }
+
+		bool cached(Chunk_nr chunk_nr) { return _lookup(chunk_nr) != nullptr; }
+
+		/**
+		 * Call 'fn(char const *data, size_t length)' for cached chunk
+		 *
+		 * \return  false if the chunk is not cached
+		 */
+		template <typename FN>
+		bool with_chunk(Chunk_nr chunk_nr, FN const &fn)
+		{
+			Entry * const entry = _lookup(chunk_nr);
+			if (!entry)
+				return false;
+
+			entry->last_used = ++_now;
+			fn((char const *)_data(entry - _entries), entry->length);
+			return true;
+		}
+
+		/**
+		 * Allocate slot for chunk, replacing the least recently used chunk
+		 *
+		 * \return  buffer of 'length' bytes to be filled by the caller
+		 */
+		char *insert(Chunk_nr chunk_nr, size_t length)
+		{
+			unsigned victim = 0;
+			for (unsigned i = 0; i < _num_entries; i++) {
+				if (!_entries[i].valid) { victim = i; break; }
+
+				if (_entries[i].last_used < _entries[victim].last_used)
+					victim = i;
+			}
+
+			_entries[victim] = Entry { chunk_nr, Genode::min(length, _chunk_size),
+			                           ++_now, true };
+			return _data(victim);
+		}
+
+		/**
+		 * Drop chunk, e.g., if it could not be filled completely
+		 */
+		void invalidate(Chunk_nr chunk_nr)
+		{
+			if (Entry * const entry = _lookup(chunk_nr))
+				entry->valid = false;
+		}
+};
+
+#endif /* _CACHE_H_ */
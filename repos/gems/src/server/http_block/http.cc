@@ -76,7 +76,12 @@ void Http::connect()
 }
 
 
-void Http::reconnect(){ close(_fd); connect(); }
+void Http::reconnect()
+{
+	close(_fd);
+	_recv_pos = _recv_len = 0;
+	connect();
+}
 
 
 void Http::resolve_uri()
@@ -92,14 +97,33 @@ void Http::resolve_uri()
 }
 
 
+bool Http::fill_recv_buf()
+{
+	ssize_t const n = read(_fd, _recv_buf, HTTP_BUF);
+	if (n <= 0)
+		return false;
+
+	_recv_pos = 0;
+	_recv_len = n;
+	return true;
+}
+
+
 Genode::size_t Http::read_header()
 {
 	bool header = true; size_t i = 0;
 
+	/*
+	 * Copy the header from the receive buffer, which is filled by reading
+	 * from the socket in large portions. Data that follows the header
+	 * stays in the receive buffer.
+	 */
 	while (header) {
-		if (!read(_fd, &_http_buf[i], 1))
+		if (_recv_pos == _recv_len && !fill_recv_buf())
 			throw Http::Socket_closed();
 
+		_http_buf[i] = _recv_buf[_recv_pos++];
+
 		if (i >= 3 && _http_buf[i - 3] == '\r' && _http_buf[i - 2] == '\n'
 		 && _http_buf[i - 1] == '\r' && _http_buf[i - 0] == '\n')
 			header = false;
@@ -163,6 +187,13 @@ void Http::do_read(void * buf, size_t size)
 {
 	size_t buf_fill = 0;
 
+	/* consume data received along with the header first */
+	if (_recv_pos < _recv_len) {
+		buf_fill = min(size, _recv_len - _recv_pos);
+		Genode::memcpy(buf, _recv_buf + _recv_pos, buf_fill);
+		_recv_pos += buf_fill;
+	}
+
 	while (buf_fill < size) {
 
 		int part;
@@ -178,9 +209,10 @@ void Http::do_read(void * buf, size_t size)
 
 
 Http::Http(Genode::Heap &heap, ::String const &uri)
-: _heap(heap), _port((char *)"80")
+: _heap(heap), _port((char *)"80"), _recv_pos(0), _recv_len(0)
 {
 	_heap.alloc(HTTP_BUF, (void**)&_http_buf);
+	_heap.alloc(HTTP_BUF, (void**)&_recv_buf);
 
 	/* parse URI */
 	parse_uri(uri);
@@ -201,6 +233,7 @@ Http::~Http()
 	_heap.free(_host, Genode::strlen(_host) + 1);
 	_heap.free(_path, Genode::strlen(_path) + 2);
 	_heap.free(_http_buf, HTTP_BUF);
+	_heap.free(_recv_buf, HTTP_BUF);
 	_heap.free(_info, sizeof(struct addrinfo));
 }
 
@@ -237,12 +270,13 @@ void Http::parse_uri(::String const &u)
 }
 
 
-void Http::cmd_get(size_t file_offset, size_t size, addr_t buffer)
+void Http::request_range(size_t file_offset, size_t size)
 {
 	while (true) {
 
 		const char *http_templ = "GET %s HTTP/1.1\r\n"
 		                         "Host: %s\r\n"
+		                         "Connection: keep-alive\r\n"
 		                         "Range: bytes=%lu-%lu\r\n"
 		                         "\r\n";
 
@@ -267,10 +301,30 @@ void Http::cmd_get(size_t file_offset, size_t size, addr_t buffer)
 
 		if (_http_ret != HTTP_SUCC_PARTIAL) {
 			error("cmd_get: server returned ", _http_ret);
+
+			/* the unread body of the reply would desynchronize the connection */
+			reconnect();
 			throw Http::Server_error();
 		}
 
-		do_read((void *)(buffer), size);
 		return;
 	}
 }
+
+
+void Http::read_body(void *buf, size_t size)
+{
+	try {
+		do_read(buf, size);
+	} catch (...) {
+		reconnect();
+		throw;
+	}
+}
+
+
+void Http::cmd_get(size_t file_offset, size_t size, addr_t buffer)
+{
+	request_range(file_offset, size);
+	read_body((void *)buffer, size);
+}
@@ -33,6 +33,9 @@ class Http
 		char            *_port;      /* host port */
 		char            *_path;      /* absolute file path on host */
 		char            *_http_buf;  /* internal data buffer */
+		char            *_recv_buf;  /* data received but not yet consumed */
+		size_t           _recv_pos;  /* first unconsumed byte */
+		size_t           _recv_len;  /* number of bytes in '_recv_buf' */
 		unsigned         _http_ret;  /* HTTP status code */
 		struct addrinfo *_info;      /* Resolved address info for host */
 		int              _fd;        /* Socket file handle */
@@ -68,6 +71,11 @@ class Http
 		 */
 		size_t read_header();
 
+		/*
+		 * Fill receive buffer, return false if connection got closed
+		 */
+		bool fill_recv_buf();
+
 		/*
 		 * Determine remote-file size
 		 */
@@ -113,6 +121,22 @@ class Http
 		 */
 		void cmd_get(size_t file_offset, size_t size, addr_t buffer);
 
+		/**
+		 * Send 'GET' command for range and receive response header
+		 *
+		 * The body must be consumed via 'read_body' afterwards. The
+		 * connection is kept alive for subsequent requests.
+		 */
+		void request_range(size_t file_offset, size_t size);
+
+		/**
+		 * Read part of the body of the current response
+		 *
+		 * On error, the connection is re-established and the remainder of
+		 * the response is dropped.
+		 */
+		void read_body(void *buf, size_t size);
+
 		/* Exceptions */
 		class Exception     : public ::Genode::Exception { };
 		class Uri_error     : public Exception { };
@@ -6,102 +6,555 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2021 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
  */
 
 /* Genode includes */
+#include <base/attached_ram_dataspace.h>
 #include <base/attached_rom_dataspace.h>
+#include <base/heap.h>
 #include <base/log.h>
-#include <block/component.h>
+#include <block/request_stream.h>
+#include <root/root.h>
 #include <libc/component.h>
 
 /* local includes */
+#include "cache.h"
 #include "http.h"
 
-using namespace Genode;
+namespace Http_block {
 
-class Driver : public Block::Driver
+	using namespace Genode;
+
+	class Backend;
+	class Jobs;
+	struct Block_session_component;
+	struct Main;
+}
+
+
+/**
+ * Remote file accessed through the chunk cache
+ */
+class Http_block::Backend : Noncopyable
 {
+	public:
+
+		struct Config
+		{
+			size_t block_size;
+			size_t chunk_size;
+			size_t cache_size;
+			size_t read_ahead;
+
+			static Config from_xml(Xml_node const &config)
+			{
+				size_t const block_size =
+					config.attribute_value("block_size", 512U);
+
+				/* chunks must hold a whole number of blocks */
+				size_t const chunk_size =
+					align_addr(max((size_t)config.attribute_value("chunk_size",
+					                                              Number_of_bytes(64*1024)),
+					               block_size), log2(block_size));
+				return {
+					.block_size = block_size,
+					.chunk_size = chunk_size,
+					.cache_size = config.attribute_value("cache_size",
+					                                     Number_of_bytes(8*1024*1024)),
+					.read_ahead = config.attribute_value("read_ahead",
+					                                     Number_of_bytes(1024*1024)),
+				};
+			}
+		};
+
+		struct Read_error : Exception { };
+
 	private:
 
-		size_t _block_size;
-		Http   _http;
+		typedef Cache::Chunk_nr Chunk_nr;
 
-	public:
+		Http  _http;
+		Cache _cache;
+
+		size_t const _block_size;
+		size_t const _chunk_size = _cache.chunk_size();
+		size_t const _file_size  = _http.file_size();
+
+		Chunk_nr const _num_chunks = (_file_size + _chunk_size - 1) / _chunk_size;
+
+		/*
+		 * Upper bound of chunks transferred by one range request, which
+		 * prevents the chunks of a request from replacing each other
+		 */
+		Chunk_nr const _max_run = max(_cache.capacity() / 4, 1U);
+
+		Chunk_nr const _read_ahead_chunks;
+
+		Chunk_nr _last_end        = 0;  /* end of previous read */
+		Chunk_nr _read_ahead_from = 0;
+		bool     _read_ahead      = false;
 
-		Driver(Heap &heap, Ram_allocator &ram,
-		       size_t block_size, ::String const &uri)
-		: Block::Driver(ram),
-		  _block_size(block_size), _http(heap, uri) {}
+		/**
+		 * Fetch chunks [first, end) with a single range request
+		 */
+		void _fetch(Chunk_nr first, Chunk_nr end)
+		{
+			size_t const offset = first*_chunk_size;
+			size_t const length = min((end - first)*_chunk_size, _file_size - offset);
+
+			_http.request_range(offset, length);
 
+			for (Chunk_nr c = first; c < end; c++) {
 
-		/*******************************
-		 **  Block::Driver interface  **
-		 *******************************/
+				size_t const len = min(_chunk_size, length - (c - first)*_chunk_size);
 
-		Block::Session::Info info() const override
+				char * const dst = _cache.insert(c, len);
+				try { _http.read_body(dst, len); }
+				catch (...) {
+					_cache.invalidate(c);
+					throw;
+				}
+			}
+		}
+
+		/**
+		 * Fetch chunks of [first, end) that are not cached
+		 *
+		 * Consecutive missing chunks are coalesced into one request.
+		 */
+		void _fetch_missing(Chunk_nr first, Chunk_nr end)
+		{
+			end = min(end, _num_chunks);
+
+			for (Chunk_nr c = first; c < end; ) {
+
+				if (_cache.cached(c)) {
+					c++;
+					continue;
+				}
+
+				Chunk_nr run_end = c + 1;
+				while (run_end < end && run_end - c < _max_run && !_cache.cached(run_end))
+					run_end++;
+
+				_fetch(c, run_end);
+				c = run_end;
+			}
+		}
+
+	public:
+
+		Backend(Env &env, Heap &heap, ::String const &uri, Config const &config)
+		:
+			_http(heap, uri),
+			_cache(env.ram(), env.rm(), heap, config.chunk_size,
+			       (unsigned)(config.cache_size / config.chunk_size)),
+			_block_size(config.block_size),
+			_read_ahead_chunks(min((Chunk_nr)(config.read_ahead / _chunk_size),
+			                       (Chunk_nr)_cache.capacity() / 2))
+		{ }
+
+		Block::Session::Info info() const
 		{
 			return { .block_size  = _block_size,
-			         .block_count = _http.file_size() / _block_size,
+			         .block_count = _file_size / _block_size,
 			         .align_log2  = log2(_block_size),
 			         .writeable   = false };
 		}
 
-		void read(Block::sector_t           block_nr,
-		          Genode::size_t            block_count,
-		          char                     *buffer,
-		          Block::Packet_descriptor &packet)
+		/**
+		 * Populate cache with the byte range [offset, offset + size)
+		 *
+		 * This is used to transfer the data of adjacent requests at once.
+		 */
+		void prefetch(uint64_t offset, size_t size)
 		{
-			_http.cmd_get(block_nr * _block_size, block_count * _block_size,
-			              (addr_t)buffer);
-			ack_packet(packet);
+			Chunk_nr const first = offset / _chunk_size;
+			Chunk_nr const end   = (offset + size + _chunk_size - 1) / _chunk_size;
+
+			_fetch_missing(first, min(end, first + _cache.capacity() / 2));
 		}
-	};
 
+		void read(uint64_t offset, size_t size, char *dst)
+		{
+			Chunk_nr const first = offset / _chunk_size;
+			Chunk_nr const end   = (offset + size + _chunk_size - 1) / _chunk_size;
 
-class Factory : public Block::Driver_factory
+			bool const sequential = (first == _last_end || first + 1 == _last_end);
+			_last_end = end;
+
+			while (size) {
+
+				Chunk_nr const c            = offset / _chunk_size;
+				size_t   const chunk_offset = offset % _chunk_size;
+
+				if (!_cache.cached(c))
+					_fetch_missing(c, min(end, c + _max_run));
+
+				size_t copied = 0;
+				_cache.with_chunk(c, [&] (char const *data, size_t length) {
+					if (length > chunk_offset) {
+						copied = min(size, length - chunk_offset);
+						memcpy(dst, data + chunk_offset, copied);
+					}
+				});
+
+				if (!copied)
+					throw Read_error();
+
+				offset += copied;
+				dst    += copied;
+				size   -= copied;
+			}
+
+			if (sequential) {
+				_read_ahead      = true;
+				_read_ahead_from = end;
+			}
+		}
+
+		/**
+		 * Fetch the chunks that follow a sequential read
+		 *
+		 * The read-ahead window is refilled once its first half got
+		 * consumed, which results in range requests of half the window size.
+		 *
+		 * \return  true if data was transferred
+		 */
+		bool read_ahead()
+		{
+			if (!_read_ahead)
+				return false;
+
+			_read_ahead = false;
+
+			Chunk_nr const first = _read_ahead_from;
+			Chunk_nr const end   = min(first + _read_ahead_chunks, _num_chunks);
+
+			if (first >= end || _cache.cached(first + (end - first) / 2))
+				return false;
+
+			try { _fetch_missing(first, end); }
+			catch (...) {
+				warning("read-ahead at offset ", first*_chunk_size, " failed");
+			}
+			return true;
+		}
+};
+
+
+/**
+ * Requests accepted from the client
+ *
+ * All pending requests are executed at once. Requests that refer to
+ * adjacent or overlapping parts of the file are transferred by a single
+ * range request.
+ */
+class Http_block::Jobs : Noncopyable
 {
 	private:
 
-		Env                   &_env;
-		Heap                  &_heap;
-		Attached_rom_dataspace _config { _env, "config" };
-		::String         const _uri;
-		size_t           const _blk_sz;
+		enum { MAX_JOBS = 32 };
+
+		enum class State { FREE, PENDING, COMPLETE };
+
+		struct Job
+		{
+			Block::Request request;
+			char          *dst;
+			State          state;
+		};
+
+		Job _jobs[MAX_JOBS] { };
+
+		size_t const _block_size;
+
+		uint64_t _offset(Job const &job) const {
+			return job.request.operation.block_number*_block_size; }
+
+		size_t _size(Job const &job) const {
+			return job.request.operation.count*_block_size; }
+
+		void _prefetch(Backend &backend)
+		{
+			Job *sorted[MAX_JOBS];
+			unsigned num = 0;
+
+			for (Job &job : _jobs)
+				if (job.state == State::PENDING)
+					sorted[num++] = &job;
+
+			/* insertion sort by file offset */
+			for (unsigned i = 1; i < num; i++)
+				for (unsigned j = i; j > 0 && _offset(*sorted[j]) < _offset(*sorted[j - 1]); j--) {
+					Job *tmp = sorted[j];
+					sorted[j] = sorted[j - 1];
+					sorted[j - 1] = tmp;
+				}
+
+			for (unsigned i = 0; i < num; ) {
+
+				uint64_t const start = _offset(*sorted[i]);
+				uint64_t       end   = start + _size(*sorted[i]);
+
+				for (i++; i < num && _offset(*sorted[i]) <= end; i++)
+					end = max(end, _offset(*sorted[i]) + _size(*sorted[i]));
+
+				try { backend.prefetch(start, (size_t)(end - start)); }
+				catch (...) { /* reported by 'Backend::read' */ }
+			}
+		}
 
 	public:
 
-		Factory(Env &env, Heap &heap)
-		:
-			_env(env), _heap(heap),
-			_uri   (_config.xml().attribute_value("uri", ::String())),
-			_blk_sz(_config.xml().attribute_value("block_size", 512U))
+		Jobs(size_t block_size) : _block_size(block_size) { }
+
+		bool acceptable() const
 		{
-			log("Using file=", _uri, " as device with block size ",
-			    Hex(_blk_sz, Hex::OMIT_PREFIX), ".");
+			for (Job const &job : _jobs)
+				if (job.state == State::FREE)
+					return true;
+
+			return false;
 		}
 
-		Block::Driver *create() {
-			return new (&_heap) Driver(_heap, _env.ram(), _blk_sz, _uri); }
+		void submit(Block::Request request, char *dst)
+		{
+			for (Job &job : _jobs)
+				if (job.state == State::FREE) {
+					job = Job { request, dst, State::PENDING };
+					return;
+				}
+		}
 
-	void destroy(Block::Driver *driver) {
-		Genode::destroy(&_heap, driver); }
+		/**
+		 * Execute pending jobs
+		 *
+		 * \return  true if progress was made
+		 */
+		bool execute(Backend &backend)
+		{
+			bool progress = false;
+
+			_prefetch(backend);
+
+			for (Job &job : _jobs) {
+				if (job.state != State::PENDING)
+					continue;
+
+				job.request.success = false;
+				try {
+					backend.read(_offset(job), _size(job), job.dst);
+					job.request.success = true;
+				}
+				catch (Http::Exception) {
+					error("failed to read block ", job.request.operation.block_number); }
+				catch (Backend::Read_error) {
+					error("failed to read block ", job.request.operation.block_number); }
+
+				job.state = State::COMPLETE;
+				progress  = true;
+			}
+			return progress;
+		}
+
+		template <typename FN>
+		void with_any_completed_job(FN const &fn)
+		{
+			for (Job &job : _jobs)
+				if (job.state == State::COMPLETE) {
+					job.state = State::FREE;
+					fn(job.request);
+					return;
+				}
+		}
 };
 
 
-struct Main
+struct Http_block::Block_session_component : Rpc_object<Block::Session>,
+                                             private Block::Request_stream
 {
-	Env        &env;
-	Heap        heap { env.ram(), env.rm() };
-	Factory     factory { env, heap };
-	Block::Root root { env.ep(), heap, env.rm(), factory, true };
+	Entrypoint &_ep;
+
+	using Block::Request_stream::with_requests;
+	using Block::Request_stream::with_content;
+	using Block::Request_stream::try_acknowledge;
+	using Block::Request_stream::wakeup_client_if_needed;
+
+	Backend &_backend;
+
+	Jobs _jobs { _backend.info().block_size };
+
+	Block_session_component(Region_map                &rm,
+	                        Entrypoint                &ep,
+	                        Dataspace_capability       ds,
+	                        Signal_context_capability  sigh,
+	                        Backend                   &backend)
+	:
+		Request_stream { rm, ds, ep, sigh, backend.info() },
+		_ep            { ep },
+		_backend       { backend }
+	{
+		_ep.manage(*this);
+	}
+
+	~Block_session_component() { _ep.dissolve(*this); }
+
+	Info info() const override { return Request_stream::info(); }
+
+	Capability<Tx> tx_cap() override { return Request_stream::tx_cap(); }
+
+	bool _acknowledge()
+	{
+		bool progress = false;
+
+		try_acknowledge([&] (Block::Request_stream::Ack &ack) {
+			_jobs.with_any_completed_job([&] (Block::Request request) {
+				ack.submit(request);
+				progress = true;
+			});
+		});
+		return progress;
+	}
+
+	void handle_request()
+	{
+		for (;;) {
+
+			bool progress = false;
+
+			with_requests([&] (Block::Request request) {
+
+				using Response = Block::Request_stream::Response;
+
+				if (!_jobs.acceptable())
+					return Response::RETRY;
+
+				Block::Operation const op = request.operation;
+				if (op.type != Block::Operation::Type::READ || !op.count
+				 || op.block_number + op.count > _backend.info().block_count)
+					return Response::REJECTED;
+
+				with_content(request, [&] (void *ptr, size_t) {
+					_jobs.submit(request, (char *)ptr); });
+
+				progress = true;
+				return Response::ACCEPTED;
+			});
+
+			progress |= _jobs.execute(_backend);
+			progress |= _acknowledge();
+
+			if (progress)
+				continue;
+
+			/*
+			 * Read ahead once all requests are acknowledged so that the
+			 * client can proceed in the meantime
+			 */
+			wakeup_client_if_needed();
+
+			if (!_backend.read_ahead())
+				break;
+		}
+
+		wakeup_client_if_needed();
+	}
+};
+
+
+struct Http_block::Main : Rpc_object<Typed_root<Block::Session>>
+{
+	Env &_env;
+
+	Signal_handler<Main> _request_handler {
+		_env.ep(), *this, &Main::_handle_requests };
+
+	Heap                   _heap   { _env.ram(), _env.rm() };
+	Attached_rom_dataspace _config { _env, "config" };
+
+	::String const _uri = _config.xml().attribute_value("uri", ::String());
+
+	Backend::Config const _backend_config = Backend::Config::from_xml(_config.xml());
+
+	/* connect to the server on the first session request, keep cache afterwards */
+	Constructible<Backend> _backend { };
+
+	Constructible<Attached_ram_dataspace>  _block_ds { };
+	Constructible<Block_session_component> _block_session { };
+
+	void _handle_requests()
+	{
+		if (!_block_session.constructed())
+			return;
+
+		Libc::with_libc([&] () { _block_session->handle_request(); });
+	}
+
+
+	/*
+	 * Root interface
+	 */
+
+	Capability<Session> session(Root::Session_args const &args,
+	                            Affinity const &) override
+	{
+		if (_block_session.constructed())
+			throw Service_denied();
+
+		size_t const tx_buf_size =
+			Arg_string::find_arg(args.string(),
+			                     "tx_buf_size").aligned_size();
+
+		Ram_quota const ram_quota = ram_quota_from_args(args.string());
+
+		if (tx_buf_size > ram_quota.value) {
+			warning("communication buffer size exceeds session quota");
+			throw Insufficient_ram_quota();
+		}
+
+		try {
+			Libc::with_libc([&] () {
+				if (!_backend.constructed())
+					_backend.construct(_env, _heap, _uri, _backend_config); });
+		} catch (Http::Exception) {
+			error("could not access ", _uri);
+			throw Service_denied();
+		}
+
+		_block_ds.construct(_env.ram(), _env.rm(), tx_buf_size);
+		_block_session.construct(_env.rm(), _env.ep(), _block_ds->cap(),
+		                         _request_handler, *_backend);
+
+		return _block_session->cap();
+	}
+
+	void upgrade(Capability<Session>, Root::Upgrade_args const &) override { }
+
+	void close(Capability<Session> cap) override
+	{
+		if (_block_session.constructed() && cap == _block_session->cap()) {
+			_block_session.destruct();
+			_block_ds.destruct();
+		}
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("Using file=", _uri, " as device with block size ",
+		    Hex(_backend_config.block_size, Hex::OMIT_PREFIX), ", ",
+		    Number_of_bytes(_backend_config.cache_size), " cache of ",
+		    Number_of_bytes(_backend_config.chunk_size), " chunks, ",
+		    Number_of_bytes(_backend_config.read_ahead), " read-ahead.");
 
-	Main(Env &env) : env(env) {
-		env.parent().announce(env.ep().manage(root)); }
+		_env.parent().announce(_env.ep().manage(*this));
+	}
 };
 
 
-void Libc::Component::construct(Libc::Env &env) { static Main m(env); }
+void Libc::Component::construct(Libc::Env &env) {
+	static Http_block::Main m(env); }
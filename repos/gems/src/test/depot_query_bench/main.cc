@@ -0,0 +1,224 @@
+/*
+ * \brief  Benchmark for the query latency of depot_query
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The benchmark populates a depot with a configurable number of packages,
+ * each referring to a source and a raw archive, and issues a blueprint query
+ * for all packages. The query is answered by two depot_query instances that
+ * share the file of the archive index:
+ *
+ * 1. By the first instance with an empty index
+ * 2. By the first instance again, with the index in memory
+ * 3. By the second instance, which restores the index stored by the first
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/attached_rom_dataspace.h>
+#include <os/reporter.h>
+#include <timer_session/connection.h>
+#include <vfs/simple_env.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection _timer { _env };
+
+	Vfs::Simple_env _vfs_env { _env, _heap, _config.xml().sub_node("vfs") };
+
+	Vfs::File_system &_fs = _vfs_env.root_dir();
+
+	unsigned const _pkgs = _config.xml().attribute_value("pkgs", 1000u);
+
+	using Path = String<128>;
+
+	Expanding_reporter _query_a { _env, "query", "query_a" };
+	Expanding_reporter _query_b { _env, "query", "query_b" };
+
+	Attached_rom_dataspace _blueprint_a { _env, "blueprint_a" };
+	Attached_rom_dataspace _blueprint_b { _env, "blueprint_b" };
+
+	Signal_handler<Main> _blueprint_handler {
+		_env.ep(), *this, &Main::_handle_blueprint };
+
+	struct Stage { char const *name; Attached_rom_dataspace &rom; };
+
+	Stage const _stages[3] {
+		{ "empty index",     _blueprint_a },
+		{ "index in memory", _blueprint_a },
+		{ "restored index",  _blueprint_b } };
+
+	unsigned _stage = 0;
+
+	uint64_t _start_us = 0;
+
+	void _mkdir(Path const &path)
+	{
+		Vfs::Vfs_handle *handle = nullptr;
+		if (_fs.opendir(path.string(), true, &handle, _heap)
+		    == Vfs::Directory_service::OPENDIR_OK)
+			_fs.close(handle);
+	}
+
+	/**
+	 * Create file including all missing parent directories
+	 */
+	void _write_file(Path const &path, char const *content)
+	{
+		using DS = Vfs::Directory_service;
+
+		/* create parent directories */
+		char const *s = path.string();
+		for (size_t i = 1; s[i]; i++)
+			if (s[i] == '/')
+				_mkdir(Path(Cstring(s, i)));
+
+		Vfs::Vfs_handle *handle = nullptr;
+		if (_fs.open(s, DS::OPEN_MODE_WRONLY | DS::OPEN_MODE_CREATE,
+		             &handle, _heap) != DS::OPEN_OK) {
+			error("could not create ", path);
+			throw Exception();
+		}
+
+		for (size_t len = strlen(content); len; ) {
+			using Result = Vfs::File_io_service::Write_result;
+
+			Vfs::file_size out = 0;
+			Result result = Result::WRITE_ERR_INVALID;
+			try {
+				result = _fs.write(handle, content, len, out);
+			} catch (Vfs::File_io_service::Insufficient_buffer) {
+				result = Result::WRITE_ERR_WOULD_BLOCK;
+			}
+
+			if (result == Result::WRITE_ERR_WOULD_BLOCK) {
+				_env.ep().wait_and_dispatch_one_io_signal();
+				continue;
+			}
+
+			if (result != Result::WRITE_OK) {
+				error("could not write ", path);
+				break;
+			}
+			content += out;
+			len     -= out;
+			handle->advance_seek(out);
+		}
+
+		_fs.close(handle);
+	}
+
+	void _populate_depot()
+	{
+		Path const d("/depot/genodelabs");
+
+		_write_file(Path(d, "/src/ld/1.0/used_apis"), "");
+		_write_file(Path(d, "/bin/x86_64/ld/1.0/ld.lib.so"), "binary");
+		_write_file(Path(d, "/pkg/base/1.0/archives"), "genodelabs/src/ld/1.0\n");
+		_write_file(Path(d, "/pkg/base/1.0/runtime"),
+		            "<runtime><content><rom label=\"ld.lib.so\"/></content></runtime>");
+
+		for (unsigned i = 0; i < _pkgs; i++) {
+
+			_write_file(Path(d, "/src/s", i, "/1.0/used_apis"),
+			            "base/2021-03-22\nos/2021-03-22\n");
+
+			_write_file(Path(d, "/bin/x86_64/s", i, "/1.0/s", i), "binary");
+
+			_write_file(Path(d, "/raw/r", i, "/1.0/config_", i), "<config/>");
+
+			_write_file(Path(d, "/pkg/p", i, "/1.0/archives"),
+			            String<160>("genodelabs/src/s", i, "/1.0\n"
+			                        "genodelabs/raw/r", i, "/1.0\n"
+			                        "genodelabs/pkg/base/1.0\n").string());
+
+			_write_file(Path(d, "/pkg/p", i, "/1.0/runtime"),
+			            String<256>("<runtime ram=\"1M\" caps=\"100\" binary=\"s", i, "\">"
+			                        "<content>"
+			                        "<rom label=\"s", i, "\"/>"
+			                        "<rom label=\"config_", i, "\"/>"
+			                        "<rom label=\"ld.lib.so\"/>"
+			                        "</content></runtime>").string());
+		}
+	}
+
+	void _issue_query()
+	{
+		Expanding_reporter &reporter = (&_stages[_stage].rom == &_blueprint_a)
+		                             ? _query_a : _query_b;
+
+		_start_us = _timer.elapsed_us();
+
+		reporter.generate([&] (Xml_generator &xml) {
+			xml.attribute("arch",    "x86_64");
+			xml.attribute("version", _stage + 1);
+			for (unsigned i = 0; i < _pkgs; i++)
+				xml.node("blueprint", [&] () {
+					xml.attribute("pkg", Path("genodelabs/pkg/p", i, "/1.0")); });
+		});
+	}
+
+	void _handle_blueprint()
+	{
+		_blueprint_a.update();
+		_blueprint_b.update();
+
+		Xml_node const blueprint = _stages[_stage].rom.xml();
+
+		if (blueprint.attribute_value("version", 0u) != _stage + 1)
+			return;
+
+		unsigned num_pkgs = 0, num_missing = 0;
+		blueprint.for_each_sub_node("pkg", [&] (Xml_node const &pkg) {
+			num_pkgs++;
+			pkg.for_each_sub_node("missing_rom", [&] (Xml_node const &) {
+				num_missing++; }); });
+
+		log(_stages[_stage].name, ": blueprint of ", num_pkgs, " pkgs after ",
+		    (_timer.elapsed_us() - _start_us)/1000, " ms",
+		    num_missing ? " (missing ROMs)" : "");
+
+		if (++_stage == 3) {
+			log("--- test finished ---");
+			return;
+		}
+
+		_issue_query();
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		_blueprint_a.sigh(_blueprint_handler);
+		_blueprint_b.sigh(_blueprint_handler);
+
+		uint64_t const start_us = _timer.elapsed_us();
+		_populate_depot();
+		log("populated depot with ", _pkgs*3 + 2, " archives in ",
+		    (_timer.elapsed_us() - start_us)/1000, " ms");
+
+		_issue_query();
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
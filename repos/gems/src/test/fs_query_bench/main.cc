@@ -0,0 +1,185 @@
+/*
+ * \brief  Benchmark for the update latency of fs_query
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The benchmark populates a file system with a tree of directories and files,
+ * which is watched by fs_query. It then modifies a single file repeatedly and
+ * measures the time until the listing report of fs_query reflects the
+ * modification.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/attached_rom_dataspace.h>
+#include <timer_session/connection.h>
+#include <vfs/simple_env.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection _timer { _env };
+
+	Vfs::Simple_env _vfs_env { _env, _heap, _config.xml().sub_node("vfs") };
+
+	Vfs::File_system &_fs = _vfs_env.root_dir();
+
+	unsigned const _dirs   = _config.xml().attribute_value("dirs",   100u);
+	unsigned const _files  = _config.xml().attribute_value("files",  100u);
+	unsigned const _rounds = _config.xml().attribute_value("rounds", 100u);
+
+	using Path    = String<64>;
+	using Content = String<32>;
+
+	Attached_rom_dataspace _listing { _env, "listing" };
+
+	Signal_handler<Main> _listing_handler {
+		_env.ep(), *this, &Main::_handle_listing };
+
+	unsigned _round = 0;
+
+	uint64_t _start_us = 0, _total_us = 0, _max_us = 0;
+
+	void _write_file(Path const &path, Content const &content)
+	{
+		using DS = Vfs::Directory_service;
+
+		Vfs::Vfs_handle *handle = nullptr;
+		if (_fs.open(path.string(), DS::OPEN_MODE_WRONLY | DS::OPEN_MODE_CREATE,
+		             &handle, _heap) != DS::OPEN_OK
+		 && _fs.open(path.string(), DS::OPEN_MODE_WRONLY,
+		             &handle, _heap) != DS::OPEN_OK) {
+			error("could not open ", path);
+			throw Exception();
+		}
+
+		_fs.ftruncate(handle, 0);
+
+		for (;;) {
+			using Result = Vfs::File_io_service::Write_result;
+
+			Vfs::file_size out = 0;
+			Result result = Result::WRITE_ERR_INVALID;
+			try {
+				result = _fs.write(handle, content.string(), content.length() - 1, out);
+			} catch (Vfs::File_io_service::Insufficient_buffer) {
+				result = Result::WRITE_ERR_WOULD_BLOCK;
+			}
+
+			if (result == Result::WRITE_ERR_WOULD_BLOCK) {
+				_env.ep().wait_and_dispatch_one_io_signal();
+				continue;
+			}
+
+			if (result != Result::WRITE_OK)
+				error("could not write ", path);
+			break;
+		}
+
+		_fs.close(handle);
+	}
+
+	Path _dir_path(unsigned i) const { return Path("/d", i); }
+
+	Path _file_path(unsigned i, unsigned j) const { return Path("/d", i, "/f", j); }
+
+	/* the modified file is located in the middle of the tree */
+	Path _target() const { return _file_path(_dirs/2, _files/2); }
+
+	Content _content(unsigned round) const { return Content("round ", round); }
+
+	bool _listing_contains(Content const &content)
+	{
+		/* the content appears as body of the file node */
+		String<40> const pattern(">", content, "<");
+
+		char   const *s   = _listing.local_addr<char const>();
+		size_t const  len = _listing.size();
+		size_t const  n   = pattern.length() - 1;
+
+		for (size_t i = 0; i + n <= len && s[i]; i++)
+			if (strcmp(s + i, pattern.string(), n) == 0)
+				return true;
+
+		return false;
+	}
+
+	void _start_round()
+	{
+		_start_us = _timer.elapsed_us();
+		_write_file(_target(), _content(_round));
+	}
+
+	void _handle_listing()
+	{
+		_listing.update();
+
+		if (!_listing_contains(_content(_round)))
+			return;
+
+		/* round 0 waits for the initial population of the tree */
+		if (_round == 0)
+			log("initial listing of ", _dirs*_files, " files after ",
+			    (_timer.elapsed_us() - _start_us)/1000, " ms");
+		else {
+			uint64_t const duration = _timer.elapsed_us() - _start_us;
+			_total_us += duration;
+			_max_us    = max(_max_us, duration);
+		}
+
+		if (_round == _rounds) {
+			log(_rounds, " single-file updates: ",
+			    _total_us/max(_rounds, 1u), " us on average, ",
+			    _max_us, " us at most");
+			log("--- test finished ---");
+			return;
+		}
+
+		_round++;
+		_start_round();
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		_listing.sigh(_listing_handler);
+
+		_start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < _dirs; i++) {
+
+			Vfs::Directory_service::Opendir_result res { };
+			Vfs::Vfs_handle *handle = nullptr;
+			res = _fs.opendir(_dir_path(i).string(), true, &handle, _heap);
+			if (res == Vfs::Directory_service::OPENDIR_OK)
+				_fs.close(handle);
+
+			for (unsigned j = 0; j < _files; j++)
+				_write_file(_file_path(i, j), Content("initial"));
+		}
+
+		_write_file(_target(), _content(_round));
+		_handle_listing();
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-fs_query_bench
+SRC_CC = main.cc
+LIBS   = base vfs
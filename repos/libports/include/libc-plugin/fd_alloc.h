@@ -20,8 +20,6 @@
 #include <base/log.h>
 #include <os/path.h>
 #include <base/allocator.h>
-#include <base/id_space.h>
-#include <util/bit_allocator.h>
 #include <util/xml_generator.h>
 
 /* libc includes */
@@ -30,7 +28,7 @@
 
 #include <libc-plugin/plugin.h>
 
-enum { MAX_NUM_FDS = 1024 };
+enum { MAX_NUM_FDS = 16*1024 };
 
 namespace Libc {
 
@@ -45,10 +43,7 @@ namespace Libc {
 	{
 		Genode::Mutex mutex { };
 
-		typedef Genode::Id_space<File_descriptor> Id_space;
-		Id_space::Element _elem;
-
-		int const libc_fd = _elem.id().value;
+		int const libc_fd;
 
 		char const *fd_path = nullptr;  /* for 'fchdir', 'fstat' */
 
@@ -59,9 +54,14 @@ namespace Libc {
 		bool cloexec  = 0;  /* for 'fcntl' */
 		bool modified = false;
 
-		File_descriptor(Id_space &id_space, Plugin &plugin, Plugin_context &context,
-		                Id_space::Id id)
-		: _elem(*this, id_space, id), plugin(&plugin), context(&context) { }
+		/*
+		 * Noncopyable
+		 */
+		File_descriptor(File_descriptor const &);
+		File_descriptor &operator = (File_descriptor const &);
+
+		File_descriptor(int libc_fd, Plugin &plugin, Plugin_context &context)
+		: libc_fd(libc_fd), plugin(&plugin), context(&context) { }
 
 		void path(char const *newpath);
 	};
@@ -71,15 +71,60 @@ namespace Libc {
 	{
 		private:
 
-			Genode::Mutex _mutex;
+			Genode::Mutex _mutex { };
 
 			Genode::Allocator &_alloc;
 
-			typedef File_descriptor::Id_space Id_space;
+			/*
+			 * The table of open file descriptors is indexed by the libc fd
+			 * and consists of blocks that are allocated on demand. Blocks are
+			 * never freed, which allows 'find_by_libc_fd' to access the table
+			 * without holding the mutex. Modifications are serialized by the
+			 * mutex.
+			 */
+			enum { BLOCK_FDS = 256, NUM_BLOCKS = MAX_NUM_FDS / BLOCK_FDS };
+
+			struct Block { File_descriptor *fds[BLOCK_FDS]; };
+
+			Block *_blocks[NUM_BLOCKS] { };
+
+			/*
+			 * Bitmap of used fds, which is searched for the lowest free fd
+			 * starting at the first word that may contain a free bit
+			 */
+			typedef Genode::uint64_t Word;
+
+			enum { WORD_BITS = 64, NUM_WORDS = MAX_NUM_FDS / WORD_BITS };
+
+			Word     _used[NUM_WORDS] { };
+			unsigned _first_free_word = 0;
+
+			/* upper bound of used fds, limits iterations over the table */
+			int _fd_limit = 0;
+
+			bool _used_fd(int fd) const {
+				return _used[fd / WORD_BITS] & (Word(1) << (fd % WORD_BITS)); }
 
-			Id_space _id_space;
+			int  _alloc_fd();
+			bool _alloc_fd(int fd);
+			void _free_fd(int fd);
 
-			Genode::Bit_allocator<MAX_NUM_FDS> _id_allocator;
+			File_descriptor *&_slot(int fd) {
+				return _blocks[fd / BLOCK_FDS]->fds[fd % BLOCK_FDS]; }
+
+			template <typename FN>
+			void _for_each(FN const &fn)
+			{
+				for (int fd = 0; fd < _fd_limit; fd++)
+					if (_used_fd(fd) && _slot(fd))
+						fn(*_slot(fd));
+			}
+
+			/*
+			 * Noncopyable
+			 */
+			File_descriptor_allocator(File_descriptor_allocator const &);
+			File_descriptor_allocator &operator = (File_descriptor_allocator const &);
 
 		public:
 
@@ -26,6 +26,7 @@
 #include <sys/poll.h>   /* for 'struct pollfd' */
 
 namespace Genode { class Env; }
+namespace Vfs { struct Handle_observer; }
 
 namespace Libc {
 
@@ -121,6 +122,31 @@ namespace Libc {
 			virtual File_descriptor *open(const char *pathname, int flags);
 			virtual int pipe(File_descriptor *pipefd[2]);
 			virtual bool poll(File_descriptor&, struct pollfd &pfd);
+
+			/**
+			 * Install observer of the file descriptor's responses
+			 *
+			 * The observer is informed whenever the file descriptor may have
+			 * become ready, in addition to the libc kernel. Each call
+			 * requests the next notification. Further notifications are
+			 * requested by 'poll' if the file descriptor is not ready.
+			 *
+			 * \return  false if the plugin cannot deliver notifications
+			 *          for individual file descriptors
+			 */
+			virtual bool watch(File_descriptor *, Vfs::Handle_observer &);
+
+			/**
+			 * Remove observer installed via 'watch'
+			 */
+			virtual void unwatch(File_descriptor *, Vfs::Handle_observer &);
+
+			/**
+			 * Return number of bytes that can be read or written without
+			 * blocking, or 0 if unknown
+			 */
+			virtual ::size_t available(File_descriptor *, bool write);
+
 			virtual ssize_t read(File_descriptor *, void *buf, ::size_t count);
 			virtual ssize_t readlink(const char *path, char *buf, ::size_t bufsiz);
 			virtual ssize_t recv(File_descriptor *, void *buf, ::size_t len, int flags);
@@ -0,0 +1,9 @@
+SRC_CC = vfs.cc
+
+INC_DIR += $(REP_DIR)/src/lib/vfs/ztar
+
+LIBS += zlib liblzma
+
+vpath %.cc $(REP_DIR)/src/lib/vfs/ztar
+
+SHARED_LIB = yes
@@ -0,0 +1,9 @@
+MIRROR_FROM_REP_DIR := lib/mk/vfs_ztar.mk src/lib/vfs/ztar
+
+content: $(MIRROR_FROM_REP_DIR) LICENSE
+
+$(MIRROR_FROM_REP_DIR):
+	$(mirror_from_rep_dir)
+
+LICENSE:
+	cp $(GENODE_DIR)/LICENSE $@
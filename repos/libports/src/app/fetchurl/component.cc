@@ -33,6 +33,8 @@ namespace Fetchurl {
 	struct User_data;
 	struct Main;
 
+	using Genode::uint64_t;
+
 	typedef Genode::String<256> Url;
 	typedef Genode::Path<256>   Path;
 }
@@ -47,6 +49,16 @@ static int progress_callback(void *userdata,
                              double ultotal, double ulnow);
 
 
+struct Fetchurl::User_data
+{
+	Timer::Connection &timer;
+	Genode::Milliseconds last_ms;
+	Genode::Milliseconds const max_timeout;
+	Genode::Milliseconds curr_timeout;
+	Fetchurl::Fetch &fetch;
+};
+
+
 class Fetchurl::Fetch : Genode::List<Fetch>::Element
 {
 	friend class Genode::List<Fetch>;
@@ -69,22 +81,27 @@ class Fetchurl::Fetch : Genode::List<Fetch>::Element
 
 		int fd = -1;
 
+		/*
+		 * State of the transfer in flight
+		 */
+		CURL *handle = nullptr;
+
+		Genode::Constructible<User_data> user_data { };
+
+		/* continue a partially downloaded file when starting the transfer */
+		bool resume;
+
+		/* number of bytes present in the file when the transfer started */
+		uint64_t resume_offset = 0;
+
 		Fetch(Main &main, Url const &url, Path const &path,
-		      Url const &proxy, long retry)
+		      Url const &proxy, long retry, bool resume)
 		:
 			main(main), url(url), path(path),
-			proxy(proxy), retry(retry+1)
+			proxy(proxy), retry(retry+1), resume(resume)
 		{ }
-};
-
 
-struct Fetchurl::User_data
-{
-	Timer::Connection &timer;
-	Genode::Milliseconds last_ms;
-	Genode::Milliseconds const max_timeout;
-	Genode::Milliseconds curr_timeout;
-	Fetchurl::Fetch &fetch;
+		bool active() const { return handle != nullptr; }
 };
 
 
@@ -110,6 +127,26 @@ struct Fetchurl::Main
 
 	Genode::Milliseconds _progress_timeout { 10u * 1000 };
 
+	enum { MAX_PARALLEL = 16 };
+
+	/* maximum number of concurrent transfers */
+	unsigned _parallel = 1;
+
+	/* continue partial files present at startup */
+	bool _resume = false;
+
+	/*
+	 * All transfers are driven by one multi handle, which maintains the
+	 * connection cache. Easy handles of completed transfers are kept for
+	 * subsequent transfers.
+	 */
+	CURLM   *_multi = nullptr;
+	CURL    *_idle_handles[MAX_PARALLEL] { };
+	unsigned _num_idle   = 0;
+	unsigned _num_active = 0;
+
+	CURLcode _exit_res = CURLE_OK;
+
 	void _schedule_report()
 	{
 		using namespace Genode;
@@ -167,6 +204,11 @@ struct Fetchurl::Main
 		_progress_timeout.value = config_node.attribute_value("progress_timeout",
 		                                                      _progress_timeout.value);
 
+		_parallel = Genode::max(1U, Genode::min(config_node.attribute_value("parallel", 1U),
+		                                        (unsigned)MAX_PARALLEL));
+
+		_resume = config_node.attribute_value("resume", false);
+
 		auto const parse_fn = [&] (Genode::Xml_node node) {
 
 			if (!node.has_attribute("url") || !node.has_attribute("path")) {
@@ -179,7 +221,7 @@ struct Fetchurl::Main
 			Url  const proxy = node.attribute_value("proxy", Url());
 			long const retry = node.attribute_value("retry", 0L);
 
-			auto *f = new (_heap) Fetch(*this, url, path, proxy, retry);
+			auto *f = new (_heap) Fetch(*this, url, path, proxy, retry, _resume);
 			_fetches.insert(f);
 		};
 
@@ -193,10 +235,13 @@ struct Fetchurl::Main
 		});
 	}
 
-	CURLcode _process_fetch(CURL *_curl, Fetch &_fetch)
+	/**
+	 * Open output file of fetch, continuing a partial file if requested
+	 *
+	 * \return  file descriptor or -1 on error
+	 */
+	int _open_output(Fetch &_fetch)
 	{
-		Genode::log("fetch ", _fetch.url);
-
 		char const *out_path = _fetch.path.base();
 
 		/* create compound directories leading to the path */
@@ -226,7 +271,7 @@ struct Fetchurl::Main
 			/* create directory for sub path */
 			if (mkdir(sub_path.string(), 0777) < 0) {
 				Genode::error("failed to create directory ", sub_path);
-				return CURLE_FAILED_INIT;
+				return -1;
 			}
 		}
 
@@ -244,9 +289,54 @@ struct Fetchurl::Main
 			default:
 				Genode::error("creation of ", out_path, " failed (errno=", errno, ")");
 			}
+			return -1;
+		}
+
+		/* only regular files can be resumed, e.g., not '/dev/log' */
+		struct stat sb;
+		sb.st_mode = 0;
+		fstat(fd, &sb);
+
+		_fetch.resume_offset = 0;
+
+		if (S_ISREG(sb.st_mode)) {
+			if (_fetch.resume) {
+				off_t const size = lseek(fd, 0, SEEK_END);
+				_fetch.resume_offset = size > 0 ? size : 0;
+			} else {
+				ftruncate(fd, 0);
+			}
+		}
+		return fd;
+	}
+
+	/**
+	 * Add transfer for fetch to the multi handle
+	 */
+	CURLcode _start_fetch(Fetch &_fetch)
+	{
+		int const fd = _open_output(_fetch);
+		if (fd == -1)
+			return CURLE_FAILED_INIT;
+
+		CURL *_curl = _num_idle ? _idle_handles[--_num_idle] : curl_easy_init();
+		if (!_curl) {
+			close(fd);
+			Genode::error("failed to initialize libcurl handle");
 			return CURLE_FAILED_INIT;
 		}
-		_fetch.fd = fd;
+		curl_easy_reset(_curl);
+
+		if (_fetch.resume_offset)
+			Genode::log("fetch ", _fetch.url, " from offset ", _fetch.resume_offset);
+		else
+			Genode::log("fetch ", _fetch.url);
+
+		_fetch.fd     = fd;
+		_fetch.handle = _curl;
+
+		/* subsequent attempts continue where this one stopped */
+		_fetch.resume = true;
 
 		curl_easy_setopt(_curl, CURLOPT_URL, _fetch.url.string());
 		curl_easy_setopt(_curl, CURLOPT_FOLLOWLOCATION, true);
@@ -254,19 +344,24 @@ struct Fetchurl::Main
 		curl_easy_setopt(_curl, CURLOPT_NOSIGNAL, true);
 		curl_easy_setopt(_curl, CURLOPT_FAILONERROR, 1L);
 
+		curl_easy_setopt(_curl, CURLOPT_PRIVATE, &_fetch);
 		curl_easy_setopt(_curl, CURLOPT_WRITEFUNCTION, write_callback);
 		curl_easy_setopt(_curl, CURLOPT_WRITEDATA, &_fetch);
 
+		if (_fetch.resume_offset)
+			curl_easy_setopt(_curl, CURLOPT_RESUME_FROM_LARGE,
+			                 (curl_off_t)_fetch.resume_offset);
+
 		curl_easy_setopt(_curl, CURLOPT_NOPROGRESS, 0L);
 		curl_easy_setopt(_curl, CURLOPT_PROGRESSFUNCTION, progress_callback);
-		User_data ud {
+		_fetch.user_data.construct(User_data {
 			.timer        = _timer,
 			.last_ms      = _timer.curr_time().trunc_to_plain_ms(),
 			.max_timeout  = _progress_timeout,
 			.curr_timeout = Genode::Milliseconds { .value = 0 },
 			.fetch        = _fetch,
-		};
-		curl_easy_setopt(_curl, CURLOPT_PROGRESSDATA, &ud);
+		});
+		curl_easy_setopt(_curl, CURLOPT_PROGRESSDATA, &*_fetch.user_data);
 
 		curl_easy_setopt(_curl, CURLOPT_SSL_VERIFYPEER, 0L);
 		curl_easy_setopt(_curl, CURLOPT_SSL_VERIFYHOST, 0L);
@@ -276,49 +371,125 @@ struct Fetchurl::Main
 			curl_easy_setopt(_curl, CURLOPT_PROXY, _fetch.proxy.string());
 		}
 
-		CURLcode res = curl_easy_perform(_curl);
+		curl_multi_add_handle(_multi, _curl);
+		_num_active++;
+
+		return CURLE_OK;
+	}
+
+	void _failed_attempt(Fetch &_fetch, CURLcode res)
+	{
+		Genode::error(curl_easy_strerror(res), ", failed to fetch ", _fetch.url);
+
+		if (--_fetch.retry < 1)
+			_exit_res = res;
+	}
+
+	void _finish_fetch(Fetch &_fetch, CURLcode res)
+	{
+		CURL * const _curl = _fetch.handle;
+
+		long response_code = 0;
+		curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, &response_code);
+
+		curl_multi_remove_handle(_multi, _curl);
+		_idle_handles[_num_idle++] = _curl;
+		_num_active--;
+
 		close(_fetch.fd);
-		_fetch.fd = -1;
+		_fetch.fd     = -1;
+		_fetch.handle = nullptr;
+		_fetch.user_data.destruct();
+
+		if (res == CURLE_OK) {
+			_fetch.retry = 0;
+			return;
+		}
+
+		/*
+		 * The server rejected the range because the file is at least as
+		 * large as the remote file (416), or it ignored the range request
+		 * and responded with the whole file (CURLE_RANGE_ERROR). Truncate
+		 * the file and start over without counting the attempt.
+		 */
+		bool const range_rejected =
+			(res == CURLE_HTTP_RETURNED_ERROR && response_code == 416) ||
+			(res == CURLE_RANGE_ERROR);
+
+		if (range_rejected && _fetch.resume_offset > 0) {
+			Genode::warning(_fetch.url, ": cannot resume, restarting download");
+			_fetch.resume = false;
+			return;
+		}
 
-		if (res != CURLE_OK)
-			Genode::error(curl_easy_strerror(res), ", failed to fetch ", _fetch.url);
-		return res;
+		_failed_attempt(_fetch, res);
 	}
 
-	int run()
+	void _collect_completed_fetches()
 	{
-		CURLcode exit_res = CURLE_OK;
+		int      msgs_left = 0;
+		CURLMsg *msg       = nullptr;
 
-		CURL *curl = curl_easy_init();
-		if (!curl) {
+		while ((msg = curl_multi_info_read(_multi, &msgs_left))) {
+
+			if (msg->msg != CURLMSG_DONE)
+				continue;
+
+			Fetch *fetch = nullptr;
+			curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &fetch);
+
+			/* 'msg' is invalid once the handle is removed */
+			CURLcode const res = msg->data.result;
+
+			_finish_fetch(*fetch, res);
+			_report();
+		}
+	}
+
+	int run()
+	{
+		_multi = curl_multi_init();
+		if (!_multi) {
 			Genode::error("failed to initialize libcurl");
 			return -1;
 		}
 
-		while (true) {
-			_report();
+		curl_multi_setopt(_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)_parallel);
+		curl_multi_setopt(_multi, CURLMOPT_MAXCONNECTS, (long)_parallel);
 
-			bool retry_some = false;
-			for (Fetch *f = _fetches.first(); f; f = f->next()) {
-				if (f->retry < 1) continue;
-				CURLcode res = _process_fetch(curl, *f);
-				if (res == CURLE_OK) {
-					f->retry = 0;
-				} else {
-					if (--f->retry > 0)
-						retry_some = true;
-					else
-						exit_res = res;
-				}
+		_report();
+
+		for (;;) {
+
+			/* start pending fetches up to the parallelism limit */
+			for (Fetch *f = _fetches.first(); f && _num_active < _parallel; f = f->next()) {
+				if (f->active() || f->retry < 1) continue;
+
+				CURLcode const res = _start_fetch(*f);
+				if (res != CURLE_OK)
+					_failed_attempt(*f, res);
 			}
-			if (!retry_some) break;
+
+			if (_num_active == 0)
+				break;
+
+			int running = 0;
+			curl_multi_perform(_multi, &running);
+
+			_collect_completed_fetches();
+
+			if (running)
+				curl_multi_wait(_multi, nullptr, 0, 1000, nullptr);
 		}
 
 		_report();
 
-		curl_easy_cleanup(curl);
+		while (_num_idle)
+			curl_easy_cleanup(_idle_handles[--_num_idle]);
+
+		curl_multi_cleanup(_multi);
 
-		return exit_res ^ CURLE_OK;
+		return _exit_res ^ CURLE_OK;
 	}
 };
 
@@ -357,6 +528,12 @@ static int progress_callback(void *userdata,
 	 * the max timeout value, we will abort the download attempt.
 	 */
 
+	/* account for the part of the file fetched by earlier attempts */
+	double const offset = (double)fetch.resume_offset;
+	dlnow += offset;
+	if (dltotal > 0)
+		dltotal += offset;
+
 	if (dlnow == fetch.dlnow) {
 		ud.curr_timeout.value += diff.value;
 	}
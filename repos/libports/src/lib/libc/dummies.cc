@@ -149,10 +149,8 @@ DUMMY(int, -1, semget, (key_t, int, int))
 DUMMY(int, -1, semop, (key_t, int, int))
 __SYS_DUMMY(int,    -1, aio_suspend, (const struct aiocb * const[], int, const struct timespec *));
 __SYS_DUMMY(int   , -1, getfsstat, (struct statfs *, long, int))
-__SYS_DUMMY(int, -1, kevent, (int, const struct kevent*, int, struct kevent *, int, const struct timespec*));
 __SYS_DUMMY(void  ,   , map_stacks_exec, (void));
 __SYS_DUMMY(int   , -1, ptrace, (int, pid_t, caddr_t, int));
-__SYS_DUMMY(ssize_t, -1, sendmsg, (int s, const struct msghdr*, int));
 __SYS_DUMMY(int   , -1, setcontext, (const ucontext_t *ucp));
 __SYS_DUMMY(void	,   , spinlock_stub,   (spinlock_t *));
 __SYS_DUMMY(void	,   , spinlock,   (spinlock_t *));
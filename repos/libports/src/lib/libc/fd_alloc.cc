@@ -41,8 +41,15 @@ void Libc::init_fd_alloc(Allocator &alloc) { _alloc_ptr = &alloc; }
 
 File_descriptor_allocator *Libc::file_descriptor_allocator()
 {
+	/* the allocator is looked up on each libc call that takes an fd */
+	static File_descriptor_allocator *fd_alloc_ptr;
+
+	if (fd_alloc_ptr)
+		return fd_alloc_ptr;
+
 	if (_alloc_ptr)
-		return unmanaged_singleton<File_descriptor_allocator>(*_alloc_ptr);
+		return fd_alloc_ptr =
+			unmanaged_singleton<File_descriptor_allocator>(*_alloc_ptr);
 
 	error("missing call of 'init_fd_alloc'");
 	return nullptr;
@@ -54,6 +61,56 @@ File_descriptor_allocator::File_descriptor_allocator(Allocator &alloc)
 { }
 
 
+int File_descriptor_allocator::_alloc_fd()
+{
+	for (unsigned i = _first_free_word; i < NUM_WORDS; i++) {
+
+		if (_used[i] == ~Word(0))
+			continue;
+
+		_first_free_word = i;
+
+		int const fd = i*WORD_BITS + __builtin_ctzll(~_used[i]);
+		return _alloc_fd(fd) ? fd : -1;
+	}
+
+	_first_free_word = NUM_WORDS;
+	return -1;
+}
+
+
+bool File_descriptor_allocator::_alloc_fd(int fd)
+{
+	if (fd < 0 || fd >= MAX_NUM_FDS || _used_fd(fd))
+		return false;
+
+	Block *&block = _blocks[fd / BLOCK_FDS];
+	if (!block) {
+		Block *new_block = nullptr;
+		try { new_block = new (_alloc) Block(); }
+		catch (...) { return false; }
+
+		__atomic_store_n(&block, new_block, __ATOMIC_RELEASE);
+	}
+
+	_used[fd / WORD_BITS] |= Word(1) << (fd % WORD_BITS);
+	_fd_limit = max(_fd_limit, fd + 1);
+	return true;
+}
+
+
+void File_descriptor_allocator::_free_fd(int fd)
+{
+	__atomic_store_n(&_slot(fd), (File_descriptor *)nullptr, __ATOMIC_RELEASE);
+
+	_used[fd / WORD_BITS] &= ~(Word(1) << (fd % WORD_BITS));
+	_first_free_word = min(_first_free_word, (unsigned)fd / WORD_BITS);
+
+	while (_fd_limit > 0 && !_used_fd(_fd_limit - 1))
+		_fd_limit--;
+}
+
+
 File_descriptor *File_descriptor_allocator::alloc(Plugin *plugin,
                                                   Plugin_context *context,
                                                   int libc_fd)
@@ -61,17 +118,23 @@ File_descriptor *File_descriptor_allocator::alloc(Plugin *plugin,
 	Mutex::Guard guard(_mutex);
 
 	bool const any_fd = (libc_fd < 0);
-	Id_space::Id id {(unsigned)libc_fd};
 
-	try {
-		if (any_fd) {
-			id.value = _id_allocator.alloc();
-		} else {
-			_id_allocator.alloc_addr(addr_t(libc_fd));
-		}
+	if (any_fd)
+		libc_fd = _alloc_fd();
+	else if (!_alloc_fd(libc_fd))
+		libc_fd = -1;
 
-		return new (_alloc) File_descriptor(_id_space, *plugin, *context, id);
-	} catch (...) { return nullptr; }
+	if (libc_fd < 0)
+		return nullptr;
+
+	try {
+		File_descriptor *fdo = new (_alloc) File_descriptor(libc_fd, *plugin, *context);
+		__atomic_store_n(&_slot(libc_fd), fdo, __ATOMIC_RELEASE);
+		return fdo;
+	} catch (...) {
+		_free_fd(libc_fd);
+		return nullptr;
+	}
 }
 
 
@@ -82,7 +145,7 @@ void File_descriptor_allocator::free(File_descriptor *fdo)
 	if (fdo->fd_path)
 		_alloc.free((void *)fdo->fd_path, ::strlen(fdo->fd_path) + 1);
 
-	_id_allocator.free(fdo->libc_fd);
+	_free_fd(fdo->libc_fd);
 	destroy(_alloc, fdo);
 }
 
@@ -96,20 +159,16 @@ void File_descriptor_allocator::preserve(int fd)
 
 File_descriptor *File_descriptor_allocator::find_by_libc_fd(int libc_fd)
 {
-	Mutex::Guard guard(_mutex);
-
-	if (libc_fd < 0)
+	if (libc_fd < 0 || libc_fd >= MAX_NUM_FDS)
 		return nullptr;
 
-	File_descriptor *result = nullptr;
+	Block const * const block =
+		__atomic_load_n(&_blocks[libc_fd / BLOCK_FDS], __ATOMIC_ACQUIRE);
 
-	try {
-		Id_space::Id const id {(unsigned)libc_fd};
-		_id_space.apply<File_descriptor>(id, [&] (File_descriptor &fd) {
-			result = &fd; });
-	} catch (Id_space::Unknown_id) { }
+	if (!block)
+		return nullptr;
 
-	return result;
+	return __atomic_load_n(&block->fds[libc_fd % BLOCK_FDS], __ATOMIC_ACQUIRE);
 }
 
 
@@ -119,7 +178,7 @@ File_descriptor *File_descriptor_allocator::any_cloexec_libc_fd()
 
 	File_descriptor *result = nullptr;
 
-	_id_space.for_each<File_descriptor>([&] (File_descriptor &fd) {
+	_for_each([&] (File_descriptor &fd) {
 		if (!result && fd.cloexec)
 			result = &fd; });
 
@@ -131,7 +190,7 @@ void File_descriptor_allocator::update_append_libc_fds()
 {
 	Mutex::Guard guard(_mutex);
 
-	_id_space.for_each<File_descriptor>([&] (File_descriptor &fd) {
+	_for_each([&] (File_descriptor &fd) {
 		if (fd.flags & O_APPEND)
 			fd.plugin->lseek(&fd, 0, SEEK_END);
 	});
@@ -142,11 +201,11 @@ int File_descriptor_allocator::any_open_fd()
 {
 	Mutex::Guard guard(_mutex);
 
-	int result = -1;
-	_id_space.apply_any<File_descriptor>([&] (File_descriptor &fd) {
-	 	result = fd.libc_fd; });
+	for (int fd = 0; fd < _fd_limit; fd++)
+		if (_used_fd(fd))
+			return fd;
 
-	return result;
+	return -1;
 }
 
 
@@ -154,7 +213,7 @@ void File_descriptor_allocator::generate_info(Xml_generator &xml)
 {
 	Mutex::Guard guard(_mutex);
 
-	_id_space.for_each<File_descriptor>([&] (File_descriptor &fd) {
+	_for_each([&] (File_descriptor &fd) {
 		xml.node("fd", [&] () {
 
 			xml.attribute("id", fd.libc_fd);
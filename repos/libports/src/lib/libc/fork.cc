@@ -328,6 +328,8 @@ struct Libc::Local_clone_service : Noncopyable
 {
 	struct Session : Session_object<Clone_session, Session>
 	{
+		Region_map &_rm;
+
 		Attached_ram_dataspace _ds;
 
 		static Session::Resources _resources()
@@ -340,6 +342,7 @@ struct Libc::Local_clone_service : Noncopyable
 		:
 			Session_object<Clone_session, Session>(ep.rpc_ep(), _resources(),
 			                                       "cloned", Session::Diag()),
+			_rm(env.rm()),
 			_ds(env.ram(), env.rm(), Clone_session::BUFFER_SIZE)
 		{ }
 
@@ -350,6 +353,26 @@ struct Libc::Local_clone_service : Noncopyable
 			::memcpy(_ds.local_addr<void>(), range.start, range.size);
 		}
 
+		bool dataspace_content(Dataspace_capability ds_cap, Memory_range range)
+		{
+			try {
+				Attached_dataspace ds(_rm, ds_cap);
+
+				/* a partial copy would leave the child's range incomplete */
+				if (ds.size() < range.size)
+					return false;
+
+				::memcpy(ds.local_addr<void>(), range.start, range.size);
+				return true;
+			}
+			catch (Region_map::Invalid_dataspace) { }
+			catch (Region_map::Region_conflict)   { }
+			catch (Out_of_ram)  { }
+			catch (Out_of_caps) { }
+
+			return false;
+		}
+
 	} _session;
 
 	typedef Local_service<Session> Service;
@@ -45,8 +45,11 @@ struct Libc::Clone_session : Session
 
 	GENODE_RPC(Rpc_dataspace, Dataspace_capability, dataspace);
 	GENODE_RPC(Rpc_memory_content, void, memory_content, Memory_range);
+	GENODE_RPC(Rpc_dataspace_content, bool, dataspace_content,
+	           Dataspace_capability, Memory_range);
 
-	GENODE_RPC_INTERFACE(Rpc_dataspace, Rpc_memory_content);
+	GENODE_RPC_INTERFACE(Rpc_dataspace, Rpc_memory_content,
+	                     Rpc_dataspace_content);
 };
 
 
@@ -88,6 +91,19 @@ struct Libc::Clone_connection : Connection<Clone_session>,
 		}
 	}
 
+	/**
+	 * Obtain memory content from cloned address space into dataspace
+	 *
+	 * The server writes the content of the range directly into the
+	 * dataspace, which spares the detour via the shared buffer.
+	 *
+	 * \return  false if the server could not access the dataspace
+	 */
+	bool dataspace_content(Dataspace_capability ds, void *start, size_t len)
+	{
+		return call<Rpc_dataspace_content>(ds, Memory_range { start, len });
+	}
+
 	template <typename OBJ>
 	void object_content(OBJ &obj) { memory_content(&obj, sizeof(obj)); }
 };
@@ -46,7 +46,9 @@ struct Libc::Cloned_malloc_heap_range
 
 	void import_content(Clone_connection &clone_connection)
 	{
-		clone_connection.memory_content((void *)local_addr, size);
+		/* let the parent fill our backing store, copy via buffer as fallback */
+		if (!clone_connection.dataspace_content(ds, (void *)local_addr, size))
+			clone_connection.memory_content((void *)local_addr, size);
 	}
 
 	virtual ~Cloned_malloc_heap_range()
@@ -74,6 +74,11 @@ namespace Libc {
 	 */
 	void init_select(Select &, Signal &, Monitor &);
 
+	/**
+	 * Kqueue support
+	 */
+	void init_kqueue(Monitor &, Signal &);
+
 	/**
 	 * Support for querying available RAM quota in sysctl functions
 	 */
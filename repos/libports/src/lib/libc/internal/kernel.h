@@ -48,6 +48,7 @@ namespace Libc {
 	class Kernel;
 	class Main_blockade;
 	class Main_job;
+	class Pager_blockade;
 }
 
 
@@ -90,6 +91,36 @@ class Libc::Main_job : public Monitor::Job
 };
 
 
+/**
+ * Blockade of a thread that serves page faults of the application
+ */
+class Libc::Pager_blockade : public Blockade
+{
+	private:
+
+		Genode::Blockade _blockade { };
+
+	public:
+
+		void block() override { _blockade.block(); }
+
+		void wakeup() override
+		{
+			_woken_up = true;
+			_blockade.wakeup();
+		}
+
+		/**
+		 * Stop waiting for the kernel, called when main returns to user
+		 */
+		void abort()
+		{
+			_expired = true;
+			_blockade.wakeup();
+		}
+};
+
+
 /**
  * Libc "kernel"
  *
@@ -282,6 +313,25 @@ struct Libc::Kernel final : Vfs::Io_response_handler,
 
 		Constructible<Main_job> _main_monitor_job { };
 
+		/*
+		 * Serializes the transitions of the main thread between kernel and
+		 * user with monitored functions executed directly by a pager
+		 */
+		Mutex _pager_mutex { };
+
+		Pager_blockade *_pager_blockade = nullptr;
+
+		void _enter_user()
+		{
+			Mutex::Guard guard(_pager_mutex);
+
+			_state = USER;
+
+			/* let a pager waiting for the kernel execute its job directly */
+			if (_pager_blockade)
+				_pager_blockade->abort();
+		}
+
 		void _monitors_handler()
 		{
 			/* mark monitors for execution when running in kernel only */
@@ -320,7 +370,10 @@ struct Libc::Kernel final : Vfs::Io_response_handler,
 		 */
 		void _switch_to_kernel()
 		{
-			_state = KERNEL;
+			{
+				Mutex::Guard guard(_pager_mutex);
+				_state = KERNEL;
+			}
 			_longjmp(_kernel_context, 1);
 		}
 
@@ -336,7 +389,7 @@ struct Libc::Kernel final : Vfs::Io_response_handler,
 				error("switching to invalid user context");
 
 			_resume_main_once = false;
-			_state = USER;
+			_enter_user();
 			_longjmp(_user_context, 1);
 		}
 
@@ -421,7 +474,7 @@ struct Libc::Kernel final : Vfs::Io_response_handler,
 					_main_monitor_job->complete();
 					_switch_to_user();
 				} else {
-					_state = USER;
+					_enter_user();
 					call_func(_user_stack, (void *)_user_entry, (void *)this);
 				}
 
@@ -568,6 +621,44 @@ struct Libc::Kernel final : Vfs::Io_response_handler,
 			}
 		}
 
+		void _monitor_from_pager(Function &fn) override
+		{
+			for (;;) {
+
+				Pager_blockade blockade { };
+
+				{
+					Mutex::Guard guard(_pager_mutex);
+
+					/*
+					 * The VFS is not used while the main thread executes
+					 * application code. Execute the function directly
+					 * because the kernel may not run before the caller
+					 * resolved a page fault of the main thread.
+					 */
+					if (_state == USER) {
+						if (fn.execute() == Monitor::Function_result::COMPLETE)
+							return;
+						continue;
+					}
+
+					_pager_blockade = &blockade;
+				}
+
+				Monitor::Job job { fn, blockade };
+
+				_monitors.monitor(job);
+
+				{
+					Mutex::Guard guard(_pager_mutex);
+					_pager_blockade = nullptr;
+				}
+
+				if (job.completed())
+					return;
+			}
+		}
+
 		void _trigger_monitor_examination() override
 		{
 			if (_main_context())
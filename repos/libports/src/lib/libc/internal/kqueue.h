@@ -0,0 +1,27 @@
+/*
+ * \brief  Interface between kqueue and the file operations
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _LIBC__INTERNAL__KQUEUE_H_
+#define _LIBC__INTERNAL__KQUEUE_H_
+
+namespace Libc {
+
+	struct File_descriptor;
+
+	/**
+	 * Remove knotes of a descriptor that is about to be closed
+	 */
+	void kqueue_descriptor_closed(File_descriptor &);
+}
+
+#endif /* _LIBC__INTERNAL__KQUEUE_H_ */
@@ -60,6 +60,7 @@ class Libc::Monitor : Interface
 	protected:
 
 		virtual Result _monitor(Function &, uint64_t) = 0;
+		virtual void _monitor_from_pager(Function &) = 0;
 		virtual void _trigger_monitor_examination() = 0;
 
 	public:
@@ -82,6 +83,27 @@ class Libc::Monitor : Interface
 			return _monitor(function, timeout_ms);
 		}
 
+		/**
+		 * Block until monitored execution completed on behalf of a pager
+		 *
+		 * The function is called by a thread that serves page faults of the
+		 * application. In contrast to 'monitor', the function is executed
+		 * by the calling thread itself while the main thread executes
+		 * application code, which may be blocked by the very page fault.
+		 */
+		template <typename FN>
+		void monitor_from_pager(FN const &fn)
+		{
+			struct _Function : Function
+			{
+				FN const &fn;
+				Function_result execute() override { return fn(); }
+				_Function(FN const &fn) : fn(fn) { }
+			} function { fn };
+
+			_monitor_from_pager(function);
+		}
+
 		/**
 		 * Trigger examination of monitored functions
 		 */
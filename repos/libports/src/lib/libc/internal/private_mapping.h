@@ -0,0 +1,422 @@
+/*
+ * \brief  Demand-paged private file mappings
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * A private mapping is backed by a managed region map that is populated on
+ * demand by a dedicated pager thread in windows of 64 KiB.
+ *
+ * If the file system shares the file's dataspace, read accesses are served
+ * by attaching read-only windows of this dataspace. Otherwise, the pager
+ * reads the window from the file into private RAM. Sequential faults raise
+ * the number of windows read ahead. The first write access to a window
+ * replaces it by a private RAM copy.
+ *
+ * Accesses that cannot be served, e.g., writes to a read-only mapping,
+ * terminate the component like a SIGSEGV would, because the faulting thread
+ * cannot be resumed.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _LIBC__INTERNAL__PRIVATE_MAPPING_H_
+#define _LIBC__INTERNAL__PRIVATE_MAPPING_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <base/env.h>
+#include <base/log.h>
+#include <base/sleep.h>
+#include <base/thread.h>
+#include <base/signal.h>
+#include <dataspace/client.h>
+#include <region_map/client.h>
+#include <rm_session/connection.h>
+#include <util/construct_at.h>
+
+/* libc includes */
+#include <signal.h>
+#include <stdlib.h>
+
+/* libc-internal includes */
+#include <internal/types.h>
+
+namespace Libc {
+
+	class Private_mapping_pager;
+	class Private_mapping;
+}
+
+
+class Libc::Private_mapping_pager : Thread
+{
+	private:
+
+		Genode::Env    &_env;
+		Rm_connection   _rm { _env };
+		Signal_receiver _receiver { };
+
+		void entry() override;
+
+	public:
+
+		Private_mapping_pager(Genode::Env &env)
+		:
+			Thread(env, "mmap_pager", 16*1024*sizeof(long)), _env(env)
+		{
+			start();
+		}
+
+		Rm_connection &rm()  { return _rm; }
+		Ram_allocator &ram() { return _env.ram(); }
+		Region_map    &local_rm() { return _env.rm(); }
+
+		Signal_context_capability manage(Signal_context &context) {
+			return _receiver.manage(&context); }
+
+		void dissolve(Signal_context &context) { _receiver.dissolve(&context); }
+
+		/**
+		 * Terminate the component because of an access that cannot be served
+		 */
+		void segmentation_fault()
+		{
+			_env.parent().exit((SIGSEGV << 8) | EXIT_FAILURE);
+			sleep_forever();
+		}
+};
+
+
+class Libc::Private_mapping : public Signal_context
+{
+	public:
+
+		/*
+		 * Granularity of read-ahead and copy-on-write
+		 */
+		enum { WINDOW_SIZE = 64*1024 };
+
+		/*
+		 * Upper bound of windows read ahead on sequential faults
+		 */
+		enum { MAX_READ_AHEAD = 16 };
+
+		/**
+		 * Interface for obtaining file content if no dataspace is shared
+		 */
+		struct Reader : Genode::Interface
+		{
+			/**
+			 * Read file content at 'offset'
+			 *
+			 * Called by the pager thread.
+			 *
+			 * \return  number of bytes read, 0 at the end of the file
+			 */
+			virtual size_t read(off_t offset, char *dst, size_t count) = 0;
+		};
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Private_mapping(Private_mapping const &);
+		Private_mapping &operator = (Private_mapping const &);
+
+		struct Window
+		{
+			enum State { UNMAPPED, SOURCE, PRIVATE };
+
+			State                    state = UNMAPPED;
+			Ram_dataspace_capability ds { };
+		};
+
+		typedef Region_map::State State;
+
+		Private_mapping_pager &_pager;
+		Genode::Allocator     &_alloc;
+
+		/* either the dataspace of the file is shared or the file is read */
+		Dataspace_capability const _source;
+		Reader              * const _reader;
+
+		off_t                const _source_offset;
+		size_t               const _source_size;  /* bytes available at offset */
+		size_t               const _size;
+		bool                 const _writeable;
+
+		Region_map_client _managed { _pager.rm().create(_size) };
+
+		unsigned const _num_windows = (unsigned)((_size + WINDOW_SIZE - 1) / WINDOW_SIZE);
+		Window * const _windows = (Window *)_alloc.alloc(sizeof(Window)*_num_windows);
+
+		/* read-ahead state */
+		unsigned _next_index = 0;
+		unsigned _read_ahead = 0;
+
+		void *_local_addr = nullptr;
+
+		size_t _window_size(addr_t window_offset) const {
+			return min((size_t)WINDOW_SIZE, _size - window_offset); }
+
+		size_t _source_avail(addr_t window_offset) const
+		{
+			if (window_offset >= _source_size)
+				return 0;
+
+			return min(_window_size(window_offset), _source_size - window_offset);
+		}
+
+		void _attach_source(Window &window, addr_t window_offset)
+		{
+			_managed.attach(_source, _window_size(window_offset),
+			                _source_offset + window_offset, true,
+			                window_offset, false, false);
+			window.state = Window::SOURCE;
+		}
+
+		void _populate(char *dst, addr_t window_offset, size_t avail)
+		{
+			if (_source.valid()) {
+				Region_map &rm = _pager.local_rm();
+
+				char const * const src = rm.attach(_source, align_addr(avail, 12),
+				                                   _source_offset + window_offset);
+				Genode::memcpy(dst, src, avail);
+
+				rm.detach(src);
+				return;
+			}
+
+			for (size_t offset = 0; offset < avail; ) {
+
+				size_t const n = _reader->read(_source_offset + window_offset + offset,
+				                               dst + offset, avail - offset);
+				if (n == 0)
+					break;
+
+				offset += n;
+			}
+		}
+
+		void _attach_private(Window &window, addr_t window_offset)
+		{
+			size_t const size = _window_size(window_offset);
+
+			Ram_dataspace_capability ds = _pager.ram().alloc(size);
+
+			/* populate private copy with the file content, if any */
+			size_t const avail = _source_avail(window_offset);
+			if (avail) {
+				Region_map &rm = _pager.local_rm();
+
+				char * const dst = rm.attach(ds);
+				try { _populate(dst, window_offset, avail); }
+				catch (...) {
+					rm.detach(dst);
+					_pager.ram().free(ds);
+					throw;
+				}
+				rm.detach(dst);
+			}
+
+			if (window.state == Window::SOURCE)
+				_managed.detach(window_offset);
+
+			_managed.attach(ds, size, 0, true, window_offset, false, _writeable);
+			window.ds    = ds;
+			window.state = Window::PRIVATE;
+		}
+
+		void _read_ahead_from(unsigned const index)
+		{
+			/* grow read-ahead on sequential faults, reset it otherwise */
+			_read_ahead = (index == _next_index)
+			            ? max(1U, min(2*_read_ahead, (unsigned)MAX_READ_AHEAD)) : 0;
+
+			unsigned i = index + 1;
+			for (; i < _num_windows && i <= index + _read_ahead; i++) {
+
+				addr_t const window_offset = (addr_t)i*WINDOW_SIZE;
+
+				if (_windows[i].state != Window::UNMAPPED
+				 || !_source_avail(window_offset))
+					break;
+
+				_attach_private(_windows[i], window_offset);
+			}
+
+			_next_index = i;
+		}
+
+		/**
+		 * Resolve fault
+		 *
+		 * \return  false if the access is invalid
+		 */
+		bool _resolve(State const state)
+		{
+			addr_t   const window_offset = state.addr & ~(addr_t)(WINDOW_SIZE - 1);
+			unsigned const index         = (unsigned)(state.addr / WINDOW_SIZE);
+
+			if (index >= _num_windows || state.type == State::EXEC_FAULT)
+				return false;
+
+			Window &window = _windows[index];
+			bool const write = (state.type == State::WRITE_FAULT);
+
+			if (write && !_writeable)
+				return false;
+
+			/* a fault within a populated window is never a valid access */
+			if (window.state == Window::PRIVATE)
+				return false;
+
+			if (window.state == Window::SOURCE && !write)
+				return false;
+
+			/*
+			 * Share the file's dataspace as long as the window is only read
+			 * and fully covered by the file content. Otherwise, populate a
+			 * private copy.
+			 */
+			if (!write && _source.valid()
+			 && _source_avail(window_offset) == _window_size(window_offset)) {
+				_attach_source(window, window_offset);
+				return true;
+			}
+
+			_attach_private(window, window_offset);
+
+			if (!_source.valid())
+				_read_ahead_from(index);
+
+			return true;
+		}
+
+		Private_mapping(Private_mapping_pager &pager,
+		                Genode::Allocator     &alloc,
+		                Dataspace_capability   source,
+		                Reader                *reader,
+		                off_t                  source_offset,
+		                size_t                 source_size,
+		                size_t                 size,
+		                bool                   writeable)
+		:
+			_pager(pager), _alloc(alloc), _source(source), _reader(reader),
+			_source_offset(source_offset), _source_size(source_size),
+			_size(align_addr(size, 12)), _writeable(writeable)
+		{
+			for (unsigned i = 0; i < _num_windows; i++)
+				construct_at<Window>(&_windows[i]);
+
+			_managed.fault_handler(_pager.manage(*this));
+
+			try {
+				_local_addr = _pager.local_rm().attach(_managed.dataspace());
+			} catch (...) {
+				_pager.dissolve(*this);
+				_pager.rm().destroy(_managed.rpc_cap());
+				_alloc.free(_windows, sizeof(Window)*_num_windows);
+				throw;
+			}
+		}
+
+	public:
+
+		/**
+		 * Constructor for a mapping backed by the file's dataspace
+		 */
+		Private_mapping(Private_mapping_pager &pager,
+		                Genode::Allocator     &alloc,
+		                Dataspace_capability   source,
+		                off_t                  source_offset,
+		                size_t                 source_size,
+		                size_t                 size,
+		                bool                   writeable)
+		:
+			Private_mapping(pager, alloc, source, nullptr, source_offset,
+			                source_size, size, writeable)
+		{ }
+
+		/**
+		 * Constructor for a mapping populated via 'reader'
+		 */
+		Private_mapping(Private_mapping_pager &pager,
+		                Genode::Allocator     &alloc,
+		                Reader                &reader,
+		                off_t                  source_offset,
+		                size_t                 source_size,
+		                size_t                 size,
+		                bool                   writeable)
+		:
+			Private_mapping(pager, alloc, Dataspace_capability(), &reader,
+			                source_offset, source_size, size, writeable)
+		{ }
+
+		~Private_mapping()
+		{
+			_pager.local_rm().detach(_local_addr);
+			_pager.dissolve(*this);
+			_pager.rm().destroy(_managed.rpc_cap());
+
+			for (unsigned i = 0; i < _num_windows; i++)
+				if (_windows[i].state == Window::PRIVATE)
+					_pager.ram().free(_windows[i].ds);
+
+			_alloc.free(_windows, sizeof(Window)*_num_windows);
+		}
+
+		void *local_addr() const { return _local_addr; }
+
+		size_t size() const { return _size; }
+
+		/**
+		 * Called by the pager thread on the occurrence of region-map faults
+		 */
+		void handle_faults()
+		{
+			for (;;) {
+				State const state = _managed.state();
+
+				if (state.type == State::READY)
+					return;
+
+				try {
+					if (_resolve(state))
+						continue;
+
+					char const * const access =
+						state.type == State::WRITE_FAULT ? "write" :
+						state.type == State::EXEC_FAULT  ? "exec"  : "read";
+
+					error("invalid ", access, " access to private mapping at ",
+					      Hex(state.addr));
+				}
+				catch (Out_of_ram)  { error("mmap pager out of RAM"); }
+				catch (Out_of_caps) { error("mmap pager out of caps"); }
+				catch (...)         { error("mmap pager failed to resolve fault at ",
+				                            Hex(state.addr)); }
+
+				_pager.segmentation_fault();
+			}
+		}
+};
+
+
+inline void Libc::Private_mapping_pager::entry()
+{
+	for (;;) {
+		Genode::Signal signal = _receiver.wait_for_signal();
+
+		static_cast<Private_mapping *>(signal.context())->handle_faults();
+	}
+}
+
+#endif /* _LIBC__INTERNAL__PRIVATE_MAPPING_H_ */
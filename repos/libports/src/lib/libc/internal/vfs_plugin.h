@@ -31,6 +31,7 @@
 
 /* libc-internal includes */
 #include <internal/errno.h>
+#include <internal/private_mapping.h>
 
 
 namespace Libc { class Vfs_plugin; }
@@ -73,17 +74,41 @@ class Libc::Vfs_plugin final : public Plugin
 
 	private:
 
+		/**
+		 * Reader of file content for populating a private mapping
+		 */
+		struct Mmap_reader : Private_mapping::Reader
+		{
+			Vfs::Vfs_handle &handle;
+
+			Mmap_reader(Vfs::Vfs_handle &handle) : handle(handle) { }
+
+			size_t read(off_t, char *, size_t) override;
+		};
+
 		struct Mmap_entry : Registry<Mmap_entry>::Element
 		{
 			void            * const start;
 			Vfs::Vfs_handle * const reference_handle;
+			Private_mapping * const private_mapping;
+			Mmap_reader     * const reader;
+
+			/* dataspace obtained from the VFS, released on unmap */
+			Absolute_path                const path;
+			Genode::Dataspace_capability const ds;
 
 			Mmap_entry(Registry<Mmap_entry> &registry, void *start,
-			           Vfs::Vfs_handle *reference_handle)
+			           Vfs::Vfs_handle *reference_handle,
+			           char const *path, Genode::Dataspace_capability ds,
+			           Private_mapping *private_mapping = nullptr,
+			           Mmap_reader     *reader          = nullptr)
 			: Registry<Mmap_entry>::Element(registry, *this), start(start),
-			  reference_handle(reference_handle) { }
+			  reference_handle(reference_handle),
+			  private_mapping(private_mapping), reader(reader),
+			  path(path), ds(ds) { }
 		};
 
+		Genode::Env                     &_env;
 		Genode::Allocator               &_alloc;
 		Vfs::File_system                &_root_fs;
 		Constructible<Genode::Directory> _root_dir { };
@@ -91,8 +116,11 @@ class Libc::Vfs_plugin final : public Plugin
 		Update_mtime               const _update_mtime;
 		Current_real_time               &_current_real_time;
 		bool                       const _pipe_configured;
+		bool                       const _lazy_mmap_configured;
 		Registry<Mmap_entry>             _mmap_registry;
 
+		Constructible<Private_mapping_pager> _private_mapping_pager { };
+
 		/**
 		 * Sync a handle
 		 */
@@ -105,6 +133,34 @@ class Libc::Vfs_plugin final : public Plugin
 
 		int _legacy_ioctl(File_descriptor *, unsigned long, char *);
 
+		/**
+		 * Open additional VFS handle that keeps the file of a mapping open
+		 */
+		Vfs::Vfs_handle *_open_reference_handle(File_descriptor *);
+
+		/**
+		 * Release dataspace obtained for a mapping and close reference handle
+		 */
+		void _release_mapping(char const *path, Genode::Dataspace_capability,
+		                      Vfs::Vfs_handle *reference_handle);
+
+		/**
+		 * Map file privately and populate the mapping on demand, if possible
+		 *
+		 * \return  local address, or nullptr if the file content must be
+		 *          copied eagerly
+		 */
+		void *_mmap_private_lazy(::size_t, int, File_descriptor *, ::off_t);
+
+		/**
+		 * Resolve page faults of a buffer within private mappings
+		 *
+		 * The VFS accesses buffers from the libc kernel, which cannot
+		 * serve page faults of lazily populated mappings. Hence, buffers
+		 * are touched in application context before.
+		 */
+		void _touch_buffer(void const *, ::size_t, bool write);
+
 		struct Ioctl_result
 		{
 			bool handled;
@@ -145,6 +201,14 @@ class Libc::Vfs_plugin final : public Plugin
 			return result;
 		}
 
+		static bool _init_lazy_mmap_configured(Xml_node config)
+		{
+			bool result = false;
+			config.with_sub_node("libc", [&] (Xml_node libc_node) {
+				result = libc_node.attribute_value("lazy_mmap", false); });
+			return result;
+		}
+
 	public:
 
 		Vfs_plugin(Libc::Env                &env,
@@ -155,12 +219,13 @@ class Libc::Vfs_plugin final : public Plugin
 		           Current_real_time        &current_real_time,
 		           Xml_node                  config)
 		:
-			_alloc(alloc),
+			_env(env), _alloc(alloc),
 			_root_fs(env.vfs()),
 			_response_handler(handler),
 			_update_mtime(update_mtime),
 			_current_real_time(current_real_time),
-			_pipe_configured(_init_pipe_configured(config))
+			_pipe_configured(_init_pipe_configured(config)),
+			_lazy_mmap_configured(_init_lazy_mmap_configured(config))
 		{
 			if (config.has_sub_node("libc"))
 				_root_dir.construct(vfs_env);
@@ -216,6 +281,9 @@ class Libc::Vfs_plugin final : public Plugin
 		File_descriptor *open(const char *path, int flags) override;
 		int     pipe(File_descriptor *pipefdo[2]) override;
 		bool    poll(File_descriptor &fdo, struct pollfd &pfd) override;
+		bool    watch(File_descriptor *, Vfs::Handle_observer &) override;
+		void    unwatch(File_descriptor *, Vfs::Handle_observer &) override;
+		::size_t available(File_descriptor *, bool) override;
 		ssize_t read(File_descriptor *, void *, ::size_t) override;
 		ssize_t readlink(const char *, char *, ::size_t) override;
 		int     rename(const char *, const char *) override;
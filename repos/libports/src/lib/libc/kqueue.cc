@@ -0,0 +1,541 @@
+/*
+ * \brief  kqueue() and kevent() implementation
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * In contrast to 'select', a kqueue keeps the set of watched descriptors
+ * across calls. Each watched descriptor is equipped with an observer at its
+ * VFS handles. The observer is informed about the handle's responses before
+ * the libc kernel's response handler and enqueues the knotes of the
+ * descriptor into the ready queue. A 'kevent' call polls the knotes of the
+ * ready queue only, which makes the cost of a wakeup independent from the
+ * number of idle descriptors. Polling a descriptor that is not ready
+ * requests the next notification.
+ *
+ * Descriptors of plugins that cannot deliver per-descriptor notifications
+ * remain in the ready queue and are polled on each wakeup.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/id_space.h>
+#include <base/registry.h>
+#include <util/fifo.h>
+#include <util/list.h>
+#include <vfs/vfs_handle.h>
+#include <libc/allocator.h>
+
+/* libc includes */
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/poll.h>
+#include <errno.h>
+
+/* libc plugin interface */
+#include <libc-plugin/plugin.h>
+#include <libc-plugin/fd_alloc.h>
+
+/* libc-internal includes */
+#include <internal/init.h>
+#include <internal/errno.h>
+#include <internal/kqueue.h>
+#include <internal/monitor.h>
+#include <internal/signal.h>
+
+namespace Libc {
+	struct Kqueue;
+	struct Kqueue_plugin;
+}
+
+using namespace Libc;
+
+
+static Monitor      *_monitor_ptr;
+static Libc::Signal *_signal_ptr;
+
+
+void Libc::init_kqueue(Monitor &monitor, Signal &signal)
+{
+	_monitor_ptr = &monitor;
+	_signal_ptr  = &signal;
+}
+
+
+static Monitor &monitor()
+{
+	struct Missing_call_of_init_kqueue : Exception { };
+	if (!_monitor_ptr)
+		throw Missing_call_of_init_kqueue();
+	return *_monitor_ptr;
+}
+
+
+static Libc::Allocator &kqueue_alloc()
+{
+	static Libc::Allocator inst { };
+	return inst;
+}
+
+
+struct Libc::Kqueue : Plugin_context
+{
+	struct Watch;
+
+	struct Knote : Fifo<Knote>::Element
+	{
+		Watch &watch;
+
+		short const filter;
+
+		bool           added     = false;
+		bool           enabled   = false;
+		bool           was_ready = false;
+		unsigned short flags     = 0;
+		unsigned       fflags  = 0;
+		void          *udata   = nullptr;
+
+		Knote(Watch &watch, short filter) : watch(watch), filter(filter) { }
+
+		bool active() const { return added && enabled; }
+
+		short poll_events() const {
+			return filter == EVFILT_READ ? POLLIN : POLLOUT; }
+	};
+
+	struct Watch : Vfs::Handle_observer, List<Watch>::Element
+	{
+		Kqueue          &kqueue;
+		File_descriptor &fd;
+
+		Id_space<Watch>::Element const _elem;
+
+		Knote read  { *this, EVFILT_READ  };
+		Knote write { *this, EVFILT_WRITE };
+
+		/* true if the plugin delivers notifications for 'fd' */
+		bool const notifying;
+
+		Watch(Kqueue &kqueue, File_descriptor &fd)
+		:
+			kqueue(kqueue), fd(fd),
+			_elem(*this, kqueue._watches, Id_space<Watch>::Id { (unsigned long)fd.libc_fd }),
+			notifying(fd.plugin->watch(&fd, *this))
+		{ }
+
+		~Watch()
+		{
+			kqueue._unschedule(read);
+			kqueue._unschedule(write);
+
+			/* observers may be installed even if 'watch' failed partially */
+			fd.plugin->unwatch(&fd, *this);
+		}
+
+		Knote &knote(short filter) { return filter == EVFILT_READ ? read : write; }
+
+		bool unused() const { return !read.added && !write.added; }
+
+		/**
+		 * Vfs::Handle_observer interface
+		 */
+		void handle_response(Vfs::Vfs_handle &) override
+		{
+			kqueue._schedule(read);
+			kqueue._schedule(write);
+		}
+	};
+
+	Registry<Kqueue>::Element _elem;
+
+	Mutex           _mutex   { };  /* serializes 'kevent' calls */
+	Id_space<Watch> _watches { };
+	List<Watch>     _watch_list { };
+
+	Mutex       _ready_mutex { };  /* protects '_ready' against responses */
+	Fifo<Knote> _ready       { };
+
+	void _schedule(Knote &knote)
+	{
+		Mutex::Guard guard(_ready_mutex);
+
+		if (knote.active() && !knote.enqueued())
+			_ready.enqueue(knote);
+	}
+
+	void _unschedule(Knote &knote)
+	{
+		Mutex::Guard guard(_ready_mutex);
+
+		if (knote.enqueued())
+			_ready.remove(knote);
+	}
+
+	Knote *_dequeue()
+	{
+		Mutex::Guard guard(_ready_mutex);
+
+		Knote *result = nullptr;
+		_ready.dequeue([&] (Knote &knote) { result = &knote; });
+		return result;
+	}
+
+	template <typename FN>
+	void _with_watch(int libc_fd, FN const &fn)
+	{
+		try {
+			_watches.apply<Watch>(Id_space<Watch>::Id { (unsigned long)libc_fd }, fn);
+		} catch (Id_space<Watch>::Unknown_id) { }
+	}
+
+	void _destroy(Watch &watch)
+	{
+		_watch_list.remove(&watch);
+		destroy(kqueue_alloc(), &watch);
+	}
+
+	/**
+	 * Apply change, return 0 on success or errno value
+	 */
+	int _apply(struct kevent const &change)
+	{
+		if (change.filter != EVFILT_READ && change.filter != EVFILT_WRITE)
+			return EINVAL;
+
+		int const libc_fd = (int)change.ident;
+
+		File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(libc_fd);
+		if (!fd || !fd->plugin)
+			return EBADF;
+
+		Watch *watch = nullptr;
+		_with_watch(libc_fd, [&] (Watch &w) { watch = &w; });
+
+		if (!watch) {
+			if (!(change.flags & EV_ADD))
+				return ENOENT;
+
+			watch = new (kqueue_alloc()) Watch(*this, *fd);
+			_watch_list.insert(watch);
+		}
+
+		Knote &knote = watch->knote(change.filter);
+
+		if (change.flags & EV_DELETE) {
+			if (!knote.added)
+				return ENOENT;
+
+			knote.added = false;
+			_unschedule(knote);
+
+			if (watch->unused())
+				_destroy(*watch);
+
+			return 0;
+		}
+
+		if (!knote.added && !(change.flags & EV_ADD))
+			return ENOENT;
+
+		if (change.flags & EV_ADD) {
+			if (!knote.added)
+				knote.enabled = true;
+
+			knote.added     = true;
+			knote.was_ready = false;
+			knote.fflags    = change.fflags;
+			knote.udata     = change.udata;
+			knote.flags     = change.flags & (EV_ONESHOT | EV_CLEAR | EV_DISPATCH);
+		}
+
+		if (change.flags & EV_DISABLE) knote.enabled = false;
+		if (change.flags & EV_ENABLE)  knote.enabled = true;
+
+		/* check for initial readiness at the next collection */
+		if (knote.active())
+			_schedule(knote);
+		else
+			_unschedule(knote);
+
+		return 0;
+	}
+
+	/**
+	 * Report ready knotes, return number of events stored in 'out'
+	 */
+	int _collect(struct kevent *out, int nevents)
+	{
+		int n = 0;
+
+		/*
+		 * Knotes that stay ready are re-enqueued at the tail. Limit the
+		 * iteration to the knotes present at the beginning to visit each
+		 * knote at most once.
+		 */
+		unsigned num_queued = 0;
+		{
+			Mutex::Guard guard(_ready_mutex);
+			_ready.for_each([&] (Knote &) { num_queued++; });
+		}
+
+		for (unsigned i = 0; i < num_queued && n < nevents; i++) {
+
+			Knote *knote_ptr = _dequeue();
+			if (!knote_ptr)
+				break;
+
+			Knote &knote = *knote_ptr;
+			Watch &watch = knote.watch;
+
+			if (!knote.active())
+				continue;
+
+			struct pollfd pfd { };
+			pfd.fd     = watch.fd.libc_fd;
+			pfd.events = knote.poll_events();
+
+			bool const ready = watch.fd.plugin->poll(watch.fd, pfd)
+			                && (pfd.revents & (pfd.events | POLLHUP | POLLERR));
+
+			/*
+			 * Knotes of notifying descriptors are enqueued by responses only.
+			 * Edge-triggered knotes of polled descriptors are reported on the
+			 * transition to ready.
+			 */
+			bool const report = ready && (watch.notifying || !(knote.flags & EV_CLEAR)
+			                                               || !knote.was_ready);
+			knote.was_ready = ready;
+
+			if (!report) {
+				/*
+				 * Polling a notifying descriptor requested the next
+				 * notification, other descriptors are polled again.
+				 */
+				if (!watch.notifying)
+					_schedule(knote);
+				continue;
+			}
+
+			bool const write = (knote.filter == EVFILT_WRITE);
+
+			struct kevent &ev = out[n++];
+			EV_SET(&ev, watch.fd.libc_fd, knote.filter, 0, 0,
+			       (intptr_t)watch.fd.plugin->available(&watch.fd, write), knote.udata);
+
+			if (pfd.revents & (POLLHUP | POLLERR))
+				ev.flags |= EV_EOF;
+
+			if (knote.flags & EV_ONESHOT) {
+				knote.added = false;
+				if (watch.unused())
+					_destroy(watch);
+				continue;
+			}
+
+			if (knote.flags & EV_DISPATCH) {
+				knote.enabled = false;
+				continue;
+			}
+
+			/* edge-triggered knotes wait for the next notification */
+			if ((knote.flags & EV_CLEAR) && watch.notifying) {
+				watch.fd.plugin->watch(&watch.fd, watch);
+				continue;
+			}
+
+			/* level-triggered knotes are reported until they become idle */
+			_schedule(knote);
+		}
+
+		return n;
+	}
+
+	Kqueue(Registry<Kqueue> &registry) : _elem(registry, *this) { }
+
+	~Kqueue()
+	{
+		while (Watch *watch = _watch_list.first())
+			_destroy(*watch);
+	}
+
+	/**
+	 * Forget about a descriptor that is about to be closed
+	 */
+	void descriptor_closed(File_descriptor &fd)
+	{
+		Mutex::Guard guard(_mutex);
+
+		_with_watch(fd.libc_fd, [&] (Watch &watch) {
+			if (&watch.fd == &fd)
+				_destroy(watch); });
+	}
+
+	int kevent(struct kevent const *changes, int nchanges,
+	           struct kevent *events, int nevents,
+	           struct timespec const *timeout)
+	{
+		if (nchanges < 0 || nevents < 0)
+			return Errno(EINVAL);
+
+		int n = 0;
+
+		/* apply changes */
+		{
+			int error = 0;
+
+			monitor().monitor([&] {
+				Mutex::Guard guard(_mutex);
+
+				for (int i = 0; i < nchanges; i++) {
+					int const result = _apply(changes[i]);
+
+					if (!result && !(changes[i].flags & EV_RECEIPT))
+						continue;
+
+					/* report errors and receipts via the event list */
+					if (n < nevents) {
+						events[n] = changes[i];
+						events[n].flags = EV_ERROR;
+						events[n].data  = result;
+						n++;
+					} else if (result) {
+						error = result;
+						break;
+					}
+				}
+				return Monitor::Function_result::COMPLETE;
+			});
+
+			if (error)
+				return Errno(error);
+		}
+
+		if (n || nevents == 0)
+			return n;
+
+		/* collect events */
+		bool const zero_timeout = timeout && timeout->tv_sec == 0
+		                                  && timeout->tv_nsec == 0;
+
+		Genode::uint64_t const timeout_ms = timeout
+			? max((Genode::uint64_t)timeout->tv_sec*1000 + timeout->tv_nsec/1000000,
+			      (Genode::uint64_t)1)
+			: 0;
+
+		unsigned const orig_signal_count = _signal_ptr->count();
+
+		auto signal_occurred = [&] {
+			return _signal_ptr->count() != orig_signal_count; };
+
+		auto collect_fn = [&] {
+			Mutex::Guard guard(_mutex);
+
+			n = _collect(events, nevents);
+
+			if (n || zero_timeout || signal_occurred())
+				return Monitor::Function_result::COMPLETE;
+
+			return Monitor::Function_result::INCOMPLETE;
+		};
+
+		Monitor::Result const result = monitor().monitor(collect_fn, timeout_ms);
+
+		if (result == Monitor::Result::TIMEOUT)
+			return 0;
+
+		if (!n && signal_occurred())
+			return Errno(EINTR);
+
+		return n;
+	}
+};
+
+
+static Registry<Kqueue> &kqueues()
+{
+	static Registry<Kqueue> inst { };
+	return inst;
+}
+
+
+struct Libc::Kqueue_plugin : Plugin
+{
+	int close(File_descriptor *fd) override
+	{
+		Kqueue *kqueue = dynamic_cast<Kqueue *>(fd->context);
+		if (kqueue)
+			destroy(kqueue_alloc(), kqueue);
+
+		file_descriptor_allocator()->free(fd);
+		return 0;
+	}
+};
+
+
+static Kqueue_plugin &kqueue_plugin()
+{
+	static Kqueue_plugin inst { };
+	return inst;
+}
+
+
+void Libc::kqueue_descriptor_closed(File_descriptor &fd)
+{
+	if (fd.plugin == &kqueue_plugin())
+		return;
+
+	kqueues().for_each([&] (Kqueue &kqueue) {
+		kqueue.descriptor_closed(fd); });
+}
+
+
+extern "C" __attribute__((weak))
+int kqueue(void)
+{
+	Kqueue *kqueue = new (kqueue_alloc()) Kqueue(kqueues());
+
+	File_descriptor *fd =
+		file_descriptor_allocator()->alloc(&kqueue_plugin(), kqueue);
+
+	if (!fd) {
+		destroy(kqueue_alloc(), kqueue);
+		return Errno(EMFILE);
+	}
+
+	return fd->libc_fd;
+}
+
+
+extern "C" __attribute__((weak))
+int kevent(int kq, struct kevent const *changelist, int nchanges,
+           struct kevent *eventlist, int nevents,
+           struct timespec const *timeout)
+{
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(kq);
+	if (!fd || fd->plugin != &kqueue_plugin())
+		return Errno(EBADF);
+
+	Kqueue *kqueue = dynamic_cast<Kqueue *>(fd->context);
+	if (!kqueue)
+		return Errno(EBADF);
+
+	return kqueue->kevent(changelist, nchanges, eventlist, nevents, timeout);
+}
+
+
+extern "C" __attribute__((alias("kevent")))
+int __sys_kevent(int, struct kevent const *, int, struct kevent *, int,
+                 struct timespec const *);
+
+extern "C" __attribute__((alias("kevent")))
+int __libc_kevent(int, struct kevent const *, int, struct kevent *, int,
+                  struct timespec const *);
+
+extern "C" __attribute__((alias("kevent")))
+int _kevent(int, struct kevent const *, int, struct kevent *, int,
+            struct timespec const *);
@@ -209,6 +209,8 @@ DUMMY(int, -1, munmap,       (void *, ::size_t));
 DUMMY(int, -1, msync,        (void *addr, ::size_t len, int flags));
 DUMMY(int, -1, pipe,         (File_descriptor*[2]));
 DUMMY(bool, 0, poll,         (File_descriptor &, struct pollfd &));
+DUMMY(bool, 0, watch,        (File_descriptor *, Vfs::Handle_observer &));
+DUMMY(::size_t, 0, available, (File_descriptor *, bool));
 DUMMY(ssize_t, -1, readlink, (const char *, char *, ::size_t));
 DUMMY(int, -1, rename,       (const char *, const char *));
 DUMMY(int, -1, rmdir,        (const char*));
@@ -216,3 +218,6 @@ DUMMY(int, -1, select,       (int, fd_set *, fd_set *, fd_set *, struct timeval
 DUMMY(int, -1, stat,         (const char*, struct stat*));
 DUMMY(int, -1, symlink,      (const char*, const char*));
 DUMMY(int, -1, unlink,       (const char*));
+
+
+void Plugin::unwatch(File_descriptor *, Vfs::Handle_observer &) { }
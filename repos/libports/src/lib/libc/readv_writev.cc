@@ -21,6 +21,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
 
 /* libc-internal includes */
 #include <internal/types.h>
@@ -28,21 +29,78 @@
 using namespace Libc;
 
 
+/*
+ * Vectors of small buffers are combined into a single read or write to spare
+ * the round trip per vector element, e.g., for each File_system packet.
+ */
+enum { GATHER_BUFFER_SIZE = 16*1024 };
+
+
+/**
+ * Repeat 'rw_func' until 'count' bytes are transferred
+ *
+ * \return number of transferred bytes, or -1 on error
+ */
+template <typename Rw_func, typename PTR>
+static ssize_t transfer_all(Rw_func rw_func, int fd, PTR buf, size_t count)
+{
+	size_t done = 0;
+	while (done < count) {
+		ssize_t const n = rw_func(fd, buf + done, count - done);
+
+		if (n == -1)
+			return -1;
+
+		if (n == 0)
+			break;
+
+		done += n;
+	}
+	return done;
+}
+
+
 struct Read
 {
-	ssize_t operator()(int fd, void *buf, size_t count)
+	ssize_t operator()(int fd, char *buf, size_t count)
 	{
 		return read(fd, buf, count);
 	}
+
+	ssize_t gathered(int fd, char *buffer, const struct iovec *iov, int iovcnt,
+	                 size_t total)
+	{
+		ssize_t const result = transfer_all(*this, fd, buffer, total);
+
+		/* scatter the read data to the vector */
+		for (size_t left = result > 0 ? result : 0; left; iov++) {
+			size_t const n = min(left, iov->iov_len);
+			::memcpy(iov->iov_base, buffer, n);
+			buffer += n;
+			left   -= n;
+		}
+		return result;
+	}
 };
 
 
 struct Write
 {
-	ssize_t operator()(int fd, const void *buf, size_t count)
+	ssize_t operator()(int fd, const char *buf, size_t count)
 	{
 		return write(fd, buf, count);
 	}
+
+	ssize_t gathered(int fd, char *buffer, const struct iovec *iov, int iovcnt,
+	                 size_t total)
+	{
+		char *dst = buffer;
+		for (int i = 0; i < iovcnt; i++) {
+			::memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+			dst += iov[i].iov_len;
+		}
+		return transfer_all(*this, fd, (char const *)buffer, total);
+	}
 };
 
 
@@ -52,6 +110,9 @@ static ssize_t readv_writev_impl(Rw_func rw_func, int fd, const struct iovec *io
 	/* FIXME this should be a pthread_mutex because function uses blocking operations */
 	static Mutex rw_mutex;
 
+	/* protected by 'rw_mutex' */
+	static char gather_buffer[GATHER_BUFFER_SIZE];
+
 	Mutex::Guard guard(rw_mutex);
 
 	char *v;
@@ -65,13 +126,16 @@ static ssize_t readv_writev_impl(Rw_func rw_func, int fd, const struct iovec *io
 	}
 
 	for (i = 0; i < iovcnt; i++)
-		v_len += iov->iov_len;
+		v_len += iov[i].iov_len;
 
 	if (v_len > SSIZE_MAX) {
 		errno = EINVAL;
 		return -1;
 	}
 
+	if (iovcnt > 1 && v_len <= sizeof(gather_buffer))
+		return rw_func.gathered(fd, gather_buffer, iov, iovcnt, v_len);
+
 	while (iovcnt > 0) {
 		v = static_cast<char *>(iov->iov_base);
 		v_len = iov->iov_len;
@@ -18,6 +18,7 @@
 #include <base/env.h>
 #include <base/log.h>
 #include <vfs/types.h>
+#include <vfs/socket_datagram.h>
 #include <util/string.h>
 #include <libc/allocator.h>
 
@@ -49,6 +50,7 @@
 namespace Libc {
 	extern char const *config_socket();
 	bool read_ready_from_kernel(File_descriptor *);
+	bool write_ready_from_kernel(File_descriptor *);
 }
 
 
@@ -152,7 +154,8 @@ struct Libc::Socket_fs::Context : Plugin_context
 		Absolute_path const _path {
 			_read_socket_path().base(), config_socket() };
 
-		enum Fd { DATA, PEEK, CONNECT, BIND, LISTEN, ACCEPT, LOCAL, REMOTE, MAX };
+		enum Fd { DATA, PEEK, CONNECT, BIND, LISTEN, ACCEPT, LOCAL, REMOTE,
+		          DATAGRAM, MAX };
 
 		struct
 		{
@@ -163,9 +166,16 @@ struct Libc::Socket_fs::Context : Plugin_context
 			{ "data",    -1, nullptr }, { "peek",   -1, nullptr },
 			{ "connect", -1, nullptr }, { "bind",   -1, nullptr },
 			{ "listen",  -1, nullptr }, { "accept", -1, nullptr },
-			{ "local",   -1, nullptr }, { "remote", -1, nullptr }
+			{ "local",   -1, nullptr }, { "remote", -1, nullptr },
+			{ "datagram", -1, nullptr }
 		};
 
+		/*
+		 * Buffer for assembling and disassembling records of the datagram
+		 * file, allocated on first use
+		 */
+		char *_datagram_buf = nullptr;
+
 
 		Proto const _proto;
 
@@ -178,10 +188,12 @@ struct Libc::Socket_fs::Context : Plugin_context
 				if (_fd[i].num != -1) fn(_fd[i].num);
 		}
 
-		void _init_fd(Fd type, int flags)
+		void _init_fd(Fd type, int flags, bool optional = false)
 		{
 			Absolute_path file(_fd[type].name, _path.base());
 			int const fd = open(file.base(), flags|_fd_flags);
+			if (fd == -1 && optional)
+				return;
 			if (fd == -1) {
 				error(__func__, ": ", _fd[type].name,
 				      " file not accessible at ", file,
@@ -202,6 +214,8 @@ struct Libc::Socket_fs::Context : Plugin_context
 
 	public:
 
+		enum { DATAGRAM_BUF_SIZE = sizeof(Vfs::Socket_datagram) + 64*1024 };
+
 		Context(Proto proto, int handle_fd)
 		: _handle_fd(handle_fd), _proto(proto)
 		{
@@ -213,12 +227,17 @@ struct Libc::Socket_fs::Context : Plugin_context
 			_init_fd(Fd::ACCEPT,  O_RDONLY);
 			_init_fd(Fd::LOCAL,   O_RDWR);
 			_init_fd(Fd::REMOTE,  O_RDWR);
+
+			/* socket file systems without datagram file use "remote" and "data" */
+			if (_proto == UDP)
+				_init_fd(Fd::DATAGRAM, O_RDWR, true);
 		}
 
 		~Context()
 		{
 			_fd_apply([] (int fd) { ::close(fd); });
 			::close(_handle_fd);
+			::free(_datagram_buf);
 		}
 
 		Absolute_path path() const { return _path; }
@@ -240,6 +259,16 @@ struct Libc::Socket_fs::Context : Plugin_context
 		int accept_fd()  { return _fd[Fd::ACCEPT].num; }
 		int local_fd()   { return _fd[Fd::LOCAL].num; }
 		int remote_fd()  { return _fd[Fd::REMOTE].num; }
+		int datagram_fd() { return _fd[Fd::DATAGRAM].num; }
+
+		bool has_datagram_file() const { return _fd[Fd::DATAGRAM].num != -1; }
+
+		char *datagram_buf()
+		{
+			if (!_datagram_buf)
+				_datagram_buf = (char *)::malloc(DATAGRAM_BUF_SIZE);
+			return _datagram_buf;
+		}
 
 		/* request the appropriate fd to ensure the file is open */
 		bool connect_read_ready() { return _fd_read_ready(Fd::CONNECT); }
@@ -247,6 +276,7 @@ struct Libc::Socket_fs::Context : Plugin_context
 		bool accept_read_ready()  { return _fd_read_ready(Fd::ACCEPT); }
 		bool local_read_ready()   { return _fd_read_ready(Fd::LOCAL); }
 		bool remote_read_ready()  { return _fd_read_ready(Fd::REMOTE); }
+		bool datagram_read_ready() { return _fd_read_ready(Fd::DATAGRAM); }
 
 		void state(State state) { _state = state; }
 		State state() const     { return _state; }
@@ -261,10 +291,46 @@ struct Libc::Socket_fs::Context : Plugin_context
 			if (_state == CONNECTING)
 				return connect_read_ready();
 
-			/* XXX ask if "data" is writeable */
+			if (_fd[Fd::DATA].file)
+				return Libc::write_ready_from_kernel(_fd[Fd::DATA].file);
+
 			return true;
 		}
 
+		/**
+		 * Observe the files relevant for readiness
+		 */
+		bool watch(Vfs::Handle_observer &observer)
+		{
+			Fd const types[] = { Fd::DATA, Fd::CONNECT, Fd::ACCEPT };
+
+			bool result = true;
+			for (Fd type : types) {
+				File_descriptor *file = _fd[type].file;
+				if (file)
+					result &= file->plugin->watch(file, observer);
+			}
+			return result;
+		}
+
+		void unwatch(Vfs::Handle_observer &observer)
+		{
+			Fd const types[] = { Fd::DATA, Fd::CONNECT, Fd::ACCEPT };
+
+			for (Fd type : types) {
+				File_descriptor *file = _fd[type].file;
+				if (file)
+					file->plugin->unwatch(file, observer);
+			}
+		}
+
+		::size_t available(bool write)
+		{
+			File_descriptor *file = _fd[Fd::DATA].file;
+
+			return file ? file->plugin->available(file, write) : 0;
+		}
+
 		/*
 		 * Read the connect status from the connect file and return 0 if connected
 		 * or -1 with errno set to the error code.
@@ -341,6 +407,9 @@ struct Libc::Socket_fs::Plugin : Libc::Plugin
 	int fcntl(File_descriptor *, int, long) override;
 	int close(File_descriptor *) override;
 	bool poll(File_descriptor &fd, struct pollfd &pfd) override;
+	bool watch(File_descriptor *, Vfs::Handle_observer &) override;
+	void unwatch(File_descriptor *, Vfs::Handle_observer &) override;
+	::size_t available(File_descriptor *, bool) override;
 	int select(int, fd_set *, fd_set *, fd_set *, timeval *) override;
 	int ioctl(File_descriptor *, unsigned long, char *) override;
 };
@@ -843,10 +912,143 @@ extern "C" ssize_t socket_fs_recv(int libc_fd, void *buf, ::size_t len, int flag
 }
 
 
+static ::size_t iov_total(msghdr const &msg)
+{
+	::size_t total = 0;
+	for (int i = 0; i < msg.msg_iovlen; i++)
+		total += msg.msg_iov[i].iov_len;
+	return total;
+}
+
+
+/**
+ * Receive one datagram including its source address via the datagram file
+ */
+static ssize_t recv_datagram(Socket_fs::Context &context, msghdr &msg, int flags)
+{
+	using Vfs::Socket_datagram;
+
+	if ((flags & MSG_DONTWAIT) && !context.datagram_read_ready())
+		return Errno(EAGAIN);
+
+	char * const buf = context.datagram_buf();
+	if (!buf) return Errno(ENOMEM);
+
+	::size_t const max_payload = Context::DATAGRAM_BUF_SIZE - sizeof(Socket_datagram);
+	::size_t const count = sizeof(Socket_datagram) + min(iov_total(msg), max_payload);
+
+	lseek(context.datagram_fd(), 0, SEEK_SET);
+	ssize_t const n = read(context.datagram_fd(), buf, count);
+	if (n < 0) return n;
+	if ((::size_t)n < sizeof(Socket_datagram)) return Errno(EIO);
+
+	Socket_datagram header { };
+	::memcpy(&header, buf, sizeof(header));
+
+	/* scatter payload to the I/O vectors */
+	::size_t const received = n - sizeof(Socket_datagram);
+	::size_t copied = 0;
+	for (int i = 0; i < msg.msg_iovlen && copied < received; i++) {
+		::size_t const len = min(msg.msg_iov[i].iov_len, received - copied);
+		::memcpy(msg.msg_iov[i].iov_base, buf + sizeof(header) + copied, len);
+		copied += len;
+	}
+
+	msg.msg_flags = header.length > received ? MSG_TRUNC : 0;
+	msg.msg_controllen = 0;
+
+	if (msg.msg_name) {
+		sockaddr_in addr { };
+		addr.sin_len    = sizeof(addr);
+		addr.sin_family = AF_INET;
+		addr.sin_port   = header.port;
+		::memcpy(&addr.sin_addr, header.addr, sizeof(header.addr));
+
+		::memcpy(msg.msg_name, &addr, min((::size_t)msg.msg_namelen, sizeof(addr)));
+		msg.msg_namelen = sizeof(addr);
+	}
+
+	return (flags & MSG_TRUNC) ? header.length : received;
+}
+
+
+static ssize_t do_recvmsg(File_descriptor *fd, msghdr *msg, int flags)
+{
+	Socket_fs::Context *context = dynamic_cast<Socket_fs::Context *>(fd->context);
+	if (!context) return Errno(ENOTSOCK);
+	if (!msg)     return Errno(EFAULT);
+	if (!iov_total(*msg)) return Errno(EINVAL);
+
+	try {
+		if (context->proto() == Context::Proto::UDP
+		 && context->has_datagram_file() && !(flags & MSG_PEEK))
+			return recv_datagram(*context, *msg, flags);
+
+		if ((flags & MSG_DONTWAIT) && !context->read_ready())
+			return Errno(EAGAIN);
+
+		/*
+		 * Without datagram file, the payload is read into the first non-empty
+		 * I/O vector only.
+		 */
+		int i = 0;
+		while (!msg->msg_iov[i].iov_len) i++;
+
+		socklen_t namelen = msg->msg_namelen;
+		ssize_t const n = do_recvfrom(fd, msg->msg_iov[i].iov_base,
+		                              msg->msg_iov[i].iov_len, flags & ~MSG_DONTWAIT,
+		                              (sockaddr *)msg->msg_name,
+		                              msg->msg_name ? &namelen : nullptr);
+		if (n < 0) return n;
+
+		msg->msg_namelen    = namelen;
+		msg->msg_flags      = 0;
+		msg->msg_controllen = 0;
+		return n;
+	} catch (Socket_fs::Context::Inaccessible) {
+		return Errno(EINVAL);
+	}
+}
+
+
 extern "C" ssize_t socket_fs_recvmsg(int libc_fd, msghdr *msg, int flags)
 {
-	warning("##########  TODO  ########## ", __func__);
-	return 0;
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(libc_fd);
+	if (!fd) return Errno(EBADF);
+
+	return do_recvmsg(fd, msg, flags);
+}
+
+
+extern "C" ssize_t socket_fs_recvmmsg(int libc_fd, mmsghdr *msgvec, ::size_t vlen,
+                                      int flags, timespec const *timeout)
+{
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(libc_fd);
+	if (!fd)     return Errno(EBADF);
+	if (!msgvec) return Errno(EFAULT);
+
+	/*
+	 * Only the first message is waited for if MSG_WAITFORONE or a timeout is
+	 * given. The timeout itself is not supported, which is in line with
+	 * FreeBSD, where the timeout is checked only after each received message.
+	 */
+	bool const wait_for_one = (flags & MSG_WAITFORONE) || timeout;
+	flags &= ~MSG_WAITFORONE;
+
+	::size_t received = 0;
+	for (; received < vlen; received++) {
+
+		int const msg_flags = (received && wait_for_one) ? flags | MSG_DONTWAIT : flags;
+
+		ssize_t const n = do_recvmsg(fd, &msgvec[received].msg_hdr, msg_flags);
+		if (n < 0) {
+			/* report the messages received so far, the error is not sticky */
+			if (received) break;
+			return n;
+		}
+		msgvec[received].msg_len = n;
+	}
+	return received;
 }
 
 
@@ -904,16 +1106,178 @@ static ssize_t do_sendto(File_descriptor *fd,
 }
 
 
+/**
+ * Append datagram record of message to buffer
+ *
+ * \return  size of the record, or 0 if the record does not fit
+ */
+static ::size_t append_datagram(char *dst, ::size_t avail, msghdr const &msg)
+{
+	using Vfs::Socket_datagram;
+
+	::size_t const len = iov_total(msg);
+	if (len > 0xffff || sizeof(Socket_datagram) + len > avail)
+		return 0;
+
+	sockaddr_in const &addr = *(sockaddr_in const *)msg.msg_name;
+
+	Socket_datagram header { };
+	::memcpy(header.addr, &addr.sin_addr, sizeof(header.addr));
+	header.port   = addr.sin_port;
+	header.length = len;
+	header.write_to(dst);
+
+	/* gather payload from the I/O vectors */
+	::size_t copied = sizeof(header);
+	for (int i = 0; i < msg.msg_iovlen; i++) {
+		::memcpy(dst + copied, msg.msg_iov[i].iov_base, msg.msg_iov[i].iov_len);
+		copied += msg.msg_iov[i].iov_len;
+	}
+	return copied;
+}
+
+
+static bool datagram_destination(Socket_fs::Context &context, msghdr const &msg)
+{
+	return context.proto() == Context::Proto::UDP && context.has_datagram_file()
+	    && msg.msg_name && msg.msg_namelen >= sizeof(sockaddr_in)
+	    && ((sockaddr const *)msg.msg_name)->sa_family == AF_INET;
+}
+
+
+/**
+ * Send batch of datagrams with one write to the datagram file
+ *
+ * \return  number of messages sent or -1 if none could be sent
+ */
+static ssize_t send_datagrams(Socket_fs::Context &context, mmsghdr *msgvec, ::size_t vlen)
+{
+	using Vfs::Socket_datagram;
+
+	char * const buf = context.datagram_buf();
+	if (!buf) return Errno(ENOMEM);
+
+	::size_t used = 0, batch = 0;
+	for (; batch < vlen; batch++) {
+		msghdr const &msg = msgvec[batch].msg_hdr;
+
+		if (!datagram_destination(context, msg))
+			break;
+
+		::size_t const size = append_datagram(buf + used,
+		                                      Context::DATAGRAM_BUF_SIZE - used, msg);
+		if (!size) {
+			if (batch) break;
+			return Errno(EMSGSIZE);
+		}
+		used += size;
+	}
+
+	lseek(context.datagram_fd(), 0, SEEK_SET);
+	ssize_t const n = write(context.datagram_fd(), buf, used);
+	if (n == 0) return Errno(ENETDOWN);
+	if (n < 0)  return n;
+
+	/* count the records accepted by the socket file system */
+	::size_t sent = 0;
+	Socket_datagram::for_each_record(buf, n, [&] (Socket_datagram const &header, char const *) {
+		msgvec[sent++].msg_len = header.length;
+		return true; });
+
+	return sent ? (ssize_t)sent : Errno(EIO);
+}
+
+
+static ssize_t do_sendmsg(File_descriptor *fd, msghdr const *msg, int flags)
+{
+	Socket_fs::Context *context = dynamic_cast<Socket_fs::Context *>(fd->context);
+	if (!context) return Errno(ENOTSOCK);
+	if (!msg)     return Errno(EFAULT);
+
+	try {
+		if (datagram_destination(*context, *msg)) {
+			mmsghdr mmsg { *msg, 0 };
+			ssize_t const n = send_datagrams(*context, &mmsg, 1);
+			return n < 0 ? n : mmsg.msg_len;
+		}
+	} catch (Socket_fs::Context::Inaccessible) {
+		return Errno(EINVAL);
+	}
+
+	/* without datagram file, only a single I/O vector is supported */
+	if (msg->msg_iovlen != 1) return Errno(EOPNOTSUPP);
+
+	return do_sendto(fd, msg->msg_iov[0].iov_base, msg->msg_iov[0].iov_len,
+	                 flags, (sockaddr const *)msg->msg_name, msg->msg_namelen);
+}
+
+
 extern "C" ssize_t socket_fs_sendto(int libc_fd, void const *buf, ::size_t len, int flags,
                                     sockaddr const *dest_addr, socklen_t dest_addrlen)
 {
 	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(libc_fd);
 	if (!fd) return Errno(EBADF);
 
+	/* use the datagram file to avoid the textual address conversion */
+	if (dest_addr && buf && len) {
+		iovec  iov { const_cast<void *>(buf), len };
+		msghdr msg { const_cast<sockaddr *>(dest_addr), dest_addrlen, &iov, 1,
+		             nullptr, 0, 0 };
+		return do_sendmsg(fd, &msg, flags);
+	}
+
 	return do_sendto(fd, buf, len, flags, dest_addr, dest_addrlen);
 }
 
 
+extern "C" ssize_t socket_fs_sendmsg(int libc_fd, msghdr const *msg, int flags)
+{
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(libc_fd);
+	if (!fd) return Errno(EBADF);
+
+	return do_sendmsg(fd, msg, flags);
+}
+
+
+extern "C" ssize_t socket_fs_sendmmsg(int libc_fd, mmsghdr *msgvec, ::size_t vlen,
+                                      int flags)
+{
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(libc_fd);
+	if (!fd)     return Errno(EBADF);
+	if (!msgvec) return Errno(EFAULT);
+
+	Socket_fs::Context *context = dynamic_cast<Socket_fs::Context *>(fd->context);
+	if (!context) return Errno(ENOTSOCK);
+
+	::size_t sent = 0;
+	while (sent < vlen) {
+
+		ssize_t n = 0;
+		try {
+			/* batch consecutive messages with destination address */
+			if (datagram_destination(*context, msgvec[sent].msg_hdr))
+				n = send_datagrams(*context, msgvec + sent, vlen - sent);
+			else {
+				n = do_sendmsg(fd, &msgvec[sent].msg_hdr, flags);
+				if (n >= 0) {
+					msgvec[sent].msg_len = n;
+					n = 1;
+				}
+			}
+		} catch (Socket_fs::Context::Inaccessible) {
+			n = Errno(EINVAL);
+		}
+
+		/* report the messages sent so far, the error is not sticky */
+		if (n <= 0)
+			return sent ? sent : n;
+
+		sent += n;
+	}
+	return sent;
+}
+
+
 extern "C" ssize_t socket_fs_send(int libc_fd, void const *buf, ::size_t len, int flags)
 {
 	/* identical to sendto() with a NULL dest_addr argument */
@@ -1210,6 +1574,40 @@ bool Socket_fs::Plugin::poll(File_descriptor &fdo, struct pollfd &pfd)
 }
 
 
+bool Socket_fs::Plugin::watch(File_descriptor *fdo, Vfs::Handle_observer &observer)
+{
+	Socket_fs::Context *context { nullptr };
+
+	try {
+		context = dynamic_cast<Socket_fs::Context *>(fdo->context);
+	} catch (Socket_fs::Context::Inaccessible) {
+		return false;
+	}
+
+	return context && context->watch(observer);
+}
+
+
+void Socket_fs::Plugin::unwatch(File_descriptor *fdo, Vfs::Handle_observer &observer)
+{
+	try {
+		if (Socket_fs::Context *context = dynamic_cast<Socket_fs::Context *>(fdo->context))
+			context->unwatch(observer);
+	} catch (Socket_fs::Context::Inaccessible) { }
+}
+
+
+::size_t Socket_fs::Plugin::available(File_descriptor *fdo, bool write)
+{
+	try {
+		if (Socket_fs::Context *context = dynamic_cast<Socket_fs::Context *>(fdo->context))
+			return context->available(write);
+	} catch (Socket_fs::Context::Inaccessible) { }
+
+	return 0;
+}
+
+
 bool Socket_fs::Plugin::supports_select(int nfds,
                                         fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
                                         struct timeval *timeout)
@@ -153,6 +153,29 @@ __SYS_(ssize_t, recvmsg, (int libc_fd, msghdr *msg, int flags),
 })
 
 
+extern "C" ssize_t recvmmsg(int libc_fd, mmsghdr *msgvec, ::size_t vlen, int flags,
+                           timespec const *timeout)
+{
+	if (*config_socket())
+		return socket_fs_recvmmsg(libc_fd, msgvec, vlen, flags, timeout);
+
+	/* plugins receive one message per call */
+	::size_t i = 0;
+	for (; i < vlen; i++) {
+		ssize_t const n = recvmsg(libc_fd, &msgvec[i].msg_hdr,
+		                          (i && ((flags & MSG_WAITFORONE) || timeout))
+		                          ? (flags & ~MSG_WAITFORONE) | MSG_DONTWAIT
+		                          : flags & ~MSG_WAITFORONE);
+		if (n < 0) {
+			if (i) break;
+			return n;
+		}
+		msgvec[i].msg_len = n;
+	}
+	return i;
+}
+
+
 __SYS_(ssize_t, sendto, (int libc_fd, void const *buf, ::size_t len, int flags,
                           sockaddr const *dest_addr, socklen_t dest_addrlen),
 {
@@ -163,6 +186,39 @@ __SYS_(ssize_t, sendto, (int libc_fd, void const *buf, ::size_t len, int flags,
 })
 
 
+__SYS_(ssize_t, sendmsg, (int libc_fd, msghdr const *msg, int flags),
+{
+	if (*config_socket())
+		return socket_fs_sendmsg(libc_fd, msg, flags);
+
+	/* plugins provide 'sendto' only, which covers a single I/O vector */
+	if (!msg) return Errno(EFAULT);
+	if (msg->msg_iovlen != 1) return Errno(EOPNOTSUPP);
+
+	FD_FUNC_WRAPPER(sendto, libc_fd, msg->msg_iov[0].iov_base,
+	                msg->msg_iov[0].iov_len, flags,
+	                (sockaddr const *)msg->msg_name, msg->msg_namelen);
+})
+
+
+extern "C" ssize_t sendmmsg(int libc_fd, mmsghdr *msgvec, ::size_t vlen, int flags)
+{
+	if (*config_socket())
+		return socket_fs_sendmmsg(libc_fd, msgvec, vlen, flags);
+
+	::size_t i = 0;
+	for (; i < vlen; i++) {
+		ssize_t const n = sendmsg(libc_fd, &msgvec[i].msg_hdr, flags);
+		if (n < 0) {
+			if (i) break;
+			return n;
+		}
+		msgvec[i].msg_len = n;
+	}
+	return i;
+}
+
+
 extern "C" ssize_t send(int libc_fd, void const *buf, ::size_t len, int flags)
 {
 	if (*config_socket())
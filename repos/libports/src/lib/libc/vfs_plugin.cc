@@ -16,6 +16,8 @@
 /* Genode includes */
 #include <base/env.h>
 #include <base/log.h>
+#include <dataspace/client.h>
+#include <util/touch.h>
 #include <vfs/dir_file_system.h>
 
 /* libc includes */
@@ -215,6 +217,18 @@ namespace Libc {
 
 		return handle->fs().read_ready(handle);
 	}
+
+	bool write_ready_from_kernel(File_descriptor *fd)
+	{
+		Vfs::Vfs_handle *handle = vfs_handle(fd);
+		if (!handle) return false;
+
+		if (handle->fs().write_ready(handle))
+			return true;
+
+		handle->fs().notify_write_ready(handle);
+		return false;
+	}
 }
 
 
@@ -823,6 +837,8 @@ ssize_t Libc::Vfs_plugin::write(File_descriptor *fd, const void *buf,
 
 	Vfs::Vfs_handle *handle = vfs_handle(fd);
 
+	_touch_buffer(buf, count, false);
+
 	Vfs::file_size out_count  = 0;
 	Result         out_result = Result::WRITE_OK;
 
@@ -954,6 +970,8 @@ ssize_t Libc::Vfs_plugin::read(File_descriptor *fd, void *buf,
 	if (fd->flags & O_DIRECTORY)
 		return Errno(EISDIR);
 
+	_touch_buffer(buf, count, true);
+
 	/* TODO refactor multiple monitor() calls to state machine in one call */
 	bool succeeded = false;
 	int result_errno = 0;
@@ -1894,6 +1912,192 @@ int Libc::Vfs_plugin::rename(char const *from_path, char const *to_path)
 }
 
 
+Vfs::Vfs_handle *Libc::Vfs_plugin::_open_reference_handle(File_descriptor *fd)
+{
+	Vfs::Vfs_handle *reference_handle = nullptr;
+	typedef Vfs::Directory_service::Open_result Result;
+	Result vfs_open_result;
+	monitor().monitor([&] {
+		vfs_open_result = _root_fs.open(fd->fd_path, fd->flags,
+		                                &reference_handle, _alloc);
+		return Fn::COMPLETE;
+	});
+
+	return (vfs_open_result == Result::OPEN_OK) ? reference_handle : nullptr;
+}
+
+
+void Libc::Vfs_plugin::_release_mapping(char const *path,
+                                        Genode::Dataspace_capability ds_cap,
+                                        Vfs::Vfs_handle *reference_handle)
+{
+	monitor().monitor([&] {
+		if (ds_cap.valid())
+			_root_fs.release(path, ds_cap);
+		reference_handle->close();
+		return Fn::COMPLETE;
+	});
+}
+
+
+size_t Libc::Vfs_plugin::Mmap_reader::read(off_t offset, char *dst, size_t count)
+{
+	typedef Vfs::File_io_service::Read_result Result;
+
+	bool           queued     = false;
+	Vfs::file_size out_count  = 0;
+	Result         out_result = Result::READ_OK;
+
+	monitor().monitor_from_pager([&] {
+		if (!queued) {
+			handle.seek(offset);
+			if (!handle.fs().queue_read(&handle, count))
+				return Fn::INCOMPLETE;
+			queued = true;
+		}
+
+		out_result = handle.fs().complete_read(&handle, dst, count, out_count);
+		return out_result != Result::READ_QUEUED ? Fn::COMPLETE : Fn::INCOMPLETE;
+	});
+
+	if (out_result != Result::READ_OK) {
+		error("mmap could not obtain file content at offset ", offset);
+		return 0;
+	}
+
+	return (size_t)out_count;
+}
+
+
+void Libc::Vfs_plugin::_touch_buffer(void const *buf, ::size_t count, bool write)
+{
+	if (!_private_mapping_pager.constructed())
+		return;
+
+	addr_t const buf_start = (addr_t)buf;
+	addr_t const buf_end   = buf_start + count;
+
+	_mmap_registry.for_each([&] (Mmap_entry &entry) {
+
+		if (!entry.private_mapping)
+			return;
+
+		addr_t const start = max(buf_start, (addr_t)entry.start);
+		addr_t const end   = min(buf_end, (addr_t)entry.start
+		                                  + entry.private_mapping->size());
+
+		for (addr_t addr = start; addr < end;
+		     addr = (addr & ~(addr_t)(PAGE_SIZE - 1)) + PAGE_SIZE) {
+
+			if (write)
+				touch_read_write((unsigned char *)addr);
+			else
+				touch_read((unsigned char const *)addr);
+		}
+	});
+}
+
+
+void *Libc::Vfs_plugin::_mmap_private_lazy(::size_t length, int prot,
+                                           File_descriptor *fd, ::off_t offset)
+{
+	bool const writeable = (prot & PROT_WRITE);
+
+	if (!fd->fd_path || (offset & (PAGE_SIZE - 1)))
+		return nullptr;
+
+	/*
+	 * File systems that hand out a copy of the file content would allocate
+	 * the whole file. Such files are read on demand instead.
+	 */
+	bool shared = false;
+	monitor().monitor([&] {
+		shared = _root_fs.dataspace_shared(fd->fd_path);
+		return Fn::COMPLETE;
+	});
+
+	/*
+	 * Except for read-only mappings of a shared dataspace, the mapping
+	 * depends on region-map faults, which are not supported on all kernels
+	 * (e.g., Linux).
+	 */
+	if (!_lazy_mmap_configured && (writeable || !shared))
+		return nullptr;
+
+	Vfs::Vfs_handle *reference_handle = _open_reference_handle(fd);
+	if (!reference_handle)
+		return nullptr;
+
+	Genode::Dataspace_capability ds_cap;
+	::size_t file_size = 0;
+
+	if (shared) {
+		monitor().monitor([&] {
+			ds_cap = _root_fs.dataspace(fd->fd_path);
+			return Fn::COMPLETE;
+		});
+
+		if (ds_cap.valid())
+			file_size = Genode::Dataspace_client(ds_cap).size();
+	} else {
+		Vfs::Directory_service::Stat stat { };
+		monitor().monitor([&] {
+			if (_root_fs.stat(fd->fd_path, stat) == Vfs::Directory_service::STAT_OK)
+				file_size = stat.size;
+			return Fn::COMPLETE;
+		});
+	}
+
+	if ((::size_t)offset >= file_size) {
+		_release_mapping(fd->fd_path, ds_cap, reference_handle);
+		return nullptr;
+	}
+
+	::size_t const avail = file_size - offset;
+
+	void            *addr            = nullptr;
+	Private_mapping *private_mapping = nullptr;
+	Mmap_reader     *reader          = nullptr;
+
+	try {
+		/* read-only mapping within the file, share the dataspace */
+		if (shared && !writeable && length <= avail)
+			addr = region_map().attach(ds_cap, length, offset, false,
+			                           (void *)0, false, false);
+
+		/* populate mapping on demand */
+		else if (_lazy_mmap_configured) {
+			if (!_private_mapping_pager.constructed())
+				_private_mapping_pager.construct(_env);
+
+			if (shared) {
+				private_mapping = new (_alloc)
+					Private_mapping(*_private_mapping_pager, _alloc, ds_cap,
+					                offset, avail, length, writeable);
+			} else {
+				reader = new (_alloc) Mmap_reader(*reference_handle);
+
+				private_mapping = new (_alloc)
+					Private_mapping(*_private_mapping_pager, _alloc, *reader,
+					                offset, avail, length, writeable);
+			}
+			addr = private_mapping->local_addr();
+		}
+	} catch (...) { }
+
+	if (!addr) {
+		if (reader)
+			destroy(_alloc, reader);
+		_release_mapping(fd->fd_path, ds_cap, reference_handle);
+		return nullptr;
+	}
+
+	new (_alloc) Mmap_entry(_mmap_registry, addr, reference_handle,
+	                        fd->fd_path, ds_cap, private_mapping, reader);
+	return addr;
+}
+
+
 void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags,
                              File_descriptor *fd, ::off_t offset)
 {
@@ -1913,11 +2117,11 @@ void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags
 
 	if (flags & MAP_PRIVATE) {
 
-		/*
-		 * XXX attempt to obtain memory mapping via
-		 *     'Vfs::Directory_service::dataspace'.
-		 */
+		addr = _mmap_private_lazy(length, prot, fd, offset);
+		if (addr)
+			return addr;
 
+		/* fall back to copying the file content */
 		addr = mem_alloc()->alloc(length, PAGE_SHIFT);
 		if (addr == (void *)-1) {
 			error("mmap out of memory");
@@ -1948,16 +2152,9 @@ void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags
 
 		/* create another VFS handle to keep the file open as long as the mapping exists */
 
-		Vfs::Vfs_handle *reference_handle = nullptr;
-		typedef Vfs::Directory_service::Open_result Result;
-		Result vfs_open_result;
-		monitor().monitor([&] {
-			vfs_open_result = _root_fs.open(fd->fd_path, fd->flags,
-			                                &reference_handle, _alloc);
-			return Fn::COMPLETE;
-		});
+		Vfs::Vfs_handle *reference_handle = _open_reference_handle(fd);
 
-		if (vfs_open_result != Result::OPEN_OK) {
+		if (!reference_handle) {
 			error("mmap could not create reference VFS handle");
 			errno = ENFILE;
 			return MAP_FAILED;
@@ -1972,10 +2169,7 @@ void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags
 
 		if (!ds_cap.valid()) {
 			Genode::error("mmap got invalid dataspace capability");
-			monitor().monitor([&] {
-				reference_handle->close();
-				return Fn::COMPLETE;
-			});
+			_release_mapping(fd->fd_path, ds_cap, reference_handle);
 			errno = ENODEV;
 			return MAP_FAILED;
 		}
@@ -1983,15 +2177,13 @@ void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags
 		try {
 			addr = region_map().attach(ds_cap, length, offset);
 		} catch (...) {
-			monitor().monitor([&] {
-				reference_handle->close();
-				return Fn::COMPLETE;
-			});
+			_release_mapping(fd->fd_path, ds_cap, reference_handle);
 			errno = ENOMEM;
 			return MAP_FAILED;
 		}
 
-		new (_alloc) Mmap_entry(_mmap_registry, addr, reference_handle);
+		new (_alloc) Mmap_entry(_mmap_registry, addr, reference_handle,
+		                        fd->fd_path, ds_cap);
 	}
 
 	return addr;
@@ -2006,26 +2198,32 @@ int Libc::Vfs_plugin::munmap(void *addr, ::size_t)
 		return 0;
 	}
 
-	/* shared mapping */
+	/* mapping of a file's dataspace */
 
-	Vfs::Vfs_handle *reference_handle = nullptr;
+	bool found = false;
 
 	_mmap_registry.for_each([&] (Mmap_entry &entry) {
 		if (entry.start == addr) {
-			reference_handle = entry.reference_handle;
+			found = true;
+
+			if (entry.private_mapping)
+				destroy(_alloc, entry.private_mapping);
+			else
+				region_map().detach(addr);
+
+			if (entry.reader)
+				destroy(_alloc, entry.reader);
+
+			_release_mapping(entry.path.string(), entry.ds,
+			                 entry.reference_handle);
+
 			destroy(_alloc, &entry);
-			region_map().detach(addr);
 		}
 	});
 
-	if (!reference_handle)
+	if (!found)
 		return Errno(EINVAL);
 
-	monitor().monitor([&] {
-		reference_handle->close();
-		return Fn::COMPLETE;
-	});
-
 	return 0;
 }
 
@@ -2089,10 +2287,93 @@ int Libc::Vfs_plugin::pipe(Libc::File_descriptor *pipefdo[2])
 }
 
 
+/*
+ * This function must be called in entrypoint context only.
+ */
 bool Libc::Vfs_plugin::poll(File_descriptor &fd, struct pollfd &pfd)
 {
-	error("Plugin::poll() is deprecated");
-	return false;
+	enum {
+		POLLIN_MASK  = POLLIN  | POLLRDNORM | POLLRDBAND | POLLPRI,
+		POLLOUT_MASK = POLLOUT | POLLWRNORM | POLLWRBAND,
+	};
+
+	Vfs::Vfs_handle *handle = vfs_handle(&fd);
+	if (!handle) {
+		pfd.revents |= POLLNVAL;
+		return true;
+	}
+
+	bool res = false;
+
+	if (pfd.events & POLLIN_MASK) {
+		if (handle->fs().read_ready(handle)) {
+			pfd.revents |= pfd.events & POLLIN_MASK;
+			res = true;
+		} else {
+			handle->fs().notify_read_ready(handle);
+		}
+	}
+
+	if (pfd.events & POLLOUT_MASK) {
+		if (handle->fs().write_ready(handle)) {
+			pfd.revents |= pfd.events & POLLOUT_MASK;
+			res = true;
+		} else {
+			handle->fs().notify_write_ready(handle);
+		}
+	}
+
+	return res;
+}
+
+
+bool Libc::Vfs_plugin::watch(File_descriptor *fd, Vfs::Handle_observer &observer)
+{
+	Vfs::Vfs_handle *handle = vfs_handle(fd);
+	if (!handle)
+		return false;
+
+	/* each handle has a single observer */
+	if (handle->observer() && handle->observer() != &observer)
+		return false;
+
+	handle->observer(&observer);
+
+	handle->fs().notify_read_ready(handle);
+	handle->fs().notify_write_ready(handle);
+	return true;
+}
+
+
+void Libc::Vfs_plugin::unwatch(File_descriptor *fd, Vfs::Handle_observer &observer)
+{
+	Vfs::Vfs_handle *handle = vfs_handle(fd);
+
+	if (handle && handle->observer() == &observer)
+		handle->observer(nullptr);
+}
+
+
+::size_t Libc::Vfs_plugin::available(File_descriptor *fd, bool write)
+{
+	Vfs::Vfs_handle *handle = vfs_handle(fd);
+	if (!handle)
+		return 0;
+
+	Vfs::file_size const count = write ? handle->fs().write_available(handle)
+	                                   : handle->fs().read_available(handle);
+	if (count || write)
+		return (::size_t)count;
+
+	/* for files without stream semantics, report the remainder of the file */
+	typedef Vfs::Directory_service::Stat_result Result;
+
+	Vfs::Directory_service::Stat stat { };
+
+	if (!fd->fd_path || _root_fs.stat(fd->fd_path, stat) != Result::STAT_OK)
+		return 0;
+
+	return stat.size > handle->seek() ? (::size_t)(stat.size - handle->seek()) : 0;
 }
 
 
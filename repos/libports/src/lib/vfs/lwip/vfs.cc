@@ -17,6 +17,7 @@
 #include <vfs/file_system_factory.h>
 #include <vfs/vfs_handle.h>
 #include <vfs/print.h>
+#include <vfs/socket_datagram.h>
 #include <timer_session/connection.h>
 #include <util/fifo.h>
 #include <base/tslab.h>
@@ -276,6 +277,7 @@ struct Lwip::Lwip_file_handle final : Lwip_handle, private Lwip_handle_list::Ele
 		REMOTE   = 1 << 7,
 		LOCATION = 1 << 8,
 		PENDING  = 1 << 9,
+		DATAGRAM = 1 << 10,
 	};
 
 	enum { DATA_READY = DATA | PEEK };
@@ -297,6 +299,7 @@ struct Lwip::Lwip_file_handle final : Lwip_handle, private Lwip_handle_list::Ele
 		if (p == "/local")    return LOCAL;
 		if (p == "/peek")     return PEEK;
 		if (p == "/remote")   return REMOTE;
+		if (p == "/datagram") return DATAGRAM;
 		return INVALID;
 	}
 
@@ -325,6 +328,7 @@ struct Lwip::Lwip_file_handle final : Lwip_handle, private Lwip_handle_list::Ele
 	                   file_size &out_count) override;
 
 	bool notify_read_ready();
+	bool notify_write_ready();
 };
 
 
@@ -428,6 +432,11 @@ struct Lwip::Socket_dir : Lwip::Directory
 
 		virtual bool read_ready(Lwip_file_handle&) = 0;
 
+		virtual bool write_ready(Lwip_file_handle&) { return true; }
+
+		virtual file_size read_available(Lwip_file_handle&)  { return 0; }
+		virtual file_size write_available(Lwip_file_handle&) { return 0; }
+
 		/**
 		 * Notify handles waiting for this PCB / socket to be ready
 		 */
@@ -506,6 +515,17 @@ bool Lwip::Lwip_file_handle::notify_read_ready()
 	return false;
 }
 
+bool Lwip::Lwip_file_handle::notify_write_ready()
+{
+	if (socket) {
+		if (!_io_progress_waiter.enqueued())
+			socket->io_progress_queue.enqueue(_io_progress_waiter);
+		return true;
+	}
+
+	return false;
+}
+
 void Lwip::Lwip_file_handle::print(Genode::Output &output) const
 {
 	output.out_string(socket->name().string());
@@ -522,6 +542,7 @@ void Lwip::Lwip_file_handle::print(Genode::Output &output) const
 	case Lwip_file_handle::PENDING:  output.out_string("/accept_socket"); break;
 	case Lwip_file_handle::PEEK:     output.out_string("/peek"); break;
 	case Lwip_file_handle::REMOTE:   output.out_string("/remote"); break;
+	case Lwip_file_handle::DATAGRAM: output.out_string("/datagram"); break;
 }
 }
 
@@ -817,6 +838,8 @@ class Lwip::Udp_socket_dir final :
 				}
 
 				bool empty() { return offset >= buf->tot_len; }
+
+				u16_t size() const { return buf->tot_len; }
 		};
 
 		Genode::Tslab<Packet, sizeof(Packet)*64> _packet_slab { &alloc };
@@ -895,6 +918,7 @@ class Lwip::Udp_socket_dir final :
 			case Lwip_file_handle::DATA:
 			case Lwip_file_handle::REMOTE:
 			case Lwip_file_handle::PEEK:
+			case Lwip_file_handle::DATAGRAM:
 				return !_packet_queue.empty();
 			default:
 				break;
@@ -931,6 +955,36 @@ class Lwip::Udp_socket_dir final :
 				});
 				break;
 
+			case Lwip_file_handle::DATAGRAM: {
+				if (count < sizeof(Socket_datagram))
+					return Read_result::READ_ERR_INVALID;
+
+				result = Read_result::READ_QUEUED;
+				_packet_queue.head([&] (Packet &pkt) {
+
+					/* the remainder of a truncated datagram is discarded */
+					u16_t const length = pkt.read(dst + sizeof(Socket_datagram),
+					                              count - sizeof(Socket_datagram));
+
+					/* TODO: IPv6 */
+					u32_t const addr = IP_IS_V4_VAL(pkt.addr)
+					                 ? ip4_addr_get_u32(ip_2_ip4(&pkt.addr)) : 0;
+
+					Socket_datagram header { };
+					memcpy(header.addr, &addr, sizeof(header.addr));
+					header.port   = lwip_htons(pkt.port);
+					header.length = pkt.size();
+					header.write_to(dst);
+
+					_packet_queue.remove(pkt);
+					destroy(_packet_slab, &pkt);
+
+					out_count = sizeof(Socket_datagram) + length;
+					result = Read_result::READ_OK;
+				});
+				break;
+			}
+
 			case Lwip_file_handle::LOCAL:
 			case Lwip_file_handle::BIND: {
 				if (count < ENDPOINT_STRLEN_MAX)
@@ -1015,6 +1069,36 @@ class Lwip::Udp_socket_dir final :
 				return Write_result::WRITE_OK;
 			}
 
+			case Lwip_file_handle::DATAGRAM: {
+				err_t err = ERR_OK;
+				out_count = Socket_datagram::for_each_record(src, count,
+					[&] (Socket_datagram const &header, char const *payload) {
+
+						pbuf *buf = pbuf_alloc(PBUF_TRANSPORT, header.length, PBUF_RAM);
+						if (!buf) {
+							err = ERR_MEM;
+							return false;
+						}
+						pbuf_take(buf, payload, header.length);
+
+						u32_t addr = 0;
+						memcpy(&addr, header.addr, sizeof(addr));
+
+						ip_addr_t to_addr { };
+						ip_addr_set_ip4_u32(&to_addr, addr);
+
+						err = udp_sendto(_pcb, buf, &to_addr, lwip_ntohs(header.port));
+						pbuf_free(buf);
+						return err == ERR_OK;
+					});
+
+				/* report error only if no datagram was sent at all */
+				if (err != ERR_OK && out_count == 0)
+					return Write_result::WRITE_ERR_IO;
+
+				return Write_result::WRITE_OK;
+			}
+
 			case Lwip_file_handle::REMOTE: {
 				if (!ip_addr_isany(&_pcb->remote_ip)) {
 					return Write_result::WRITE_ERR_INVALID;
@@ -1298,6 +1382,40 @@ class Lwip::Tcp_socket_dir final :
 			return false;
 		}
 
+		bool write_ready(Lwip_file_handle &handle) override
+		{
+			if (handle.kind != Lwip_file_handle::DATA)
+				return true;
+
+			Genode::Mutex::Guard guard { Lwip::mutex() };
+
+			/* a closed socket lets the application find out via 'write' */
+			if (_pcb == NULL || state != READY)
+				return state != CONNECT;
+
+			return tcp_sndbuf(_pcb) > 0;
+		}
+
+		file_size read_available(Lwip_file_handle &handle) override
+		{
+			if (handle.kind != Lwip_file_handle::DATA)
+				return 0;
+
+			Genode::Mutex::Guard guard { Lwip::mutex() };
+
+			return _recv_pbuf ? _recv_pbuf->tot_len - _recv_off : 0;
+		}
+
+		file_size write_available(Lwip_file_handle &handle) override
+		{
+			if (handle.kind != Lwip_file_handle::DATA)
+				return 0;
+
+			Genode::Mutex::Guard guard { Lwip::mutex() };
+
+			return (_pcb && state == READY) ? tcp_sndbuf(_pcb) : 0;
+		}
+
 		Read_result read(Lwip_file_handle &handle,
 		                 char *dst, file_size count,
 		                 file_size &out_count) override
@@ -2066,6 +2184,38 @@ class Lwip::File_system final : public Vfs::File_system, public Lwip::Directory
 			return false;
 		}
 
+		bool write_ready(Vfs_handle *vfs_handle) override
+		{
+			if (Lwip_file_handle *handle = dynamic_cast<Lwip_file_handle*>(vfs_handle)) {
+				if (handle->socket)
+					return handle->socket->write_ready(*handle);
+			}
+			return true;
+		}
+
+		bool notify_write_ready(Vfs_handle *vfs_handle) override
+		{
+			if (Lwip_file_handle *handle = dynamic_cast<Lwip_file_handle*>(vfs_handle))
+				return handle->notify_write_ready();
+			return false;
+		}
+
+		file_size read_available(Vfs_handle *vfs_handle) override
+		{
+			if (Lwip_file_handle *handle = dynamic_cast<Lwip_file_handle*>(vfs_handle))
+				if (handle->socket)
+					return handle->socket->read_available(*handle);
+			return 0;
+		}
+
+		file_size write_available(Vfs_handle *vfs_handle) override
+		{
+			if (Lwip_file_handle *handle = dynamic_cast<Lwip_file_handle*>(vfs_handle))
+				if (handle->socket)
+					return handle->socket->write_available(*handle);
+			return 0;
+		}
+
 		bool check_unblock(Vfs_handle*, bool, bool, bool) override
 		{
 			Genode::error("VFS lwIP: ",__func__," not implemented");
@@ -0,0 +1,150 @@
+/*
+ * \brief  Bounded LRU cache of decompressed archive extents
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _ZTAR__CHUNK_CACHE_H_
+#define _ZTAR__CHUNK_CACHE_H_
+
+/* Genode includes */
+#include <util/construct_at.h>
+
+/* local includes */
+#include <decoder.h>
+
+namespace Ztar { class Chunk_cache; }
+
+
+class Ztar::Chunk_cache
+{
+	public:
+
+		enum { CHUNK_SIZE = 64*1024 };
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Chunk_cache(Chunk_cache const &);
+		Chunk_cache &operator = (Chunk_cache const &);
+
+		struct Entry
+		{
+			bool          valid     = false;
+			file_size     index     = 0;
+			unsigned long last_used = 0;
+			size_t        length    = 0;
+			char         *data      = nullptr;
+		};
+
+		Genode::Allocator &_alloc;
+		Decoder           &_decoder;
+
+		unsigned const _num_entries;
+		Entry  * const _entries;
+
+		unsigned long _use_counter = 0;
+
+		/* size of the uncompressed stream, unknown until the scan is done */
+		file_size _stream_size = ~(file_size)0;
+
+		size_t _expected_length(file_size index) const
+		{
+			file_size const start = index*CHUNK_SIZE;
+			if (start >= _stream_size)
+				return 0;
+
+			return (size_t)Genode::min((file_size)CHUNK_SIZE, _stream_size - start);
+		}
+
+		Entry &_lookup(file_size index)
+		{
+			Entry *victim = &_entries[0];
+
+			for (unsigned i = 0; i < _num_entries; i++) {
+				Entry &e = _entries[i];
+
+				if (e.valid && e.index == index) {
+					e.last_used = ++_use_counter;
+					return e;
+				}
+
+				if (!e.valid || (victim->valid && e.last_used < victim->last_used))
+					victim = &e;
+			}
+
+			/* cache miss, refill least-recently used entry */
+			Entry &e = *victim;
+			e.index     = index;
+			e.last_used = ++_use_counter;
+			e.length    = _decoder.read(index*CHUNK_SIZE, e.data, CHUNK_SIZE);
+
+			/* a chunk cut short by a decoding error is decoded again next time */
+			e.valid = (e.length >= _expected_length(index));
+
+			return e;
+		}
+
+	public:
+
+		Chunk_cache(Genode::Allocator &alloc, Decoder &decoder, size_t cache_size)
+		:
+			_alloc(alloc), _decoder(decoder),
+			_num_entries((unsigned)Genode::max(cache_size/CHUNK_SIZE, (size_t)1)),
+			_entries((Entry *)alloc.alloc(sizeof(Entry)*_num_entries))
+		{
+			for (unsigned i = 0; i < _num_entries; i++) {
+				Genode::construct_at<Entry>(&_entries[i]);
+				_entries[i].data = (char *)_alloc.alloc(CHUNK_SIZE);
+			}
+		}
+
+		~Chunk_cache()
+		{
+			for (unsigned i = 0; i < _num_entries; i++)
+				_alloc.free(_entries[i].data, CHUNK_SIZE);
+
+			_alloc.free(_entries, sizeof(Entry)*_num_entries);
+		}
+
+		/**
+		 * Define size of the uncompressed stream as determined by the scan
+		 */
+		void stream_size(file_size size) { _stream_size = size; }
+
+		/**
+		 * Copy 'len' bytes of the uncompressed stream at 'offset' to 'dst'
+		 *
+		 * \return number of bytes copied
+		 */
+		size_t read(file_size offset, char *dst, size_t len)
+		{
+			size_t done = 0;
+
+			while (done < len) {
+
+				file_size const pos  = offset + done;
+				Entry     const &e   = _lookup(pos / CHUNK_SIZE);
+				size_t    const skip = pos % CHUNK_SIZE;
+
+				if (e.length <= skip)
+					break;
+
+				size_t const n = Genode::min(len - done, e.length - skip);
+				Genode::memcpy(dst + done, e.data + skip, n);
+				done += n;
+			}
+			return done;
+		}
+};
+
+#endif /* _ZTAR__CHUNK_CACHE_H_ */
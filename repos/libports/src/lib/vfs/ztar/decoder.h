@@ -0,0 +1,650 @@
+/*
+ * \brief  Seekable decoders for compressed tar archives
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * Both decoders operate on the compressed archive as present in the ROM
+ * dataspace. While building the tar index, the archive is decompressed
+ * once as a whole ('scan'). Afterwards, arbitrary extents of the
+ * uncompressed stream can be obtained via 'read', which resumes decoding
+ * at the closest seek point instead of at the beginning of the archive.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _ZTAR__DECODER_H_
+#define _ZTAR__DECODER_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <base/log.h>
+#include <vfs/types.h>
+
+/* compression libraries */
+#include <zlib.h>
+#include <lzma.h>
+
+namespace Ztar {
+
+	using namespace Vfs;
+	using Genode::size_t;
+	using Genode::uint8_t;
+
+	struct Scan_sink;
+	struct Decoder;
+	class  Gzip_decoder;
+	class  Xz_decoder;
+
+	struct Decoder_failed { };
+}
+
+
+/**
+ * Consumer of the uncompressed byte stream during the initial scan
+ */
+struct Ztar::Scan_sink : Genode::Interface
+{
+	virtual void consume(char const *src, size_t len) = 0;
+};
+
+
+struct Ztar::Decoder : Genode::Interface
+{
+	/**
+	 * Decompress the whole archive once, feeding the output into 'sink'
+	 *
+	 * \throw Decoder_failed
+	 */
+	virtual void scan(Scan_sink &sink) = 0;
+
+	/**
+	 * Read 'len' bytes of uncompressed data starting at 'offset'
+	 *
+	 * \return number of bytes read, which is smaller than 'len' only
+	 *         at the end of the stream or on a decoding error
+	 */
+	virtual size_t read(file_size offset, char *dst, size_t len) = 0;
+};
+
+
+/**
+ * Gzip decoder with periodic seek points
+ *
+ * Deflate streams cannot be entered at arbitrary positions. During 'scan',
+ * the decoder therefore records the inflate state at deflate-block
+ * boundaries roughly every 'span' bytes of output, consisting of the bit
+ * offset within the compressed input and the preceding 32 KiB of output
+ * (the dictionary window). A later 'read' primes a raw inflate stream
+ * with the closest such point.
+ */
+class Ztar::Gzip_decoder : public Decoder
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Gzip_decoder(Gzip_decoder const &);
+		Gzip_decoder &operator = (Gzip_decoder const &);
+
+		enum { WINDOW_SIZE = 32*1024, SKIP_CHUNK = 16*1024 };
+
+		struct Seek_point
+		{
+			file_size out;     /* offset in uncompressed stream */
+			file_size in;      /* offset in compressed stream */
+			int       bits;    /* unused bits in preceding input byte */
+			uint8_t   window[WINDOW_SIZE];
+		};
+
+		Genode::Allocator &_alloc;
+
+		uint8_t const * const _base;
+		file_size       const _size;
+		file_size       const _span;
+
+		Seek_point **_points         = nullptr;
+		unsigned     _points_used    = 0;
+		unsigned     _points_capacity = 0;
+
+		/*
+		 * Inflate state kept across 'read' calls such that sequential
+		 * accesses continue decoding instead of restarting at a seek point
+		 */
+		z_stream  _cursor { };
+		bool      _cursor_valid = false;
+		file_size _cursor_out   = 0;
+
+		static void *_zalloc(void *opaque, uInt items, uInt size)
+		{
+			Genode::Allocator &alloc = *(Genode::Allocator *)opaque;
+
+			/* keep size in front of the block to support 'free' */
+			size_t const bytes = (size_t)items*size + sizeof(size_t);
+			void *ptr = nullptr;
+			if (!alloc.alloc(bytes, &ptr))
+				return Z_NULL;
+
+			*(size_t *)ptr = bytes;
+			return (size_t *)ptr + 1;
+		}
+
+		static void _zfree(void *opaque, void *ptr)
+		{
+			Genode::Allocator &alloc = *(Genode::Allocator *)opaque;
+
+			size_t *block = (size_t *)ptr - 1;
+			alloc.free(block, *block);
+		}
+
+		void _init_stream(z_stream &strm)
+		{
+			strm = z_stream { };
+			strm.zalloc = _zalloc;
+			strm.zfree  = _zfree;
+			strm.opaque = &_alloc;
+		}
+
+		void _add_point(int bits, file_size in, file_size out,
+		                unsigned left, uint8_t const *window)
+		{
+			if (_points_used == _points_capacity) {
+				unsigned const new_capacity = _points_capacity ? 2*_points_capacity : 16;
+
+				Seek_point **new_points = (Seek_point **)
+					_alloc.alloc(sizeof(Seek_point *)*new_capacity);
+
+				for (unsigned i = 0; i < _points_used; i++)
+					new_points[i] = _points[i];
+
+				if (_points)
+					_alloc.free(_points, sizeof(Seek_point *)*_points_capacity);
+
+				_points          = new_points;
+				_points_capacity = new_capacity;
+			}
+
+			Seek_point &p = *(Seek_point *)_alloc.alloc(sizeof(Seek_point));
+			p.out  = out;
+			p.in   = in;
+			p.bits = bits;
+
+			/* linearize circular output window */
+			if (left)
+				Genode::memcpy(p.window, window + WINDOW_SIZE - left, left);
+			if (left < WINDOW_SIZE)
+				Genode::memcpy(p.window + left, window, WINDOW_SIZE - left);
+
+			_points[_points_used++] = &p;
+		}
+
+		void _release_cursor()
+		{
+			if (_cursor_valid)
+				inflateEnd(&_cursor);
+
+			_cursor_valid = false;
+		}
+
+		/**
+		 * Position cursor at the seek point preceding 'offset'
+		 */
+		bool _seek(file_size offset)
+		{
+			if (!_points_used)
+				return false;
+
+			unsigned index = 0;
+			while (index + 1 < _points_used && _points[index + 1]->out <= offset)
+				index++;
+
+			/* reuse cursor if it lies between the seek point and 'offset' */
+			if (_cursor_valid && _points[index]->out <= _cursor_out
+			                  && _cursor_out <= offset)
+				return true;
+
+			_release_cursor();
+
+			Seek_point const &p = *_points[index];
+
+			_init_stream(_cursor);
+			if (inflateInit2(&_cursor, -15) != Z_OK)
+				return false;
+
+			_cursor.next_in  = (Bytef *)(_base + p.in);
+			_cursor.avail_in = (uInt)(_size - p.in);
+
+			/* feed remaining bits of the partially consumed input byte */
+			if (p.bits)
+				inflatePrime(&_cursor, p.bits, _base[p.in - 1] >> (8 - p.bits));
+
+			inflateSetDictionary(&_cursor, p.window, WINDOW_SIZE);
+
+			_cursor_valid = true;
+			_cursor_out   = p.out;
+			return true;
+		}
+
+		/**
+		 * Inflate up to 'len' bytes at the cursor position into 'dst'
+		 */
+		size_t _inflate(uint8_t *dst, size_t len)
+		{
+			_cursor.next_out  = dst;
+			_cursor.avail_out = (uInt)len;
+
+			int const ret = inflate(&_cursor, Z_NO_FLUSH);
+
+			size_t const produced = len - _cursor.avail_out;
+			_cursor_out += produced;
+
+			if (ret == Z_STREAM_END)
+				_release_cursor();
+
+			else if (ret != Z_OK && (ret != Z_BUF_ERROR || !produced)) {
+				Genode::error("inflate failed (", ret, ")");
+				_release_cursor();
+			}
+			return produced;
+		}
+
+	public:
+
+		Gzip_decoder(Genode::Allocator &alloc, void const *base,
+		             file_size size, file_size span)
+		:
+			_alloc(alloc), _base((uint8_t const *)base), _size(size),
+			_span(span)
+		{ }
+
+		~Gzip_decoder()
+		{
+			_release_cursor();
+
+			for (unsigned i = 0; i < _points_used; i++)
+				_alloc.free(_points[i], sizeof(Seek_point));
+
+			if (_points)
+				_alloc.free(_points, sizeof(Seek_point *)*_points_capacity);
+		}
+
+		static bool probe(void const *base, file_size size)
+		{
+			uint8_t const *magic = (uint8_t const *)base;
+			return size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+		}
+
+		void scan(Scan_sink &sink) override
+		{
+			z_stream strm { };
+			_init_stream(strm);
+
+			/* automatic gzip header detection */
+			if (inflateInit2(&strm, 47) != Z_OK)
+				throw Decoder_failed();
+
+			uint8_t *window = (uint8_t *)_alloc.alloc(WINDOW_SIZE);
+
+			strm.next_in  = (Bytef *)_base;
+			strm.avail_in = (uInt)_size;
+
+			file_size total_out = 0, last = 0;
+			int ret = Z_OK;
+
+			strm.avail_out = 0;
+
+			while (ret != Z_STREAM_END) {
+
+				if (strm.avail_out == 0) {
+					strm.avail_out = WINDOW_SIZE;
+					strm.next_out  = window;
+				}
+
+				uInt const avail_out = strm.avail_out;
+				uint8_t const *start = strm.next_out;
+
+				ret = inflate(&strm, Z_BLOCK);
+
+				size_t const produced = avail_out - strm.avail_out;
+				if (produced)
+					sink.consume((char const *)start, produced);
+
+				total_out += produced;
+
+				if (ret != Z_OK && ret != Z_STREAM_END)
+					break;
+
+				/* at end of a deflate block that is not the last one */
+				bool const block_end  = (strm.data_type & 128);
+				bool const last_block = (strm.data_type & 64);
+
+				if (block_end && !last_block
+				 && (total_out == 0 || total_out - last > _span)) {
+					_add_point(strm.data_type & 7,
+					           strm.next_in - (Bytef const *)_base,
+					           total_out, strm.avail_out, window);
+					last = total_out;
+				}
+			}
+
+			inflateEnd(&strm);
+			_alloc.free(window, WINDOW_SIZE);
+
+			if (ret != Z_STREAM_END) {
+				Genode::error("gzip stream is corrupt (", ret, ")");
+				throw Decoder_failed();
+			}
+		}
+
+		size_t read(file_size offset, char *dst, size_t len) override
+		{
+			if (!_seek(offset))
+				return 0;
+
+			/* skip output between cursor and 'offset' */
+			uint8_t skip_buf[SKIP_CHUNK];
+			while (_cursor_valid && _cursor_out < offset) {
+				size_t const n = Genode::min((file_size)SKIP_CHUNK,
+				                             offset - _cursor_out);
+				if (!_inflate(skip_buf, n) && !_cursor_valid)
+					return 0;
+			}
+
+			size_t done = 0;
+			while (_cursor_valid && done < len) {
+				size_t const n = _inflate((uint8_t *)dst + done, len - done);
+				if (!n)
+					break;
+				done += n;
+			}
+			return done;
+		}
+};
+
+
+/**
+ * Xz decoder using the block index of the xz container
+ *
+ * Xz streams consist of independently decodable blocks, which are listed
+ * in the index at the end of the stream. Random access decodes only the
+ * block containing the requested offset. Note that archives compressed
+ * with a single block (default of single-threaded 'xz') still work but
+ * degrade to decoding from the start. Use 'xz --block-size' or 'xz -T0'
+ * for seekable archives.
+ */
+class Ztar::Xz_decoder : public Decoder
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Xz_decoder(Xz_decoder const &);
+		Xz_decoder &operator = (Xz_decoder const &);
+
+		enum { SKIP_CHUNK = 16*1024, DECODE_CHUNK = 64*1024 };
+
+		Genode::Allocator &_alloc;
+
+		uint8_t const * const _base;
+		file_size       const _size;
+
+		lzma_allocator _lzma_alloc { _lzma_malloc, _lzma_free, &_alloc };
+
+		lzma_index *_index = nullptr;
+
+		lzma_stream_flags _footer_flags { };
+
+		/*
+		 * Decoder state of the block currently being decoded, kept across
+		 * 'read' calls to support sequential accesses within a block
+		 */
+		lzma_stream _cursor       = LZMA_STREAM_INIT;
+		bool        _cursor_valid = false;
+		file_size   _cursor_out   = 0;
+		file_size   _block_end    = 0;
+
+		static void *_lzma_malloc(void *opaque, size_t nmemb, size_t size)
+		{
+			Genode::Allocator &alloc = *(Genode::Allocator *)opaque;
+
+			size_t const bytes = nmemb*size + sizeof(size_t);
+			void *ptr = nullptr;
+			if (!alloc.alloc(bytes, &ptr))
+				return nullptr;
+
+			*(size_t *)ptr = bytes;
+			return (size_t *)ptr + 1;
+		}
+
+		static void _lzma_free(void *opaque, void *ptr)
+		{
+			if (!ptr)
+				return;
+
+			Genode::Allocator &alloc = *(Genode::Allocator *)opaque;
+
+			size_t *block = (size_t *)ptr - 1;
+			alloc.free(block, *block);
+		}
+
+		void _release_cursor()
+		{
+			if (_cursor_valid)
+				lzma_end(&_cursor);
+
+			_cursor_valid = false;
+		}
+
+		void _decode_index()
+		{
+			/* skip stream padding */
+			file_size end = _size;
+			while (end >= 4 && !_base[end - 1] && !_base[end - 2]
+			                && !_base[end - 3] && !_base[end - 4])
+				end -= 4;
+
+			if (end < 2*LZMA_STREAM_HEADER_SIZE) {
+				Genode::error("xz stream is truncated");
+				throw Decoder_failed();
+			}
+
+			uint8_t const *footer = _base + end - LZMA_STREAM_HEADER_SIZE;
+			if (lzma_stream_footer_decode(&_footer_flags, footer) != LZMA_OK) {
+				Genode::error("invalid xz stream footer");
+				throw Decoder_failed();
+			}
+
+			file_size const index_size = _footer_flags.backward_size;
+			if (index_size > end - 2*LZMA_STREAM_HEADER_SIZE) {
+				Genode::error("invalid xz index size");
+				throw Decoder_failed();
+			}
+
+			uint64_t memlimit = UINT64_MAX;
+			size_t   in_pos   = 0;
+			lzma_ret const ret =
+				lzma_index_buffer_decode(&_index, &memlimit, &_lzma_alloc,
+				                         footer - index_size, &in_pos,
+				                         index_size);
+			if (ret != LZMA_OK) {
+				Genode::error("failed to decode xz index (", (int)ret, ")");
+				throw Decoder_failed();
+			}
+
+			lzma_index_stream_flags(_index, &_footer_flags);
+
+			/* concatenated streams are not supported */
+			file_size const stream_size = lzma_index_total_size(_index)
+			                            + index_size + 2*LZMA_STREAM_HEADER_SIZE;
+			if (stream_size != end)
+				Genode::warning("ignoring data beyond first xz stream");
+		}
+
+		/**
+		 * Start decoding the block that contains 'offset'
+		 */
+		bool _enter_block(file_size offset)
+		{
+			_release_cursor();
+
+			lzma_index_iter iter;
+			lzma_index_iter_init(&iter, _index);
+			if (lzma_index_iter_locate(&iter, offset))
+				return false;
+
+			uint8_t const *header = _base + iter.block.compressed_file_offset;
+
+			lzma_filter filters[LZMA_FILTERS_MAX + 1];
+			lzma_block block { };
+			block.version     = 0;
+			block.check       = iter.stream.flags->check;
+			block.filters     = filters;
+			block.header_size = lzma_block_header_size_decode(header[0]);
+
+			if (lzma_block_header_decode(&block, &_lzma_alloc, header) != LZMA_OK) {
+				Genode::error("invalid xz block header");
+				return false;
+			}
+
+			_cursor = LZMA_STREAM_INIT;
+			_cursor.allocator = &_lzma_alloc;
+			lzma_ret const ret = lzma_block_decoder(&_cursor, &block);
+
+			/* filter options are copied by the block decoder */
+			for (unsigned i = 0; filters[i].id != LZMA_VLI_UNKNOWN; i++)
+				_lzma_free(&_alloc, filters[i].options);
+
+			if (ret != LZMA_OK) {
+				Genode::error("failed to initialize xz block decoder");
+				return false;
+			}
+
+			_cursor.next_in  = header + block.header_size;
+			_cursor.avail_in = iter.block.total_size - block.header_size;
+
+			_cursor_valid = true;
+			_cursor_out   = iter.block.uncompressed_file_offset;
+			_block_end    = _cursor_out + iter.block.uncompressed_size;
+			return true;
+		}
+
+		/**
+		 * Decode up to 'len' bytes at the cursor position into 'dst'
+		 */
+		size_t _decode(uint8_t *dst, size_t len)
+		{
+			_cursor.next_out  = dst;
+			_cursor.avail_out = len;
+
+			lzma_ret const ret = lzma_code(&_cursor, LZMA_RUN);
+
+			size_t const produced = len - _cursor.avail_out;
+			_cursor_out += produced;
+
+			if (ret == LZMA_STREAM_END)
+				_release_cursor();
+
+			else if (ret != LZMA_OK) {
+				Genode::error("xz block decoding failed (", (int)ret, ")");
+				_release_cursor();
+			}
+			return produced;
+		}
+
+	public:
+
+		Xz_decoder(Genode::Allocator &alloc, void const *base, file_size size)
+		:
+			_alloc(alloc), _base((uint8_t const *)base), _size(size)
+		{
+			_decode_index();
+		}
+
+		~Xz_decoder()
+		{
+			_release_cursor();
+			lzma_index_end(_index, &_lzma_alloc);
+		}
+
+		static bool probe(void const *base, file_size size)
+		{
+			static uint8_t const magic[] = { 0xfd, '7', 'z', 'X', 'Z', 0 };
+
+			return size >= sizeof(magic)
+			    && Genode::memcmp(base, magic, sizeof(magic)) == 0;
+		}
+
+		void scan(Scan_sink &sink) override
+		{
+			uint8_t *buf = (uint8_t *)_alloc.alloc(DECODE_CHUNK);
+
+			file_size const total = lzma_index_uncompressed_size(_index);
+			file_size offset = 0;
+
+			while (offset < total) {
+
+				if (!_cursor_valid || _cursor_out != offset)
+					if (!_enter_block(offset))
+						break;
+
+				size_t const n = _decode(buf, DECODE_CHUNK);
+				if (!n && !_cursor_valid && _cursor_out != _block_end)
+					break;
+
+				sink.consume((char const *)buf, n);
+				offset += n;
+			}
+
+			_release_cursor();
+			_alloc.free(buf, DECODE_CHUNK);
+
+			if (offset != total) {
+				Genode::error("xz stream is corrupt");
+				throw Decoder_failed();
+			}
+		}
+
+		size_t read(file_size offset, char *dst, size_t len) override
+		{
+			size_t done = 0;
+
+			while (done < len) {
+
+				file_size const pos = offset + done;
+
+				bool const cursor_usable = _cursor_valid
+				                        && _cursor_out <= pos
+				                        && pos < _block_end;
+
+				if (!cursor_usable && !_enter_block(pos))
+					break;
+
+				/* skip output between block start and 'pos' */
+				uint8_t skip_buf[SKIP_CHUNK];
+				while (_cursor_valid && _cursor_out < pos) {
+					size_t const n = Genode::min((file_size)SKIP_CHUNK,
+					                             pos - _cursor_out);
+					if (!_decode(skip_buf, n) && !_cursor_valid)
+						return done;
+				}
+
+				if (!_cursor_valid)
+					break;
+
+				size_t const n = _decode((uint8_t *)dst + done, len - done);
+				if (!n)
+					break;
+
+				done += n;
+			}
+			return done;
+		}
+};
+
+#endif /* _ZTAR__DECODER_H_ */
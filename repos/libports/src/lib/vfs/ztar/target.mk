@@ -0,0 +1,2 @@
+TARGET = dummy-vfs_ztar
+LIBS = vfs_ztar
@@ -0,0 +1,711 @@
+/*
+ * \brief  VFS plugin for compressed tar archives
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * In contrast to the built-in 'tar' file system, the archive is not
+ * required to be present uncompressed in memory. The plugin decompresses
+ * the archive once to build the directory index and a seek index of the
+ * compressed stream. File content is decompressed on demand into a
+ * bounded LRU cache of fixed-size extents.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_rom_dataspace.h>
+#include <util/reconstructible.h>
+#include <vfs/file_system_factory.h>
+#include <vfs/vfs_handle.h>
+
+/* local includes */
+#include <decoder.h>
+#include <chunk_cache.h>
+
+namespace Ztar {
+
+	struct Node;
+	class  Index_builder;
+	class  File_system;
+
+	using Genode::Allocator;
+}
+
+
+struct Ztar::Node : List<Node>, List<Node>::Element
+{
+	/*
+	 * Noncopyable
+	 */
+	Node(Node const &);
+	Node &operator = (Node const &);
+
+	enum Type { FILE, HARDLINK, SYMLINK, DIRECTORY };
+
+	Allocator &alloc;
+
+	char const *name;
+
+	bool        has_record  = false;
+	Type        type        = DIRECTORY;
+	file_size   size        = 0;
+	file_size   data_offset = 0;   /* offset in uncompressed stream */
+	long long   mtime       = 0;
+	unsigned    mode        = 0;
+	char const *linked_name = nullptr;
+
+	static char const *_copy(Allocator &alloc, char const *s)
+	{
+		size_t const len = strlen(s) + 1;
+		char *copy = (char *)alloc.alloc(len);
+		copy_cstring(copy, s, len);
+		return copy;
+	}
+
+	Node(Allocator &alloc, char const *name)
+	: alloc(alloc), name(_copy(alloc, name)) { }
+
+	~Node()
+	{
+		while (Node *child = first()) {
+			remove(child);
+			destroy(alloc, child);
+		}
+
+		alloc.free((void *)name, strlen(name) + 1);
+		if (linked_name)
+			alloc.free((void *)linked_name, strlen(linked_name) + 1);
+	}
+
+	void linked(char const *target) { linked_name = _copy(alloc, target); }
+
+	Node *child(char const *child_name)
+	{
+		for (Node *n = first(); n; n = n->next())
+			if (strcmp(n->name, child_name) == 0)
+				return n;
+		return nullptr;
+	}
+
+	Node const *child(file_size index) const
+	{
+		for (Node const *n = first(); n; n = n->next(), index--)
+			if (index == 0)
+				return n;
+		return nullptr;
+	}
+
+	file_size num_children() const
+	{
+		file_size count = 0;
+		for (Node const *n = first(); n; n = n->next(), count++) ;
+		return count;
+	}
+
+	/**
+	 * Call 'fn' for each path element of 'path'
+	 */
+	template <typename FN>
+	static bool for_each_path_element(char const *path, FN const &fn)
+	{
+		Absolute_path const abs_path(path);
+
+		char element[MAX_PATH_LEN];
+		char const *p = abs_path.base();
+
+		while (*p) {
+			while (*p == '/') p++;
+
+			size_t len = 0;
+			while (p[len] && p[len] != '/') len++;
+
+			if (!len)
+				break;
+
+			copy_cstring(element, p, min(len + 1, sizeof(element)));
+			p += len;
+
+			if (strcmp(element, ".") == 0)
+				continue;
+
+			if (!fn(element))
+				return false;
+		}
+		return true;
+	}
+
+	Node *lookup(char const *path)
+	{
+		Node *node = this;
+		bool const found = for_each_path_element(path, [&] (char const *element) {
+			node = node->child(element);
+			return node != nullptr; });
+
+		return found ? node : nullptr;
+	}
+
+	Node &lookup_or_create(char const *path)
+	{
+		Node *node = this;
+		for_each_path_element(path, [&] (char const *element) {
+			Node *child = node->child(element);
+			if (!child) {
+				child = new (alloc) Node(alloc, element);
+				node->insert(child);
+			}
+			node = child;
+			return true;
+		});
+		return *node;
+	}
+};
+
+
+/**
+ * Parser of tar headers within the uncompressed byte stream
+ */
+class Ztar::Index_builder : public Scan_sink
+{
+	private:
+
+		enum { BLOCK_LEN = 512, NAME_LEN = 100, PREFIX_LEN = 155 };
+
+		Node &_root;
+
+		char      _header[BLOCK_LEN] { };
+		size_t    _header_fill = 0;
+		file_size _data_left   = 0;
+		file_size _pos         = 0;
+		bool      _end         = false;
+
+		/* GNU extension for long names stored in the preceding record */
+		enum class Capture { NONE, NAME, LINK } _capture = Capture::NONE;
+
+		char   _long_name[MAX_PATH_LEN] { };
+		char   _long_link[MAX_PATH_LEN] { };
+		size_t _capture_len = 0;
+
+		static file_size _octal(char const *field, size_t len)
+		{
+			char buf[16] { };
+			copy_cstring(buf, field, min(len + 1, sizeof(buf)));
+
+			unsigned long long value = 0;
+			Genode::ascii_to_unsigned(buf, value, 8);
+			return value;
+		}
+
+		static file_size _block_align(file_size size) {
+			return Genode::align_addr(size, 9); }
+
+		bool _zero_header() const
+		{
+			for (size_t i = 0; i < BLOCK_LEN; i++)
+				if (_header[i])
+					return false;
+			return true;
+		}
+
+		void _apply_header()
+		{
+			if (_zero_header()) {
+				_end = true;
+				return;
+			}
+
+			file_size const size = _octal(_header + 124, 12);
+			char      const type = _header[156];
+
+			_data_left = _block_align(size);
+			_capture   = Capture::NONE;
+
+			if (type == 'L' || type == 'K') {
+				_capture     = (type == 'L') ? Capture::NAME : Capture::LINK;
+				_capture_len = 0;
+				Genode::memset(type == 'L' ? _long_name : _long_link, 0, MAX_PATH_LEN);
+				return;
+			}
+
+			/* assemble path from ustar prefix and name field */
+			char path[MAX_PATH_LEN] { };
+			if (_long_name[0]) {
+				copy_cstring(path, _long_name, sizeof(path));
+			} else {
+				size_t len = 0;
+				if (Genode::memcmp(_header + 257, "ustar", 5) == 0 && _header[345]) {
+					copy_cstring(path, _header + 345, PREFIX_LEN + 1);
+					len = strlen(path);
+					path[len++] = '/';
+				}
+				copy_cstring(path + len, _header, min((size_t)NAME_LEN + 1,
+				                                      sizeof(path) - len));
+			}
+
+			Node &node = _root.lookup_or_create(path);
+
+			node.has_record  = true;
+			node.size        = size;
+			node.data_offset = _pos;
+			node.mtime       = (long long)_octal(_header + 136, 12);
+			node.mode        = (unsigned)_octal(_header + 100, 8);
+
+			switch (type) {
+			case '1': node.type = Node::HARDLINK;  break;
+			case '2': node.type = Node::SYMLINK;   break;
+			case '5': node.type = Node::DIRECTORY; break;
+			default:  node.type = Node::FILE;      break;
+			}
+
+			if (node.type == Node::HARDLINK || node.type == Node::SYMLINK) {
+				char target[MAX_PATH_LEN] { };
+				copy_cstring(target, _long_link[0] ? _long_link : _header + 157,
+				             _long_link[0] ? sizeof(target) : NAME_LEN + 1);
+				node.linked(target);
+			}
+
+			_long_name[0] = 0;
+			_long_link[0] = 0;
+		}
+
+	public:
+
+		Index_builder(Node &root) : _root(root) { }
+
+		/**
+		 * Return number of bytes of the archive up to its end marker
+		 */
+		file_size size() const { return _pos; }
+
+		void consume(char const *src, size_t len) override
+		{
+			while (len && !_end) {
+
+				if (_data_left) {
+					size_t const n = (size_t)min((file_size)len, _data_left);
+
+					if (_capture != Capture::NONE) {
+						char *dst = (_capture == Capture::NAME) ? _long_name : _long_link;
+						size_t const space = MAX_PATH_LEN - 1 - _capture_len;
+						size_t const c = min(n, space);
+						memcpy(dst + _capture_len, src, c);
+						_capture_len += c;
+					}
+
+					src += n; len -= n; _pos += n; _data_left -= n;
+
+					if (!_data_left)
+						_capture = Capture::NONE;
+					continue;
+				}
+
+				size_t const n = min(len, BLOCK_LEN - _header_fill);
+				memcpy(_header + _header_fill, src, n);
+				src += n; len -= n; _pos += n; _header_fill += n;
+
+				if (_header_fill == BLOCK_LEN) {
+					_header_fill = 0;
+					_apply_header();
+				}
+			}
+		}
+};
+
+
+class Ztar::File_system : public Vfs::File_system
+{
+	private:
+
+		typedef Genode::String<64> Rom_name;
+
+		Genode::Env &_env;
+		Allocator   &_alloc;
+
+		Rom_name const _rom_name;
+
+		Genode::Attached_rom_dataspace _rom { _env, _rom_name.string() };
+
+		Genode::Constructible<Gzip_decoder> _gzip { };
+		Genode::Constructible<Xz_decoder>   _xz   { };
+
+		Decoder &_init_decoder(Xml_node config)
+		{
+			void const *base = _rom.local_addr<void const>();
+			file_size const size = _rom.size();
+
+			if (Xz_decoder::probe(base, size)) {
+				_xz.construct(_alloc, base, size);
+				return *_xz;
+			}
+
+			if (Gzip_decoder::probe(base, size)) {
+				Genode::Number_of_bytes const span =
+					config.attribute_value("span", Genode::Number_of_bytes(1024*1024));
+
+				_gzip.construct(_alloc, base, size, span);
+				return *_gzip;
+			}
+
+			Genode::error(_rom_name, ": unsupported compression format");
+			throw Decoder_failed();
+		}
+
+		Decoder &_decoder;
+
+		Node _root { _alloc, "" };
+
+		Mutex _mutex { };
+
+		Chunk_cache _cache;
+
+		/**
+		 * Walk hardlinks until we reach a non-link node
+		 */
+		Node const *_dereference(char const *path)
+		{
+			Node const *node = _root.lookup(path);
+
+			for (unsigned i = 0; node && node->type == Node::HARDLINK; i++) {
+				if (i == 16) {
+					Genode::error(_rom_name, " contains a hard-link loop at '", path, "'");
+					return nullptr;
+				}
+				node = _root.lookup(node->linked_name);
+			}
+			return node;
+		}
+
+		struct Ztar_handle : Vfs_handle
+		{
+			Node const &node;
+
+			Ztar_handle(Vfs::File_system &fs, Allocator &alloc, Node const &node)
+			: Vfs_handle(fs, fs, alloc, 0), node(node) { }
+
+			virtual Read_result read(char *dst, file_size count,
+			                         file_size &out_count) = 0;
+		};
+
+		struct File_handle : Ztar_handle
+		{
+			Chunk_cache &cache;
+			Mutex       &mutex;
+
+			File_handle(Vfs::File_system &fs, Allocator &alloc, Node const &node,
+			            Chunk_cache &cache, Mutex &mutex)
+			: Ztar_handle(fs, alloc, node), cache(cache), mutex(mutex) { }
+
+			Read_result read(char *dst, file_size count,
+			                 file_size &out_count) override
+			{
+				file_size const left = node.size > seek() ? node.size - seek() : 0;
+
+				count = min(left, count);
+
+				Mutex::Guard guard(mutex);
+				out_count = cache.read(node.data_offset + seek(), dst, (size_t)count);
+
+				return out_count == count ? READ_OK : READ_ERR_IO;
+			}
+		};
+
+		struct Dir_handle : Ztar_handle
+		{
+			using Ztar_handle::Ztar_handle;
+
+			Read_result read(char *dst, file_size count,
+			                 file_size &out_count) override
+			{
+				if (count < sizeof(Dirent))
+					return READ_ERR_INVALID;
+
+				Dirent &dirent = *(Dirent *)dst;
+
+				Node const *child = node.child(seek() / sizeof(Dirent));
+				if (!child) {
+					dirent = Dirent { };
+					out_count = 0;
+					return READ_OK;
+				}
+
+				Node const *target = child;
+				if (target->type == Node::HARDLINK)
+					target = static_cast<File_system &>(fs())._dereference(child->linked_name);
+
+				using Dirent_type = Vfs::Directory_service::Dirent_type;
+
+				auto dirent_type = [&] ()
+				{
+					if (!target) return Dirent_type::END;
+
+					switch (target->type) {
+					case Node::FILE:      return Dirent_type::CONTINUOUS_FILE;
+					case Node::SYMLINK:   return Dirent_type::SYMLINK;
+					case Node::DIRECTORY: return Dirent_type::DIRECTORY;
+					case Node::HARDLINK:  break;
+					}
+					return Dirent_type::END;
+				};
+
+				dirent = {
+					.fileno = (Genode::addr_t)child,
+					.type   = dirent_type(),
+					.rwx    = { .readable   = true,
+					            .writeable  = false,
+					            .executable = target && (target->mode & 0100) },
+					.name   = { child->name }
+				};
+				out_count = sizeof(Dirent);
+				return READ_OK;
+			}
+		};
+
+		struct Symlink_handle : Ztar_handle
+		{
+			using Ztar_handle::Ztar_handle;
+
+			Read_result read(char *dst, file_size count,
+			                 file_size &out_count) override
+			{
+				out_count = min(count, (file_size)strlen(node.linked_name));
+				memcpy(dst, node.linked_name, (size_t)out_count);
+				return READ_OK;
+			}
+		};
+
+		template <typename HANDLE, typename... ARGS>
+		HANDLE *_new_handle(Allocator &alloc, ARGS &&... args)
+		{
+			return new (alloc) HANDLE(*this, alloc, args...);
+		}
+
+	public:
+
+		File_system(Vfs::Env &env, Xml_node config)
+		:
+			_env(env.env()), _alloc(env.alloc()),
+			_rom_name(config.attribute_value("name", Rom_name())),
+			_decoder(_init_decoder(config)),
+			_cache(_alloc, _decoder,
+			       config.attribute_value("cache", Genode::Number_of_bytes(4*1024*1024)))
+		{
+			Index_builder builder(_root);
+			_decoder.scan(builder);
+			_cache.stream_size(builder.size());
+
+			Genode::log("compressed tar archive '", _rom_name, "' "
+			            "size is ", _rom.size());
+		}
+
+
+		/*********************************
+		 ** Directory-service interface **
+		 *********************************/
+
+		Dataspace_capability dataspace(char const *path) override
+		{
+			Node const *node = _dereference(path);
+			if (!node || node->type != Node::FILE)
+				return Dataspace_capability();
+
+			try {
+				Ram_dataspace_capability ds_cap = _env.ram().alloc(node->size);
+
+				char *local_addr = _env.rm().attach(ds_cap);
+
+				/* bypass the cache to not evict the working set */
+				size_t read_bytes = 0;
+				{
+					Mutex::Guard guard(_mutex);
+					read_bytes = _decoder.read(node->data_offset, local_addr,
+					                           (size_t)node->size);
+				}
+				_env.rm().detach(local_addr);
+
+				if (read_bytes == node->size)
+					return ds_cap;
+
+				_env.ram().free(ds_cap);
+			}
+			catch (...) { Genode::warning(__func__, " could not create new dataspace"); }
+
+			return Dataspace_capability();
+		}
+
+		void release(char const *, Dataspace_capability ds_cap) override
+		{
+			_env.ram().free(static_cap_cast<Genode::Ram_dataspace>(ds_cap));
+		}
+
+		Stat_result stat(char const *path, Stat &out) override
+		{
+			out = Stat { };
+
+			Node const *node = _dereference(path);
+			if (!node)
+				return STAT_ERR_NO_ENTRY;
+
+			auto node_type = [&] ()
+			{
+				switch (node->type) {
+				case Node::FILE:    return Node_type::CONTINUOUS_FILE;
+				case Node::SYMLINK: return Node_type::SYMLINK;
+				default:            break;
+				}
+				return Node_type::DIRECTORY;
+			};
+
+			out = {
+				.size              = node->type == Node::FILE ? node->size : 0,
+				.type              = node_type(),
+				.rwx               = { .readable   = true,
+				                       .writeable  = false,
+				                       .executable = (node->mode & 0100) != 0
+				                                  || !node->has_record },
+				.inode             = (Genode::addr_t)node,
+				.device            = (Genode::addr_t)this,
+				.modification_time = { node->mtime }
+			};
+			return STAT_OK;
+		}
+
+		Unlink_result unlink(char const *path) override
+		{
+			return _root.lookup(path) ? UNLINK_ERR_NO_PERM : UNLINK_ERR_NO_ENTRY;
+		}
+
+		Rename_result rename(char const *from, char const *to) override
+		{
+			if (_root.lookup(from) || _root.lookup(to))
+				return RENAME_ERR_NO_PERM;
+			return RENAME_ERR_NO_ENTRY;
+		}
+
+		file_size num_dirent(char const *path) override
+		{
+			Node const *node = _dereference(path);
+			return node ? node->num_children() : 0;
+		}
+
+		bool directory(char const *path) override
+		{
+			Node const *node = _dereference(path);
+			return node && node->type == Node::DIRECTORY;
+		}
+
+		char const *leaf_path(char const *path) override
+		{
+			return _root.lookup(path) ? path : nullptr;
+		}
+
+		Open_result open(char const *path, unsigned, Vfs_handle **out_handle,
+		                 Allocator &alloc) override
+		{
+			Node const *node = _dereference(path);
+			if (!node || node->type != Node::FILE)
+				return OPEN_ERR_UNACCESSIBLE;
+
+			try {
+				*out_handle = _new_handle<File_handle>(alloc, *node, _cache, _mutex);
+				return OPEN_OK;
+			}
+			catch (Genode::Out_of_ram)  { return OPEN_ERR_OUT_OF_RAM; }
+			catch (Genode::Out_of_caps) { return OPEN_ERR_OUT_OF_CAPS; }
+		}
+
+		Opendir_result opendir(char const *path, bool /* create */,
+		                       Vfs_handle **out_handle, Allocator &alloc) override
+		{
+			Node const *node = _dereference(path);
+			if (!node || node->type != Node::DIRECTORY)
+				return OPENDIR_ERR_LOOKUP_FAILED;
+
+			try {
+				*out_handle = _new_handle<Dir_handle>(alloc, *node);
+				return OPENDIR_OK;
+			}
+			catch (Genode::Out_of_ram)  { return OPENDIR_ERR_OUT_OF_RAM; }
+			catch (Genode::Out_of_caps) { return OPENDIR_ERR_OUT_OF_CAPS; }
+		}
+
+		Openlink_result openlink(char const *path, bool /* create */,
+		                         Vfs_handle **out_handle, Allocator &alloc) override
+		{
+			Node const *node = _dereference(path);
+			if (!node || node->type != Node::SYMLINK)
+				return OPENLINK_ERR_LOOKUP_FAILED;
+
+			try {
+				*out_handle = _new_handle<Symlink_handle>(alloc, *node);
+				return OPENLINK_OK;
+			}
+			catch (Genode::Out_of_ram)  { return OPENLINK_ERR_OUT_OF_RAM; }
+			catch (Genode::Out_of_caps) { return OPENLINK_ERR_OUT_OF_CAPS; }
+		}
+
+		void close(Vfs_handle *vfs_handle) override
+		{
+			if (vfs_handle)
+				destroy(vfs_handle->alloc(), static_cast<Ztar_handle *>(vfs_handle));
+		}
+
+
+		/***************************
+		 ** File_system interface **
+		 ***************************/
+
+		static char const *name()   { return "ztar"; }
+		char const *type() override { return "ztar"; }
+
+
+		/********************************
+		 ** File I/O service interface **
+		 ********************************/
+
+		Write_result write(Vfs_handle *, char const *, file_size,
+		                   file_size &) override
+		{
+			return WRITE_ERR_INVALID;
+		}
+
+		Read_result complete_read(Vfs_handle *vfs_handle, char *dst,
+		                          file_size count, file_size &out_count) override
+		{
+			out_count = 0;
+
+			Ztar_handle *handle = static_cast<Ztar_handle *>(vfs_handle);
+			if (!handle)
+				return READ_ERR_INVALID;
+
+			return handle->read(dst, count, out_count);
+		}
+
+		Ftruncate_result ftruncate(Vfs_handle *, file_size) override
+		{
+			return FTRUNCATE_ERR_NO_PERM;
+		}
+
+		bool read_ready(Vfs_handle *) override { return true; }
+};
+
+
+struct Ztar_factory : Vfs::File_system_factory
+{
+	Vfs::File_system *create(Vfs::Env &env, Genode::Xml_node node) override
+	{
+		try { return new (env.alloc()) Ztar::File_system(env, node); }
+		catch (Ztar::Decoder_failed) { }
+		return nullptr;
+	}
+};
+
+
+extern "C" Vfs::File_system_factory *vfs_file_system_factory(void)
+{
+	static Ztar_factory factory;
+	return &factory;
+}
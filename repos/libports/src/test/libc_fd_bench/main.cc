@@ -0,0 +1,91 @@
+/*
+ * \brief  Benchmark for the cost of read() depending on the number of open fds
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * For each number of open descriptors given as argument, the benchmark opens
+ * descriptors of '/dev/null' until the number is reached and measures the
+ * duration of single-byte reads from a descriptor of '/dev/zero', which is
+ * opened last and therefore has the highest fd number.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static unsigned long long now_ns()
+{
+	struct timespec ts { };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec*1000*1000*1000 + ts.tv_nsec;
+}
+
+
+static bool bench_read(int num_fds, int iterations)
+{
+	int const fd = open("/dev/zero", O_RDONLY);
+	if (fd < 0) {
+		perror("open /dev/zero");
+		return false;
+	}
+
+	unsigned long long const start = now_ns();
+
+	for (int i = 0; i < iterations; i++) {
+		char c;
+		if (read(fd, &c, 1) != 1) {
+			perror("read");
+			return false;
+		}
+	}
+
+	unsigned long long const duration = now_ns() - start;
+
+	printf("%5d open fds: %d reads from fd %d in %llu us, %llu ns per read()\n",
+	       num_fds, iterations, fd, duration / 1000, duration / iterations);
+
+	close(fd);
+	return true;
+}
+
+
+int main(int argc, char **argv)
+{
+	int const iterations = argc > 1 ? atoi(argv[1]) : 100000;
+
+	/* stdin, stdout and stderr */
+	int num_open = 3;
+
+	for (int i = 2; i < argc; i++) {
+
+		/* one descriptor is used for reading */
+		int const num_fds = atoi(argv[i]);
+
+		for (; num_open < num_fds - 1; num_open++) {
+			if (open("/dev/null", O_RDONLY) < 0) {
+				printf("could open only %d of %d descriptors (%s)\n",
+				       num_open, num_fds, strerror(errno));
+				return 1;
+			}
+		}
+
+		if (!bench_read(num_open + 1, iterations))
+			return 1;
+	}
+
+	printf("--- fd benchmark finished ---\n");
+	return 0;
+}
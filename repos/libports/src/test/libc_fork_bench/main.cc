@@ -0,0 +1,92 @@
+/*
+ * \brief  Latency of fork and execve for a large parent
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The parent populates its heap with the given number of MiB, then
+ * repeatedly forks a child that immediately executes the benchmark binary
+ * again with the argument "child", which returns right away. For each
+ * round, the time until 'fork' returns in the parent and the time until the
+ * child's exit is reported via 'waitpid' are printed.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+static unsigned long long now_us()
+{
+	struct timespec ts { };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+
+int main(int argc, char **argv)
+{
+	if (argc > 1 && strcmp(argv[1], "child") == 0)
+		return 0;
+
+	unsigned const heap_mib = argc > 1 ? atoi(argv[1]) : 500;
+	unsigned const rounds   = argc > 2 ? atoi(argv[2]) : 5;
+
+	/* populate heap, each MiB is a separate allocation */
+	enum { MIB = 1024*1024 };
+	for (unsigned i = 0; i < heap_mib; i++) {
+		void * const block = malloc(MIB);
+		if (!block) {
+			printf("Error: could not allocate %u MiB of heap\n", heap_mib);
+			return -1;
+		}
+		memset(block, i & 0xff, MIB);
+	}
+
+	printf("parent heap populated with %u MiB\n", heap_mib);
+
+	for (unsigned i = 0; i < rounds; i++) {
+
+		unsigned long long const start_us = now_us();
+
+		pid_t const pid = fork();
+		if (pid < 0) {
+			printf("Error: fork failed\n");
+			return -1;
+		}
+
+		if (pid == 0) {
+			char argv0[] = "test-libc_fork_bench";
+			char argv1[] = "child";
+			char *child_argv[] { argv0, argv1, nullptr };
+
+			execve("test-libc_fork_bench", child_argv, nullptr);
+
+			printf("Error: execve failed\n");
+			_exit(-1);
+		}
+
+		unsigned long long const fork_us = now_us() - start_us;
+
+		int status = 0;
+		waitpid(pid, &status, 0);
+
+		unsigned long long const total_us = now_us() - start_us;
+
+		printf("round %u: fork %llu ms, fork+exec+exit %llu ms\n",
+		       i, fork_us / 1000, total_us / 1000);
+	}
+
+	printf("--- fork benchmark finished ---\n");
+	return 0;
+}
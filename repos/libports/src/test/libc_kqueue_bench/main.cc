@@ -0,0 +1,205 @@
+/*
+ * \brief  Benchmark for kevent() with many idle descriptors
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The benchmark watches the read ends of a large number of idle pipes and a
+ * small number of active pipes. Each round writes one byte to every active
+ * pipe and waits until all of them are reported as readable. For
+ * comparison, the same rounds are executed via poll() if all descriptors
+ * fit into an fd_set. The file-descriptor table itself is not limited, but
+ * the libc poll() is implemented on top of select().
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/event.h>
+#include <sys/select.h>
+
+
+static unsigned long long now_us()
+{
+	struct timespec ts { };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec*1000*1000 + ts.tv_nsec/1000;
+}
+
+
+struct Pipe { int rd, wr; };
+
+
+static int create_pipes(Pipe *pipes, int count)
+{
+	for (int i = 0; i < count; i++) {
+		int fds[2];
+		if (pipe(fds) != 0)
+			return i;
+
+		fcntl(fds[0], F_SETFL, O_NONBLOCK);
+		pipes[i] = Pipe { fds[0], fds[1] };
+	}
+	return count;
+}
+
+
+static void write_active(Pipe const *active, int num_active)
+{
+	char const c = 'x';
+	for (int i = 0; i < num_active; i++)
+		if (write(active[i].wr, &c, 1) != 1)
+			perror("write");
+}
+
+
+static bool bench_kevent(Pipe const *active, int num_active,
+                         Pipe const *idle, int num_idle, int rounds)
+{
+	int const kq = kqueue();
+	if (kq < 0) {
+		perror("kqueue");
+		return false;
+	}
+
+	unsigned long long const t_start = now_us();
+
+	auto add = [&] (int fd) {
+		struct kevent change;
+		EV_SET(&change, fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+		return kevent(kq, &change, 1, nullptr, 0, nullptr) == 0;
+	};
+
+	for (int i = 0; i < num_idle; i++)
+		if (!add(idle[i].rd)) { perror("kevent EV_ADD"); return false; }
+
+	for (int i = 0; i < num_active; i++)
+		if (!add(active[i].rd)) { perror("kevent EV_ADD"); return false; }
+
+	unsigned long long const t_registered = now_us();
+
+	struct kevent *events = (struct kevent *)calloc(num_active, sizeof(struct kevent));
+
+	for (int round = 0; round < rounds; round++) {
+
+		write_active(active, num_active);
+
+		for (int pending = num_active; pending > 0; ) {
+
+			int const n = kevent(kq, nullptr, 0, events, num_active, nullptr);
+			if (n < 0) {
+				perror("kevent");
+				return false;
+			}
+
+			for (int i = 0; i < n; i++) {
+				char c;
+				if (read((int)events[i].ident, &c, 1) == 1)
+					pending--;
+			}
+		}
+	}
+
+	unsigned long long const t_end = now_us();
+
+	free(events);
+	close(kq);
+
+	printf("kevent: register %llu us, %d rounds %llu us (%llu us/round)\n",
+	       t_registered - t_start, rounds, t_end - t_registered,
+	       (t_end - t_registered) / rounds);
+	return true;
+}
+
+
+static bool bench_poll(Pipe const *active, int num_active,
+                       Pipe const *idle, int num_idle, int rounds)
+{
+	int const nfds = num_active + num_idle;
+
+	struct pollfd *fds = (struct pollfd *)calloc(nfds, sizeof(struct pollfd));
+
+	for (int i = 0; i < nfds; i++) {
+		fds[i].fd     = i < num_idle ? idle[i].rd : active[i - num_idle].rd;
+		fds[i].events = POLLIN;
+
+		if (fds[i].fd >= FD_SETSIZE) {
+			printf("poll: skipped, descriptors exceed FD_SETSIZE\n");
+			free(fds);
+			return true;
+		}
+	}
+
+	unsigned long long const t_start = now_us();
+
+	for (int round = 0; round < rounds; round++) {
+
+		write_active(active, num_active);
+
+		for (int pending = num_active; pending > 0; ) {
+
+			if (poll(fds, nfds, -1) < 0) {
+				perror("poll");
+				return false;
+			}
+
+			for (int i = 0; i < nfds; i++) {
+				char c;
+				if ((fds[i].revents & POLLIN) && read(fds[i].fd, &c, 1) == 1)
+					pending--;
+			}
+		}
+	}
+
+	unsigned long long const t_end = now_us();
+
+	free(fds);
+
+	printf("poll:   %d rounds %llu us (%llu us/round)\n",
+	       rounds, t_end - t_start, (t_end - t_start) / rounds);
+	return true;
+}
+
+
+int main(int argc, char **argv)
+{
+	int const want_idle  = argc > 1 ? atoi(argv[1]) : 10000;
+	int const num_active = argc > 2 ? atoi(argv[2]) : 100;
+	int const rounds     = argc > 3 ? atoi(argv[3]) : 100;
+
+	Pipe *active = (Pipe *)calloc(num_active, sizeof(Pipe));
+	Pipe *idle   = (Pipe *)calloc(want_idle,  sizeof(Pipe));
+
+	if (create_pipes(active, num_active) != num_active) {
+		perror("pipe");
+		return 1;
+	}
+
+	int const num_idle = create_pipes(idle, want_idle);
+	if (num_idle < want_idle)
+		printf("created only %d of %d idle pipes (%s)\n",
+		       num_idle, want_idle, strerror(errno));
+
+	printf("%d idle and %d active pipes\n", num_idle, num_active);
+
+	if (!bench_kevent(active, num_active, idle, num_idle, rounds))
+		return 1;
+
+	if (!bench_poll(active, num_active, idle, num_idle, rounds))
+		return 1;
+
+	printf("--- kqueue benchmark finished ---\n");
+	return 0;
+}
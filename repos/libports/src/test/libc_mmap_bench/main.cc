@@ -0,0 +1,127 @@
+/*
+ * \brief  Benchmark for private file mappings
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The benchmark creates a large file, maps it privately, and touches 1% of
+ * its pages, first read-only and then with write access.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+static unsigned long long now_us()
+{
+	struct timespec ts { };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec*1000*1000 + ts.tv_nsec/1000;
+}
+
+
+static bool bench(int fd, size_t size, int prot, char const *name)
+{
+	enum { PAGE = 4096, STRIDE = 100*PAGE };
+
+	unsigned long long const t_start = now_us();
+
+	char *ptr = (char *)mmap(nullptr, size, prot, MAP_PRIVATE, fd, 0);
+	if (ptr == MAP_FAILED) {
+		perror("mmap");
+		return false;
+	}
+
+	unsigned long long const t_mapped = now_us();
+
+	unsigned long pages = 0;
+	unsigned long sum   = 0;
+	for (size_t offset = 0; offset < size; offset += STRIDE, pages++) {
+		sum += (unsigned char)ptr[offset];
+		if (prot & PROT_WRITE)
+			ptr[offset] = (char)pages;
+	}
+
+	unsigned long long const t_touched = now_us();
+
+	munmap(ptr, size);
+
+	unsigned long long const t_unmapped = now_us();
+
+	printf("%s: mmap %llu us, touch %lu pages %llu us, munmap %llu us, "
+	       "total %llu us (checksum %lu)\n", name,
+	       t_mapped - t_start, pages, t_touched - t_mapped,
+	       t_unmapped - t_touched, t_unmapped - t_start, sum);
+
+	return true;
+}
+
+
+static bool create_file(char const *path, size_t size)
+{
+	int const fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+	if (fd < 0) {
+		perror("open");
+		return false;
+	}
+
+	static char buf[64*1024];
+	memset(buf, 0x55, sizeof(buf));
+
+	for (size_t offset = 0; offset < size; offset += sizeof(buf))
+		if (write(fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+			perror("write");
+			close(fd);
+			return false;
+		}
+
+	close(fd);
+	return true;
+}
+
+
+int main(int argc, char **argv)
+{
+	char   const *path    = argc > 1 ? argv[1] : "/data/mmap_bench.img";
+	size_t const  size_mb = argc > 2 ? atoi(argv[2]) : 256;
+
+	if (!create_file(path, size_mb << 20))
+		return 1;
+
+	int const fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		perror("open");
+		return 1;
+	}
+
+	struct stat st { };
+	if (fstat(fd, &st) < 0) {
+		perror("fstat");
+		return 1;
+	}
+
+	size_t const size = st.st_size;
+	printf("mapping %s (%zu MiB)\n", path, size >> 20);
+
+	if (!bench(fd, size, PROT_READ,              "read-only ")
+	 || !bench(fd, size, PROT_READ | PROT_WRITE, "read-write"))
+		return 1;
+
+	close(fd);
+
+	printf("--- mmap benchmark finished ---\n");
+	return 0;
+}
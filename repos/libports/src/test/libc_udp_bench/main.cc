@@ -0,0 +1,216 @@
+/*
+ * \brief  Benchmark for the UDP packet rate of the socket API
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The benchmark runs as sender and receiver in two components. In the first
+ * round, each datagram is sent and received individually via sendto() and
+ * recvfrom(). In the second round, batches of datagrams are transferred via
+ * sendmmsg() and recvmmsg(). Each round is terminated by end markers, which
+ * are datagrams of one byte carrying the number of the round.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+enum { MAX_BATCH = 64, MAX_SIZE = 1472, ROUNDS = 2 };
+
+
+static unsigned long long now_ns()
+{
+	struct timespec ts { };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec*1000*1000*1000 + ts.tv_nsec;
+}
+
+
+static void report(char const *what, unsigned long count,
+                   unsigned long long duration_ns)
+{
+	unsigned long long const us = duration_ns / 1000;
+
+	printf("%-18s %8lu datagrams in %8llu us, %8llu datagrams/s\n",
+	       what, count, us, us ? count*1000*1000ULL / us : 0);
+}
+
+
+static char          payload[MAX_BATCH][MAX_SIZE];
+static struct iovec  iov[MAX_BATCH];
+static struct mmsghdr msgs[MAX_BATCH];
+static sockaddr_in   addrs[MAX_BATCH];
+
+
+static void init_msgs(size_t size, sockaddr_in const *dst)
+{
+	for (unsigned i = 0; i < MAX_BATCH; i++) {
+		iov[i] = { payload[i], size };
+		if (dst) addrs[i] = *dst;
+		msgs[i].msg_hdr = { &addrs[i], sizeof(addrs[i]), &iov[i], 1, nullptr, 0, 0 };
+	}
+}
+
+
+static void send_round(int s, unsigned round, sockaddr_in const &dst,
+                       unsigned long count, unsigned batch, size_t size)
+{
+	init_msgs(size, &dst);
+
+	/*
+	 * Datagrams the stack fails to send, e.g., due to exhausted buffers, are
+	 * not retried but merely not counted.
+	 */
+	unsigned long attempted = 0, sent = 0;
+	unsigned long long const start = now_ns();
+
+	while (attempted < count) {
+		if (round == 0) {
+			if (sendto(s, payload[0], size, 0, (sockaddr const *)&dst, sizeof(dst)) > 0)
+				sent++;
+			attempted++;
+		} else {
+			unsigned const n = count - attempted < batch ? count - attempted : batch;
+			ssize_t const res = sendmmsg(s, msgs, n, 0);
+			if (res > 0)
+				sent += res;
+			attempted += res > 0 ? res : n;
+		}
+	}
+
+	report(round ? "sendmmsg:" : "sendto:", sent, now_ns() - start);
+
+	/* send end markers repeatedly as datagrams may get lost */
+	char const marker = (char)round;
+	for (unsigned i = 0; i < 10; i++) {
+		sendto(s, &marker, 1, 0, (sockaddr const *)&dst, sizeof(dst));
+		usleep(100*1000);
+	}
+}
+
+
+static int recv_round(int s, unsigned round, unsigned batch)
+{
+	init_msgs(MAX_SIZE, nullptr);
+
+	unsigned long received = 0;
+	unsigned long long start = 0;
+
+	for (;;) {
+		unsigned n = 1;
+		if (round == 0) {
+			sockaddr_in src { };
+			socklen_t   src_len = sizeof(src);
+			ssize_t const res = recvfrom(s, payload[0], MAX_SIZE, 0,
+			                             (sockaddr *)&src, &src_len);
+			if (res < 0) {
+				perror("recvfrom");
+				return -1;
+			}
+			msgs[0].msg_len = res;
+		} else {
+			for (unsigned i = 0; i < batch; i++)
+				msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+
+			ssize_t const res = recvmmsg(s, msgs, batch, MSG_WAITFORONE, nullptr);
+			if (res <= 0) {
+				perror("recvmmsg");
+				return -1;
+			}
+			n = res;
+		}
+
+		for (unsigned i = 0; i < n; i++) {
+
+			/* ignore end markers of the previous round */
+			if (msgs[i].msg_len == 1 && payload[i][0] != (char)round)
+				continue;
+
+			if (msgs[i].msg_len == 1) {
+				report(round ? "recvmmsg:" : "recvfrom:", received,
+				       received ? now_ns() - start : 0);
+				return 0;
+			}
+
+			if (!received)
+				start = now_ns();
+			received++;
+		}
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		printf("usage: %s send <ip> <port> [count] [batch] [size] | recv <port> [batch]\n",
+		       argv[0]);
+		return 1;
+	}
+
+	bool const sender = strcmp(argv[1], "send") == 0;
+
+	int const s = socket(AF_INET, SOCK_DGRAM, 0);
+	if (s < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	if (sender) {
+		sockaddr_in dst { };
+		dst.sin_family      = AF_INET;
+		dst.sin_port        = htons(atoi(argv[3]));
+		dst.sin_addr.s_addr = inet_addr(argv[2]);
+
+		unsigned long const count = argc > 4 ? atol(argv[4]) : 100000;
+		unsigned      const batch = argc > 5 ? atoi(argv[5]) : 32;
+		size_t        const size  = argc > 6 ? atoi(argv[6]) : 64;
+
+		if (batch < 1 || batch > MAX_BATCH || size < 2 || size > MAX_SIZE) {
+			printf("invalid batch or datagram size\n");
+			return 1;
+		}
+
+		/* give the receiver time to bind its socket */
+		sleep(2);
+
+		for (unsigned round = 0; round < ROUNDS; round++)
+			send_round(s, round, dst, count, batch, size);
+
+	} else {
+		sockaddr_in addr { };
+		addr.sin_family      = AF_INET;
+		addr.sin_port        = htons(atoi(argv[2]));
+		addr.sin_addr.s_addr = INADDR_ANY;
+
+		if (bind(s, (sockaddr *)&addr, sizeof(addr))) {
+			perror("bind");
+			return 1;
+		}
+
+		unsigned const batch = argc > 3 ? atoi(argv[3]) : 32;
+		if (batch < 1 || batch > MAX_BATCH) {
+			printf("invalid batch size\n");
+			return 1;
+		}
+
+		for (unsigned round = 0; round < ROUNDS; round++)
+			if (recv_round(s, round, batch))
+				return 1;
+
+		printf("--- UDP benchmark finished ---\n");
+	}
+	return 0;
+}
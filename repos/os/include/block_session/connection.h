@@ -86,6 +86,12 @@ struct Block::Connection : Genode::Connection<Session>, Session_client
 				 */
 				Payload _payload { };
 
+				/*
+				 * True if '_payload' is provided by the application, which
+				 * transfers the data in place
+				 */
+				bool const _in_place;
+
 				bool _completed = false;
 
 				/*
@@ -108,7 +114,7 @@ struct Block::Connection : Genode::Connection<Session>, Session_client
 
 				Operation _curr_operation() const
 				{
-					if (!Operation::has_payload(_operation.type))
+					if (!Operation::has_payload(_operation.type) || _in_place)
 						return _operation;
 
 					return {
@@ -141,7 +147,7 @@ struct Block::Connection : Genode::Connection<Session>, Session_client
 
 					Packet_descriptor const p(_curr_operation(), _payload, tag);
 
-					if (_operation.type == Operation::Type::WRITE)
+					if (_operation.type == Operation::Type::WRITE && !_in_place)
 						_with_offset_and_length(job, [&] (off_t offset, size_t length) {
 							policy.produce_write_content(job, offset,
 							                             tx.packet_content(p),
@@ -153,7 +159,28 @@ struct Block::Connection : Genode::Connection<Session>, Session_client
 
 				Job(Connection &connection, Operation operation)
 				:
-					_connection(connection), _operation(operation)
+					_connection(connection), _operation(operation),
+					_in_place(false)
+				{
+					_connection._pending.enqueue(_pending_elem);
+				}
+
+				/**
+				 * Constructor of a job that operates on a given payload
+				 *
+				 * The 'payload' must refer to a range of the packet-stream
+				 * buffer that the application keeps allocated while the job
+				 * is in progress. The range must cover the entire operation
+				 * and is neither allocated nor released by the connection.
+				 * Since the data is transferred in place, the
+				 * 'produce_write_content' and 'consume_read_result' hooks
+				 * of the policy are not called for such a job.
+				 */
+				Job(Connection &connection, Operation operation,
+				    Packet_descriptor::Payload payload)
+				:
+					_connection(connection), _operation(operation),
+					_payload(payload), _in_place(true)
 				{
 					_connection._pending.enqueue(_pending_elem);
 				}
@@ -371,13 +398,17 @@ bool Block::Connection<JOB>::_try_process_ack(POLICY &policy, Tx::Source &tx)
 	try {
 		_tags.template apply<_JOB>(id, [&] (_JOB &job) {
 
-			if (type == Operation::Type::READ)
+			/* needed to access private members of 'Job' (friend) */
+			Job &job_base = job;
+
+			if (type == Operation::Type::READ && !job_base._in_place)
 				Job::_with_offset_and_length(job, [&] (off_t offset, size_t length) {
 					policy.consume_read_result(job, offset,
 					                           tx.packet_content(p), length); });
 
-			/* needed to access private members of 'Job' (friend) */
-			Job &job_base = job;
+			/* the payload of in-place jobs is owned by the application */
+			if (job_base._in_place)
+				release_packet = false;
 
 			bool const partial_read_or_write =
 				p.succeeded() &&
@@ -442,6 +473,11 @@ bool Block::Connection<JOB>::_try_submit_pending_job(POLICY &policy, Tx::Source
 			if (!Operation::has_payload(job._operation.type))
 				return;
 
+			if (job._in_place) {
+				payload = job._payload;
+				return;
+			}
+
 			size_t const bytes = _info.block_size * job._curr_operation().count;
 
 			payload = { .offset = tx.alloc_packet(bytes, _info.align_log2).offset(),
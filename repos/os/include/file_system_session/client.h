@@ -35,13 +35,16 @@ class File_system::Session_client : public Genode::Rpc_client<Session>
 		 * \param session          session capability
 		 * \param tx_buffer_alloc  allocator used for managing the
 		 *                         transmission buffer
+		 *
+		 * The packet-descriptor queues are sized as reported by the
+		 * server, which may have limited the requested queue size.
 		 */
 		Session_client(Session_capability       session,
 		               Genode::Range_allocator &tx_buffer_alloc,
 		               Genode::Region_map      &rm)
 		:
 			Rpc_client<Session>(session),
-			_tx(call<Rpc_tx_cap>(), rm, tx_buffer_alloc)
+			_tx(call<Rpc_tx_cap>(), rm, tx_buffer_alloc, call<Rpc_queue_size>())
 		{ }
 
 
@@ -63,25 +63,32 @@ struct File_system::Connection : Genode::Connection<Session>, Session_client
 	 * \param root             root directory of session
 	 * \param writeable        session is writable
 	 * \param tx_buf_size      size of transmission buffer in bytes
+	 * \param queue_size       size of the packet-descriptor queues, which
+	 *                         are located within the transmission buffer
+	 *                         and bound the number of outstanding packets,
+	 *                         must be a power of two
 	 */
 	Connection(Genode::Env             &env,
 	           Genode::Range_allocator &tx_block_alloc,
 	           char const              *label       = "",
 	           char const              *root        = "/",
 	           bool                     writeable   = true,
-	           size_t                   tx_buf_size = DEFAULT_TX_BUF_SIZE)
+	           size_t                   tx_buf_size = DEFAULT_TX_BUF_SIZE,
+	           unsigned                 queue_size  = TX_QUEUE_SIZE)
 	:
 		Genode::Connection<Session>(env,
 			session(env.parent(),
 			        "ram_quota=%ld, "
 			        "cap_quota=%ld, "
 			        "tx_buf_size=%ld, "
+			        "queue_size=%u, "
 			        "label=\"%s\", "
 			        "root=\"%s\", "
 			        "writeable=%d",
 			        8*1024*sizeof(long) + tx_buf_size,
 			        CAP_QUOTA,
 			        tx_buf_size,
+			        queue_size,
 			        label, root, writeable)),
 		Session_client(cap(), tx_block_alloc, env.rm())
 	{ }
@@ -106,6 +106,15 @@ namespace File_system {
 		Genode::int64_t value;
 	};
 
+	/**
+	 * File range addressed by a vectored READ_V or WRITE_V packet
+	 */
+	struct Segment
+	{
+		seek_off_t position;   /* file seek offset in bytes, or SEEK_TAIL */
+		size_t     length;     /* length of range in bytes */
+	};
+
 	typedef Genode::Out_of_ram  Out_of_ram;
 	typedef Genode::Out_of_caps Out_of_caps;
 
@@ -118,6 +127,11 @@ namespace File_system {
 
 	enum { MAX_NAME_LEN = 128, MAX_PATH_LEN = 1024 };
 
+	/**
+	 * Maximum number of segments of a vectored packet
+	 */
+	enum { MAX_SEGMENTS = 64 };
+
 	/**
 	 * File offset constant for reading or writing to the end of a file
 	 *
@@ -172,9 +186,26 @@ class File_system::Packet_descriptor : public Genode::Packet_descriptor
 			 * This is only needed by file systems that maintain an internal
 			 * cache, which needs to be flushed on certain occasions.
 			 */
-			SYNC
+			SYNC,
+
+			/**
+			 * Vectored read and write
+			 *
+			 * A vectored packet covers 'num_segments()' file ranges. Its
+			 * payload holds the data of all segments back to back, followed
+			 * by the 8-byte aligned table of 'Segment' entries. The packet
+			 * length refers to the data only and is not altered by the
+			 * acknowledgement. For READ_V, the server updates the length of
+			 * each table entry with the number of bytes read for the segment.
+			 */
+			READ_V,
+			WRITE_V
 		};
 
+		struct Segments { unsigned count; };
+
+		enum { SEGMENT_ALIGN_LOG2 = 3 };
+
 	private:
 
 		Node_handle _handle { 0 };   /* node handle */
@@ -232,6 +263,20 @@ class File_system::Packet_descriptor : public Genode::Packet_descriptor
 			_position(0), _length(0)
 		{ }
 
+		/**
+		 * Constructor for vectored operations
+		 *
+		 * \param length    accumulated length of all segments in bytes
+		 */
+		Packet_descriptor(Packet_descriptor p,
+		                  Node_handle handle, Opcode op, size_t length,
+		                  Segments segments)
+		:
+			Genode::Packet_descriptor(p.offset(), p.size()),
+			_handle(handle), _op(op), _success(false),
+			_position(segments.count), _length(length)
+		{ }
+
 		/**
 		 * Constructor
 		 */
@@ -244,10 +289,45 @@ class File_system::Packet_descriptor : public Genode::Packet_descriptor
 
 		Node_handle handle()    const { return _handle;   }
 		Opcode      operation() const { return _op;       }
-		seek_off_t  position()  const { return _op != Opcode::WRITE_TIMESTAMP ? _position : 0; }
+		bool        vectored()  const { return _op == READ_V || _op == WRITE_V; }
+		seek_off_t  position()  const { return _op != Opcode::WRITE_TIMESTAMP && !vectored() ? _position : 0; }
 		size_t      length()    const { return _op != Opcode::WRITE_TIMESTAMP ? _length : 0;   }
 		bool        succeeded() const { return _success;  }
 
+		unsigned num_segments() const { return vectored() ? (unsigned)_position : 0; }
+
+		/**
+		 * Offset of the segment table within the payload of a vectored packet
+		 */
+		static size_t segment_table_offset(size_t length) {
+			return Genode::align_addr(length, SEGMENT_ALIGN_LOG2); }
+
+		/**
+		 * Payload size needed for a vectored packet
+		 */
+		static size_t vector_size(size_t length, unsigned num_segments) {
+			return segment_table_offset(length) + num_segments*sizeof(Segment); }
+
+		/**
+		 * Return true if the segment table of a vectored packet is in bounds
+		 *
+		 * The table must be naturally aligned within the bulk buffer, which
+		 * the client ensures by allocating the packet with an alignment of
+		 * 'SEGMENT_ALIGN_LOG2'.
+		 */
+		bool segments_valid() const
+		{
+			return num_segments() > 0 && num_segments() <= MAX_SEGMENTS
+			    && vector_size(_length, num_segments()) <= size()
+			    && (offset() & ((1 << SEGMENT_ALIGN_LOG2) - 1)) == 0;
+		}
+
+		/**
+		 * Return pointer to the segment table within the packet content
+		 */
+		Segment *segment_table(char *content) const {
+			return (Segment *)(content + segment_table_offset(_length)); }
+
 		template <typename FN>
 		void with_timestamp(FN const &fn) const
 		{
@@ -317,10 +397,17 @@ struct File_system::Directory_entry
 
 struct File_system::Session : public Genode::Session
 {
-	enum { TX_QUEUE_SIZE = 16 };
+	/*
+	 * The size of the packet-descriptor queues is negotiated via the
+	 * 'queue_size' session argument. It defaults to 'TX_QUEUE_SIZE', must
+	 * be a power of two, and is limited to 'MAX_TX_QUEUE_SIZE'. The queues are located within the
+	 * transmission buffer. The client obtains the size applied by the
+	 * server via the '_queue_size' RPC function.
+	 */
+	enum { TX_QUEUE_SIZE = 16, MAX_TX_QUEUE_SIZE = 1024 };
 
 	typedef Genode::Packet_stream_policy<File_system::Packet_descriptor,
-	                                     TX_QUEUE_SIZE, TX_QUEUE_SIZE,
+	                                     MAX_TX_QUEUE_SIZE, MAX_TX_QUEUE_SIZE,
 	                                     char> Tx_policy;
 
 	typedef Packet_stream_tx::Channel<Tx_policy> Tx;
@@ -480,6 +567,7 @@ struct File_system::Session : public Genode::Session
 	 *******************/
 
 	GENODE_RPC(Rpc_tx_cap, Genode::Capability<Tx>, _tx_cap);
+	GENODE_RPC(Rpc_queue_size, unsigned, _queue_size);
 	GENODE_RPC_THROW(Rpc_file, File_handle, file,
 	                 GENODE_TYPE_LIST(Invalid_handle, Invalid_name,
 	                                  Lookup_failed, Node_already_exists,
@@ -526,7 +614,7 @@ struct File_system::Session : public Genode::Session
 	                                  Lookup_failed, Permission_denied, Unavailable),
 	                 Dir_handle, Name const &, Dir_handle, Name const &);
 
-	GENODE_RPC_INTERFACE(Rpc_tx_cap,
+	GENODE_RPC_INTERFACE(Rpc_tx_cap, Rpc_queue_size,
 	                     Rpc_file, Rpc_symlink, Rpc_dir,
 	                     Rpc_node, Rpc_watch,
 	                     Rpc_close, Rpc_status, Rpc_control, Rpc_unlink,
@@ -17,11 +17,16 @@
 #include <file_system_session/file_system_session.h>
 #include <packet_stream_tx/rpc_object.h>
 #include <base/rpc_server.h>
+#include <util/arg_string.h>
 
 namespace File_system { class Session_rpc_object; }
 
 class File_system::Session_rpc_object : public Genode::Rpc_object<Session, Session_rpc_object>
 {
+	private:
+
+		unsigned const _tx_queue_size;
+
 	protected:
 
 		Packet_stream_tx::Rpc_object<Tx> _tx;
@@ -31,14 +36,48 @@ class File_system::Session_rpc_object : public Genode::Rpc_object<Session, Sessi
 		/**
 		 * Constructor
 		 *
-		 * \param tx_ds  dataspace used as communication buffer
-		 *               for the tx packet stream
-		 * \param ep     entry point used for packet-stream channel
+		 * \param tx_ds       dataspace used as communication buffer
+		 *                    for the tx packet stream
+		 * \param ep          entry point used for packet-stream channel
+		 * \param queue_size  size of the packet-descriptor queues as
+		 *                    requested by the client
 		 */
 		Session_rpc_object(Genode::Dataspace_capability  tx_ds,
 		                   Genode::Region_map           &rm,
-		                   Genode::Rpc_entrypoint       &ep)
-		: _tx(tx_ds, rm, ep) { }
+		                   Genode::Rpc_entrypoint       &ep,
+		                   unsigned                      queue_size = TX_QUEUE_SIZE)
+		:
+			_tx_queue_size(Tx_policy::Submit_queue::size(queue_size)),
+			_tx(tx_ds, rm, ep, _tx_queue_size)
+		{ }
+
+		/**
+		 * Return queue size requested via the session arguments
+		 */
+		static unsigned queue_size_from_args(char const *args)
+		{
+			return (unsigned)Genode::Arg_string::find_arg(args, "queue_size")
+			                                    .ulong_value(TX_QUEUE_SIZE);
+		}
+
+		/**
+		 * Return true if 'queue_size' is a power of two within the bounds
+		 * of the session's packet-stream policy
+		 */
+		static bool queue_size_valid(unsigned queue_size)
+		{
+			return Tx_policy::Submit_queue::valid_size(queue_size);
+		}
+
+		/**
+		 * Return space occupied by the packet-descriptor queues within the
+		 * transmission buffer
+		 */
+		static Genode::size_t queues_size(unsigned queue_size)
+		{
+			return Tx_policy::Submit_queue::bytes(queue_size)
+			     + Tx_policy::Ack_queue::bytes(queue_size);
+		}
 
 		/**
 		 * Return capability to packet-stream channel
@@ -48,6 +87,14 @@ class File_system::Session_rpc_object : public Genode::Rpc_object<Session, Sessi
 		 */
 		Genode::Capability<Tx> _tx_cap() { return _tx.cap(); }
 
+		/**
+		 * Return size of the packet-descriptor queues applied by the server
+		 *
+		 * This method is called by the client via an RPC call at session
+		 * construction time.
+		 */
+		unsigned _queue_size() { return _tx_queue_size; }
+
 		Tx::Sink *tx_sink() { return _tx.sink(); }
 
 		/**
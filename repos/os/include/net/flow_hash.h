@@ -0,0 +1,149 @@
+/*
+ * \brief  Hash of the flow an Ethernet frame belongs to
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The hash is used to distribute the frames of a multi-queue NIC or Uplink
+ * session among the queue pairs such that all frames of a flow take the
+ * same queue pair and thereby stay in order. For IPv4 frames, the hash
+ * covers the addresses, the protocol, and - for unfragmented TCP and UDP
+ * packets - the ports. The hash is symmetric, so both directions of a
+ * connection share a queue pair. All other frames have the hash 0.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _NET__FLOW_HASH_H_
+#define _NET__FLOW_HASH_H_
+
+/* Genode includes */
+#include <net/ethernet.h>
+#include <net/ipv4.h>
+
+namespace Net { class Flow_hash; }
+
+
+class Net::Flow_hash
+{
+	private:
+
+		Genode::uint32_t _value;
+
+		struct Fnv
+		{
+			Genode::uint32_t value = 2166136261u;
+
+			void add(Genode::uint8_t const *bytes, Genode::size_t len)
+			{
+				for (Genode::size_t i = 0; i < len; i++)
+					value = (value ^ bytes[i]) * 16777619u;
+			}
+		};
+
+		static bool _less(Genode::uint8_t const *a, Genode::uint8_t const *b,
+		                  Genode::size_t len)
+		{
+			for (Genode::size_t i = 0; i < len; i++)
+				if (a[i] != b[i])
+					return a[i] < b[i];
+			return false;
+		}
+
+	public:
+
+		explicit Flow_hash(Genode::uint32_t value) : _value(value) { }
+
+		/**
+		 * Constructor
+		 *
+		 * \param src_port  source port in network byte order, 0 if unknown
+		 * \param dst_port  destination port in network byte order, 0 if unknown
+		 */
+		Flow_hash(Ipv4_address const &src, Ipv4_address const &dst,
+		          Genode::uint8_t protocol,
+		          Genode::uint16_t src_port, Genode::uint16_t dst_port)
+		:
+			_value(0)
+		{
+			struct Endpoint
+			{
+				Genode::uint8_t bytes[IPV4_ADDR_LEN + 2];
+
+				Endpoint(Ipv4_address const &addr, Genode::uint16_t port)
+				{
+					Genode::memcpy(bytes, addr.addr, IPV4_ADDR_LEN);
+					Genode::memcpy(bytes + IPV4_ADDR_LEN, &port, 2);
+				}
+			};
+
+			Endpoint const a(src, src_port), b(dst, dst_port);
+			bool const swap = _less(b.bytes, a.bytes, sizeof(a.bytes));
+
+			Fnv fnv { };
+			fnv.add((swap ? b : a).bytes, sizeof(a.bytes));
+			fnv.add((swap ? a : b).bytes, sizeof(b.bytes));
+			fnv.add(&protocol, 1);
+
+			/* fold the upper bits into the lower ones used for the queue index */
+			_value = fnv.value ^ (fnv.value >> 16);
+		}
+
+		/**
+		 * Calculate hash of the Ethernet frame at 'base'
+		 */
+		static Flow_hash of_frame(void const *base, Genode::size_t size)
+		{
+			enum { IPV4_MIN_HEADER = 20, IPV4_FRAGMENT = 6 };
+
+			Genode::uint8_t const *bytes = (Genode::uint8_t const *)base;
+
+			if (size < sizeof(Ethernet_frame) + IPV4_MIN_HEADER)
+				return Flow_hash(0);
+
+			Ethernet_frame const &eth = *(Ethernet_frame const *)base;
+			if (eth.type() != Ethernet_frame::Type::IPV4)
+				return Flow_hash(0);
+
+			bytes += sizeof(Ethernet_frame);
+			size  -= sizeof(Ethernet_frame);
+
+			Ipv4_packet const &ip = *(Ipv4_packet const *)bytes;
+			Genode::size_t const header_size = ip.header_length() * 4;
+			if (header_size < IPV4_MIN_HEADER || header_size > size)
+				return Flow_hash(0);
+
+			Genode::uint8_t const protocol = (Genode::uint8_t)ip.protocol();
+
+			/* fragments lack the ports except for the first one */
+			bool const fragment = (bytes[IPV4_FRAGMENT]     & 0x3f)
+			                    ||  bytes[IPV4_FRAGMENT + 1];
+
+			bool const with_ports = !fragment && size >= header_size + 4
+			                     && (ip.protocol() == Ipv4_packet::Protocol::TCP ||
+			                         ip.protocol() == Ipv4_packet::Protocol::UDP);
+
+			Genode::uint16_t src_port = 0, dst_port = 0;
+			if (with_ports) {
+				Genode::memcpy(&src_port, bytes + header_size,     2);
+				Genode::memcpy(&dst_port, bytes + header_size + 2, 2);
+			}
+			return Flow_hash(ip.src(), ip.dst(), protocol, src_port, dst_port);
+		}
+
+		Genode::uint32_t value() const { return _value; }
+
+		/**
+		 * Return queue pair of the flow for a session with 'queues' queue pairs
+		 */
+		unsigned queue(unsigned queues) const
+		{
+			return queues > 1 ? _value % queues : 0;
+		}
+};
+
+#endif /* _NET__FLOW_HASH_H_ */
@@ -34,6 +34,29 @@ class Nic::Communication_buffers
 		Nic::Packet_allocator          _rx_packet_alloc;
 		Genode::Attached_ram_dataspace _tx_ds, _rx_ds;
 
+		/**
+		 * Buffers of an additional queue pair
+		 */
+		struct Queue_buffers
+		{
+			Nic::Packet_allocator          rx_packet_alloc;
+			Genode::Attached_ram_dataspace tx_ds, rx_ds;
+
+			Queue_buffers(Genode::Allocator      &rx_block_md_alloc,
+			              Genode::Ram_allocator  &ram,
+			              Genode::Region_map     &region_map,
+			              Genode::size_t          tx_size,
+			              Genode::size_t          rx_size,
+			              Genode::Cache_attribute cache_policy)
+			:
+				rx_packet_alloc(&rx_block_md_alloc),
+				tx_ds(ram, region_map, tx_size, cache_policy),
+				rx_ds(ram, region_map, rx_size, cache_policy)
+			{ }
+		};
+
+		Genode::Constructible<Queue_buffers> _queue_buffers[Session::MAX_QUEUES - 1] { };
+
 		Communication_buffers(Genode::Allocator      &rx_block_md_alloc,
 		                      Genode::Ram_allocator  &ram,
 		                      Genode::Region_map     &region_map,
@@ -79,6 +102,33 @@ class Nic::Session_component : Communication_buffers, public Session_rpc_object
 		using Communication_buffers::_tx_ds;
 		using Communication_buffers::_rx_ds;
 
+		void _construct_queues(unsigned                queues,
+		                       Genode::size_t const    tx_buf_size,
+		                       Genode::size_t const    rx_buf_size,
+		                       Genode::Cache_attribute cache_policy,
+		                       Genode::Allocator      &rx_block_md_alloc,
+		                       Genode::Env            &env)
+		{
+			queues = Genode::min(Genode::max(queues, 1U), (unsigned)MAX_QUEUES);
+
+			for (unsigned i = 1; i < queues; i++) {
+				_queue_buffers[i - 1].construct(rx_block_md_alloc, env.ram(),
+				                                env.rm(), tx_buf_size,
+				                                rx_buf_size, cache_policy);
+				Queue_buffers &buffers = *_queue_buffers[i - 1];
+				_add_queue(env.rm(), buffers.tx_ds.cap(), buffers.rx_ds.cap(),
+				           buffers.rx_packet_alloc, _ep.rpc_ep());
+			}
+
+			/* install data-flow signal handlers for all packet streams */
+			for (unsigned i = 0; i < _num_queues; i++) {
+				_tx_queue(i).sigh_ready_to_ack(_packet_stream_dispatcher);
+				_tx_queue(i).sigh_packet_avail(_packet_stream_dispatcher);
+				_rx_queue(i).sigh_ready_to_submit(_packet_stream_dispatcher);
+				_rx_queue(i).sigh_ack_avail(_packet_stream_dispatcher);
+			}
+		}
+
 	public:
 
 		/**
@@ -91,12 +141,15 @@ class Nic::Session_component : Communication_buffers, public Session_rpc_object
 		 * \param env                Genode environment needed to access
 		 *                           resources and open connections from
 		 *                           within the Session_component
+		 * \param queues             number of queue pairs, each with
+		 *                           buffers of the given sizes
 		 */
 		Session_component(Genode::size_t const    tx_buf_size,
 		                  Genode::size_t const    rx_buf_size,
 		                  Genode::Cache_attribute cache_policy,
 		                  Genode::Allocator      &rx_block_md_alloc,
-		                  Genode::Env            &env)
+		                  Genode::Env            &env,
+		                  unsigned                queues = 1)
 		:
 			Communication_buffers(rx_block_md_alloc, env.ram(), env.rm(),
 			                      tx_buf_size, rx_buf_size, cache_policy),
@@ -106,11 +159,8 @@ class Nic::Session_component : Communication_buffers, public Session_rpc_object
 			                  &_rx_packet_alloc, env.ep().rpc_ep()),
 			_ep(env.ep())
 		{
-			/* install data-flow signal handlers for both packet streams */
-			_tx.sigh_ready_to_ack(_packet_stream_dispatcher);
-			_tx.sigh_packet_avail(_packet_stream_dispatcher);
-			_rx.sigh_ready_to_submit(_packet_stream_dispatcher);
-			_rx.sigh_ack_avail(_packet_stream_dispatcher);
+			_construct_queues(queues, tx_buf_size, rx_buf_size, cache_policy,
+			                  rx_block_md_alloc, env);
 		}
 
 		/**
@@ -124,13 +174,16 @@ class Nic::Session_component : Communication_buffers, public Session_rpc_object
 		 *                           resources and open connections from
 		 *                           within the Session_component
 		 * \param ep                 entrypoint for RPC
+		 * \param queues             number of queue pairs, each with
+		 *                           buffers of the given sizes
 		 */
 		Session_component(Genode::size_t const    tx_buf_size,
 		                  Genode::size_t const    rx_buf_size,
 		                  Genode::Cache_attribute cache_policy,
 		                  Genode::Allocator      &rx_block_md_alloc,
 		                  Genode::Env            &env,
-		                  Genode::Entrypoint     &ep)
+		                  Genode::Entrypoint     &ep,
+		                  unsigned                queues = 1)
 		:
 			Communication_buffers(rx_block_md_alloc, env.ram(), env.rm(),
 			                      tx_buf_size, rx_buf_size, cache_policy),
@@ -140,11 +193,8 @@ class Nic::Session_component : Communication_buffers, public Session_rpc_object
 			                  &_rx_packet_alloc, ep.rpc_ep()),
 			                  _ep(ep)
 		{
-			/* install data-flow signal handlers for both packet streams */
-			_tx.sigh_ready_to_ack(_packet_stream_dispatcher);
-			_tx.sigh_packet_avail(_packet_stream_dispatcher);
-			_rx.sigh_ready_to_submit(_packet_stream_dispatcher);
-			_rx.sigh_ack_avail(_packet_stream_dispatcher);
+			_construct_queues(queues, tx_buf_size, rx_buf_size, cache_policy,
+			                  rx_block_md_alloc, env);
 		}
 
 		void link_state_sigh(Genode::Signal_context_capability sigh) override
@@ -28,12 +28,25 @@ template <class SESSION_COMPONENT>
 class Nic::Root : public Genode::Root_component<SESSION_COMPONENT,
                                                 Genode::Single_client>
 {
-	private:
+	protected:
 
 		Env       &_env;
 		Allocator &_md_alloc;
 
-	protected:
+		/**
+		 * Create session component with the given number of queue pairs
+		 *
+		 * The default implementation provides a single queue pair. Session
+		 * components that support multiple queue pairs override this method.
+		 */
+		virtual SESSION_COMPONENT *_create_queued_session(size_t   tx_buf_size,
+		                                                  size_t   rx_buf_size,
+		                                                  unsigned /* queues */)
+		{
+			return new (Root::md_alloc())
+			            SESSION_COMPONENT(tx_buf_size, rx_buf_size,
+			                             _md_alloc, _env);
+		}
 
 		SESSION_COMPONENT *_create_session(const char *args) override
 		{
@@ -42,6 +55,9 @@ class Nic::Root : public Genode::Root_component<SESSION_COMPONENT,
 			size_t ram_quota   = Arg_string::find_arg(args, "ram_quota"  ).ulong_value(0);
 			size_t tx_buf_size = Arg_string::find_arg(args, "tx_buf_size").ulong_value(0);
 			size_t rx_buf_size = Arg_string::find_arg(args, "rx_buf_size").ulong_value(0);
+			unsigned queues    = Arg_string::find_arg(args, "queues"     ).ulong_value(1);
+
+			queues = min(max(queues, 1U), (unsigned)Session::MAX_QUEUES);
 
 			/* deplete ram quota by the memory needed for the session structure */
 			size_t session_size = max(4096UL, (unsigned long)sizeof(SESSION_COMPONENT));
@@ -49,19 +65,19 @@ class Nic::Root : public Genode::Root_component<SESSION_COMPONENT,
 				throw Genode::Insufficient_ram_quota();
 
 			/*
-			 * Check if donated ram quota suffices for both communication
-			 * buffers and check for overflow
+			 * Check if donated ram quota suffices for the communication
+			 * buffers of all queue pairs and check for overflow
 			 */
-			if (tx_buf_size + rx_buf_size < tx_buf_size ||
-			    tx_buf_size + rx_buf_size > ram_quota - session_size) {
+			size_t const buf_size = tx_buf_size + rx_buf_size;
+			if (buf_size < tx_buf_size ||
+			    buf_size * queues / queues != buf_size ||
+			    buf_size * queues > ram_quota - session_size) {
 				Genode::error("insufficient 'ram_quota', got ", ram_quota, ", "
-				              "need ", tx_buf_size + rx_buf_size + session_size);
+				              "need ", buf_size * queues + session_size);
 				throw Genode::Insufficient_ram_quota();
 			}
 
-			return new (Root::md_alloc())
-			            SESSION_COMPONENT(tx_buf_size, rx_buf_size,
-			                             _md_alloc, _env);
+			return _create_queued_session(tx_buf_size, rx_buf_size, queues);
 		}
 
 	public:
@@ -30,19 +30,23 @@ struct Nic::Connection : Genode::Connection<Session>, Session_client
 	 *                         transmission buffer
 	 * \param tx_buf_size      size of transmission buffer in bytes
 	 * \param rx_buf_size      size of reception buffer in bytes
+	 * \param queues           number of requested queue pairs, each
+	 *                         queue pair has buffers of the given sizes
 	 */
 	Connection(Genode::Env             &env,
 	           Genode::Range_allocator *tx_block_alloc,
 	           Genode::size_t           tx_buf_size,
 	           Genode::size_t           rx_buf_size,
-	           char const              *label = "")
+	           char const              *label = "",
+	           unsigned                 queues = 1)
 	:
 		Genode::Connection<Session>(env,
 			session(env.parent(),
 			        "ram_quota=%ld, cap_quota=%ld, "
-			        "tx_buf_size=%ld, rx_buf_size=%ld, label=\"%s\"",
-			        32*1024*sizeof(long) + tx_buf_size + rx_buf_size,
-			        CAP_QUOTA, tx_buf_size, rx_buf_size, label)),
+			        "tx_buf_size=%ld, rx_buf_size=%ld, queues=%u, label=\"%s\"",
+			        32*1024*sizeof(long) + queues*(tx_buf_size + rx_buf_size),
+			        CAP_QUOTA + (queues - 1)*QUEUE_CAP_QUOTA,
+			        tx_buf_size, rx_buf_size, queues, label)),
 		Session_client(cap(), *tx_block_alloc, env.rm())
 	{ }
 };
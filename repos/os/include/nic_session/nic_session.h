@@ -49,10 +49,17 @@ namespace Nic {
  * interface via a pointer to the abstract 'Session' class. This way, we can
  * transparently co-locate the packet-stream server with the client in same
  * program.
+ *
+ * A session may carry up to 'MAX_QUEUES' pairs of tx and rx channels. The
+ * client requests the number of queue pairs with the 'queues' session
+ * argument. Queue pair 0 is formed by the regular 'tx' and 'rx' channels,
+ * the channels of the additional queue pairs are obtained via
+ * 'Queue_client'. Packets of one flow should be transmitted via the same
+ * queue pair (see 'Net::Flow_hash').
  */
 struct Nic::Session : Genode::Session
 {
-	enum { QUEUE_SIZE = 1024 };
+	enum { QUEUE_SIZE = 1024, MAX_QUEUES = 8 };
 
 	/*
 	 * Types used by the client stub code and server implementation
@@ -79,6 +86,12 @@ struct Nic::Session : Genode::Session
 	 */
 	enum { CAP_QUOTA = 8 };
 
+	/*
+	 * Each additional queue pair consumes two packet-stream dataspaces, two
+	 * packet-stream capabilities, and four signal context capabilities.
+	 */
+	enum { QUEUE_CAP_QUOTA = 8 };
+
 	virtual ~Session() { }
 
 	/**
@@ -116,6 +129,13 @@ struct Nic::Session : Genode::Session
 	 */
 	virtual void link_state_sigh(Genode::Signal_context_capability sigh) = 0;
 
+	/**
+	 * Return number of queue pairs provided by the session
+	 *
+	 * The server may provide fewer queue pairs than requested.
+	 */
+	virtual unsigned queues() { return 1; }
+
 	/*******************
 	 ** RPC interface **
 	 *******************/
@@ -123,12 +143,16 @@ struct Nic::Session : Genode::Session
 	GENODE_RPC(Rpc_mac_address, Mac_address, mac_address);
 	GENODE_RPC(Rpc_tx_cap, Genode::Capability<Tx>, _tx_cap);
 	GENODE_RPC(Rpc_rx_cap, Genode::Capability<Rx>, _rx_cap);
+	GENODE_RPC(Rpc_queue_tx_cap, Genode::Capability<Tx>, _queue_tx_cap, unsigned);
+	GENODE_RPC(Rpc_queue_rx_cap, Genode::Capability<Rx>, _queue_rx_cap, unsigned);
+	GENODE_RPC(Rpc_queues, unsigned, queues);
 	GENODE_RPC(Rpc_link_state, bool, link_state);
 	GENODE_RPC(Rpc_link_state_sigh, void, link_state_sigh,
 	           Genode::Signal_context_capability);
 
 	GENODE_RPC_INTERFACE(Rpc_mac_address, Rpc_link_state,
-	                     Rpc_link_state_sigh, Rpc_tx_cap, Rpc_rx_cap);
+	                     Rpc_link_state_sigh, Rpc_tx_cap, Rpc_rx_cap,
+	                     Rpc_queues, Rpc_queue_tx_cap, Rpc_queue_rx_cap);
 };
 
 #endif /* _INCLUDE__NIC_SESSION__NIC_SESSION_H_ */
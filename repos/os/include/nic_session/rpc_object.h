@@ -14,6 +14,7 @@
 #ifndef _INCLUDE__NIC_SESSION__RPC_OBJECT_H_
 #define _INCLUDE__NIC_SESSION__RPC_OBJECT_H_
 
+#include <util/reconstructible.h>
 #include <nic_session/nic_session.h>
 #include <packet_stream_tx/rpc_object.h>
 #include <packet_stream_rx/rpc_object.h>
@@ -28,6 +29,47 @@ class Nic::Session_rpc_object : public Genode::Rpc_object<Session, Session_rpc_o
 		Packet_stream_tx::Rpc_object<Tx> _tx;
 		Packet_stream_rx::Rpc_object<Rx> _rx;
 
+		/* channels of the queue pairs 1 ... 'MAX_QUEUES - 1' */
+		Genode::Constructible<Packet_stream_tx::Rpc_object<Tx>> _queue_tx[MAX_QUEUES - 1] { };
+		Genode::Constructible<Packet_stream_rx::Rpc_object<Rx>> _queue_rx[MAX_QUEUES - 1] { };
+
+		unsigned _num_queues { 1 };
+
+		/**
+		 * Add queue pair, queue pairs are numbered in the order of creation
+		 *
+		 * The request is ignored if the session has 'MAX_QUEUES' already.
+		 */
+		void _add_queue(Genode::Region_map           &rm,
+		                Genode::Dataspace_capability  tx_ds,
+		                Genode::Dataspace_capability  rx_ds,
+		                Genode::Range_allocator      &rx_buffer_alloc,
+		                Genode::Rpc_entrypoint       &ep)
+		{
+			if (_num_queues == MAX_QUEUES)
+				return;
+
+			_queue_tx[_num_queues - 1].construct(tx_ds, rm, ep);
+			_queue_rx[_num_queues - 1].construct(rx_ds, rm, rx_buffer_alloc, ep);
+			_num_queues++;
+		}
+
+		/**
+		 * Return tx channel of queue pair, 'queue' must be lower than 'queues()'
+		 */
+		Packet_stream_tx::Rpc_object<Tx> &_tx_queue(unsigned queue)
+		{
+			return queue ? *_queue_tx[queue - 1] : _tx;
+		}
+
+		/**
+		 * Return rx channel of queue pair, 'queue' must be lower than 'queues()'
+		 */
+		Packet_stream_rx::Rpc_object<Rx> &_rx_queue(unsigned queue)
+		{
+			return queue ? *_queue_rx[queue - 1] : _rx;
+		}
+
 	public:
 
 		/**
@@ -53,6 +95,18 @@ class Nic::Session_rpc_object : public Genode::Rpc_object<Session, Session_rpc_o
 
 		Genode::Capability<Tx> _tx_cap() { return _tx.cap(); }
 		Genode::Capability<Rx> _rx_cap() { return _rx.cap(); }
+
+		Genode::Capability<Tx> _queue_tx_cap(unsigned queue)
+		{
+			return queue < _num_queues ? _tx_queue(queue).cap() : Genode::Capability<Tx>();
+		}
+
+		Genode::Capability<Rx> _queue_rx_cap(unsigned queue)
+		{
+			return queue < _num_queues ? _rx_queue(queue).cap() : Genode::Capability<Rx>();
+		}
+
+		unsigned queues() override { return _num_queues; }
 };
 
 #endif /* _INCLUDE__NIC_SESSION__RPC_OBJECT_H_ */
@@ -48,6 +48,33 @@ class Genode::Buffered_xml
 			return allocation;
 		}
 
+		/**
+		 * Buffer that grows during the XML generation
+		 */
+		struct Buffer : Xml_generator::Expandable_buffer
+		{
+			Allocator &_alloc;
+
+			Allocation allocation;
+
+			Buffer(Allocator &alloc, size_t size)
+			:
+				_alloc(alloc), allocation { (char *)_alloc.alloc(size), size }
+			{ }
+
+			Range range() override { return { allocation.ptr, allocation.size }; }
+
+			void expand(size_t min_size) override
+			{
+				Allocation const expanded { (char *)_alloc.alloc(min_size), min_size };
+
+				Genode::memcpy(expanded.ptr, allocation.ptr, allocation.size);
+				_alloc.free(allocation.ptr, allocation.size);
+
+				allocation = expanded;
+			}
+		};
+
 		/**
 		 * Generate XML into allocated buffer
 		 *
@@ -56,22 +83,16 @@ class Genode::Buffered_xml
 		template <typename FN>
 		Allocation _generate(char const *node_name, FN const &fn, size_t size)
 		{
-			Allocation allocation { };
-
-			retry<Xml_generator::Buffer_exceeded>(
+			Buffer buffer { _alloc, size };
 
-				[&] () {
-					allocation = Allocation { (char *)_alloc.alloc(size), size };
-					Xml_generator xml(allocation.ptr, size, node_name,
-					                  [&] () { fn(xml); }); },
+			try {
+				Xml_generator xml(buffer, node_name, [&] () { fn(xml); }); }
+			catch (...) {
+				_alloc.free(buffer.allocation.ptr, buffer.allocation.size);
+				throw;
+			}
 
-				[&] () {
-					_alloc.free(allocation.ptr, allocation.size);
-					allocation = { };
-					size = size*2;
-				}
-			);
-			return allocation;
+			return buffer.allocation;
 		}
 
 		/*
@@ -155,6 +155,11 @@ class Genode::Packet_descriptor
 /**
  * Ring buffer shared between source and sink, containing packet descriptors
  *
+ * The 'QUEUE_SIZE' template argument denotes the maximum number of queue
+ * elements. The actual queue size is defined at construction time. Both
+ * source and sink must agree on the same queue size. Queue sizes are powers
+ * of two so that ring positions are obtained by masking.
+ *
  * This class is private to the packet-stream interface.
  */
 template <typename PACKET_DESCRIPTOR, int QUEUE_SIZE>
@@ -163,37 +168,91 @@ class Genode::Packet_descriptor_queue
 	private:
 
 		/*
-		 * The anonymous struct is needed to skip the initialization of the
-		 * members, which are shared by both sides of the packet stream.
+		 * Ring buffer located in the memory shared by both sides of the
+		 * packet stream. A queue smaller than 'QUEUE_SIZE' occupies only
+		 * the leading part of the 'queue' array.
 		 */
-		struct
+		struct Ring
 		{
-			unsigned volatile _head;
-			unsigned volatile _tail;
-			PACKET_DESCRIPTOR _queue[QUEUE_SIZE];
+			unsigned volatile head;
+			unsigned volatile tail;
+			PACKET_DESCRIPTOR queue[QUEUE_SIZE];
 		};
 
+		Ring &_ring;
+
+		/*
+		 * The queue size is kept locally because the shared memory may be
+		 * modified by the other side at any time.
+		 */
+		unsigned const _size;
+		unsigned const _mask = _size - 1;
+
+		static constexpr bool _power_of_two(unsigned size) {
+			return size && !(size & (size - 1)); }
+
+		static_assert(_power_of_two(QUEUE_SIZE),
+		              "packet-descriptor queue size must be a power of two");
+
 	public:
 
 		typedef PACKET_DESCRIPTOR Packet_descriptor;
 
 		enum Role { PRODUCER, CONSUMER };
 
+		/**
+		 * Return true if 'size' is a power of two within the queue bounds
+		 */
+		static bool valid_size(unsigned size)
+		{
+			return _power_of_two(size) && size >= 2 && size <= (unsigned)QUEUE_SIZE;
+		}
+
+		/**
+		 * Return effective queue size for the requested 'size'
+		 *
+		 * The size is limited to the queue bounds and rounded down to a
+		 * power of two.
+		 */
+		static unsigned size(unsigned size)
+		{
+			size = Genode::max(2U, Genode::min(size, (unsigned)QUEUE_SIZE));
+
+			while (!_power_of_two(size))
+				size &= size - 1;
+
+			return size;
+		}
+
+		/**
+		 * Return number of bytes occupied by a queue of 'size' elements
+		 */
+		static Genode::size_t bytes(unsigned size)
+		{
+			return sizeof(Ring)
+			     - (QUEUE_SIZE - Packet_descriptor_queue::size(size))*sizeof(PACKET_DESCRIPTOR);
+		}
+
 		/**
 		 * Constructor
 		 *
-		 * Because the 'Packet_descriptor_queue' is constructed twice (at the
-		 * source and at the sink) inside a shared-memory block, the
-		 * constructor must know the role of the instance to initialize only
-		 * those members that are driven by the respective role.
+		 * \param ring  local address of the ring buffer in shared memory
+		 * \param size  number of queue elements
+		 *
+		 * Because the ring buffer is initialized twice (at the source and
+		 * at the sink), the constructor must know the role of the instance
+		 * to initialize only those members that are driven by the
+		 * respective role.
 		 */
-		Packet_descriptor_queue(Role role)
+		Packet_descriptor_queue(void *ring, Role role, unsigned size)
+		:
+			_ring(*(Ring *)ring), _size(Packet_descriptor_queue::size(size))
 		{
 			if (role == PRODUCER) {
-				_head = 0;
-				Genode::memset(_queue, 0, sizeof(_queue));
+				_ring.head = 0;
+				Genode::memset(_ring.queue, 0, _size*sizeof(PACKET_DESCRIPTOR));
 			} else
-				_tail = 0;
+				_ring.tail = 0;
 		}
 
 		/**
@@ -206,8 +265,8 @@ class Genode::Packet_descriptor_queue
 		{
 			if (full()) return false;
 
-			_queue[_head%QUEUE_SIZE] = packet;
-			_head = (_head + 1)%QUEUE_SIZE;
+			_ring.queue[_ring.head & _mask] = packet;
+			_ring.head = (_ring.head + 1) & _mask;
 			return true;
 		}
 
@@ -218,8 +277,8 @@ class Genode::Packet_descriptor_queue
 		 */
 		PACKET_DESCRIPTOR get()
 		{
-			PACKET_DESCRIPTOR packet = _queue[_tail%QUEUE_SIZE];
-			_tail = (_tail + 1)%QUEUE_SIZE;
+			PACKET_DESCRIPTOR packet = _ring.queue[_ring.tail & _mask];
+			_ring.tail = (_ring.tail + 1) & _mask;
 			return packet;
 		}
 
@@ -228,36 +287,35 @@ class Genode::Packet_descriptor_queue
 		 */
 		PACKET_DESCRIPTOR peek() const
 		{
-			return _queue[_tail%QUEUE_SIZE];
+			return _ring.queue[_ring.tail & _mask];
 		}
 
 		/**
 		 * Return true if packet-descriptor queue is empty
 		 */
-		bool empty() { return _tail == _head; }
+		bool empty() { return _ring.tail == _ring.head; }
 
 		/**
 		 * Return true if packet-descriptor queue is full
 		 */
-		bool full() { return (_head + 1)%QUEUE_SIZE == _tail; }
+		bool full() { return ((_ring.head + 1) & _mask) == _ring.tail; }
 
 		/**
 		 * Return true if a single element is stored in the queue
 		 */
-		bool single_element() { return (_tail + 1)%QUEUE_SIZE == _head; }
+		bool single_element() { return ((_ring.tail + 1) & _mask) == _ring.head; }
 
 
 		/**
 		 * Return true if a single slot is left to be put into the queue
 		 */
-		bool single_slot_free() { return (_head + 2)%QUEUE_SIZE == _tail; }
+		bool single_slot_free() { return ((_ring.head + 2) & _mask) == _ring.tail; }
 
 		/**
 		 * Return number of slots left to be put into the queue
 		 */
 		unsigned slots_free() {
-			return ((_tail > _head) ? _tail - _head
-			                        : QUEUE_SIZE - _head + _tail) - 1; }
+			return ((_ring.tail - _ring.head - 1) & _mask); }
 };
 
 
@@ -280,7 +338,7 @@ class Genode::Packet_descriptor_transmitter
 		Genode::Signal_transmitter         _rx_ready { };
 
 		Genode::Mutex  _tx_queue_mutex { };
-		TX_QUEUE      *_tx_queue;
+		TX_QUEUE       _tx_queue;
 		bool           _tx_wakeup_needed = false;
 
 		/*
@@ -294,7 +352,7 @@ class Genode::Packet_descriptor_transmitter
 		/**
 		 * Constructor
 		 */
-		Packet_descriptor_transmitter(TX_QUEUE *tx_queue)
+		Packet_descriptor_transmitter(TX_QUEUE const &tx_queue)
 		:
 			_tx_ready_cap(_tx_ready.manage(&_tx_ready_context)),
 			_tx_queue(tx_queue)
@@ -319,14 +377,14 @@ class Genode::Packet_descriptor_transmitter
 			 * before a signal handler was registered,
 			 * a signal has to be send again
 			 */
-			if (!_tx_queue->empty())
+			if (!_tx_queue.empty())
 				_rx_ready.submit();
 		}
 
 		bool ready_for_tx()
 		{
 			Genode::Mutex::Guard mutex_guard(_tx_queue_mutex);
-			return !_tx_queue->full();
+			return !_tx_queue.full();
 		}
 
 		void tx(typename TX_QUEUE::Packet_descriptor packet)
@@ -335,7 +393,7 @@ class Genode::Packet_descriptor_transmitter
 
 			do {
 				/* block for signal if tx queue is full */
-				if (_tx_queue->full())
+				if (_tx_queue.full())
 					_tx_ready.wait_for_signal();
 
 				/*
@@ -344,9 +402,9 @@ class Genode::Packet_descriptor_transmitter
 				 * if the queue insertion succeeds and retry if needed.
 				 */
 
-			} while (_tx_queue->add(packet) == false);
+			} while (_tx_queue.add(packet) == false);
 
-			if (_tx_queue->single_element())
+			if (_tx_queue.single_element())
 				_rx_ready.submit();
 		}
 
@@ -354,12 +412,12 @@ class Genode::Packet_descriptor_transmitter
 		{
 			Genode::Mutex::Guard mutex_guard(_tx_queue_mutex);
 
-			if (_tx_queue->full())
+			if (_tx_queue.full())
 				return false;
 
-			_tx_queue->add(packet);
+			_tx_queue.add(packet);
 
-			if (_tx_queue->single_element())
+			if (_tx_queue.single_element())
 				_tx_wakeup_needed = true;
 
 			return true;
@@ -383,7 +441,7 @@ class Genode::Packet_descriptor_transmitter
 		/**
 		 * Return number of slots left to be put into the tx queue
 		 */
-		unsigned tx_slots_free() { return _tx_queue->slots_free(); }
+		unsigned tx_slots_free() { return _tx_queue.slots_free(); }
 };
 
 
@@ -406,7 +464,7 @@ class Genode::Packet_descriptor_receiver
 		Genode::Signal_transmitter        _tx_ready { };
 
 		Genode::Mutex mutable  _rx_queue_mutex { };
-		RX_QUEUE              *_rx_queue;
+		RX_QUEUE               _rx_queue;
 		bool                   _rx_wakeup_needed = false;
 
 		/*
@@ -420,7 +478,7 @@ class Genode::Packet_descriptor_receiver
 		/**
 		 * Constructor
 		 */
-		Packet_descriptor_receiver(RX_QUEUE *rx_queue)
+		Packet_descriptor_receiver(RX_QUEUE const &rx_queue)
 		:
 			_rx_ready_cap(_rx_ready.manage(&_rx_ready_context)),
 			_rx_queue(rx_queue)
@@ -445,26 +503,26 @@ class Genode::Packet_descriptor_receiver
 			 * before a signal handler was registered,
 			 * a signal has to be send again
 			 */
-			if (!_rx_queue->empty())
+			if (!_rx_queue.empty())
 				_tx_ready.submit();
 		}
 
 		bool ready_for_rx()
 		{
 			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
-			return !_rx_queue->empty();
+			return !_rx_queue.empty();
 		}
 
 		void rx(typename RX_QUEUE::Packet_descriptor *out_packet)
 		{
 			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
 
-			while (_rx_queue->empty())
+			while (_rx_queue.empty())
 				_rx_ready.wait_for_signal();
 
-			*out_packet = _rx_queue->get();
+			*out_packet = _rx_queue.get();
 
-			if (_rx_queue->single_slot_free())
+			if (_rx_queue.single_slot_free())
 				_tx_ready.submit();
 		}
 
@@ -474,10 +532,10 @@ class Genode::Packet_descriptor_receiver
 
 			typename RX_QUEUE::Packet_descriptor packet { };
 
-			if (!_rx_queue->empty())
-				packet = _rx_queue->get();
+			if (!_rx_queue.empty())
+				packet = _rx_queue.get();
 
-			if (_rx_queue->single_slot_free())
+			if (_rx_queue.single_slot_free())
 				_rx_wakeup_needed = true;
 
 			return packet;
@@ -502,7 +560,7 @@ class Genode::Packet_descriptor_receiver
 		typename RX_QUEUE::Packet_descriptor rx_peek() const
 		{
 			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
-			return _rx_queue->peek();
+			return _rx_queue.peek();
 		}
 };
 
@@ -682,6 +740,9 @@ class Genode::Packet_stream_source : private Packet_stream_base
 		 * \param rm            region to map buffer dataspace into
 		 * \param packet_alloc  allocator for managing packet allocation within
 		 *                      the shared communication buffer
+		 * \param queue_size    number of elements of the submit and
+		 *                      acknowledgement queues, limited by the
+		 *                      queue sizes of the 'POLICY'
 		 *
 		 * The 'packet_alloc' must not be pre-initialized. It will be
 		 * initialized by the constructor using dataspace-relative offsets
@@ -689,18 +750,19 @@ class Genode::Packet_stream_source : private Packet_stream_base
 		 */
 		Packet_stream_source(Genode::Dataspace_capability  transport_ds_cap,
 		                     Genode::Region_map           &rm,
-		                     Genode::Range_allocator      &packet_alloc)
+		                     Genode::Range_allocator      &packet_alloc,
+		                     unsigned                      queue_size = ~0U)
 		:
 			Packet_stream_base(transport_ds_cap, rm,
-			                   sizeof(Submit_queue),
-			                   sizeof(Ack_queue)),
+			                   Submit_queue::bytes(queue_size),
+			                   Ack_queue::bytes(queue_size)),
 			_packet_alloc(packet_alloc),
 
 			/* construct packet-descriptor queues */
-			_submit_transmitter(construct_at<Submit_queue>(_submit_queue_local_base(),
-			                                               Submit_queue::PRODUCER)),
-			_ack_receiver(construct_at<Ack_queue>(_ack_queue_local_base(),
-			                                      Ack_queue::CONSUMER))
+			_submit_transmitter(Submit_queue(_submit_queue_local_base(),
+			                                 Submit_queue::PRODUCER, queue_size)),
+			_ack_receiver(Ack_queue(_ack_queue_local_base(),
+			                        Ack_queue::CONSUMER, queue_size))
 		{
 			/* initialize packet allocator */
 			_packet_alloc.add_range(_bulk_buffer_offset,
@@ -893,17 +955,23 @@ class Genode::Packet_stream_sink : private Packet_stream_base
 		 *
 		 * \param transport_ds  dataspace used for communication buffer shared between
 		 *                      source and sink
+		 * \param queue_size    number of elements of the submit and
+		 *                      acknowledgement queues, must correspond to
+		 *                      the queue size used by the source
 		 */
 		Packet_stream_sink(Genode::Dataspace_capability transport_ds,
-		                   Genode::Region_map &rm)
+		                   Genode::Region_map &rm,
+		                   unsigned queue_size = ~0U)
 		:
-			Packet_stream_base(transport_ds, rm, sizeof(Submit_queue), sizeof(Ack_queue)),
+			Packet_stream_base(transport_ds, rm,
+			                   Submit_queue::bytes(queue_size),
+			                   Ack_queue::bytes(queue_size)),
 
 			/* construct packet-descriptor queues */
-			_submit_receiver(construct_at<Submit_queue>(_submit_queue_local_base(),
-			                                            Submit_queue::CONSUMER)),
-			_ack_transmitter(construct_at<Ack_queue>(_ack_queue_local_base(),
-			                                         Ack_queue::PRODUCER))
+			_submit_receiver(Submit_queue(_submit_queue_local_base(),
+			                              Submit_queue::CONSUMER, queue_size)),
+			_ack_transmitter(Ack_queue(_ack_queue_local_base(),
+			                           Ack_queue::PRODUCER, queue_size))
 		{ }
 
 		using Packet_stream_base::packet_valid;
@@ -18,6 +18,7 @@
 #include <util/xml_node.h>
 #include <util/reconstructible.h>
 #include <base/attached_dataspace.h>
+#include <base/heap.h>
 #include <report_session/connection.h>
 #include <util/xml_generator.h>
 
@@ -35,6 +36,8 @@ class Genode::Reporter
 
 	private:
 
+		friend class Expanding_reporter;
+
 		Env &_env;
 
 		Name const _xml_name;
@@ -135,6 +138,18 @@ class Genode::Reporter
 				if (reporter.enabled())
 					reporter._conn->report.submit(used());
 			}
+
+			/**
+			 * Constructor for generating XML into an expandable buffer
+			 *
+			 * The caller is responsible for submitting the report.
+			 */
+			template <typename FUNC>
+			Xml_generator(Expandable_buffer &buffer, char const *name,
+			              FUNC const &func)
+			:
+				Genode::Xml_generator(buffer, name, func)
+			{ }
 		};
 };
 
@@ -169,16 +184,79 @@ class Genode::Expanding_reporter
 
 		size_t _buffer_size;
 
+		/*
+		 * Backing store for reports that exceed the report buffer
+		 */
+		Sliced_heap _overflow_alloc { _env.ram(), _env.rm() };
+
+		/**
+		 * Output buffer of the XML generator
+		 *
+		 * The XML is generated directly into the report buffer. Once the
+		 * report exceeds the report buffer, the generation continues in a
+		 * buffer allocated from '_overflow_alloc'. So the generator function
+		 * is executed only once, regardless of the report size.
+		 */
+		struct Buffer : Genode::Xml_generator::Expandable_buffer
+		{
+			Reporter  &_reporter;
+			Allocator &_alloc;
+
+			Range _overflow { nullptr, 0 };
+
+			/*
+			 * Noncopyable
+			 */
+			Buffer(Buffer const &);
+			Buffer &operator = (Buffer const &);
+
+			Buffer(Reporter &reporter, Allocator &alloc)
+			: _reporter(reporter), _alloc(alloc) { }
+
+			~Buffer()
+			{
+				if (overflown())
+					_alloc.free(_overflow.start, _overflow.num_bytes);
+			}
+
+			bool overflown() const { return _overflow.start != nullptr; }
+
+			Range range() override
+			{
+				return overflown() ? _overflow
+				                   : Range { _reporter._base(), _reporter._size() };
+			}
+
+			void expand(size_t min_size) override
+			{
+				Range const current  = range();
+				Range const expanded { (char *)_alloc.alloc(min_size), min_size };
+
+				memcpy(expanded.start, current.start, current.num_bytes);
+
+				if (overflown())
+					_alloc.free(_overflow.start, _overflow.num_bytes);
+
+				_overflow = expanded;
+			}
+		};
+
 		void _construct()
 		{
 			_reporter.construct(_env, _type.string(), _label.string(), _buffer_size);
 			_reporter->enabled(true);
 		}
 
-		void _increase_report_buffer()
+		/**
+		 * Report data, increasing the report buffer if needed
+		 */
+		void _report(char const *start, size_t length)
 		{
-			_buffer_size += 4096;
-			_construct();
+			if (length > _buffer_size) {
+				_buffer_size = align_addr(length, 12);
+				_construct();
+			}
+			_reporter->report(start, length);
 		}
 
 	public:
@@ -191,26 +269,25 @@ class Genode::Expanding_reporter
 		template <typename FN>
 		void generate(FN const &fn)
 		{
-			retry<Xml_generator::Buffer_exceeded>(
+			Buffer buffer { *_reporter, _overflow_alloc };
 
-				[&] () {
-					Reporter::Xml_generator
-						xml(*_reporter, [&] () { fn(xml); }); },
+			size_t used = 0;
+			{
+				Reporter::Xml_generator xml(buffer, _type.string(),
+				                            [&] () { fn(xml); });
+				used = xml.used();
+			}
 
-				[&] () { _increase_report_buffer(); }
-			);
+			if (buffer.overflown())
+				_report(buffer.range().start, used);
+			else
+				_reporter->_conn->report.submit(used);
 		}
 
 		void generate(Xml_node node)
 		{
-			retry<Xml_generator::Buffer_exceeded>(
-
-				[&] () {
-					node.with_raw_node([&] (char const *start, size_t length) {
-						_reporter->report(start, length); }); },
-
-				[&] () { _increase_report_buffer(); }
-			);
+			node.with_raw_node([&] (char const *start, size_t length) {
+				_report(start, length); });
 		}
 };
 
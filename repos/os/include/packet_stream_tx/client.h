@@ -50,10 +50,12 @@ class Packet_stream_tx::Client : public Genode::Rpc_client<CHANNEL>
 		 */
 		Client(Genode::Capability<CHANNEL> channel_cap,
 		       Genode::Region_map &rm,
-		       Genode::Range_allocator &buffer_alloc)
+		       Genode::Range_allocator &buffer_alloc,
+		       unsigned queue_size = ~0U)
 		:
 			Genode::Rpc_client<CHANNEL>(channel_cap),
-			_source(Base::template call<Rpc_dataspace>(), rm, buffer_alloc)
+			_source(Base::template call<Rpc_dataspace>(), rm, buffer_alloc,
+			        queue_size)
 		{
 			/* wire data-flow signals for the packet transmitter */
 			_source.register_sigh_packet_avail(Base::template call<Rpc_packet_avail>());
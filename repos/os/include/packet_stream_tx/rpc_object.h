@@ -41,12 +41,15 @@ class Packet_stream_tx::Rpc_object : public Genode::Rpc_object<CHANNEL, Rpc_obje
 		 *            for the transmission packet stream
 		 * \param ep  entry point used for serving the channel's RPC
 		 *            interface
+		 * \param queue_size  number of elements of the packet-descriptor
+		 *                    queues, must match the client's queue size
 		 */
 		Rpc_object(Genode::Dataspace_capability ds,
 		           Genode::Region_map     &rm,
-		           Genode::Rpc_entrypoint &ep)
+		           Genode::Rpc_entrypoint &ep,
+		           unsigned                queue_size = ~0U)
 		:
-			_ep(ep), _sink(ds, rm),
+			_ep(ep), _sink(ds, rm, queue_size),
 
 			/* init signal handlers with default handlers of sink */
 			_sigh_ready_to_ack(_sink.sigh_ready_to_ack()),
@@ -0,0 +1,52 @@
+/*
+ * \brief  Trace event recorded by the 'rpc_affinity' policy module
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The events allow a trace client to correlate the RPC calls and signal
+ * submissions of one thread with the dispatching and reception of another
+ * thread by their time stamps and RPC names.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__TRACE__AFFINITY_EVENT_H_
+#define _INCLUDE__TRACE__AFFINITY_EVENT_H_
+
+#include <util/string.h>
+#include <trace/timestamp.h>
+
+namespace Genode { namespace Trace { struct Affinity_event; } }
+
+
+struct Genode::Trace::Affinity_event
+{
+	enum Type { INVALID, RPC_CALL, RPC_DISPATCH, SIGNAL_SUBMIT, SIGNAL_RECEIVE };
+
+	Timestamp timestamp;
+	uint32_t  name;       /* hash of the RPC name, 0 for signals */
+	uint32_t  type;
+
+	static uint32_t hash(char const *s)
+	{
+		/* FNV-1a */
+		uint32_t h = 2166136261u;
+		for (; s && *s; s++)
+			h = (h ^ (uint8_t)*s) * 16777619u;
+		return h;
+	}
+
+	static size_t generate(char *dst, Type type, char const *rpc_name)
+	{
+		Affinity_event const event { Trace::timestamp(), hash(rpc_name), type };
+		memcpy(dst, &event, sizeof(event));
+		return sizeof(event);
+	}
+};
+
+#endif /* _INCLUDE__TRACE__AFFINITY_EVENT_H_ */
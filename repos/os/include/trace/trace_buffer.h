@@ -5,14 +5,14 @@
  */
 
 /*
- * Copyright (C) 2018 Genode Labs GmbH
+ * Copyright (C) 2018-2021 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
  */
 
-#ifndef _TRACE_BUFFER_H_
-#define _TRACE_BUFFER_H_
+#ifndef _INCLUDE__TRACE__TRACE_BUFFER_H_
+#define _INCLUDE__TRACE__TRACE_BUFFER_H_
 
 /* Genode includes */
 #include <base/trace/buffer.h>
@@ -27,6 +27,7 @@ class Trace_buffer
 
 		Genode::Trace::Buffer        &_buffer;
 		Genode::Trace::Buffer::Entry  _curr          { _buffer.first() };
+		bool                          _processed     { false };
 		unsigned                      _wrapped_count { 0 };
 
 	public:
@@ -50,30 +51,28 @@ class Trace_buffer
 				_wrapped_count = _buffer.wrapped();
 			}
 
-			/* initialize _curr if _buffer was empty until now */
-			if (_curr.last())
-				_curr = _buffer.first();
+			/* continue after the entry processed last, which is in _curr */
+			Trace::Buffer::Entry e = _processed ? _buffer.next(_curr)
+			                                    : _buffer.first();
 
 			/* iterate over all entries that were not processed yet */
-			     Trace::Buffer::Entry e1 = _curr;
-			for (Trace::Buffer::Entry e2 = _curr; wrapped || !e2.last();
-			                          e2 = _buffer.next(e2))
+			for (; wrapped || !e.last(); e = _buffer.next(e))
 			{
 				/* if buffer wrapped, we pass the last entry once and continue at first entry */
-				if (wrapped && e2.last()) {
+				if (wrapped && e.last()) {
 					wrapped = false;
-					e2 = _buffer.first();
-					if (e2.last())
+					e = _buffer.first();
+					if (e.last())
 						break;
 				}
 
-				e1 = e2;
-				functor(e1);
+				functor(e);
+
+				_curr      = e;
+				_processed = true;
 			}
-			/* remember the last processed entry in _curr */
-			_curr = e1;
 		}
 };
 
 
-#endif /* _TRACE_BUFFER_H_ */
+#endif /* _INCLUDE__TRACE__TRACE_BUFFER_H_ */
@@ -20,7 +20,11 @@
 #include <packet_stream_tx/client.h>
 #include <packet_stream_rx/client.h>
 
-namespace Uplink { class Session_client; }
+namespace Uplink {
+
+	class Session_client;
+	class Queue_client;
+}
 
 
 class Uplink::Session_client : public Genode::Rpc_client<Session>
@@ -56,6 +60,52 @@ class Uplink::Session_client : public Genode::Rpc_client<Session>
 		Rx *rx_channel() override { return &_rx; }
 		Tx::Source *tx() override { return _tx.source(); }
 		Rx::Sink   *rx() override { return _rx.sink(); }
+
+		unsigned queues() override { return call<Rpc_queues>(); }
+
+		/**
+		 * Request capabilities of the channels of an additional queue pair
+		 *
+		 * \noapi
+		 */
+		Genode::Capability<Tx> queue_tx_cap(unsigned queue) { return call<Rpc_queue_tx_cap>(queue); }
+		Genode::Capability<Rx> queue_rx_cap(unsigned queue) { return call<Rpc_queue_rx_cap>(queue); }
+};
+
+
+/**
+ * Client-side packet-stream interfaces of an additional queue pair
+ */
+class Uplink::Queue_client
+{
+	private:
+
+		Packet_stream_tx::Client<Session::Tx> _tx;
+		Packet_stream_rx::Client<Session::Rx> _rx;
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param queue            index of queue pair, must be in the range
+		 *                         of 1 to 'session.queues() - 1'
+		 * \param tx_buffer_alloc  allocator used for managing the
+		 *                         transmission buffer of the queue pair
+		 */
+		Queue_client(Session_client          &session,
+		             unsigned                 queue,
+		             Genode::Range_allocator &tx_buffer_alloc,
+		             Genode::Region_map      &rm)
+		:
+			_tx(session.queue_tx_cap(queue), rm, tx_buffer_alloc),
+			_rx(session.queue_rx_cap(queue), rm)
+		{ }
+
+		Session::Tx *tx_channel() { return &_tx; }
+		Session::Rx *rx_channel() { return &_rx; }
+		Session::Tx::Source *tx() { return _tx.source(); }
+		Session::Rx::Sink   *rx() { return _rx.sink(); }
 };
 
 #endif /* _UPLINK_SESSION__CLIENT_H_ */
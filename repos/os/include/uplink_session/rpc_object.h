@@ -15,6 +15,7 @@
 #define _UPLINK_SESSION__RPC_OBJECT_H_
 
 /* Genode includes */
+#include <util/reconstructible.h>
 #include <uplink_session/uplink_session.h>
 #include <packet_stream_tx/rpc_object.h>
 #include <packet_stream_rx/rpc_object.h>
@@ -29,6 +30,47 @@ class Uplink::Session_rpc_object : public Genode::Rpc_object<Session, Session_rp
 		Packet_stream_tx::Rpc_object<Tx> _tx;
 		Packet_stream_rx::Rpc_object<Rx> _rx;
 
+		/* channels of the queue pairs 1 ... 'MAX_QUEUES - 1' */
+		Genode::Constructible<Packet_stream_tx::Rpc_object<Tx>> _queue_tx[MAX_QUEUES - 1] { };
+		Genode::Constructible<Packet_stream_rx::Rpc_object<Rx>> _queue_rx[MAX_QUEUES - 1] { };
+
+		unsigned _num_queues { 1 };
+
+		/**
+		 * Add queue pair, queue pairs are numbered in the order of creation
+		 *
+		 * The request is ignored if the session has 'MAX_QUEUES' already.
+		 */
+		void _add_queue(Genode::Region_map           &rm,
+		                Genode::Dataspace_capability  tx_ds,
+		                Genode::Dataspace_capability  rx_ds,
+		                Genode::Range_allocator      &rx_buffer_alloc,
+		                Genode::Rpc_entrypoint       &ep)
+		{
+			if (_num_queues == MAX_QUEUES)
+				return;
+
+			_queue_tx[_num_queues - 1].construct(tx_ds, rm, ep);
+			_queue_rx[_num_queues - 1].construct(rx_ds, rm, rx_buffer_alloc, ep);
+			_num_queues++;
+		}
+
+		/**
+		 * Return tx channel of queue pair, 'queue' must be lower than 'queues()'
+		 */
+		Packet_stream_tx::Rpc_object<Tx> &_tx_queue(unsigned queue)
+		{
+			return queue ? *_queue_tx[queue - 1] : _tx;
+		}
+
+		/**
+		 * Return rx channel of queue pair, 'queue' must be lower than 'queues()'
+		 */
+		Packet_stream_rx::Rpc_object<Rx> &_rx_queue(unsigned queue)
+		{
+			return queue ? *_queue_rx[queue - 1] : _rx;
+		}
+
 	public:
 
 		/**
@@ -54,6 +96,18 @@ class Uplink::Session_rpc_object : public Genode::Rpc_object<Session, Session_rp
 
 		Genode::Capability<Tx> _tx_cap() { return _tx.cap(); }
 		Genode::Capability<Rx> _rx_cap() { return _rx.cap(); }
+
+		Genode::Capability<Tx> _queue_tx_cap(unsigned queue)
+		{
+			return queue < _num_queues ? _tx_queue(queue).cap() : Genode::Capability<Tx>();
+		}
+
+		Genode::Capability<Rx> _queue_rx_cap(unsigned queue)
+		{
+			return queue < _num_queues ? _rx_queue(queue).cap() : Genode::Capability<Rx>();
+		}
+
+		unsigned queues() override { return _num_queues; }
 };
 
 #endif /* _UPLINK_SESSION__RPC_OBJECT_H_ */
@@ -44,10 +44,14 @@ namespace Uplink {
  * interface via a pointer to the abstract 'Session' class. This way, we can
  * transparently co-locate the packet-stream server with the client in same
  * program.
+ *
+ * Like a NIC session, an Uplink session may carry up to 'MAX_QUEUES' pairs
+ * of tx and rx channels as requested with the 'queues' session argument.
+ * Queue pair 0 is formed by the regular 'tx' and 'rx' channels.
  */
 struct Uplink::Session : Genode::Session
 {
-	enum { QUEUE_SIZE = 1024 };
+	enum { QUEUE_SIZE = 1024, MAX_QUEUES = 8 };
 
 	/*
 	 * Types used by the client stub code and server implementation
@@ -74,6 +78,12 @@ struct Uplink::Session : Genode::Session
 	 */
 	enum { CAP_QUOTA = 8 };
 
+	/*
+	 * Each additional queue pair consumes two packet-stream dataspaces, two
+	 * packet-stream capabilities, and four signal context capabilities.
+	 */
+	enum { QUEUE_CAP_QUOTA = 8 };
+
 	virtual ~Session() { }
 
 	/**
@@ -96,6 +106,11 @@ struct Uplink::Session : Genode::Session
 	 */
 	virtual Rx::Sink *rx() { return 0; }
 
+	/**
+	 * Return number of queue pairs provided by the session
+	 */
+	virtual unsigned queues() { return 1; }
+
 
 	/*******************
 	 ** RPC interface **
@@ -103,8 +118,12 @@ struct Uplink::Session : Genode::Session
 
 	GENODE_RPC(Rpc_tx_cap, Genode::Capability<Tx>, _tx_cap);
 	GENODE_RPC(Rpc_rx_cap, Genode::Capability<Rx>, _rx_cap);
+	GENODE_RPC(Rpc_queue_tx_cap, Genode::Capability<Tx>, _queue_tx_cap, unsigned);
+	GENODE_RPC(Rpc_queue_rx_cap, Genode::Capability<Rx>, _queue_rx_cap, unsigned);
+	GENODE_RPC(Rpc_queues, unsigned, queues);
 
-	GENODE_RPC_INTERFACE(Rpc_tx_cap, Rpc_rx_cap);
+	GENODE_RPC_INTERFACE(Rpc_tx_cap, Rpc_rx_cap, Rpc_queues,
+	                     Rpc_queue_tx_cap, Rpc_queue_rx_cap);
 };
 
 #endif /* _UPLINK_SESSION__UPLINK_SESSION_H_ */
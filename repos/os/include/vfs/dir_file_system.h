@@ -443,6 +443,21 @@ class Vfs::Dir_file_system : public File_system
 				fs->release(path, ds_cap);
 		}
 
+		bool dataspace_shared(char const *path) override
+		{
+			path = _sub_path(path);
+			if (!path)
+				return false;
+
+			/* the first file system that knows the file hands out its dataspace */
+			for (File_system *fs = _first_file_system; fs; fs = fs->next) {
+				Stat stat { };
+				if (fs->stat(path, stat) == STAT_OK)
+					return fs->dataspace_shared(path);
+			}
+			return false;
+		}
+
 		Stat_result stat(char const *path, Stat &out) override
 		{
 			path = _sub_path(path);
@@ -957,6 +972,38 @@ class Vfs::Dir_file_system : public File_system
 			return handle->fs().notify_read_ready(handle);
 		}
 
+		bool write_ready(Vfs_handle *handle) override
+		{
+			if (&handle->fs() == this)
+				return true;
+
+			return handle->fs().write_ready(handle);
+		}
+
+		bool notify_write_ready(Vfs_handle *handle) override
+		{
+			if (&handle->fs() == this)
+				return true;
+
+			return handle->fs().notify_write_ready(handle);
+		}
+
+		file_size read_available(Vfs_handle *handle) override
+		{
+			if (&handle->fs() == this)
+				return 0;
+
+			return handle->fs().read_available(handle);
+		}
+
+		file_size write_available(Vfs_handle *handle) override
+		{
+			if (&handle->fs() == this)
+				return 0;
+
+			return handle->fs().write_available(handle);
+		}
+
 		bool queue_sync(Vfs_handle *vfs_handle) override
 		{
 			bool result = true;
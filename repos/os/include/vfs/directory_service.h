@@ -30,6 +30,14 @@ struct Vfs::Directory_service : Interface
 	virtual Dataspace_capability dataspace(char const *path) = 0;
 	virtual void release(char const *path, Dataspace_capability) = 0;
 
+	/**
+	 * Return true if 'dataspace' hands out the backing store of the file
+	 *
+	 * File systems that hand out a copy of the file content, which must be
+	 * freed via 'release', keep the default.
+	 */
+	virtual bool dataspace_shared(char const *) { return false; }
+
 
 	enum General_error { ERR_FD_INVALID, NUM_GENERAL_ERRORS };
 
@@ -87,6 +87,35 @@ struct Vfs::File_io_service : Interface
 	 */
 	virtual bool notify_read_ready(Vfs_handle *) { return true; }
 
+	/**
+	 * Return true if data can be written to the handle without blocking
+	 */
+	virtual bool write_ready(Vfs_handle *) { return true; }
+
+	/**
+	 * Explicitly indicate interest in write-ready for a handle
+	 *
+	 * Once the handle becomes write-ready, an I/O-progress response is
+	 * delivered at the handle.
+	 *
+	 * \return false if notification setup failed
+	 */
+	virtual bool notify_write_ready(Vfs_handle *) { return true; }
+
+	/**
+	 * Return number of bytes that can be read without blocking
+	 *
+	 * \return 0 if the number is unknown
+	 */
+	virtual file_size read_available(Vfs_handle *) { return 0; }
+
+	/**
+	 * Return number of bytes that can be written without blocking
+	 *
+	 * \return 0 if the number is unknown
+	 */
+	virtual file_size write_available(Vfs_handle *) { return 0; }
+
 
 	/***************
 	 ** Ftruncate **
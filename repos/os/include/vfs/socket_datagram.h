@@ -0,0 +1,88 @@
+/*
+ * \brief  Record format of the "datagram" file of socket file systems
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * UDP sockets of a socket file system provide a "datagram" file besides the
+ * "data" and "remote" files. Each record of the file consists of a header
+ * followed by the payload of one datagram. So the peer address and the
+ * payload are transferred with one VFS operation.
+ *
+ * A write may contain any number of records, each sent as an individual
+ * datagram to the address given in its header. A read returns exactly one
+ * record carrying the source address of the datagram. If the payload does
+ * not fit into the read buffer, it is truncated and the remainder is
+ * discarded.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__VFS__SOCKET_DATAGRAM_H_
+#define _INCLUDE__VFS__SOCKET_DATAGRAM_H_
+
+/* Genode includes */
+#include <util/string.h>
+
+namespace Vfs { struct Socket_datagram; }
+
+
+struct Vfs::Socket_datagram
+{
+	/*
+	 * The address and port are stored in network byte order such that they
+	 * can be copied from and to 'sockaddr_in' as is.
+	 */
+	Genode::uint8_t  addr[4];
+	Genode::uint16_t port;
+	/*
+	 * Payload bytes following the header. For a record read from the file,
+	 * it is the size of the received datagram, which exceeds the payload
+	 * following the header if the datagram was truncated.
+	 */
+	Genode::uint16_t length;
+
+	/**
+	 * Call 'fn(Socket_datagram const &, char const *payload)' for each
+	 * complete record in buffer
+	 *
+	 * The records of the buffer are not necessarily aligned. The traversal
+	 * stops at the first incomplete record or if 'fn' returns false.
+	 *
+	 * \return  number of bytes of the processed records
+	 */
+	template <typename FN>
+	static Genode::size_t for_each_record(char const *src, Genode::size_t count,
+	                                      FN const &fn)
+	{
+		Genode::size_t consumed = 0;
+
+		while (count - consumed >= sizeof(Socket_datagram)) {
+
+			Socket_datagram header { };
+			Genode::memcpy(&header, src + consumed, sizeof(header));
+
+			Genode::size_t const size = sizeof(header) + header.length;
+			if (count - consumed < size)
+				break;
+
+			if (!fn(header, src + consumed + sizeof(header)))
+				break;
+
+			consumed += size;
+		}
+		return consumed;
+	}
+
+	/**
+	 * Write record header to the possibly unaligned buffer 'dst'
+	 */
+	void write_to(char *dst) const { Genode::memcpy(dst, this, sizeof(*this)); }
+
+} __attribute__((packed));
+
+#endif /* _INCLUDE__VFS__SOCKET_DATAGRAM_H_ */
@@ -19,6 +19,7 @@
 namespace Vfs{
 	struct Io_response_handler;
 	struct Watch_response_handler;
+	struct Handle_observer;
 	class Vfs_handle;
 	class Vfs_watch_handle;
 	class File_io_service;
@@ -60,6 +61,20 @@ struct Vfs::Watch_response_handler : Genode::Interface
 };
 
 
+/**
+ * Observer of the responses of an individual handle
+ *
+ * In contrast to the response handler, which is usually shared by all
+ * handles of an application, an observer is installed at a single handle.
+ * It is informed about each response of the handle before the response
+ * handler.
+ */
+struct Vfs::Handle_observer : Genode::Interface
+{
+	virtual void handle_response(Vfs_handle &) = 0;
+};
+
+
 class Vfs::Vfs_handle
 {
 	private:
@@ -67,7 +82,8 @@ class Vfs::Vfs_handle
 		Directory_service   &_ds;
 		File_io_service     &_fs;
 		Genode::Allocator   &_alloc;
-		Io_response_handler *_handler = nullptr;
+		Io_response_handler *_handler  = nullptr;
+		Handle_observer     *_observer = nullptr;
 		file_size            _seek = 0;
 		int                  _status_flags;
 
@@ -156,16 +172,29 @@ class Vfs::Vfs_handle
 			if (_handler) func(*_handler); }
 
 		/**
-		 * Notify application through response handler
+		 * Set observer of the handle's responses, unset with nullptr
 		 */
-		void read_ready_response() {
-			if (_handler) _handler->read_ready_response(); }
+		virtual void observer(Handle_observer *observer) { _observer = observer; }
+
+		Handle_observer *observer() const { return _observer; }
 
 		/**
-		 * Notify application through response handler
+		 * Notify application through observer and response handler
+		 */
+		void read_ready_response()
+		{
+			if (_observer) _observer->handle_response(*this);
+			if (_handler)  _handler->read_ready_response();
+		}
+
+		/**
+		 * Notify application through observer and response handler
 		 */
-		void io_progress_response() {
-			if (_handler) _handler->io_progress_response(); }
+		void io_progress_response()
+		{
+			if (_observer) _observer->handle_response(*this);
+			if (_handler)  _handler->io_progress_response();
+		}
 
 		/**
 		 * Close handle at backing file-system.
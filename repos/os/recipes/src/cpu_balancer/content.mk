@@ -1,2 +1,2 @@
-SRC_DIR = src/server/cpu_balancer
+SRC_DIR = src/server/cpu_balancer include/trace
 include $(GENODE_DIR)/repos/base/recipes/src/content.inc
@@ -1,2 +1,2 @@
-SRC_DIR = src/app/trace_logger
+SRC_DIR = src/app/trace_logger include/trace
 include $(GENODE_DIR)/repos/base/recipes/src/content.inc
@@ -14,6 +14,10 @@
  *  <config>
  *  	<nic mac="12:23:34:45:56:67" tap="tap1"/>
  *  </config>
+ *
+ * In NIC-server mode, a client may request multiple queue pairs. Each queue
+ * pair is then backed by a queue of a multi-queue TAP device, which must
+ * have been created with the 'multi_queue' option.
  */
 
 /*
@@ -65,29 +69,147 @@ static Net::Mac_address default_mac_address()
 }
 
 
-class Linux_session_component : public Nic::Session_component
+/**
+ * Queues of the TAP device used by a NIC session
+ *
+ * If the TAP device lacks the 'multi_queue' option, the session falls back
+ * to the number of queues that could be opened.
+ */
+class Tap_queues : Genode::Noncopyable
+{
+	private:
+
+		typedef Genode::String<IFNAMSIZ> Tap_name;
+
+		static Tap_name _tap_name(Genode::Env &env)
+		{
+			Genode::Attached_rom_dataspace config(env, "config");
+
+			/* use tap0 if no config has been provided */
+			Tap_name const name = config.xml().has_sub_node("nic")
+			                    ? config.xml().sub_node("nic").attribute_value("tap", Tap_name())
+			                    : Tap_name();
+			if (name == "") {
+				Genode::log("no config provided, using tap0");
+				return Tap_name("tap0");
+			}
+
+			Genode::log("using tap device \"", name, "\"");
+			return name;
+		}
+
+		/**
+		 * Open TAP device
+		 *
+		 * \return  file descriptor, or -1 on error
+		 */
+		static int _open_tap_fd(Tap_name const &name, bool const multi_queue)
+		{
+			int fd = open("/dev/net/tun", O_RDWR);
+			if (fd < 0) {
+				Genode::error("could not open /dev/net/tun: no virtual network emulation");
+				return -1;
+			}
+
+			/* set fd to non-blocking */
+			if (fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
+				Genode::error("could not set /dev/net/tun to non-blocking");
+				close(fd);
+				return -1;
+			}
+
+			struct ifreq ifr;
+			Genode::memset(&ifr, 0, sizeof(ifr));
+			ifr.ifr_flags = IFF_TAP | IFF_NO_PI | (multi_queue ? IFF_MULTI_QUEUE : 0);
+			Genode::copy_cstring(ifr.ifr_name, name.string(), sizeof(ifr.ifr_name));
+
+			if (ioctl(fd, TUNSETIFF, (void *) &ifr) != 0) {
+				close(fd);
+				return -1;
+			}
+
+			return fd;
+		}
+
+	protected:
+
+		int      _tap_fd[Nic::Session::MAX_QUEUES] { };
+		unsigned _num_tap_fds { 0 };
+
+		Tap_queues(Genode::Env &env, unsigned const queues)
+		{
+			Tap_name const name = _tap_name(env);
+
+			if (queues > 1) {
+				for (; _num_tap_fds < queues; _num_tap_fds++) {
+					_tap_fd[_num_tap_fds] = _open_tap_fd(name, true);
+					if (_tap_fd[_num_tap_fds] < 0)
+						break;
+				}
+
+				if (_num_tap_fds < queues)
+					Genode::warning("TAP device provides ",
+					                Genode::max(_num_tap_fds, 1U), " instead of ",
+					                queues, " queues, multi_queue option missing?");
+			}
+
+			if (_num_tap_fds == 0) {
+				_tap_fd[0] = _open_tap_fd(name, false);
+				if (_tap_fd[0] < 0) {
+					Genode::error("could not configure /dev/net/tun: no virtual network emulation");
+					/* this error is fatal */
+					throw Genode::Exception();
+				}
+				_num_tap_fds = 1;
+			}
+		}
+
+		~Tap_queues()
+		{
+			for (unsigned i = 0; i < _num_tap_fds; i++)
+				close(_tap_fd[i]);
+		}
+};
+
+
+/*
+ * The 'Tap_queues' base is constructed first to determine the number of queue
+ * pairs of the session and destructed last, after the rx thread is gone.
+ */
+class Linux_session_component : private Tap_queues, public Nic::Session_component
 {
 	private:
 
 		struct Rx_signal_thread : Genode::Thread
 		{
-			int                               fd;
+			int const                        *fds;
+			unsigned const                    num_fds;
 			Genode::Signal_context_capability sigh;
 			Genode::Blockade                  blockade { };
 
-			Rx_signal_thread(Genode::Env &env, int fd, Genode::Signal_context_capability sigh)
-			: Genode::Thread(env, "rx_signal", 0x1000), fd(fd), sigh(sigh) { }
+			Rx_signal_thread(Genode::Env &env, int const *fds, unsigned num_fds,
+			                 Genode::Signal_context_capability sigh)
+			:
+				Genode::Thread(env, "rx_signal", 0x1000),
+				fds(fds), num_fds(num_fds), sigh(sigh)
+			{ }
 
 			void entry() override
 			{
 				while (true) {
-					/* wait for packet arrival on fd */
+					/* wait for packet arrival on any of the fds */
 					int    ret;
+					int    nfds = 0;
 					fd_set rfds;
 
-					FD_ZERO(&rfds);
-					FD_SET(fd, &rfds);
-					do { ret = select(fd + 1, &rfds, 0, 0, 0); } while (ret < 0);
+					do {
+						FD_ZERO(&rfds);
+						for (unsigned i = 0; i < num_fds; i++) {
+							FD_SET(fds[i], &rfds);
+							nfds = Genode::max(nfds, fds[i] + 1);
+						}
+						ret = select(nfds, &rfds, 0, 0, 0);
+					} while (ret < 0);
 
 					/* signal incoming packet */
 					Genode::Signal_transmitter(sigh).submit();
@@ -95,74 +217,33 @@ class Linux_session_component : public Nic::Session_component
 					blockade.block();
 				}
 			}
+
+			/*
+			 * Noncopyable
+			 */
+			Rx_signal_thread(Rx_signal_thread const &);
+			Rx_signal_thread &operator = (Rx_signal_thread const &);
 		};
 
 		Genode::Attached_rom_dataspace _config_rom;
 
 		Nic::Mac_address _mac_addr { };
-		int              _tap_fd;
 		Rx_signal_thread _rx_thread;
 
-		int _setup_tap_fd()
-		{
-			/* open TAP device */
-			int ret;
-			struct ifreq ifr;
-
-			int fd = open("/dev/net/tun", O_RDWR);
-			if (fd < 0) {
-				Genode::error("could not open /dev/net/tun: no virtual network emulation");
-				/* this error is fatal */
-				throw Genode::Exception();
-			}
-
-			/* set fd to non-blocking */
-			if (fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
-				Genode::error("could not set /dev/net/tun to non-blocking");
-				throw Genode::Exception();
-			}
-
-			Genode::memset(&ifr, 0, sizeof(ifr));
-			ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
-
-			/* get tap device from config */
-			try {
-				Genode::Xml_node nic_node = _config_rom.xml().sub_node("nic");
-				nic_node.attribute("tap").with_raw_value([&] (char const *ptr, size_t len) {
-					len = Genode::min(len, sizeof(ifr.ifr_name) - 1);
-					Genode::memcpy(ifr.ifr_name, ptr, len);
-					ifr.ifr_name[len] = 0;
-				});
-				Genode::log("using tap device \"", Genode::Cstring(ifr.ifr_name), "\"");
-			} catch (...) {
-				/* use tap0 if no config has been provided */
-				Genode::copy_cstring(ifr.ifr_name, "tap0", sizeof(ifr.ifr_name));
-				Genode::log("no config provided, using tap0");
-			}
-
-			ret = ioctl(fd, TUNSETIFF, (void *) &ifr);
-			if (ret != 0) {
-				Genode::error("could not configure /dev/net/tun: no virtual network emulation");
-				close(fd);
-				/* this error is fatal */
-				throw Genode::Exception();
-			}
-
-			return fd;
-		}
-
-		bool _send()
+		bool _send(unsigned const queue)
 		{
 			using namespace Genode;
 
-			if (!_tx.sink()->ready_to_ack())
+			Session::Tx::Sink &tx = *_tx_queue(queue).sink();
+
+			if (!tx.ready_to_ack())
 				return false;
 
-			if (!_tx.sink()->packet_avail())
+			if (!tx.packet_avail())
 				return false;
 
-			Packet_descriptor packet = _tx.sink()->get_packet();
-			if (!packet.size() || !_tx.sink()->packet_valid(packet)) {
+			Packet_descriptor packet = tx.get_packet();
+			if (!packet.size() || !tx.packet_valid(packet)) {
 				warning("invalid tx packet");
 				return true;
 			}
@@ -171,7 +252,7 @@ class Linux_session_component : public Nic::Session_component
 
 			/* non-blocking-write packet to TAP */
 			do {
-				ret = write(_tap_fd, _tx.sink()->packet_content(packet), packet.size());
+				ret = write(_tap_fd[queue], tx.packet_content(packet), packet.size());
 				/* drop packet if write would block */
 				if (ret < 0 && errno == EAGAIN)
 					continue;
@@ -179,7 +260,7 @@ class Linux_session_component : public Nic::Session_component
 				if (ret < 0) Genode::error("write: errno=", errno);
 			} while (ret < 0);
 
-			_tx.sink()->acknowledge_packet(packet);
+			tx.acknowledge_packet(packet);
 
 			return true;
 		}
@@ -187,38 +268,40 @@ class Linux_session_component : public Nic::Session_component
 		enum class Receive_result {
 			NO_PACKET, READ_ERROR, SUBMITTED, ALLOC_FAILED, SUBMIT_QUEUE_FULL };
 
-		Receive_result _receive()
+		Receive_result _receive(unsigned const queue)
 		{
 			unsigned const max_size = Nic::Packet_allocator::DEFAULT_PACKET_SIZE;
 
-			if (!_rx.source()->ready_to_submit())
+			Session::Rx::Source &rx = *_rx_queue(queue).source();
+
+			if (!rx.ready_to_submit())
 				return Receive_result::SUBMIT_QUEUE_FULL;
 
 			Nic::Packet_descriptor p;
 			try {
-				p = _rx.source()->alloc_packet(max_size);
+				p = rx.alloc_packet(max_size);
 			} catch (Session::Rx::Source::Packet_alloc_failed) { return Receive_result::ALLOC_FAILED; }
 
-			int size = read(_tap_fd, _rx.source()->packet_content(p), max_size);
+			int size = read(_tap_fd[queue], rx.packet_content(p), max_size);
 			if (size <= 0) {
-				_rx.source()->release_packet(p);
+				rx.release_packet(p);
 				return errno == EAGAIN ? Receive_result::NO_PACKET
 				                       : Receive_result::READ_ERROR;
 			}
 
 			/* adjust packet size */
 			Nic::Packet_descriptor p_adjust(p.offset(), size);
-			_rx.source()->submit_packet(p_adjust);
+			rx.submit_packet(p_adjust);
 
 			return Receive_result::SUBMITTED;
 		}
 
 	protected:
 
-		bool _handle_incoming_packets()
+		bool _handle_incoming_packets(unsigned const queue)
 		{
 			while (true) {
-				switch (_receive()) {
+				switch (_receive(queue)) {
 				case Receive_result::NO_PACKET:         return true;
 				case Receive_result::READ_ERROR:        return true;
 				case Receive_result::SUBMITTED:         continue;
@@ -230,13 +313,22 @@ class Linux_session_component : public Nic::Session_component
 
 		void _handle_packet_stream() override
 		{
-			while (_rx.source()->ack_avail()) {
-				_rx.source()->release_packet(_rx.source()->get_acked_packet());
-			}
+			bool drained = true;
+
+			for (unsigned i = 0; i < queues(); i++) {
 
-			while (_send()) ;
+				Session::Rx::Source &rx = *_rx_queue(i).source();
+				while (rx.ack_avail())
+					rx.release_packet(rx.get_acked_packet());
 
-			if (_handle_incoming_packets())
+				while (_send(i)) ;
+
+				if (!_handle_incoming_packets(i))
+					drained = false;
+			}
+
+			/* wait for new packets only if all queues of the TAP device are drained */
+			if (drained)
 				_rx_thread.blockade.wakeup();
 		}
 
@@ -245,12 +337,14 @@ class Linux_session_component : public Nic::Session_component
 		Linux_session_component(Genode::size_t const tx_buf_size,
 		                        Genode::size_t const rx_buf_size,
 		                        Genode::Allocator   &rx_block_md_alloc,
-		                        Server::Env         &env)
+		                        Server::Env         &env,
+		                        unsigned             queues = 1)
 		:
-			Session_component(tx_buf_size, rx_buf_size, Genode::CACHED, rx_block_md_alloc, env),
+			Tap_queues(env, queues),
+			Session_component(tx_buf_size, rx_buf_size, Genode::CACHED,
+			                  rx_block_md_alloc, env, _num_tap_fds),
 			_config_rom(env, "config"),
-			_tap_fd(_setup_tap_fd()),
-			_rx_thread(env, _tap_fd, _packet_stream_dispatcher)
+			_rx_thread(env, _tap_fd, _num_tap_fds, _packet_stream_dispatcher)
 		{
 			_mac_addr = default_mac_address();
 
@@ -269,6 +363,25 @@ class Linux_session_component : public Nic::Session_component
 };
 
 
+/**
+ * Root of the NIC service that supports multiple queue pairs per session
+ */
+struct Linux_root : Nic::Root<Linux_session_component>
+{
+	Linux_session_component *_create_queued_session(Genode::size_t tx_buf_size,
+	                                                Genode::size_t rx_buf_size,
+	                                                unsigned       queues) override
+	{
+		return new (md_alloc())
+			Linux_session_component(tx_buf_size, rx_buf_size, _md_alloc,
+			                        _env, queues);
+	}
+
+	Linux_root(Genode::Env &env, Genode::Allocator &md_alloc)
+	: Nic::Root<Linux_session_component>(env, md_alloc) { }
+};
+
+
 class Uplink_client : public Genode::Uplink_client_base
 {
 	private:
@@ -450,8 +563,7 @@ struct Server::Main
 		switch (mode) {
 		case Nic_driver_mode::NIC_SERVER:
 			{
-				Nic::Root<Linux_session_component> &nic_root {
-					*new (_heap) Nic::Root<Linux_session_component>(_env, _heap) };
+				Linux_root &nic_root { *new (_heap) Linux_root(_env, _heap) };
 
 				_env.parent().announce(_env.ep().manage(nic_root));
 				break;
@@ -0,0 +1,46 @@
+#include <trace/policy.h>
+#include <trace/affinity_event.h>
+
+using namespace Genode;
+
+typedef Trace::Affinity_event Event;
+
+size_t max_event_size()
+{
+	return sizeof(Event);
+}
+
+size_t log_output(char *dst, char const *log_message, size_t len)
+{
+	return 0;
+}
+
+size_t rpc_call(char *dst, char const *rpc_name, Msgbuf_base const &)
+{
+	return Event::generate(dst, Event::RPC_CALL, rpc_name);
+}
+
+size_t rpc_returned(char *dst, char const *rpc_name, Msgbuf_base const &)
+{
+	return 0;
+}
+
+size_t rpc_dispatch(char *dst, char const *rpc_name)
+{
+	return Event::generate(dst, Event::RPC_DISPATCH, rpc_name);
+}
+
+size_t rpc_reply(char *dst, char const *rpc_name)
+{
+	return 0;
+}
+
+size_t signal_submit(char *dst, unsigned const)
+{
+	return Event::generate(dst, Event::SIGNAL_SUBMIT, nullptr);
+}
+
+size_t signal_receive(char *dst, Signal_context const &, unsigned)
+{
+	return Event::generate(dst, Event::SIGNAL_RECEIVE, nullptr);
+}
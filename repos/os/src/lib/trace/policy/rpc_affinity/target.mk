@@ -0,0 +1,5 @@
+TARGET = rpc_affinity_policy
+
+TARGET_POLICY = rpc_affinity
+
+include $(PRG_DIR)/../policy.inc
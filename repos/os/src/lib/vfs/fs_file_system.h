@@ -64,6 +64,9 @@ class Vfs::Fs_file_system : public File_system
 
 			::File_system::Packet_descriptor queued_read_packet { };
 			::File_system::Packet_descriptor queued_sync_packet { };
+
+			/* failure of a write acknowledged after the write returned */
+			bool write_failed = false;
 		};
 
 		struct Fs_vfs_handle;
@@ -128,6 +131,7 @@ class Vfs::Fs_file_system : public File_system
 			using Handle_state::queued_sync_packet;
 			using Handle_state::queued_sync_state;
 			using Handle_state::read_ready_state;
+			using Handle_state::write_failed;
 
 			::File_system::Connection &_fs;
 
@@ -438,6 +442,139 @@ class Vfs::Fs_file_system : public File_system
 
 		Fs_vfs_handle_queue _congested_handles { };
 
+		/**
+		 * Small writes gathered while the packet stream is congested
+		 *
+		 * Once the submit queue is full, further writes to the same file are
+		 * collected in a single WRITE_V packet instead of blocking the
+		 * writer. The packet is submitted as soon as the queue has room.
+		 */
+		struct Write_vector
+		{
+			enum { CAPACITY = 16*1024 };
+
+			bool                             valid        = false;
+			::File_system::Packet_descriptor packet       { };
+			::File_system::Node_handle       handle       { 0 };
+			file_size                        length       = 0;
+			unsigned                         num_segments = 0;
+			::File_system::Segment           segments[::File_system::MAX_SEGMENTS] { };
+		};
+
+		Write_vector _write_vector { };
+
+		/**
+		 * Append write to the write vector
+		 *
+		 * \return false if the write cannot be gathered
+		 */
+		bool _gather_write(Fs_vfs_handle &handle, char const *buf,
+		                   file_size count, file_size seek_offset)
+		{
+			::File_system::Session::Tx::Source &source = *_fs.tx();
+			using ::File_system::Packet_descriptor;
+			using ::File_system::Segment;
+
+			Write_vector &v = _write_vector;
+
+			if (v.valid && !(v.handle == handle.file_handle()))
+				return false;
+
+			if (count > Write_vector::CAPACITY - v.length)
+				return false;
+
+			if (!v.valid) {
+				try {
+					v.packet = source.alloc_packet(
+						Packet_descriptor::vector_size(Write_vector::CAPACITY,
+						                               ::File_system::MAX_SEGMENTS),
+						Packet_descriptor::SEGMENT_ALIGN_LOG2);
+				}
+				catch (::File_system::Session::Tx::Source::Packet_alloc_failed) {
+					return false; }
+
+				v.valid        = true;
+				v.handle       = handle.file_handle();
+				v.length       = 0;
+				v.num_segments = 0;
+			}
+
+			/* extend the last segment if the write continues it */
+			Segment * const last = v.num_segments
+			                     ? &v.segments[v.num_segments - 1] : nullptr;
+
+			file_size const tail = ::File_system::SEEK_TAIL;
+
+			bool const continues = last
+				&& ((last->position == tail && seek_offset == tail)
+				 || (last->position != tail && last->position + last->length == seek_offset));
+
+			if (!continues) {
+				if (v.num_segments == ::File_system::MAX_SEGMENTS)
+					return false;
+
+				v.segments[v.num_segments++] = Segment { .position = seek_offset,
+				                                         .length   = 0 };
+			}
+
+			memcpy(source.packet_content(v.packet) + v.length, buf, count);
+
+			v.segments[v.num_segments - 1].length += count;
+			v.length += count;
+			return true;
+		}
+
+		/**
+		 * Submit gathered writes
+		 *
+		 * \return false if the write vector is still pending
+		 */
+		bool _submit_write_vector()
+		{
+			::File_system::Session::Tx::Source &source = *_fs.tx();
+			using ::File_system::Packet_descriptor;
+
+			Write_vector &v = _write_vector;
+
+			if (!v.valid)
+				return true;
+
+			if (!source.ready_to_submit())
+				return false;
+
+			Packet_descriptor const packet(v.packet, v.handle, Packet_descriptor::WRITE_V,
+			                               v.length, Packet_descriptor::Segments { v.num_segments });
+
+			memcpy(packet.segment_table(source.packet_content(packet)),
+			       v.segments, v.num_segments*sizeof(v.segments[0]));
+
+			source.submit_packet(packet);
+
+			v.valid = false;
+			return true;
+		}
+
+		/**
+		 * Submit gathered writes of 'handle', waiting for the submit queue if needed
+		 *
+		 * Must be called without holding '_mutex'.
+		 */
+		void _flush_write_vector(Fs_vfs_handle &handle)
+		{
+			for (;;) {
+				{
+					Mutex::Guard guard(_mutex);
+
+					if (!_write_vector.valid || !(_write_vector.handle == handle.file_handle()))
+						return;
+
+					if (_submit_write_vector())
+						return;
+				}
+				_env.env().ep().wait_and_dispatch_one_io_signal();
+			}
+		}
+
 		file_size _read(Fs_vfs_handle &handle, void *buf,
 		                file_size const count, file_size const seek_offset)
 		{
@@ -507,7 +644,11 @@ class Vfs::Fs_file_system : public File_system
 			file_size const max_packet_size = source.bulk_buffer_size() / 2;
 			count = min(max_packet_size, count);
 
-			if (!source.ready_to_submit()) {
+			if (!_submit_write_vector() || !source.ready_to_submit()) {
+
+				if (_gather_write(handle, buf, count, seek_offset))
+					return count;
+
 				if (!handle.enqueued())
 					_congested_handles.enqueue(handle);
 				throw Insufficient_buffer();
@@ -537,6 +678,11 @@ class Vfs::Fs_file_system : public File_system
 
 		void _ready_to_submit()
 		{
+			{
+				Mutex::Guard guard(_mutex);
+				_submit_write_vector();
+			}
+
 			_congested_handles.dequeue_all([] (Fs_vfs_handle &handle) {
 				handle.io_progress_response(); });
 		}
@@ -570,6 +716,15 @@ class Vfs::Fs_file_system : public File_system
 						break;
 
 					case Packet_descriptor::WRITE:
+					case Packet_descriptor::WRITE_V:
+						/*
+						 * Writes return before the server acknowledged
+						 * them. Keep a failure for the next write or sync
+						 * of the handle.
+						 */
+						if (!packet.succeeded())
+							handle.write_failed = true;
+
 						/*
 						 * Notify anyone who might have failed on
 						 * 'alloc_packet()'
@@ -590,6 +745,10 @@ class Vfs::Fs_file_system : public File_system
 					case Packet_descriptor::WRITE_TIMESTAMP:
 						/* previously handled */
 						break;
+
+					case Packet_descriptor::READ_V:
+						/* never submitted */
+						break;
 					}
 				};
 
@@ -604,7 +763,8 @@ class Vfs::Fs_file_system : public File_system
 				catch (Handle_space::Unknown_id) {
 					Genode::warning("ack for unknown File_system handle ", id); }
 
-				if (packet.operation() == Packet_descriptor::WRITE) {
+				if (packet.operation() == Packet_descriptor::WRITE
+				 || packet.operation() == Packet_descriptor::WRITE_V) {
 					Mutex::Guard guard(_mutex);
 					source.release_packet(packet);
 				}
@@ -637,6 +797,12 @@ class Vfs::Fs_file_system : public File_system
 			return config.attribute_value("buffer_size", fs_default);
 		}
 
+		static unsigned queue_size(Genode::Xml_node const &config)
+		{
+			return config.attribute_value("queue_size",
+			                              (unsigned)::File_system::Session::TX_QUEUE_SIZE);
+		}
+
 	public:
 
 		Fs_file_system(Vfs::Env &env, Genode::Xml_node config)
@@ -647,7 +813,7 @@ class Vfs::Fs_file_system : public File_system
 			_fs(_env.env(), _fs_packet_alloc,
 			    _label.string(), _root.string(),
 			    config.attribute_value("writeable", true),
-			    buffer_size(config))
+			    buffer_size(config), queue_size(config))
 		{
 			_fs.sigh_ack_avail(_ack_handler);
 			_fs.sigh_ready_to_submit(_ready_handler);
@@ -918,9 +1084,11 @@ class Vfs::Fs_file_system : public File_system
 
 		void close(Vfs_handle *vfs_handle) override
 		{
-			Mutex::Guard guard(_mutex);
-
 			Fs_vfs_handle *fs_handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+
+			_flush_write_vector(*fs_handle);
+
+			Mutex::Guard guard(_mutex);
 			if (fs_handle->enqueued())
 				_congested_handles.remove(*fs_handle);
 
@@ -984,6 +1152,13 @@ class Vfs::Fs_file_system : public File_system
 
 			Fs_vfs_handle &handle = static_cast<Fs_vfs_handle &>(*vfs_handle);
 
+			/* report the failure of a preceding write */
+			if (handle.write_failed) {
+				handle.write_failed = false;
+				out_count = 0;
+				return WRITE_ERR_IO;
+			}
+
 			out_count = _write(handle, buf, buf_size, handle.seek());
 			return WRITE_OK;
 		}
@@ -994,7 +1169,8 @@ class Vfs::Fs_file_system : public File_system
 
 			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
 
-			bool result = handle->queue_read(count);
+			/* preserve the order of reads and gathered writes */
+			bool result = _submit_write_vector() && handle->queue_read(count);
 			if (!result && !handle->enqueued())
 				_congested_handles.enqueue(*handle);
 			return result;
@@ -1003,12 +1179,20 @@ class Vfs::Fs_file_system : public File_system
 		Read_result complete_read(Vfs_handle *vfs_handle, char *dst, file_size count,
 		                          file_size &out_count) override
 		{
+			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+
+			/*
+			 * Process acknowledgements not yet seen by the signal handler,
+			 * which enables callers to complete the read while the
+			 * entrypoint is blocked, e.g., by a page fault
+			 */
+			if (handle->queued_read_state == Handle_state::Queued_state::QUEUED)
+				_handle_ack();
+
 			Mutex::Guard guard(_mutex);
 
 			out_count = 0;
 
-			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
-
 			Read_result result = handle->complete_read(dst, count, out_count);
 			if (result == READ_QUEUED && !handle->enqueued())
 				_congested_handles.enqueue(*handle);
@@ -1051,9 +1235,27 @@ class Vfs::Fs_file_system : public File_system
 			return true;
 		}
 
+		bool write_ready(Vfs_handle *) override
+		{
+			return _fs.tx()->ready_to_submit();
+		}
+
+		bool notify_write_ready(Vfs_handle *vfs_handle) override
+		{
+			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+
+			/* congested handles are notified once packets can be submitted */
+			if (!handle->enqueued())
+				_congested_handles.enqueue(*handle);
+
+			return true;
+		}
+
 		Ftruncate_result ftruncate(Vfs_handle *vfs_handle, file_size len) override
 		{
-			Fs_vfs_handle const *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+
+			_flush_write_vector(*handle);
 
 			try {
 				_fs.truncate(handle->file_handle(), len);
@@ -1070,6 +1272,9 @@ class Vfs::Fs_file_system : public File_system
 		{
 			Mutex::Guard guard(_mutex);
 
+			if (!_submit_write_vector())
+				return false;
+
 			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
 
 			return handle->queue_sync();
@@ -1081,13 +1286,24 @@ class Vfs::Fs_file_system : public File_system
 
 			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
 
-			return handle->complete_sync();
+			Sync_result const result = handle->complete_sync();
+
+			/* report the failure of a write acknowledged before the sync */
+			if (result == SYNC_OK && handle->write_failed) {
+				handle->write_failed = false;
+				return SYNC_ERR_INVALID;
+			}
+
+			return result;
 		}
 
 		bool update_modification_timestamp(Vfs_handle *vfs_handle, Vfs::Timestamp time) override
 		{
 			Mutex::Guard guard(_mutex);
 
+			if (!_submit_write_vector())
+				return false;
+
 			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
 
 			return handle->update_modification_timestamp(time);
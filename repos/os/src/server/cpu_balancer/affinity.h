@@ -0,0 +1,186 @@
+/*
+ * \brief  Communication affinity between traced threads
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The graph accumulates the interactions between threads that are traced
+ * with the 'rpc_affinity' policy. An RPC call of one thread is attributed
+ * to the thread that dispatches an RPC of the same name shortly after. A
+ * signal submission is attributed to the thread receiving a signal shortly
+ * after. The edge weights decay with each evaluation.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _AFFINITY_H_
+#define _AFFINITY_H_
+
+#include <trace/affinity_event.h>
+
+namespace Cpu { class Affinity_graph; }
+
+
+class Cpu::Affinity_graph
+{
+	public:
+
+		enum { MAX_NODES = 32, MAX_EVENTS = 256 /* per node */ };
+
+		typedef Genode::Trace::Affinity_event Affinity_event;
+		typedef Genode::Trace::Timestamp      Timestamp;
+
+	private:
+
+		enum { PENDING = 16 };
+
+		struct Event
+		{
+			Timestamp timestamp;
+			unsigned  name;
+			unsigned  type;
+			unsigned  node;
+		};
+
+		unsigned _weight[MAX_NODES][MAX_NODES] { };
+		unsigned _count [MAX_NODES][MAX_NODES] { };
+
+		/* most recent events of each node since the last evaluation */
+		Event    _events[MAX_NODES][MAX_EVENTS] { };
+		unsigned _first     [MAX_NODES] { };
+		unsigned _num_events[MAX_NODES] { };
+
+		/* recent calls and submissions not yet attributed to a receiver */
+		Event    _pending[PENDING]   { };
+		unsigned _pending_head       { 0 };
+
+		static unsigned _originator_of(unsigned type)
+		{
+			switch (type) {
+			case Affinity_event::RPC_DISPATCH:   return Affinity_event::RPC_CALL;
+			case Affinity_event::SIGNAL_RECEIVE: return Affinity_event::SIGNAL_SUBMIT;
+			}
+			return Affinity_event::INVALID;
+		}
+
+		void _match(Event const &event, Timestamp const window)
+		{
+			unsigned const originator = _originator_of(event.type);
+
+			if (originator == Affinity_event::INVALID) {
+				_pending[_pending_head] = event;
+				_pending_head = (_pending_head + 1) % PENDING;
+				return;
+			}
+
+			/* search most recent originator first */
+			for (unsigned i = 1; i <= PENDING; i++) {
+				Event &p = _pending[(_pending_head + PENDING - i) % PENDING];
+
+				if (p.type != originator || p.name != event.name || p.node == event.node)
+					continue;
+
+				if (event.timestamp - p.timestamp > window)
+					return;
+
+				_count[p.node][event.node]++;
+				p.type = Affinity_event::INVALID;
+				return;
+			}
+		}
+
+	public:
+
+		void clear(unsigned const node)
+		{
+			if (node >= MAX_NODES)
+				return;
+
+			for (unsigned i = 0; i < MAX_NODES; i++) {
+				_weight[node][i] = _weight[i][node] = 0;
+				_count [node][i] = _count [i][node] = 0;
+			}
+			_first[node] = _num_events[node] = 0;
+		}
+
+		/**
+		 * Record event of node, events of a node must be added in order
+		 *
+		 * If more than 'MAX_EVENTS' are added between two evaluations, the
+		 * oldest events of the node are dropped.
+		 */
+		void add(unsigned const node, Affinity_event const &event)
+		{
+			if (node >= MAX_NODES)
+				return;
+
+			unsigned &first = _first[node];
+			unsigned &count = _num_events[node];
+
+			_events[node][(first + count) % MAX_EVENTS] =
+				Event { event.timestamp, event.name, event.type, node };
+
+			if (count < MAX_EVENTS)
+				count++;
+			else
+				first = (first + 1) % MAX_EVENTS;
+		}
+
+		/**
+		 * Attribute the recorded events and update the edge weights
+		 *
+		 * \param window  maximum delay between the events of both sides
+		 */
+		void evaluate(Timestamp const window)
+		{
+			for (unsigned i = 0; i < PENDING; i++)
+				_pending[i].type = Affinity_event::INVALID;
+
+			/* merge the per-node event sequences by time stamp */
+			for (;;) {
+				unsigned next = MAX_NODES;
+				for (unsigned n = 0; n < MAX_NODES; n++) {
+					if (!_num_events[n])
+						continue;
+					if (next == MAX_NODES || _events[n][_first[n]].timestamp
+					                       < _events[next][_first[next]].timestamp)
+						next = n;
+				}
+
+				if (next == MAX_NODES)
+					break;
+
+				_match(_events[next][_first[next]], window);
+
+				_first[next] = (_first[next] + 1) % MAX_EVENTS;
+				_num_events[next]--;
+			}
+
+			for (unsigned a = 0; a < MAX_NODES; a++) {
+				for (unsigned b = a + 1; b < MAX_NODES; b++) {
+					unsigned const count = _count[a][b] + _count[b][a];
+					unsigned const weight = _weight[a][b] - _weight[a][b] / 4 + count;
+
+					_weight[a][b] = _weight[b][a] = weight;
+					_count [a][b] = _count [b][a] = 0;
+				}
+			}
+		}
+
+		/**
+		 * Return decayed number of interactions between two nodes
+		 *
+		 * The weight of a steady rate of interactions converges to four
+		 * times the interactions per evaluation.
+		 */
+		unsigned weight(unsigned const a, unsigned const b) const
+		{
+			return (a < MAX_NODES && b < MAX_NODES) ? _weight[a][b] : 0;
+		}
+};
+
+#endif /* _AFFINITY_H_ */
@@ -378,6 +378,7 @@ void Cpu::Balancer::handle_timeout()
 	if (trace.constructed()) {
 		reread_subjects = trace->subject_id_reread();
 		trace->read_idle_times();
+		trace->read_events(timer.elapsed_us());
 	}
 
 	/* update all sessions */
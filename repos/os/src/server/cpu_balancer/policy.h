@@ -30,6 +30,7 @@ namespace Cpu
 	class Policy_pin;
 	class Policy_round_robin;
 	class Policy_max_utilize;
+	class Policy_affinity;
 };
 
 class Cpu::Policy {
@@ -68,6 +69,9 @@ class Cpu::Policy {
 
 		Location location { };
 
+		/* trace subject of the thread, valid if tracing is enabled */
+		Subject_id subject_id { };
+
 		virtual ~Policy() { }
 		virtual void config(Location const &) = 0;
 		virtual bool update(Location const &, Location &, Execution_time const &) = 0;
@@ -312,4 +316,240 @@ class Cpu::Policy_max_utilize : public Cpu::Policy
 			return "max-utilize"; }
 };
 
+class Cpu::Policy_affinity : public Cpu::Policy
+{
+	private:
+
+		enum {
+			CHATTY_WEIGHT    = 400, /* ~100 interactions per interval   */
+			HOT_PERCENT      = 50,  /* of the CPU time of an interval   */
+			HEADROOM_PERCENT = 10,  /* CPU time kept free on co-location */
+			STABLE_ROUNDS    = 3,   /* intervals a target must persist  */
+			COOLDOWN_ROUNDS  = 5,   /* intervals after a migration      */
+		};
+
+		Location _pending  { };
+		unsigned _stable   { 0 };
+		unsigned _cooldown { 0 };
+
+		static Genode::uint64_t _value(Execution_time const &time)
+		{
+			return time.scheduling_context ? time.scheduling_context
+			                               : time.thread_context;
+		}
+
+		static bool _same(Location const &a, Location const &b) {
+			return a.xpos() == b.xpos() && a.ypos() == b.ypos(); }
+
+		static bool _within(Location const &base, Location const &loc)
+		{
+			return loc.xpos() >= base.xpos() && loc.ypos() >= base.ypos()
+			    && loc.xpos() <  base.xpos() + int(base.width())
+			    && loc.ypos() <  base.ypos() + int(base.height());
+		}
+
+		/**
+		 * Return true if this thread should give way to 'other'
+		 *
+		 * Of two threads considering each other, only the one with less
+		 * load moves. This avoids both moving towards each other.
+		 */
+		bool _yields_to(Genode::uint64_t own, Subject_id const &other,
+		                Genode::uint64_t other_load) const
+		{
+			return own < other_load
+			    || (own == other_load && subject_id.id < other.id);
+		}
+
+		/**
+		 * Determine CPU next to the strongest communication peer
+		 *
+		 * \return true if a peer with enough interactions exists
+		 */
+		bool _colocate(Location const &base, Location const &current,
+		               Trace &trace, Genode::uint64_t const own,
+		               Genode::uint64_t const capacity, Location &target)
+		{
+			unsigned         weight    = 0;
+			Subject_id       peer      { };
+			Location         peer_loc  { };
+			Genode::uint64_t peer_load = 0;
+
+			trace.for_each_observed(subject_id, [&] (Subject_id const &id,
+			                                         Location const &loc,
+			                                         Execution_time const &load,
+			                                         unsigned const w) {
+				if (w > weight && _within(base, loc)) {
+					weight = w; peer = id; peer_loc = loc; peer_load = _value(load); }
+			});
+
+			if (weight < CHATTY_WEIGHT)
+				return false;
+
+			if (_same(peer_loc, current) || !_yields_to(own, peer, peer_load))
+				return true;
+
+			/* load of the CPUs sharing the core of the peer */
+			auto load_at = [&] (Location const &loc) {
+				Genode::uint64_t sum = 0;
+				trace.for_each_observed(subject_id, [&] (Subject_id const &,
+				                                         Location const &l,
+				                                         Execution_time const &load,
+				                                         unsigned) {
+					if (_same(l, loc)) sum += _value(load); });
+				return sum;
+			};
+
+			auto fits = [&] (Location const &loc) {
+				return !capacity || (load_at(loc) + own) * 100
+				                    <= capacity * (100 - HEADROOM_PERCENT); };
+
+			if (fits(peer_loc)) {
+				target = peer_loc;
+				return true;
+			}
+
+			/* fall back to a hyperthread sharing the caches of the peer's core */
+			for (unsigned y = base.ypos(); y < base.ypos() + base.height(); y++) {
+				Location const sibling(peer_loc.xpos(), y, 1, 1);
+				if (_same(sibling, peer_loc))
+					continue;
+				if (_same(sibling, current))
+					return true;
+				if (fits(sibling)) {
+					target = sibling;
+					return true;
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * Determine less loaded core if another hot thread shares the CPU
+		 */
+		void _spread(Location const &base, Location const &current,
+		             Trace &trace, Genode::uint64_t const own,
+		             Genode::uint64_t const capacity, Location &target)
+		{
+			auto hot = [&] (Genode::uint64_t load) {
+				return load * 100 > capacity * HOT_PERCENT; };
+
+			if (!hot(own))
+				return;
+
+			bool contended = false;
+			trace.for_each_observed(subject_id, [&] (Subject_id const &id,
+			                                         Location const &loc,
+			                                         Execution_time const &load,
+			                                         unsigned) {
+				if (_same(loc, current) && hot(_value(load))
+				 && _yields_to(own, id, _value(load)))
+					contended = true; });
+
+			if (!contended)
+				return;
+
+			/* hot load of a core, CPUs of the same core share the caches */
+			auto core_load = [&] (int const xpos) {
+				Genode::uint64_t sum = 0;
+				trace.for_each_observed(subject_id, [&] (Subject_id const &,
+				                                         Location const &l,
+				                                         Execution_time const &load,
+				                                         unsigned) {
+					if (l.xpos() == xpos && hot(_value(load))) sum += _value(load); });
+				return sum;
+			};
+
+			/* a move must lower the hot load of the core to which we move */
+			Genode::uint64_t const current_load = core_load(current.xpos());
+			Genode::uint64_t const limit = current_load > own ? current_load - own : 0;
+
+			bool             found     = false;
+			Genode::uint64_t best_load = 0;
+			Genode::uint64_t best_idle = 0;
+
+			for (unsigned x = base.xpos(); x < base.xpos() + base.width(); x++) {
+				for (unsigned y = base.ypos(); y < base.ypos() + base.height(); y++) {
+
+					Location const loc(x, y, 1, 1);
+					if (_same(loc, current))
+						continue;
+
+					Genode::uint64_t const load = core_load(x);
+					Genode::uint64_t const idle = _value(trace.diff_idle_times(loc));
+
+					if (load >= limit)
+						continue;
+
+					if (!found || load < best_load
+					 || (load == best_load && idle > best_idle)) {
+						found     = true;
+						best_load = load;
+						best_idle = idle;
+						target    = loc;
+					}
+				}
+			}
+		}
+
+	public:
+
+		void config(Location const &) override { };
+		void thread_create(Location const &loc) override { location = loc; }
+
+		bool update(Location const &base, Location &current, Execution_time const &) override {
+			return _update(base, current); }
+
+		bool migrate(Location const &base, Location &current, Trace *trace) override
+		{
+			if (!trace || !trace->observe(subject_id))
+				return false;
+
+			if (_cooldown) {
+				_cooldown--;
+				return false;
+			}
+
+			Genode::uint64_t const own      = _value(trace->load(subject_id));
+			Genode::uint64_t const capacity = _value(trace->read_max_idle(current));
+
+			Location target = current;
+
+			if (!_colocate(base, current, *trace, own, capacity, target) && capacity)
+				_spread(base, current, *trace, own, capacity, target);
+
+			/* hysteresis, the same target must be proposed repeatedly */
+			if (_same(target, current)) {
+				_stable = 0;
+				return false;
+			}
+
+			if (_stable && _same(target, _pending))
+				_stable++;
+			else {
+				_pending = target;
+				_stable  = 1;
+			}
+
+			if (_stable < STABLE_ROUNDS)
+				return false;
+
+			current   = Location(target.xpos(), target.ypos(), 1, 1);
+			_stable   = 0;
+			_cooldown = COOLDOWN_ROUNDS;
+
+			trace->moved(subject_id, current);
+			return true;
+		}
+
+		void print(Genode::Output &output) const override {
+			Genode::print(output, "affinity"); }
+
+		bool same_type(Name const &name) const override {
+			return name == "affinity"; }
+
+		char const * string() const override {
+			return "affinity"; }
+};
+
 #endif
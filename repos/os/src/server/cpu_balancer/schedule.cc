@@ -33,6 +33,8 @@ void Cpu::Session::update_threads(Trace &trace, Session_label const &cpu_balance
 			return false;
 		}
 
+		policy.subject_id = subject_id;
+
 		Affinity::Location const &base = _affinity.location();
 		Affinity::Location current { base.xpos() + policy.location.xpos(),
 		                             base.ypos() + policy.location.ypos(), 1, 1 };
@@ -89,6 +89,8 @@ class Cpu::Session : public Rpc_object<Cpu_session>
 					*policy = new (_md_alloc) Policy_round_robin();
 				else if (name == "max-utilize")
 					*policy = new (_md_alloc) Policy_max_utilize();
+				else if (name == "affinity")
+					*policy = new (_md_alloc) Policy_affinity();
 				else
 					*policy = new (_md_alloc) Policy_none();
 
@@ -208,10 +210,8 @@ class Cpu::Session : public Rpc_object<Cpu_session>
 				if (thread._name != thread_name)
 					return false;
 
-				if (thread._fix) {
-					done = true;
-					return true;
-				}
+				/* an explicitly configured policy overrides the heuristic */
+				thread._fix = false;
 
 				if (!thread._policy->same_type(policy_name)) {
 					Cpu::Policy * new_policy = nullptr;
@@ -235,11 +235,21 @@ class Cpu::Session : public Rpc_object<Cpu_session>
 			                           Cpu::Policy &policy) {
 				store_name = thread_name;
 				fn(cap, policy);
-			});
+			}, true);
 		}
 
+		/**
+		 * Construct thread with policy
+		 *
+		 * \param configured  policy is explicitly configured for the thread
+		 *
+		 * Entrypoint and main threads without an explicitly configured
+		 * policy are kept at their location. Core on NOVA does not migrate
+		 * RPC entrypoint threads at all.
+		 */
 		template <typename FUNC>
-		void construct(Cpu::Policy::Name const &policy_name, FUNC const &fn)
+		void construct(Cpu::Policy::Name const &policy_name, FUNC const &fn,
+		               bool const configured = false)
 		{
 			Thread_client * thread = nullptr;
 
@@ -252,10 +262,11 @@ class Cpu::Session : public Rpc_object<Cpu_session>
 					fn(thread->_cap, thread->_name, *thread->_policy);
 
 					/* XXX - heuristic */
-					thread->_fix = (thread->_name == _label.last_element()) ||
-					               (thread->_name == "ep") ||
-					               (thread->_name == "signal_proxy") ||
-					               (thread->_name == "root");
+					thread->_fix = !configured &&
+					              ((thread->_name == _label.last_element()) ||
+					                (thread->_name == "ep") ||
+					                (thread->_name == "signal_proxy") ||
+					                (thread->_name == "root"));
 
 					if (thread->_fix) {
 						if (thread->_policy) {
@@ -12,6 +12,9 @@
  * under the terms of the GNU Affero General Public License version 3.
  */
 
+#include <dataspace/client.h>
+#include <rom_session/connection.h>
+
 #include "trace.h"
 
 void Cpu::Trace::_read_idle_times(bool skip_max_idle)
@@ -180,3 +183,165 @@ Genode::Session_label Cpu::Trace::lookup_my_label()
 
 	return label;
 }
+
+void Cpu::Trace::_load_policy()
+{
+	if (_policy_loaded || _policy_missing || !_trace.constructed())
+		return;
+
+	try {
+		Genode::Rom_connection rom(_env, "rpc_affinity");
+
+		Genode::Dataspace_capability const ds = rom.dataspace();
+		Genode::size_t const size = Genode::Dataspace_client(ds).size();
+
+		_policy_id = _trace->alloc_policy(size);
+
+		void *dst = _env.rm().attach(_trace->policy(_policy_id));
+		void *src = _env.rm().attach(ds);
+		Genode::memcpy(dst, src, size);
+		_env.rm().detach(dst);
+		_env.rm().detach(src);
+
+		_policy_loaded = true;
+	} catch (Genode::Service_denied) {
+		Genode::warning("trace policy 'rpc_affinity' missing, "
+		                "communication of threads is not considered");
+		_policy_missing = true;
+	}
+}
+
+void Cpu::Trace::_release_observed(unsigned const i)
+{
+	if (i >= MAX_OBSERVED)
+		return;
+
+	Observed &o = _observed[i];
+
+	if (o.buffer) {
+		o.reader.destruct();
+		_env.rm().detach(o.buffer);
+		o.buffer = nullptr;
+	}
+
+	o.id       = Subject_id();
+	o.location = Affinity::Location();
+	o.time     = Execution_time();
+	o.load     = Execution_time();
+
+	_graph.clear(i);
+}
+
+bool Cpu::Trace::observe(Subject_id const id)
+{
+	if (!_trace.constructed() || !id.id)
+		return false;
+
+	if (_observed_index(id) < MAX_OBSERVED)
+		return true;
+
+	unsigned i = 0;
+	for (; i < MAX_OBSERVED && _observed[i].id.id; i++) { }
+
+	if (i == MAX_OBSERVED)
+		return false;
+
+	Observed &o = _observed[i];
+	o.id = id;
+
+	_load_policy();
+
+	/* without events, the placement solely depends on the load */
+	if (!_policy_loaded)
+		return true;
+
+	using namespace Genode::Trace;
+
+	try {
+		_trace->trace(id, _policy_id, OBSERVED_BUFFER);
+
+		o.buffer = _env.rm().attach(_trace->buffer(id));
+		o.reader.construct(*o.buffer);
+
+	} catch (Source_is_dead) {
+		_release_observed(i);
+		return false;
+	} catch (Nonexistent_subject) {
+		_release_observed(i);
+		return false;
+	} catch (Already_traced) {
+		Genode::warning("thread already traced, subject id=", id.id);
+	} catch (Traced_by_other_session) {
+		Genode::warning("thread traced by other session, subject id=", id.id);
+	}
+
+	return true;
+}
+
+void Cpu::Trace::read_events(Genode::uint64_t const now_us)
+{
+	if (!_trace.constructed())
+		return;
+
+	/* calibrate time stamps of the events against the timer */
+	Genode::Trace::Timestamp const now = Genode::Trace::timestamp();
+
+	if (_last_us && now_us > _last_us && now > _last_timestamp)
+		_ticks_per_us = (now - _last_timestamp) / (now_us - _last_us);
+
+	_last_timestamp = now;
+	_last_us        = now_us;
+
+	for (unsigned i = 0; i < MAX_OBSERVED; i++) {
+		Observed &o = _observed[i];
+
+		if (!o.id.id)
+			continue;
+
+		Subject_info info { };
+		try { info = _trace->subject_info(o.id); }
+		catch (Genode::Trace::Nonexistent_subject) {
+			_release_observed(i);
+			continue;
+		}
+
+		if (info.state() == Subject_info::DEAD) {
+			try { _trace->free(o.id); }
+			catch (Genode::Trace::Nonexistent_subject) { }
+
+			_release_observed(i);
+			continue;
+		}
+
+		Execution_time const time = info.execution_time();
+
+		using Genode::uint64_t;
+
+		uint64_t const ec = (o.time.thread_context < time.thread_context) ?
+		                    time.thread_context - o.time.thread_context : 0;
+		uint64_t const sc = (o.time.scheduling_context < time.scheduling_context) ?
+		                    time.scheduling_context - o.time.scheduling_context : 0;
+
+		/* the first sample covers the whole lifetime of the thread */
+		bool const first = !o.time.thread_context && !o.time.scheduling_context;
+
+		o.load     = first ? Execution_time() : Execution_time(ec, sc);
+		o.time     = time;
+		o.location = info.affinity();
+
+		if (!o.reader.constructed())
+			continue;
+
+		o.reader->for_each_new_entry([&] (Genode::Trace::Buffer::Entry entry) {
+			if (entry.length() != sizeof(Affinity_graph::Affinity_event))
+				return;
+
+			Affinity_graph::Affinity_event event { };
+			Genode::memcpy(&event, entry.data(), sizeof(event));
+			_graph.add(i, event);
+		});
+	}
+
+	if (_ticks_per_us)
+		_graph.evaluate(_ticks_per_us * WINDOW_US);
+}
@@ -17,6 +17,9 @@
 
 #include <util/reconstructible.h>
 #include <trace_session/connection.h>
+#include <trace/trace_buffer.h>
+
+#include "affinity.h"
 
 namespace Cpu {
 	class Trace;
@@ -52,13 +55,68 @@ class Cpu::Trace
 
 		unsigned        _subject_id_reread { 0 };
 
+		/*
+		 * Threads traced with the 'rpc_affinity' policy to determine
+		 * which threads communicate with each other
+		 */
+		enum {
+			MAX_OBSERVED    = Affinity_graph::MAX_NODES,
+			OBSERVED_BUFFER = 8 * 1024,
+			WINDOW_US       = 20,    /* max delay between call and dispatch */
+		};
+
+		struct Observed
+		{
+			Subject_id                  id       { };
+			Genode::Trace::Buffer      *buffer   { nullptr };
+			Constructible<Trace_buffer> reader   { };
+			Affinity::Location          location { };
+			Execution_time              time     { };
+			Execution_time              load     { }; /* of last interval */
+
+			Observed() { }
+
+			/*
+			 * Noncopyable
+			 */
+			Observed(Observed const &);
+			Observed &operator = (Observed const &);
+		};
+
+		Observed       _observed[MAX_OBSERVED];
+		Affinity_graph _graph { };
+
+		Genode::Trace::Policy_id _policy_id      { };
+		bool                     _policy_loaded  { false };
+		bool                     _policy_missing { false };
+
+		Genode::Trace::Timestamp _last_timestamp { 0 };
+		Genode::uint64_t         _last_us        { 0 };
+		Genode::uint64_t         _ticks_per_us   { 0 };
+
 		void _lookup_missing_idle_id(Affinity::Location const &);
 
+		void _load_policy();
+		void _release_observed(unsigned);
+
+		unsigned _observed_index(Subject_id const id) const
+		{
+			for (unsigned i = 0; i < MAX_OBSERVED; i++)
+				if (id.id && _observed[i].id.id == id.id)
+					return i;
+			return MAX_OBSERVED;
+		}
+
 		void _reconstruct(Genode::size_t const upgrade = 4 * 4096)
 		{
 			_ram_quota += upgrade;
 			_arg_quota += upgrade;
 
+			/* subject ids and buffers become invalid with the session */
+			for (unsigned i = 0; i < MAX_OBSERVED; i++)
+				_release_observed(i);
+			_policy_loaded = false;
+
 			_trace.destruct();
 			_trace.construct(_env, _ram_quota, _arg_quota, 0 /* parent levels */);
 
@@ -165,6 +223,58 @@ class Cpu::Trace
 
 			return Execution_time { ec, sc };
 		}
+
+		/**
+		 * Start tracing the RPC and signal events of thread
+		 *
+		 * \return false if the thread cannot be observed
+		 */
+		bool observe(Subject_id const);
+
+		/**
+		 * Read events of observed threads and update affinity graph
+		 *
+		 * \param now_us  current time used to calibrate the time stamps
+		 */
+		void read_events(Genode::uint64_t now_us);
+
+		/**
+		 * Return execution time consumed by observed thread in last interval
+		 */
+		Execution_time load(Subject_id const id) const
+		{
+			unsigned const i = _observed_index(id);
+			return (i < MAX_OBSERVED) ? _observed[i].load : Execution_time(0, 0);
+		}
+
+		/**
+		 * Record migration of observed thread until its next trace update
+		 */
+		void moved(Subject_id const id, Affinity::Location const &location)
+		{
+			unsigned const i = _observed_index(id);
+			if (i < MAX_OBSERVED)
+				_observed[i].location = location;
+		}
+
+		/**
+		 * Call 'fn(id, location, load, weight)' for each other observed thread
+		 *
+		 * The weight denotes the communication affinity to thread 'id'.
+		 */
+		template <typename FUNC>
+		void for_each_observed(Subject_id const id, FUNC const &fn) const
+		{
+			unsigned const self = _observed_index(id);
+
+			for (unsigned i = 0; i < MAX_OBSERVED; i++) {
+				Observed const &o = _observed[i];
+				if (!o.id.id || i == self)
+					continue;
+
+				fn(o.id, o.location, o.load, _graph.weight(self, i));
+			}
+		}
 };
 
 struct Cpu::Sleeper : Genode::Thread
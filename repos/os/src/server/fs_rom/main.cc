@@ -474,6 +474,10 @@ class Fs_rom::Rom_session_component : public  Rpc_object<Rom_session>
 			case File_system::Packet_descriptor::WRITE_TIMESTAMP:
 				warning("discarding strange WRITE_TIMESTAMP acknowledgement");
 				return;
+			case File_system::Packet_descriptor::READ_V:
+			case File_system::Packet_descriptor::WRITE_V:
+				warning("discarding strange vectored acknowledgement");
+				return;
 			}
 		}
 };
@@ -55,6 +55,39 @@ class Lx_fs::Session_component : public Session_rpc_object
 		 ** Packet-stream processing **
 		 ******************************/
 
+		/**
+		 * Perform vectored packet operation segment by segment
+		 *
+		 * \return true on success, false on failure
+		 */
+		bool _process_segments(Packet_descriptor const &packet, Open_node &open_node)
+		{
+			char    * const content = tx_sink()->packet_content(packet);
+			Segment * const table   = packet.segment_table(content);
+
+			size_t offset = 0;
+			for (unsigned i = 0; i < packet.num_segments(); i++) {
+
+				/* copy segment from shared memory before checking its bounds */
+				Segment const segment = table[i];
+
+				if (segment.length > packet.length() - offset)
+					return false;
+
+				if (packet.operation() == Packet_descriptor::READ_V)
+					table[i].length = open_node.node().read(content + offset,
+					                                        segment.length,
+					                                        segment.position);
+
+				else if (open_node.node().write(content + offset, segment.length,
+				                                segment.position) != segment.length)
+					return false;
+
+				offset += segment.length;
+			}
+			return true;
+		}
+
 		/**
 		 * Perform packet operation
 		 *
@@ -126,6 +159,15 @@ class Lx_fs::Session_component : public Session_rpc_object
 				}
 
 				break;
+
+			case Packet_descriptor::READ_V:
+			case Packet_descriptor::WRITE_V:
+
+				if (tx_sink()->packet_valid(packet) && packet.segments_valid()) {
+					succeeded  = _process_segments(packet, open_node);
+					res_length = length;
+				}
+				break;
 			}
 
 			packet.length(res_length);
@@ -196,12 +238,14 @@ class Lx_fs::Session_component : public Session_rpc_object
 		 * Constructor
 		 */
 		Session_component(size_t       tx_buf_size,
+		                  unsigned     queue_size,
 		                  Genode::Env &env,
 		                  char const  *root_dir,
 		                  bool         writable,
 		                  Allocator   &md_alloc)
 		:
-			Session_rpc_object(env.ram().alloc(tx_buf_size), env.rm(), env.ep().rpc_ep()),
+			Session_rpc_object(env.ram().alloc(tx_buf_size), env.rm(),
+			                   env.ep().rpc_ep(), queue_size),
 			_env(env),
 			_md_alloc(md_alloc),
 			_root(*new (&_md_alloc) Directory(_md_alloc, root_dir, false)),
@@ -460,6 +504,22 @@ class Lx_fs::Root : public Root_component<Session_component>
 				throw Genode::Service_denied();
 			}
 
+			unsigned const queue_size =
+				Session_rpc_object::queue_size_from_args(args);
+
+			if (!Session_rpc_object::queue_size_valid(queue_size)) {
+				Genode::error(label, " requested invalid queue size ", queue_size,
+				              ", must be a power of two of at most ",
+				              (unsigned)File_system::Session::MAX_TX_QUEUE_SIZE);
+				throw Genode::Service_denied();
+			}
+
+			if (Session_rpc_object::queues_size(queue_size) >= tx_buf_size) {
+				Genode::error(label, " requested a transmission buffer too small "
+				              "for queue size ", queue_size);
+				throw Genode::Service_denied();
+			}
+
 			/*
 			 * Check if donated ram quota suffices for session data,
 			 * and communication buffer.
@@ -473,7 +533,8 @@ class Lx_fs::Root : public Root_component<Session_component>
 
 			try {
 				return new (md_alloc())
-				       Session_component(tx_buf_size, _env, root_dir, writeable, *md_alloc());
+				       Session_component(tx_buf_size, queue_size, _env, root_dir,
+				                         writeable, *md_alloc());
 			}
 			catch (Lookup_failed) {
 				Genode::error("session root directory \"", root, "\" "
@@ -41,14 +41,16 @@ class Nic_loopback::Session_component : public Nic::Session_component
 		 * \param rx_buf_size        buffer size for rx channel
 		 * \param rx_block_md_alloc  backing store of the meta data of the
 		 *                           rx block allocator
+		 * \param queues             number of queue pairs
 		 */
 		Session_component(size_t const tx_buf_size,
 		                  size_t const rx_buf_size,
 		                  Allocator   &rx_block_md_alloc,
-		                  Env         &env)
+		                  Env         &env,
+		                  unsigned     queues)
 		:
 			Nic::Session_component(tx_buf_size, rx_buf_size, CACHED,
-			                       rx_block_md_alloc, env)
+			                       rx_block_md_alloc, env, queues)
 		{ }
 
 		Nic::Mac_address mac_address() override
@@ -64,32 +66,44 @@ class Nic_loopback::Session_component : public Nic::Session_component
 			return true;
 		}
 
-		void _handle_packet_stream() override;
+		/**
+		 * Echo the packets of the tx channel of a queue pair to its rx channel
+		 */
+		void _handle_queue(unsigned queue);
+
+		void _handle_packet_stream() override
+		{
+			for (unsigned i = 0; i < queues(); i++)
+				_handle_queue(i);
+		}
 };
 
 
-void Nic_loopback::Session_component::_handle_packet_stream()
+void Nic_loopback::Session_component::_handle_queue(unsigned const queue)
 {
 	size_t const alloc_size = Nic::Packet_allocator::DEFAULT_PACKET_SIZE;
 
+	Session::Tx::Sink   &tx = *_tx_queue(queue).sink();
+	Session::Rx::Source &rx = *_rx_queue(queue).source();
+
 	/* loop while we can make progress */
 	for (;;) {
 
 		/* flush acknowledgements for the echoes packets */
-		while (_rx.source()->ack_avail())
-			_rx.source()->release_packet(_rx.source()->get_acked_packet());
+		while (rx.ack_avail())
+			rx.release_packet(rx.get_acked_packet());
 
 		/*
 		 * If the client cannot accept new acknowledgements for a sent packets,
 		 * we won't consume the sent packet.
 		 */
-		if (!_tx.sink()->ready_to_ack())
+		if (!tx.ready_to_ack())
 			return;
 
 		/*
 		 * Nothing to be done if the client has not sent any packets.
 		 */
-		if (!_tx.sink()->packet_avail())
+		if (!tx.packet_avail())
 			return;
 
 		/*
@@ -101,7 +115,7 @@ void Nic_loopback::Session_component::_handle_packet_stream()
 		 * The client fails to pick up the packets from the rx channel. So we
 		 * won't try to submit new packets.
 		 */
-		if (!_rx.source()->ready_to_submit())
+		if (!rx.ready_to_submit())
 			return;
 
 		/*
@@ -111,27 +125,27 @@ void Nic_loopback::Session_component::_handle_packet_stream()
 
 		Packet_descriptor packet_to_client;
 		try {
-			packet_to_client = _rx.source()->alloc_packet(alloc_size); }
+			packet_to_client = rx.alloc_packet(alloc_size); }
 		catch (Session::Rx::Source::Packet_alloc_failed) {
 			continue; }
 
 		/* obtain packet */
-		Packet_descriptor const packet_from_client = _tx.sink()->get_packet();
-		if (!packet_from_client.size() || !_tx.sink()->packet_valid(packet_from_client)) {
+		Packet_descriptor const packet_from_client = tx.get_packet();
+		if (!packet_from_client.size() || !tx.packet_valid(packet_from_client)) {
 			warning("received invalid packet");
-			_rx.source()->release_packet(packet_to_client);
+			rx.release_packet(packet_to_client);
 			continue;
 		}
 
-		memcpy(_rx.source()->packet_content(packet_to_client),
-		       _tx.sink()->packet_content(packet_from_client),
+		memcpy(rx.packet_content(packet_to_client),
+		       tx.packet_content(packet_from_client),
 		       packet_from_client.size());
 
 		packet_to_client = Packet_descriptor(packet_to_client.offset(),
 		                                     packet_from_client.size());
-		_rx.source()->submit_packet(packet_to_client);
+		rx.submit_packet(packet_to_client);
 
-		_tx.sink()->acknowledge_packet(packet_from_client);
+		tx.acknowledge_packet(packet_from_client);
 	}
 }
 
@@ -149,6 +163,9 @@ class Nic_loopback::Root : public Root_component<Session_component>
 			size_t ram_quota   = Arg_string::find_arg(args, "ram_quota"  ).ulong_value(0);
 			size_t tx_buf_size = Arg_string::find_arg(args, "tx_buf_size").ulong_value(0);
 			size_t rx_buf_size = Arg_string::find_arg(args, "rx_buf_size").ulong_value(0);
+			unsigned queues    = Arg_string::find_arg(args, "queues"     ).ulong_value(1);
+
+			queues = min(max(queues, 1U), (unsigned)Nic::Session::MAX_QUEUES);
 
 			/* deplete ram quota by the memory needed for the session structure */
 			size_t session_size = max(4096UL, (size_t)sizeof(Session_component));
@@ -156,18 +173,20 @@ class Nic_loopback::Root : public Root_component<Session_component>
 				throw Insufficient_ram_quota();
 
 			/*
-			 * Check if donated ram quota suffices for both communication
-			 * buffers and check for overflow
+			 * Check if donated ram quota suffices for the communication
+			 * buffers of all queue pairs and check for overflow
 			 */
-			if (tx_buf_size + rx_buf_size < tx_buf_size ||
-			    tx_buf_size + rx_buf_size > ram_quota - session_size) {
+			size_t const buf_size = tx_buf_size + rx_buf_size;
+			if (buf_size < tx_buf_size ||
+			    buf_size * queues / queues != buf_size ||
+			    buf_size * queues > ram_quota - session_size) {
 				error("insufficient 'ram_quota', got ", ram_quota, ", "
-				      "need ", tx_buf_size + rx_buf_size + session_size);
+				      "need ", buf_size * queues + session_size);
 				throw Insufficient_ram_quota();
 			}
 
 			return new (md_alloc()) Session_component(tx_buf_size, rx_buf_size,
-			                                          *md_alloc(), _env);
+			                                          *md_alloc(), _env, queues);
 		}
 
 	public:
@@ -312,6 +312,11 @@ Nic_session_component *Net::Nic_session_root::_create_session(char const *args)
 			Session_env &session_env {
 				*construct_at<Session_env>(ram_ptr, session_env_stack) };
 
+			/*
+			 * The 'queues' argument is not evaluated. The router handles all
+			 * packets at one entrypoint, so further queue pairs would not add
+			 * parallelism. The session thereby reports a single queue pair.
+			 */
 			/* create new session object behind session env in the RAM block */
 			try {
 				Session_label const label { label_from_args(args) };
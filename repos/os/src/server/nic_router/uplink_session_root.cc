@@ -169,6 +169,11 @@ Net::Uplink_session_root::_create_session(char const *args)
 				_invalid_downlink("malformed 'mac_address' arg");
 				throw Service_denied();
 			}
+			/*
+			 * The 'queues' argument is not evaluated. The router handles all
+			 * packets at one entrypoint, so further queue pairs would not add
+			 * parallelism. The session thereby reports a single queue pair.
+			 */
 			/* create new session object behind session env in the RAM block */
 			try {
 				return construct_at<Uplink_session_component>(
@@ -14,12 +14,13 @@
  */
 
 #include <base/attached_rom_dataspace.h>
-#include <base/attached_ram_dataspace.h>
 #include <base/component.h>
 #include <base/heap.h>
 #include <block_session/rpc_object.h>
 #include <block/request_stream.h>
 #include <os/session_policy.h>
+#include <region_map/client.h>
+#include <rm_session/connection.h>
 #include <util/bit_allocator.h>
 
 #include "gpt.h"
@@ -27,6 +28,8 @@
 
 namespace Block {
 	class  Session_component;
+	struct Zero_copy_window;
+	class  Session_buffer;
 	struct Session_handler;
 	struct Dispatch;
 	class  Main;
@@ -66,9 +69,123 @@ struct Block::Job_queue
 };
 
 
+/*
+ * Range of the packet-stream buffer shared with the device driver that is
+ * reserved as bulk buffer of one client session
+ */
+struct Block::Zero_copy_window : Noncopyable
+{
+	Rm_connection             &rm;
+	Dataspace_capability const device_ds;
+	Packet_descriptor    const reservation;
+
+	/* set once the session is closed while jobs may still be in flight */
+	bool retired { false };
+
+	Zero_copy_window(Rm_connection &rm, Dataspace_capability device_ds,
+	                 Packet_descriptor reservation)
+	: rm(rm), device_ds(device_ds), reservation(reservation) { }
+
+	off_t  offset() const { return reservation.offset(); }
+	size_t size()   const { return reservation.size(); }
+};
+
+
+/*
+ * Communication buffer of a client session
+ *
+ * With a zero-copy window, the buffer is a managed dataspace. Its head,
+ * which hosts the packet-stream queues, is backed by private RAM whereas
+ * the remainder is the window into the buffer shared with the device
+ * driver. Requests with their payload located within the window are
+ * forwarded to the driver without copying.
+ */
+class Block::Session_buffer
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Session_buffer(Session_buffer const &);
+		Session_buffer &operator = (Session_buffer const &);
+
+		Env                    &_env;
+		Zero_copy_window const *_window;
+		size_t            const _head_size;
+		size_t            const _align_log2;
+
+		Ram_dataspace_capability const _ram_ds { _env.ram().alloc(_head_size) };
+
+		Constructible<Region_map_client> _managed { };
+
+	public:
+
+		Session_buffer(Env &env, size_t size, Zero_copy_window const *window,
+		               size_t align_log2)
+		:
+			_env(env), _window(window),
+			_head_size(window ? size - window->size() : size),
+			_align_log2(align_log2)
+		{
+			if (!_window)
+				return;
+
+			_managed.construct(_window->rm.create(size));
+			_managed->attach_at(_ram_ds, 0);
+			_managed->attach(_window->device_ds, _window->size(),
+			                 _window->offset(), true, _head_size);
+		}
+
+		~Session_buffer()
+		{
+			if (_managed.constructed())
+				_window->rm.destroy(_managed->rpc_cap());
+
+			_env.ram().free(_ram_ds);
+		}
+
+		Dataspace_capability cap()
+		{
+			if (_managed.constructed())
+				return _managed->dataspace();
+
+			return _ram_ds;
+		}
+
+		/**
+		 * Call 'fn' with the payload of 'request' within the device buffer
+		 *
+		 * The functor is not called if the payload is not located within
+		 * the zero-copy window or violates the alignment constraints of the
+		 * device.
+		 */
+		template <typename FN>
+		void with_device_payload(Request const &request, size_t size,
+		                         FN const &fn) const
+		{
+			if (!_window || request.offset < (off_t)_head_size)
+				return;
+
+			size_t const offset = request.offset - _head_size;
+
+			if (offset + size > _window->size())
+				return;
+
+			if (offset & ((1UL << _align_log2) - 1))
+				return;
+
+			fn(Packet_descriptor::Payload { .offset = _window->offset() + (off_t)offset,
+			                                .bytes  = size });
+		}
+};
+
+
 struct Block::Dispatch : Interface
 {
 	virtual Response submit(long number, Request const &request, addr_t addr) = 0;
+	virtual Response submit_in_place(long number, Request const &request,
+	                                 Packet_descriptor::Payload payload) = 0;
 	virtual void     update() = 0;
 	virtual void     acknowledge_completed(bool all = true, long number = -1) = 0;
 	virtual Response sync(long number, Request const &request) = 0;
@@ -77,14 +194,15 @@ struct Block::Dispatch : Interface
 
 struct Block::Session_handler : Interface
 {
-	Env                   &env;
-	Attached_ram_dataspace ds;
+	Env           &env;
+	Session_buffer buffer;
 
 	Signal_handler<Session_handler> request_handler
 	  { env.ep(), *this, &Session_handler::handle };
 
-	Session_handler(Env &env, size_t buffer_size)
-	: env(env), ds(env.ram(), env.rm(), buffer_size)
+	Session_handler(Env &env, size_t buffer_size,
+	                Zero_copy_window const *window, size_t align_log2)
+	: env(env), buffer(env, buffer_size, window, align_log2)
 	{ }
 
 	virtual void handle_requests()= 0;
@@ -110,9 +228,10 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 		bool syncing { false };
 
 		Session_component(Env &env, long number, size_t buffer_size,
+		                  Zero_copy_window const *window,
 		                  Session::Info info, Dispatch &dispatcher)
-		: Session_handler(env, buffer_size),
-		  Request_stream(env.rm(), ds.cap(), env.ep(), request_handler, info),
+		: Session_handler(env, buffer_size, window, info.align_log2),
+		  Request_stream(env.rm(), buffer.cap(), env.ep(), request_handler, info),
 		  _number(number), _dispatcher(dispatcher)
 		{
 			env.ep().manage(*this);
@@ -179,8 +298,18 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 					}
 
 					with_payload([&] (Request_stream::Payload const &payload) {
-						payload.with_content(request, [&] (void *addr, size_t) {
-							response = _dispatcher.submit(_number, request, addr_t(addr));
+						payload.with_content(request, [&] (void *addr, size_t size) {
+
+							bool in_place = false;
+							buffer.with_device_payload(request, size,
+								[&] (Packet_descriptor::Payload device_payload) {
+									in_place = true;
+									response = _dispatcher.submit_in_place(_number, request,
+									                                       device_payload);
+								});
+
+							if (!in_place)
+								response = _dispatcher.submit(_number, request, addr_t(addr));
 						});
 					});
 
@@ -219,6 +348,8 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			_config.xml().attribute_value("io_buffer",
 			                              Number_of_bytes(4*1024*1024));
 
+		bool const _zero_copy = _config.xml().attribute_value("zero_copy", false);
+
 		Allocator_avl           _block_alloc { &_heap };
 		Block_connection        _block    { _env, &_block_alloc, _io_buffer_size };
 		Io_signal_handler<Main> _io_sigh  { _env.ep(), *this, &Main::_handle_io };
@@ -231,6 +362,78 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 		Job_queue<128>       _job_queue { };
 		Registry<Block::Job> _job_registry { };
 
+		Constructible<Rm_connection> _rm { };
+
+		Zero_copy_window *_windows[MAX_SESSIONS] { };
+
+		/*
+		 * Size of the session-buffer part that holds the packet-stream
+		 * queues, which cannot be shared with the device driver
+		 */
+		static size_t _queues_size()
+		{
+			return align_addr(Session::Tx_policy::Submit_queue::bytes(Session::TX_QUEUE_SIZE) +
+			                  Session::Tx_policy::Ack_queue::bytes(Session::TX_QUEUE_SIZE), 12);
+		}
+
+		Zero_copy_window *_alloc_window(long number, size_t buffer_size)
+		{
+			if (buffer_size < _queues_size() + 4096)
+				return nullptr;
+
+			size_t const size = (buffer_size - _queues_size()) & ~0xfffUL;
+
+			/*
+			 * The window of a previous session cannot be reused before all
+			 * of its jobs are completed because the device may still access
+			 * it. Until then, the session goes without zero-copy window.
+			 */
+			_release_retired_windows();
+			if (_windows[number])
+				return nullptr;
+
+			try {
+				Block::Session::Tx::Source &tx = *_block.tx();
+
+				int const align_log2 = max(12, (int)_block.info().align_log2);
+
+				_windows[number] = new (_heap)
+					Zero_copy_window(*_rm, tx.dataspace(),
+					                 tx.alloc_packet(size, align_log2));
+
+				return _windows[number];
+			}
+			catch (Block::Session::Tx::Source::Packet_alloc_failed) {
+				warning("io_buffer exhausted, no zero-copy window for partition ",
+				        number); }
+
+			return nullptr;
+		}
+
+		/**
+		 * Release windows of closed sessions once no job refers to them
+		 */
+		void _release_retired_windows()
+		{
+			for (long number = 0; number < MAX_SESSIONS; number++) {
+
+				Zero_copy_window *window = _windows[number];
+				if (!window || !window->retired)
+					continue;
+
+				bool in_flight = false;
+				_job_registry.for_each([&] (Job const &job) {
+					in_flight |= (job.number == number); });
+
+				if (in_flight)
+					continue;
+
+				_block.tx()->release_packet(window->reservation);
+				destroy(_heap, window);
+				_windows[number] = nullptr;
+			}
+		}
+
 		unsigned _wake_up_index { 0 };
 
 		void _wakeup_clients()
@@ -291,6 +494,9 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 		{
 			_block.sigh(_io_sigh);
 
+			if (_zero_copy)
+				_rm.construct(_env);
+
 			/* announce at parent */
 			env.parent().announce(env.ep().manage(*this));
 		}
@@ -364,15 +570,25 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				throw Insufficient_ram_quota();
 			}
 
+			Zero_copy_window *window = _zero_copy ? _alloc_window(num, tx_buf_size)
+			                                      : nullptr;
+
+			/*
+			 * Payloads within the zero-copy window are handed to the device
+			 * as is and must therefore satisfy its alignment constraints.
+			 */
 			Session::Info info {
 				.block_size  = _block.info().block_size,
 				.block_count = _partition_table.partition(num).sectors,
-				.align_log2  = 0,
+				.align_log2  = window ? _block.info().align_log2 : 0,
 				.writeable   = writeable,
 			};
 
-			_sessions[num] = new (_heap) Session_component(_env, num, tx_buf_size,
-			                                               info, *this);
+			size_t const buffer_size = window ? _queues_size() + window->size()
+			                                  : tx_buf_size;
+
+			_sessions[num] = new (_heap) Session_component(_env, num, buffer_size,
+			                                               window, info, *this);
 			return _sessions[num]->cap();
 		}
 
@@ -385,6 +601,11 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				destroy(_heap, _sessions[number]);
 				_sessions[number] = nullptr;
 
+				if (_windows[number]) {
+					_windows[number]->retired = true;
+					_release_retired_windows();
+				}
+
 				break;
 			}
 		}
@@ -424,7 +645,8 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 
 		void update() override { _block.update_jobs(*this); }
 
-		Response submit(long number, Request const &request, addr_t addr) override
+		template <typename FN>
+		Response _submit(long number, Request const &request, FN const &construct_fn)
 		{
 			Partition &partition = _partition_table.partition(number);
 			block_number_t last  = request.operation.block_number + request.operation.count;
@@ -442,12 +664,29 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				Operation op     = request.operation;
 				op.block_number += partition.lba;
 
-				job.construct(_block, op, _job_registry, index, number, request, addr);
+				construct_fn(job, op, index);
 			});
 
 			return Response::ACCEPTED;
 		}
 
+		Response submit(long number, Request const &request, addr_t addr) override
+		{
+			return _submit(number, request,
+				[&] (Job_object &job, Operation op, addr_t index) {
+					job.construct(_block, op, _job_registry, index, number,
+					              request, addr); });
+		}
+
+		Response submit_in_place(long number, Request const &request,
+		                         Packet_descriptor::Payload payload) override
+		{
+			return _submit(number, request,
+				[&] (Job_object &job, Operation op, addr_t index) {
+					job.construct(_block, op, payload, _job_registry, index,
+					              number, request); });
+		}
+
 		Response sync(long number, Request const &request) override
 		{
 			addr_t index = 0;
@@ -482,6 +721,8 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				if (_sessions[job.number]->acknowledge(job.request))
 					_job_queue.free(index);
 			});
+
+			_release_retired_windows();
 		}
 };
 
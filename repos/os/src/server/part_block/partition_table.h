@@ -61,6 +61,21 @@ struct Block::Job : public Block_connection::Job
 	: Block_connection::Job(connection, operation),
 	  registry_element(registry, *this),
 	  index(index), number(number), request(request), addr(addr) { }
+
+	/*
+	 * Job that transfers the data in place, 'payload' refers to the
+	 * zero-copy window of the client session
+	 */
+	Job(Block_connection          &connection,
+	    Operation                  operation,
+	    Packet_descriptor::Payload payload,
+	    Registry<Job>             &registry,
+	    addr_t const               index,
+	    addr_t const               number,
+	    Request                    request)
+	: Block_connection::Job(connection, operation, payload),
+	  registry_element(registry, *this),
+	  index(index), number(number), request(request), addr(0) { }
 };
 
 
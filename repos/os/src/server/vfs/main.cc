@@ -17,6 +17,7 @@
 #include <base/component.h>
 #include <base/registry.h>
 #include <base/heap.h>
+#include <base/blockade.h>
 #include <base/attached_ram_dataspace.h>
 #include <base/attached_rom_dataspace.h>
 #include <file_system_session/rpc_object.h>
@@ -34,6 +35,9 @@ namespace Vfs_server {
 
 	class Session_resources;
 	class Session_component;
+	class Session_scheduler;
+	class Worker_env;
+	class Worker;
 	class Vfs_env;
 	class Root;
 
@@ -200,7 +204,8 @@ class Vfs_server::Session_component : private Session_resources,
 				};
 
 				/* test for invalid packet */
-				if (packet.length() > packet.size()) {
+				if (packet.length() > packet.size()
+				 || (packet.vectored() && !packet.segments_valid())) {
 					consume_and_ack_invalid_packet();
 					continue;
 				}
@@ -434,10 +439,12 @@ class Vfs_server::Session_component : private Session_resources,
 		 * Constructor
 		 */
 		Session_component(Genode::Env         &env,
+		                  Genode::Entrypoint  &ep,
 		                  char          const *label,
 		                  Genode::Ram_quota    ram_quota,
 		                  Genode::Cap_quota    cap_quota,
 		                  size_t               tx_buf_size,
+		                  unsigned             queue_size,
 		                  Vfs::File_system    &vfs,
 		                  Session_queue       &active_sessions,
 		                  Io_progress_handler &io_progress_handler,
@@ -445,9 +452,10 @@ class Vfs_server::Session_component : private Session_resources,
 		                  bool                 writeable)
 		:
 			Session_resources(env.pd(), env.rm(), ram_quota, cap_quota, tx_buf_size),
-			Session_rpc_object(_packet_ds.cap(), env.rm(), env.ep().rpc_ep()),
+			Session_rpc_object(_packet_ds.cap(), env.rm(), ep.rpc_ep(),
+			                   queue_size),
 			_vfs(vfs),
-			_ep(env.ep()),
+			_ep(ep),
 			_io_progress_handler(io_progress_handler),
 			_active_sessions(active_sessions),
 			_root_path(root_path),
@@ -736,53 +744,28 @@ class Vfs_server::Session_component : private Session_resources,
 };
 
 
-class Vfs_server::Root : public Genode::Root_component<Session_component>,
-                         private Genode::Entrypoint::Io_progress_handler
+/**
+ * Scheduler of the packet processing of the sessions served by one entrypoint
+ */
+class Vfs_server::Session_scheduler : public Io_progress_handler
 {
 	private:
 
-		Genode::Env &_env;
-
-		Genode::Attached_rom_dataspace _config_rom { _env, "config" };
+		Genode::Signal_handler<Session_scheduler> _reactivate_handler;
 
-		Genode::Xml_node vfs_config()
-		{
-			try { return _config_rom.xml().sub_node("vfs"); }
-			catch (...) {
-				Genode::error("VFS not configured");
-				_env.parent().exit(~0);
-				throw;
-			}
-		}
-
-		Genode::Signal_handler<Root> _reactivate_handler {
-			_env.ep(), *this, &Root::handle_io_progress };
+		/* sessions with active jobs */
+		Session_queue _active_sessions { };
 
-		Genode::Signal_handler<Root> _config_handler {
-			_env.ep(), *this, &Root::_config_update };
+	public:
 
-		void _config_update()
+		Session_scheduler(Genode::Entrypoint &ep)
+		:
+			_reactivate_handler(ep, *this, &Session_scheduler::handle_io_progress)
 		{
-			_config_rom.update();
-			_vfs_env.root_dir().apply_config(vfs_config());
-
-			/*
-			 * The VFS configuration change may result in watch notifications
-			 * generated by VFS plugins. Execute 'handle_io_progress' to
-			 * deliver the watch notifications.
-			 */
-			handle_io_progress();
+			ep.register_io_progress_handler(*this);
 		}
 
-		/**
-		 * The VFS uses an internal heap that
-		 * subtracts from the component quota
-		 */
-		Genode::Heap    _vfs_heap { &_env.ram(), &_env.rm() };
-		Vfs::Simple_env _vfs_env  { _env, _vfs_heap, vfs_config() };
-
-		/* sessions with active jobs */
-		Session_queue _active_sessions { };
+		Session_queue &active_sessions() { return _active_sessions; }
 
 		/**
 		 * Entrypoint::Io_progress_handler interface
@@ -840,6 +823,402 @@ class Vfs_server::Root : public Genode::Root_component<Session_component>,
 			if (yield)
 				Genode::Signal_transmitter(_reactivate_handler).submit();
 		}
+};
+
+
+/**
+ * Environment of a worker's VFS, which uses the worker's entrypoint
+ */
+class Vfs_server::Worker_env : public Genode::Env
+{
+	private:
+
+		Genode::Env        &_env;
+		Genode::Entrypoint &_ep;
+
+	public:
+
+		Worker_env(Genode::Env &env, Genode::Entrypoint &ep) : _env(env), _ep(ep) { }
+
+		using Parent                   = Genode::Parent;
+		using Cpu_session              = Genode::Cpu_session;
+		using Pd_session               = Genode::Pd_session;
+		using Region_map               = Genode::Region_map;
+		using Entrypoint               = Genode::Entrypoint;
+		using Affinity                 = Genode::Affinity;
+		using Session_capability       = Genode::Session_capability;
+		using Cpu_session_capability   = Genode::Cpu_session_capability;
+		using Pd_session_capability    = Genode::Pd_session_capability;
+
+		Parent      &parent() override { return _env.parent(); }
+		Cpu_session &cpu()    override { return _env.cpu(); }
+		Region_map  &rm()     override { return _env.rm(); }
+		Pd_session  &pd()     override { return _env.pd(); }
+		Entrypoint  &ep()     override { return _ep; }
+
+		Cpu_session_capability cpu_session_cap() override { return _env.cpu_session_cap(); }
+		Pd_session_capability  pd_session_cap()  override { return _env.pd_session_cap(); }
+
+		Genode::Id_space<Parent::Client> &id_space() override { return _env.id_space(); }
+
+		Session_capability session(Parent::Service_name const &name,
+		                           Parent::Client::Id          id,
+		                           Parent::Session_args const &args,
+		                           Affinity             const &affinity) override {
+			return _env.session(name, id, args, affinity); }
+
+		void upgrade(Parent::Client::Id id, Parent::Upgrade_args const &args) override {
+			_env.upgrade(id, args); }
+
+		void close(Parent::Client::Id id) override { _env.close(id); }
+
+		void exec_static_constructors() override { }
+
+		void reinit(Genode::Native_capability::Raw raw) override {
+			_env.reinit(raw); }
+
+		void reinit_main_thread(Genode::Capability<Region_map> &stack_area_rm) override {
+			_env.reinit_main_thread(stack_area_rm); }
+};
+
+
+/**
+ * Thread that serves sessions with a private VFS instance
+ *
+ * A worker has its own entrypoint, which handles the RPC requests and
+ * packet-stream signals of its sessions as well as the I/O signals of its
+ * VFS plugins. Hence, a slow back end of one worker does not delay the
+ * sessions served by other workers or by the main entrypoint.
+ *
+ * Workers are declared by '<worker name="..." cpu="...">' nodes, each
+ * hosting a '<vfs>' node. A session policy assigns its sessions to a worker
+ * via the 'worker' attribute. The VFS of a worker is not shared with the
+ * main VFS and is not affected by configuration updates.
+ */
+class Vfs_server::Worker : Genode::Registry<Worker>::Element
+{
+	public:
+
+		typedef Genode::String<64> Name;
+
+		enum { STACK_SIZE = 16*1024*sizeof(long) };
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Worker(Worker const &);
+		Worker &operator = (Worker const &);
+
+		Name const _name;
+
+		Genode::Entrypoint _ep;
+		Worker_env         _env;
+
+		Session_scheduler _scheduler { _ep };
+
+		Genode::Heap _vfs_heap { &_env.ram(), &_env.rm() };
+
+		Genode::Constructible<Vfs::Simple_env> _vfs_env { };
+
+		/*
+		 * Execution of functors in the context of the worker thread
+		 */
+
+		struct Job : Genode::Interface { virtual void execute() = 0; };
+
+		Genode::Mutex    _job_mutex { };
+		Job             *_job       { nullptr };
+		Genode::Blockade _job_done  { };
+
+		void _handle_job()
+		{
+			if (!_job)
+				return;
+
+			_job->execute();
+			_job = nullptr;
+			_job_done.wakeup();
+		}
+
+		Genode::Signal_handler<Worker> _job_handler {
+			_ep, *this, &Worker::_handle_job };
+
+		/**
+		 * Execute 'fn' by the worker thread and wait for its completion
+		 *
+		 * The functor must not throw.
+		 */
+		template <typename FN>
+		void _apply(FN const &fn)
+		{
+			Genode::Mutex::Guard guard(_job_mutex);
+
+			struct Functor_job : Job
+			{
+				FN const &fn;
+				Functor_job(FN const &fn) : fn(fn) { }
+				void execute() override { fn(); }
+			} job { fn };
+
+			_job = &job;
+			Genode::Signal_transmitter(_job_handler).submit();
+			_job_done.block();
+		}
+
+		static Genode::Affinity::Location _location(Genode::Env &env,
+		                                            Genode::Xml_node node)
+		{
+			if (!node.has_attribute("cpu"))
+				return Genode::Affinity::Location();
+
+			return env.cpu().affinity_space().location_of_index(
+				node.attribute_value("cpu", 0U));
+		}
+
+	public:
+
+		Worker(Genode::Registry<Worker> &registry, Genode::Env &env,
+		       Genode::Xml_node node)
+		:
+			Genode::Registry<Worker>::Element(registry, *this),
+			_name(node.attribute_value("name", Name())),
+			_ep(env, STACK_SIZE, Genode::String<80>("vfs_", _name).string(),
+			    _location(env, node)),
+			_env(env, _ep)
+		{
+			Genode::Xml_node const vfs_config = node.sub_node("vfs");
+
+			_apply([&] () {
+				_vfs_env.construct(_env, _vfs_heap, vfs_config); });
+		}
+
+		Name const &name() const { return _name; }
+
+		/**
+		 * Create session served by the worker
+		 *
+		 * \return nullptr if the session root does not exist
+		 */
+		template <typename CREATE_FN>
+		Session_component *create_session(Path const &session_root,
+		                                  CREATE_FN const &create_fn)
+		{
+			Session_component *session = nullptr;
+			bool root_exists = false;
+			bool out_of_caps = false;
+
+			_apply([&] () {
+
+				Vfs::File_system &vfs = _vfs_env->root_dir();
+
+				root_exists = (session_root == "/")
+				           || vfs.directory(session_root.base());
+				if (!root_exists)
+					return;
+
+				try {
+					session = create_fn(_ep, vfs, _scheduler);
+					_ep.rpc_ep().manage(session);
+				}
+				catch (Genode::Out_of_caps) { out_of_caps = true; }
+				catch (...) { }
+			});
+
+			if (!root_exists)
+				return nullptr;
+
+			if (out_of_caps)
+				throw Genode::Out_of_caps();
+
+			if (!session)
+				throw Genode::Out_of_ram();
+
+			return session;
+		}
+
+		/**
+		 * Apply 'fn' to the session with capability 'cap' if served by the worker
+		 *
+		 * \return true if the session is served by the worker
+		 */
+		template <typename FN>
+		bool apply(Genode::Session_capability cap, FN const &fn)
+		{
+			bool served = false;
+
+			_apply([&] () {
+				_ep.rpc_ep().apply(cap, [&] (Session_component *session) {
+					if (!session)
+						return;
+
+					served = true;
+					fn(*session);
+				});
+			});
+
+			return served;
+		}
+
+		/**
+		 * Close session if served by the worker
+		 *
+		 * \return true if the session was served by the worker
+		 */
+		template <typename DESTROY_FN>
+		bool close(Genode::Session_capability cap, DESTROY_FN const &destroy_fn)
+		{
+			Session_component *session = nullptr;
+
+			_apply([&] () {
+				_ep.rpc_ep().apply(cap, [&] (Session_component *s) {
+					if (s)
+						_ep.rpc_ep().dissolve(s);
+					session = s;
+				});
+
+				if (session)
+					destroy_fn(session);
+			});
+
+			return session != nullptr;
+		}
+};
+
+
+class Vfs_server::Root : public Genode::Root_component<Session_component>
+{
+	private:
+
+		Genode::Env &_env;
+
+		Genode::Attached_rom_dataspace _config_rom { _env, "config" };
+
+		Genode::Xml_node vfs_config()
+		{
+			try { return _config_rom.xml().sub_node("vfs"); }
+			catch (...) {
+				Genode::error("VFS not configured");
+				_env.parent().exit(~0);
+				throw;
+			}
+		}
+
+		Genode::Signal_handler<Root> _config_handler {
+			_env.ep(), *this, &Root::_config_update };
+
+		void _config_update()
+		{
+			_config_rom.update();
+			_vfs_env.root_dir().apply_config(vfs_config());
+
+			/*
+			 * The VFS configuration change may result in watch notifications
+			 * generated by VFS plugins. Execute 'handle_io_progress' to
+			 * deliver the watch notifications.
+			 */
+			_scheduler.handle_io_progress();
+		}
+
+		/**
+		 * The VFS uses an internal heap that
+		 * subtracts from the component quota
+		 */
+		Genode::Heap    _vfs_heap { &_env.ram(), &_env.rm() };
+		Vfs::Simple_env _vfs_env  { _env, _vfs_heap, vfs_config() };
+
+		/* packet processing of the sessions served by the main entrypoint */
+		Session_scheduler _scheduler { _env.ep() };
+
+		/* workers with private VFS instances, configured at startup */
+		Genode::Registry<Worker> _workers { };
+
+		void _construct_workers()
+		{
+			_config_rom.xml().for_each_sub_node("worker", [&] (Genode::Xml_node node) {
+
+				Worker::Name const name = node.attribute_value("name", Worker::Name());
+
+				if (!name.valid() || !node.has_sub_node("vfs")) {
+					Genode::error("worker lacks 'name' attribute or 'vfs' node");
+					return;
+				}
+
+				if (_with_worker(name, [] (Worker &) { })) {
+					Genode::error("worker '", name, "' defined twice");
+					return;
+				}
+
+				new (_vfs_heap) Worker(_workers, _env, node);
+			});
+		}
+
+		/*
+		 * Sessions served by workers, looked up on upgrade and close
+		 */
+		struct Worker_session : Genode::Registry<Worker_session>::Element
+		{
+			Genode::Session_capability const cap;
+			Worker                          &worker;
+
+			Worker_session(Genode::Registry<Worker_session> &registry,
+			               Genode::Session_capability cap, Worker &worker)
+			:
+				Genode::Registry<Worker_session>::Element(registry, *this),
+				cap(cap), worker(worker)
+			{ }
+		};
+
+		Genode::Registry<Worker_session> _worker_sessions { };
+
+		/**
+		 * Apply 'fn' to the worker that serves the session 'cap'
+		 *
+		 * \return false if the session is not served by a worker
+		 */
+		template <typename FN>
+		bool _with_worker_session(Genode::Session_capability cap, FN const &fn)
+		{
+			Worker_session *found = nullptr;
+			_worker_sessions.for_each([&] (Worker_session &ws) {
+				if (ws.cap == cap)
+					found = &ws; });
+
+			if (found)
+				fn(*found);
+
+			return found != nullptr;
+		}
+
+		/**
+		 * Return true if the session 'cap' is managed by the root's entrypoint
+		 */
+		bool _served_by_root_ep(Genode::Session_capability cap)
+		{
+			bool served = false;
+			ep()->apply(cap, [&] (Session_component *session) {
+				served = (session != nullptr); });
+			return served;
+		}
+
+		/**
+		 * Apply 'fn' to the worker named 'name'
+		 *
+		 * \return false if no such worker exists
+		 */
+		template <typename FN>
+		bool _with_worker(Worker::Name const &name, FN const &fn)
+		{
+			bool found = false;
+			_workers.for_each([&] (Worker &worker) {
+				if (!found && worker.name() == name) {
+					found = true;
+					fn(worker);
+				}
+			});
+			return found;
+		}
 
 	protected:
 
@@ -867,6 +1246,22 @@ class Vfs_server::Root : public Genode::Root_component<Session_component>,
 			if (!tx_buf_size)
 				throw Service_denied();
 
+			unsigned const queue_size =
+				Session_rpc_object::queue_size_from_args(args);
+
+			if (!Session_rpc_object::queue_size_valid(queue_size)) {
+				error("invalid queue size ", queue_size, " requested by '",
+				      label, "', must be a power of two of at most ",
+				      (unsigned)File_system::Session::MAX_TX_QUEUE_SIZE);
+				throw Service_denied();
+			}
+
+			if (Session_rpc_object::queues_size(queue_size) >= tx_buf_size) {
+				error("'tx_buf_size' of '", label, "' too small for "
+				      "queue size ", queue_size);
+				throw Service_denied();
+			}
+
 			size_t session_size =
 				max((size_t)4096, sizeof(Session_component)) +
 				tx_buf_size;
@@ -915,21 +1310,46 @@ class Vfs_server::Root : public Genode::Root_component<Session_component>,
 				}
 			}
 
+			auto create = [&] (Entrypoint &ep, Vfs::File_system &vfs,
+			                   Session_scheduler &scheduler)
+			{
+				return new (md_alloc())
+					Session_component(_env, ep, label.string(),
+					                  Genode::Ram_quota{ram_quota},
+					                  Genode::Cap_quota{cap_quota},
+					                  tx_buf_size, queue_size, vfs,
+					                  scheduler.active_sessions(), scheduler,
+					                  session_root.base(), writeable);
+			};
+
+			Session_component *session = nullptr;
+
+			/* serve the session by a worker if requested by the policy */
+			Worker::Name const worker_name =
+				policy.attribute_value("worker", Worker::Name());
+
+			if (worker_name.valid()) {
+				if (!_with_worker(worker_name, [&] (Worker &worker) {
+					session = worker.create_session(session_root, create);
+					if (session)
+						new (_vfs_heap)
+							Worker_session(_worker_sessions, session->cap(), worker);
+				})) {
+					error("worker '", worker_name, "' of '", label, "' not defined");
+					throw Service_denied();
+				}
+			}
+
 			/* check if the session root exists */
-			if (!((session_root == "/")
-			 || _vfs_env.root_dir().directory(session_root.base()))) {
+			else if ((session_root == "/")
+			      || _vfs_env.root_dir().directory(session_root.base()))
+				session = create(_env.ep(), _vfs_env.root_dir(), _scheduler);
+
+			if (!session) {
 				error("session root '", session_root, "' not found for '", label, "'");
 				throw Service_denied();
 			}
 
-			Session_component *session = new (md_alloc())
-				Session_component(_env, label.string(),
-				                  Genode::Ram_quota{ram_quota},
-				                  Genode::Cap_quota{cap_quota},
-				                  tx_buf_size, _vfs_env.root_dir(),
-				                  _active_sessions, *this,
-				                  session_root.base(), writeable);
-
 			auto ram_used = _env.pd().used_ram().value - initial_ram_usage;
 			auto cap_used = _env.pd().used_caps().value - initial_cap_usage;
 
@@ -971,10 +1391,57 @@ class Vfs_server::Root : public Genode::Root_component<Session_component>,
 			Root_component<Session_component>(&env.ep().rpc_ep(), &md_alloc),
 			_env(env)
 		{
-			_env.ep().register_io_progress_handler(*this);
+			_construct_workers();
 			_config_rom.sigh(_config_handler);
 			env.parent().announce(env.ep().manage(*this));
 		}
+
+
+		/********************
+		 ** Root interface **
+		 ********************/
+
+		/*
+		 * Sessions served by workers are managed by the workers' entrypoints
+		 * and are therefore unknown to the entrypoint of the root component.
+		 * They are dispatched only to the worker recorded at session creation
+		 * so that a busy worker does not stall requests for other sessions.
+		 */
+
+		void upgrade(Genode::Session_capability cap,
+		             Genode::Root::Upgrade_args const &args) override
+		{
+			if (!args.valid_string()) throw Genode::Service_denied();
+
+			if (_served_by_root_ep(cap)) {
+				Root_component<Session_component>::upgrade(cap, args);
+				return;
+			}
+
+			bool const served_by_worker = _with_worker_session(cap, [&] (Worker_session &ws) {
+				ws.worker.apply(cap, [&] (Session_component &session) {
+					_upgrade_session(&session, args.string()); }); });
+
+			if (!served_by_worker)
+				Root_component<Session_component>::upgrade(cap, args);
+		}
+
+		void close(Genode::Session_capability cap) override
+		{
+			if (_served_by_root_ep(cap)) {
+				Root_component<Session_component>::close(cap);
+				return;
+			}
+
+			bool const served_by_worker = _with_worker_session(cap, [&] (Worker_session &ws) {
+				ws.worker.close(cap, [&] (Session_component *session) {
+					_destroy_session(session); });
+				Genode::destroy(_vfs_heap, &ws);
+			});
+
+			if (!served_by_worker)
+				Root_component<Session_component>::close(cap);
+		}
 };
 
 
@@ -308,15 +308,20 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 
 	protected:
 
+		bool _queue_read_at(file_offset seek_offset, file_size count)
+		{
+			_handle.seek(seek_offset);
+
+			return _handle.fs().queue_read(&_handle, count);
+		}
+
 		Submit_result _submit_read_at(file_offset seek_offset)
 		{
 			if (!(_mode & READ_ONLY))
 				return Submit_result::DENIED;
 
-			_handle.seek(seek_offset);
-
 			bool const queuing_succeeded =
-				_handle.fs().queue_read(&_handle, _packet.length());
+				_queue_read_at(seek_offset, _packet.length());
 
 			if (queuing_succeeded)
 				_packet_in_progress = true;
@@ -664,6 +669,11 @@ struct Vfs_server::Symlink : Io_node
 			case Packet_descriptor::READ_READY:      return _submit_read_ready();
 			case Packet_descriptor::CONTENT_CHANGED: return _submit_content_changed();
 			case Packet_descriptor::WRITE_TIMESTAMP: return _submit_write_timestamp();
+
+			/* vectored operations are not supported */
+			case Packet_descriptor::READ_V:
+			case Packet_descriptor::WRITE_V:
+				break;
 			}
 
 			Genode::warning("invalid operation ", (int)_packet.operation(), " "
@@ -701,6 +711,8 @@ struct Vfs_server::Symlink : Io_node
 			/* never executed */
 			case Packet_descriptor::READ_READY:
 			case Packet_descriptor::CONTENT_CHANGED:
+			case Packet_descriptor::READ_V:
+			case Packet_descriptor::WRITE_V:
 				break;
 			}
 		}
@@ -731,10 +743,8 @@ class Vfs_server::File : public Io_node
 				fn(stat);
 		}
 
-		seek_off_t _seek_pos()
+		seek_off_t _seek_pos(seek_off_t seek_pos)
 		{
-			seek_off_t seek_pos = _packet.position();
-
 			if (seek_pos == (seek_off_t)SEEK_TAIL)
 				_with_stat([&] (Stat const &stat) {
 					seek_pos = stat.size; });
@@ -742,6 +752,8 @@ class Vfs_server::File : public Io_node
 			return seek_pos;
 		}
 
+		seek_off_t _seek_pos() { return _seek_pos(_packet.position()); }
+
 		enum class Write_type { UNKNOWN, CONTINUOUS, TRANSACTIONAL };
 
 		Write_type _write_type = Write_type::UNKNOWN;
@@ -755,6 +767,138 @@ class Vfs_server::File : public Io_node
 
 		bool _watch_read_ready = false;
 
+		/*
+		 * Progress of vectored operations
+		 */
+		unsigned _segment        = 0;      /* index of current segment */
+		size_t   _segment_offset = 0;      /* payload offset of segment data */
+		bool     _segment_queued = false;  /* read of segment is queued */
+
+		/**
+		 * Return true if a partially completed write may be continued
+		 */
+		bool _continuous_write()
+		{
+			/* determine write type once via 'stat' */
+			if (_write_type == Write_type::UNKNOWN) {
+				_write_type = Write_type::TRANSACTIONAL;
+
+				_with_stat([&] (Stat const &stat) {
+					if (stat.type == Vfs::Node_type::CONTINUOUS_FILE)
+						_write_type = Write_type::CONTINUOUS; });
+			}
+
+			return _write_type == Write_type::CONTINUOUS;
+		}
+
+		/**
+		 * Return current segment of vectored operation
+		 *
+		 * The segment table resides in memory shared with the client. Hence,
+		 * the segment is copied and its bounds are checked.
+		 *
+		 * \return false if the segment exceeds the packet payload
+		 */
+		bool _current_segment(::File_system::Segment &segment) const
+		{
+			segment = _packet.segment_table(_payload_ptr.ptr)[_segment];
+
+			return segment.length <= _packet.length() - _segment_offset;
+		}
+
+		Submit_result _submit_read_v()
+		{
+			if (!(mode() & READ_ONLY))
+				return Submit_result::DENIED;
+
+			_packet_in_progress = true;
+			return Submit_result::ACCEPTED;
+		}
+
+		void _execute_read_v()
+		{
+			while (_segment < _packet.num_segments()) {
+
+				::File_system::Segment segment { };
+				if (!_current_segment(segment)) {
+					_acknowledge_as_failure();
+					return;
+				}
+
+				if (!_segment_queued) {
+					if (!_queue_read_at(_seek_pos(segment.position), segment.length))
+						return; /* retry on next execution */
+
+					_segment_queued = true;
+				}
+
+				file_size out_count = 0;
+
+				switch (_handle.fs().complete_read(&_handle,
+				                                   _payload_ptr.ptr + _segment_offset,
+				                                   segment.length, out_count)) {
+				case Read_result::READ_OK:
+					break;
+
+				case Read_result::READ_ERR_IO:
+				case Read_result::READ_ERR_INVALID:
+					_acknowledge_as_failure();
+					return;
+
+				case Read_result::READ_ERR_WOULD_BLOCK:
+				case Read_result::READ_ERR_AGAIN:
+				case Read_result::READ_ERR_INTERRUPT:
+				case Read_result::READ_QUEUED:
+					return;
+				}
+
+				/* report number of bytes read for the segment */
+				_packet.segment_table(_payload_ptr.ptr)[_segment].length = out_count;
+
+				_segment_queued  = false;
+				_segment_offset += segment.length;
+				_segment++;
+			}
+
+			_acknowledge_as_success(_packet.length());
+		}
+
+		void _execute_write_v()
+		{
+			while (_segment < _packet.num_segments()) {
+
+				::File_system::Segment segment { };
+				if (!_current_segment(segment)) {
+					_acknowledge_as_failure();
+					return;
+				}
+
+				if (_write_pos == 0)
+					_initial_write_seek_offset = _seek_pos(segment.position);
+
+				size_t       const count    = segment.length - _write_pos;
+				char const * const src_ptr  = _payload_ptr.ptr + _segment_offset + _write_pos;
+				size_t       const consumed = _execute_write(src_ptr, count,
+				                                             _write_pos);
+				if (!job_in_progress())
+					return;
+
+				if (consumed < count) {
+					if (_continuous_write())
+						_write_pos += consumed;
+					else
+						_acknowledge_as_failure();
+					return;
+				}
+
+				_write_pos       = 0;
+				_segment_offset += segment.length;
+				_segment++;
+			}
+
+			_acknowledge_as_success(_packet.length());
+		}
+
 	protected:
 
 		static Vfs_handle &_open(Vfs::File_system  &vfs, Genode::Allocator &alloc,
@@ -790,8 +934,11 @@ class Vfs_server::File : public Io_node
 		{
 			_import_job(packet, payload_ptr);
 
-			_write_type = Write_type::UNKNOWN;
-			_write_pos  = 0;
+			_write_type     = Write_type::UNKNOWN;
+			_write_pos      = 0;
+			_segment        = 0;
+			_segment_offset = 0;
+			_segment_queued = false;
 
 			switch (packet.operation()) {
 
@@ -801,6 +948,8 @@ class Vfs_server::File : public Io_node
 			case Packet_descriptor::READ_READY:      return _submit_read_ready();
 			case Packet_descriptor::CONTENT_CHANGED: return _submit_content_changed();
 			case Packet_descriptor::WRITE_TIMESTAMP: return _submit_write_timestamp();
+			case Packet_descriptor::READ_V:          return _submit_read_v();
+			case Packet_descriptor::WRITE_V:         return _submit_write_at(0);
 			}
 
 			Genode::warning("invalid operation ", (int)_packet.operation(), " "
@@ -830,17 +979,7 @@ class Vfs_server::File : public Io_node
 					 * Continue writing if the file is continuous.
 					 * Return an error if the file is transactional.
 					 */
-
-					/* determine write type once via 'stat' */
-					if (_write_type == Write_type::UNKNOWN) {
-						_write_type = Write_type::TRANSACTIONAL;
-
-						_with_stat([&] (Stat const &stat) {
-							if (stat.type == Vfs::Node_type::CONTINUOUS_FILE)
-								_write_type = Write_type::CONTINUOUS; });
-					}
-
-					if (_write_type == Write_type::TRANSACTIONAL) {
+					if (!_continuous_write()) {
 						_acknowledge_as_failure();
 						break;
 					}
@@ -852,6 +991,9 @@ class Vfs_server::File : public Io_node
 					break;
 				}
 
+			case Packet_descriptor::READ_V:  _execute_read_v();  break;
+			case Packet_descriptor::WRITE_V: _execute_write_v(); break;
+
 			/* generic */
 			case Packet_descriptor::READ:            _execute_read(); break;
 			case Packet_descriptor::SYNC:            _execute_sync(); break;
@@ -1037,6 +1179,8 @@ struct Vfs_server::Directory : Io_node
 				return _submit_read_at(_packet.position());
 
 			case Packet_descriptor::WRITE:
+			case Packet_descriptor::READ_V:
+			case Packet_descriptor::WRITE_V:
 				return Submit_result::DENIED;
 
 			case Packet_descriptor::SYNC:            return _submit_sync();
@@ -1078,6 +1222,8 @@ struct Vfs_server::Directory : Io_node
 			case Packet_descriptor::WRITE:
 			case Packet_descriptor::READ_READY:
 			case Packet_descriptor::CONTENT_CHANGED:
+			case Packet_descriptor::READ_V:
+			case Packet_descriptor::WRITE_V:
 				break;
 			}
 		}
@@ -45,6 +45,7 @@ struct Vfs_block::File_info
 	File_path const path;
 	bool      const writeable;
 	size_t    const block_size;
+	unsigned  const queue_depth;
 };
 
 
@@ -59,10 +60,14 @@ Vfs_block::File_info Vfs_block::file_info_from_policy(Session_policy const &poli
 	size_t const block_size =
 		policy.attribute_value("block_size", 512u);
 
+	unsigned const queue_depth =
+		policy.attribute_value("queue_depth", 8u);
+
 	return File_info {
-		.path       = file_path,
-		.writeable  = writeable,
-		.block_size = block_size };
+		.path        = file_path,
+		.writeable   = writeable,
+		.block_size  = block_size,
+		.queue_depth = queue_depth };
 }
 
 
@@ -73,10 +78,36 @@ class Vfs_block::File
 		File(const File&) = delete;
 		File& operator=(const File&) = delete;
 
+		enum { MAX_JOBS = 64 };
+
 		Vfs::File_system &_vfs;
-		Vfs::Vfs_handle  *_vfs_handle;
 
-		Constructible<Vfs_block::Job> _job { };
+		/*
+		 * Each job uses a handle of its own because the seek offset and
+		 * the queued read or sync operation are state of the handle.
+		 */
+		struct Job_slot
+		{
+			Vfs::Vfs_handle              *handle { nullptr };
+			Constructible<Vfs_block::Job> job    { };
+		};
+
+		Job_slot _slots[MAX_JOBS] { };
+		unsigned _num_slots { 0 };
+
+		template <typename FN>
+		void _for_each_job(FN const &fn)
+		{
+			for (unsigned i = 0; i < _num_slots; i++)
+				if (_slots[i].job.constructed())
+					fn(*_slots[i].job);
+		}
+
+		static bool _overlap(Block::Operation const &a, Block::Operation const &b)
+		{
+			return a.block_number < b.block_number + b.count
+			    && b.block_number < a.block_number + a.count;
+		}
 
 		struct Io_response_handler : Vfs::Io_response_handler
 		{
@@ -95,6 +126,16 @@ class Vfs_block::File
 
 		Block::Session::Info _block_info { };
 
+		void _close_handles()
+		{
+			for (unsigned i = 0; i < _num_slots; i++) {
+				_slots[i].job.destruct();
+				_vfs.close(_slots[i].handle);
+				_slots[i].handle = nullptr;
+			}
+			_num_slots = 0;
+		}
+
 	public:
 
 		File(Genode::Allocator         &alloc,
@@ -102,8 +143,7 @@ class Vfs_block::File
 		     Signal_context_capability  sigh,
 		     File_info           const &info)
 		:
-			_vfs        { vfs },
-			_vfs_handle { nullptr }
+			_vfs { vfs }
 		{
 			using DS = Vfs::Directory_service;
 
@@ -111,19 +151,25 @@ class Vfs_block::File
 				info.writeable ? DS::OPEN_MODE_RDWR
 				               : DS::OPEN_MODE_RDONLY;
 
+			unsigned const queue_depth =
+				max(1u, min((unsigned)MAX_JOBS, info.queue_depth));
+
 			using Open_result = DS::Open_result;
-			Open_result res = _vfs.open(info.path.string(), mode,
-			                            &_vfs_handle, alloc);
-			if (res != Open_result::OPEN_OK) {
-				error("Could not open '", info.path.string(), "'");
-				throw Genode::Exception();
+			for (; _num_slots < queue_depth; _num_slots++) {
+				Open_result res = _vfs.open(info.path.string(), mode,
+				                            &_slots[_num_slots].handle, alloc);
+				if (res != Open_result::OPEN_OK) {
+					_close_handles();
+					error("Could not open '", info.path.string(), "'");
+					throw Genode::Exception();
+				}
 			}
 
 			using Stat_result = DS::Stat_result;
 			Vfs::Directory_service::Stat stat { };
 			Stat_result stat_res = _vfs.stat(info.path.string(), stat);
 			if (stat_res != Stat_result::STAT_OK) {
-				_vfs.close(_vfs_handle);
+				_close_handles();
 				error("Could not stat '", info.path.string(), "'");
 				throw Genode::Exception();
 			}
@@ -139,12 +185,14 @@ class Vfs_block::File
 			};
 
 			_io_response_handler.sigh = sigh;
-			_vfs_handle->handler(&_io_response_handler);
+			for (unsigned i = 0; i < _num_slots; i++)
+				_slots[i].handle->handler(&_io_response_handler);
 
 			log("Block session for file '", info.path.string(),
 			    "' with block count: ",     _block_info.block_count,
 			    " block size: ",            _block_info.block_size,
-				" writeable: ",             _block_info.writeable);
+				" writeable: ",             _block_info.writeable,
+			    " queue depth: ",           _num_slots);
 		}
 
 		~File()
@@ -153,23 +201,55 @@ class Vfs_block::File
 			 * Sync is expected to be done through the Block
 			 * request stream, omit it here.
 			 */
-			_vfs.close(_vfs_handle);
+			_close_handles();
 		}
 
 		Block::Session::Info block_info() const { return _block_info; }
 
 		bool execute()
 		{
-			if (!_job.constructed()) {
-				return false;
-			}
+			bool progress = false;
+			_for_each_job([&] (Vfs_block::Job &job) {
+				progress |= job.execute(); });
 
-			return _job->execute();
+			return progress;
 		}
 
-		bool acceptable() const
+		/**
+		 * Return true if request can be submitted now
+		 *
+		 * A SYNC request waits for all jobs in flight and holds back
+		 * subsequent requests until it is completed. A request that
+		 * overlaps with a pending write waits for the write to complete,
+		 * and vice versa, to retain the order of conflicting requests.
+		 */
+		bool acceptable(Block::Request const &request)
 		{
-			return !_job.constructed();
+			using Type = Block::Operation::Type;
+
+			Block::Operation const &op = request.operation;
+
+			bool free_slot = false;
+			for (unsigned i = 0; i < _num_slots; i++)
+				free_slot |= !_slots[i].job.constructed();
+
+			if (!free_slot)
+				return false;
+
+			bool conflict = false;
+			_for_each_job([&] (Vfs_block::Job const &job) {
+
+				Block::Operation const &pending = job.request.operation;
+
+				if (op.type == Type::SYNC || pending.type == Type::SYNC)
+					conflict = true;
+
+				if ((op.type == Type::WRITE || pending.type == Type::WRITE)
+				 && _overlap(op, pending))
+					conflict = true;
+			});
+
+			return !conflict;
 		}
 
 		bool valid(Block::Request const &request)
@@ -200,23 +280,35 @@ class Vfs_block::File
 			file_offset const base_offset =
 				req.operation.block_number * _block_info.block_size;
 
-			_job.construct(*_vfs_handle, req, base_offset,
-			               reinterpret_cast<char*>(ptr), length);
+			for (unsigned i = 0; i < _num_slots; i++) {
+
+				Job_slot &slot = _slots[i];
+				if (slot.job.constructed())
+					continue;
+
+				slot.job.construct(*slot.handle, req, base_offset,
+				                   reinterpret_cast<char*>(ptr), length);
+				return;
+			}
 		}
 
 		template <typename FN>
 		void with_any_completed_job(FN const &fn)
 		{
-			if (!_job.constructed() || !_job->completed()) {
-				return;
-			}
+			for (unsigned i = 0; i < _num_slots; i++) {
+
+				Job_slot &slot = _slots[i];
+				if (!slot.job.constructed() || !slot.job->completed())
+					continue;
 
-			Block::Request req = _job->request;
-			req.success = _job->succeeded();
+				Block::Request req = slot.job->request;
+				req.success = slot.job->succeeded();
 
-			_job.destruct();
+				slot.job.destruct();
 
-			fn(req);
+				fn(req);
+				return;
+			}
 		}
 };
 
@@ -262,7 +354,7 @@ struct Block_session_component : Rpc_object<Block::Session>,
 
 				using Response = Block::Request_stream::Response;
 
-				if (!_file.acceptable()) {
+				if (!_file.acceptable(request)) {
 					return Response::RETRY;
 				}
 
@@ -79,8 +79,8 @@ class Test : Genode::Interface
 		Genode::size_t _shared_buffer_size(Genode::size_t bulk)
 		{
 			return bulk +
-			       sizeof(Block::Session::Tx_policy::Ack_queue) +
-			       sizeof(Block::Session::Tx_policy::Submit_queue) +
+			       Block::Session::Tx_policy::Ack_queue::bytes(Block::Session::TX_QUEUE_SIZE) +
+			       Block::Session::Tx_policy::Submit_queue::bytes(Block::Session::TX_QUEUE_SIZE) +
 			       (1 << Block::Packet_descriptor::PACKET_ALIGNMENT) - 1;
 		}
 
@@ -0,0 +1,195 @@
+/*
+ * \brief  RPC throughput of thread pairs under the CPU balancer
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * Each pair consists of a client thread that calls a server entrypoint in
+ * a tight loop. Initially, client and server of a pair are placed on
+ * different CPUs and each server shares its CPU with a busy-looping burner
+ * thread. A balancer policy that considers the communication of threads
+ * co-locates the pairs and moves the burners away.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/rpc_client.h>
+#include <base/rpc_server.h>
+#include <base/thread.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	using namespace Genode;
+
+	struct Ping;
+	struct Ping_client;
+	struct Server;
+	struct Client;
+	struct Burner;
+	struct Main;
+
+	enum { STACK_SIZE = 4*1024*sizeof(addr_t) };
+}
+
+
+struct Test::Ping : Interface
+{
+	GENODE_RPC(Rpc_ping, unsigned, ping, unsigned);
+	GENODE_RPC_INTERFACE(Rpc_ping);
+};
+
+
+struct Test::Ping_client : Rpc_client<Ping>
+{
+	Ping_client(Capability<Ping> cap) : Rpc_client<Ping>(cap) { }
+
+	unsigned ping(unsigned value) { return call<Rpc_ping>(value); }
+};
+
+
+struct Test::Server : Rpc_object<Ping, Server>
+{
+	Entrypoint _ep;
+
+	Capability<Ping> const cap { _ep.manage(*this) };
+
+	Server(Env &env, unsigned const i, Affinity::Location const location)
+	:
+		_ep(env, STACK_SIZE, Thread::Name("server_", i).string(), location)
+	{ }
+
+	~Server() { _ep.dissolve(*this); }
+
+	unsigned ping(unsigned value) { return value + 1; }
+};
+
+
+struct Test::Client : Thread
+{
+	Capability<Ping> const _server;
+
+	uint64_t volatile calls = 0;
+
+	Client(Env &env, unsigned const i, Affinity::Location const location,
+	       Capability<Ping> server)
+	:
+		Thread(env, Name("client_", i), STACK_SIZE, location, Weight(), env.cpu()),
+		_server(server)
+	{ }
+
+	void entry() override
+	{
+		Ping_client server(_server);
+
+		for (unsigned value = 0; ; value = server.ping(value))
+			calls = calls + 1;
+	}
+};
+
+
+struct Test::Burner : Thread
+{
+	uint64_t volatile loops = 0;
+
+	Burner(Env &env, unsigned const i, Affinity::Location const location)
+	:
+		Thread(env, Name("burn_", i), STACK_SIZE, location, Weight(), env.cpu())
+	{ }
+
+	void entry() override
+	{
+		for (;;)
+			loops = loops + 1;
+	}
+};
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection _timer { _env };
+
+	enum { MAX_PAIRS = 8 };
+
+	unsigned const _pairs  = min(_config.xml().attribute_value("pairs", 2u),
+	                             (unsigned)MAX_PAIRS);
+	unsigned const _rounds = _config.xml().attribute_value("rounds", 30u);
+	unsigned const _cpus   = max(_env.cpu().affinity_space().width(), 1u);
+
+	Constructible<Server> _servers[MAX_PAIRS];
+	Constructible<Client> _clients[MAX_PAIRS];
+	Constructible<Burner> _burners[MAX_PAIRS];
+
+	uint64_t _last[MAX_PAIRS] { };
+	uint64_t _last_us         { _timer.elapsed_us() };
+	unsigned _round           { 0 };
+	uint64_t _sum             { 0 };  /* calls/s of the second half */
+
+	Signal_handler<Main> _timeout_handler {
+		_env.ep(), *this, &Main::_handle_timeout };
+
+	Affinity::Location _cpu(unsigned const i) const {
+		return Affinity::Location(i % _cpus, 0, 1, 1); }
+
+	void _handle_timeout()
+	{
+		uint64_t const now_us  = _timer.elapsed_us();
+		uint64_t const delta   = max(now_us - _last_us, (uint64_t)1);
+		uint64_t       total   = 0;
+
+		_last_us = now_us;
+
+		for (unsigned i = 0; i < _pairs; i++) {
+			uint64_t const calls = _clients[i]->calls;
+			total   += (calls - _last[i]) * 1000*1000 / delta;
+			_last[i] = calls;
+		}
+
+		_round++;
+		log("round ", _round, ": ", total, " calls/s");
+
+		if (_round > _rounds / 2)
+			_sum += total;
+
+		if (_round < _rounds)
+			return;
+
+		_timer.trigger_periodic(0);
+
+		log("average of last ", _rounds - _rounds / 2, " rounds: ",
+		    _sum / max(_rounds - _rounds / 2, 1u), " calls/s");
+		log("--- test finished ---");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("pairs=", _pairs, " cpus=", _cpus);
+
+		/* deliberately place client and server of a pair apart */
+		for (unsigned i = 0; i < _pairs; i++) {
+			_servers[i].construct(_env, i, _cpu(2*i));
+			_clients[i].construct(_env, i, _cpu(2*i + 1), _servers[i]->cap);
+			_burners[i].construct(_env, i, _cpu(2*i));
+		}
+
+		for (unsigned i = 0; i < _pairs; i++) {
+			_burners[i]->start();
+			_clients[i]->start();
+		}
+
+		_timer.sigh(_timeout_handler);
+		_timer.trigger_periodic(1000*1000);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-cpu_balancer_affinity
+SRC_CC = main.cc
+LIBS   = base
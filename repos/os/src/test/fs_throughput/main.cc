@@ -0,0 +1,147 @@
+/*
+ * \brief  File_system throughput at increasing queue sizes
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * For each queue size, a new session is created with the queue size
+ * requested via the 'queue_size' session argument. The test keeps as many
+ * packets in flight as the queues permit while writing and reading a file.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/allocator_avl.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <file_system_session/connection.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	using namespace Genode;
+	using File_system::Packet_descriptor;
+	using File_system::File_handle;
+	using File_system::Dir_handle;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Heap              _heap  { _env.pd(), _env.rm() };
+	Timer::Connection _timer { _env };
+
+	size_t const _request_size =
+		_config.xml().attribute_value("request_size", Number_of_bytes(64*1024));
+
+	size_t const _file_size =
+		_config.xml().attribute_value("file_size", Number_of_bytes(16*1024*1024));
+
+	unsigned const _max_queue_size =
+		_config.xml().attribute_value("max_queue_size", 256U);
+
+	/**
+	 * Transfer the whole file with up to 'depth' packets in flight
+	 *
+	 * \return  duration in microseconds
+	 */
+	uint64_t _transfer(File_system::Session::Tx::Source &source, File_handle handle,
+	                   Packet_descriptor::Opcode op, unsigned depth)
+	{
+		uint64_t const start_us = _timer.elapsed_us();
+
+		size_t submitted = 0, completed = 0;
+
+		for (unsigned i = 0; i < depth && submitted < _file_size; i++) {
+			source.submit_packet(Packet_descriptor(source.alloc_packet(_request_size),
+			                                       handle, op, _request_size,
+			                                       submitted));
+			submitted += _request_size;
+		}
+
+		while (completed < _file_size) {
+
+			Packet_descriptor const packet = source.get_acked_packet();
+
+			if (!packet.succeeded() || packet.length() != _request_size) {
+				error(op == Packet_descriptor::READ ? "read" : "write",
+				      " failed at offset ", packet.position());
+				throw Exception();
+			}
+
+			completed += _request_size;
+
+			/* reuse the packet's buffer for the next request */
+			if (submitted < _file_size) {
+				source.submit_packet(Packet_descriptor(packet, handle, op,
+				                                       _request_size, submitted));
+				submitted += _request_size;
+			} else {
+				source.release_packet(packet);
+			}
+		}
+
+		return _timer.elapsed_us() - start_us;
+	}
+
+	void _log_result(char const *what, unsigned queue_size, uint64_t us)
+	{
+		uint64_t const kib_per_sec = us ? (_file_size / 1024) * 1000000 / us : 0;
+
+		log(what, " queue_size=", queue_size, " request_size=", _request_size,
+		    ": ", kib_per_sec / 1024, ".", (kib_per_sec % 1024) * 100 / 1024,
+		    " MiB/s");
+	}
+
+	void _run(unsigned queue_size)
+	{
+		/* a queue holds one element less than its size */
+		unsigned const depth = queue_size - 1;
+
+		/*
+		 * The transmission buffer accommodates the queues and the payload
+		 * of all packets in flight.
+		 */
+		size_t const tx_buf_size =
+			depth*_request_size + 4096 +
+			2*File_system::Session::Tx_policy::Submit_queue::bytes(queue_size);
+
+		Allocator_avl           alloc { &_heap };
+		File_system::Connection fs    { _env, alloc, "", "/", true,
+		                                tx_buf_size, queue_size };
+
+		Dir_handle dir = fs.dir("/", false);
+
+		File_handle file = fs.file(dir, "test", File_system::READ_WRITE, true);
+
+		_log_result("write", queue_size,
+		            _transfer(*fs.tx(), file, Packet_descriptor::WRITE, depth));
+		_log_result("read ", queue_size,
+		            _transfer(*fs.tx(), file, Packet_descriptor::READ, depth));
+
+		fs.close(file);
+		fs.unlink(dir, "test");
+		fs.close(dir);
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		for (unsigned queue_size = 2; queue_size <= _max_queue_size; queue_size *= 2)
+			_run(queue_size);
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,228 @@
+/*
+ * \brief  Many small writes with and without vectored File_system packets
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The test mimics a logging workload by writing a large number of small
+ * records to a file, first with one WRITE packet per record, then with
+ * WRITE_V packets that carry a batch of records each. Finally, a sample of
+ * records is read back with a single READ_V packet and validated.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/allocator_avl.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <file_system_session/connection.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	using namespace Genode;
+	using File_system::Packet_descriptor;
+	using File_system::File_handle;
+	using File_system::Dir_handle;
+	using File_system::Segment;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	typedef File_system::Session::Tx::Source Source;
+
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Heap              _heap  { _env.pd(), _env.rm() };
+	Timer::Connection _timer { _env };
+	Allocator_avl     _alloc { &_heap };
+
+	File_system::Connection _fs { _env, _alloc, "", "/", true, 256*1024 };
+
+	size_t const _record_size =
+		_config.xml().attribute_value("record_size", Number_of_bytes(96));
+
+	unsigned const _records =
+		_config.xml().attribute_value("records", 16384U);
+
+	unsigned const _batch =
+		min(_config.xml().attribute_value("batch", (unsigned)File_system::MAX_SEGMENTS),
+		    (unsigned)File_system::MAX_SEGMENTS);
+
+	static char _pattern(unsigned record, size_t i) { return (char)(record*31 + i); }
+
+	void _fill_record(char *dst, unsigned record)
+	{
+		for (size_t i = 0; i < _record_size; i++)
+			dst[i] = _pattern(record, i);
+	}
+
+	/**
+	 * Submit 'num_packets' packets created by 'fn' and wait for their completion
+	 *
+	 * As many packets are kept in flight as the submit queue permits.
+	 *
+	 * \return  duration in microseconds
+	 */
+	template <typename FN>
+	uint64_t _stream(unsigned num_packets, FN const &fn)
+	{
+		Source &source = *_fs.tx();
+
+		uint64_t const start_us = _timer.elapsed_us();
+
+		unsigned submitted = 0, completed = 0;
+
+		while (completed < num_packets) {
+
+			while (submitted < num_packets && source.ready_to_submit())
+				source.submit_packet(fn(source, submitted++));
+
+			Packet_descriptor const packet = source.get_acked_packet();
+
+			if (!packet.succeeded()) {
+				error("operation ", (int)packet.operation(), " failed");
+				throw Exception();
+			}
+
+			source.release_packet(packet);
+			completed++;
+		}
+
+		return _timer.elapsed_us() - start_us;
+	}
+
+	void _log_result(char const *what, unsigned packets, uint64_t us)
+	{
+		uint64_t const records_per_sec = us ? (uint64_t)_records * 1000000 / us : 0;
+
+		log(what, ": ", _records, " records of ", _record_size, " bytes in ",
+		    packets, " packets, ", us / 1000, " ms, ", records_per_sec, " records/s");
+	}
+
+	void _write_plain(File_handle file)
+	{
+		auto packet = [&] (Source &source, unsigned record)
+		{
+			Packet_descriptor const p(source.alloc_packet(_record_size), file,
+			                          Packet_descriptor::WRITE, _record_size,
+			                          record*_record_size);
+
+			_fill_record(source.packet_content(p), record);
+			return p;
+		};
+
+		_log_result("WRITE  ", _records, _stream(_records, packet));
+	}
+
+	void _write_vectored(File_handle file)
+	{
+		unsigned const num_packets = (_records + _batch - 1) / _batch;
+
+		auto packet = [&] (Source &source, unsigned index)
+		{
+			unsigned const first = index*_batch;
+			unsigned const count = min(_batch, _records - first);
+			size_t   const length = count*_record_size;
+
+			Packet_descriptor const p(
+				source.alloc_packet(Packet_descriptor::vector_size(length, count),
+				                    Packet_descriptor::SEGMENT_ALIGN_LOG2),
+				file, Packet_descriptor::WRITE_V, length,
+				Packet_descriptor::Segments { count });
+
+			char    * const content = source.packet_content(p);
+			Segment * const table   = p.segment_table(content);
+
+			/* one segment per record, as issued by individual writes */
+			for (unsigned i = 0; i < count; i++) {
+				_fill_record(content + i*_record_size, first + i);
+				table[i] = Segment { .position = (first + i)*_record_size,
+				                     .length   = _record_size };
+			}
+			return p;
+		};
+
+		_log_result("WRITE_V", num_packets, _stream(num_packets, packet));
+	}
+
+	/**
+	 * Read back a strided sample of records with a single READ_V packet
+	 */
+	void _validate(File_handle file)
+	{
+		Source &source = *_fs.tx();
+
+		unsigned const stride = max(_records / _batch, 1U);
+		unsigned const count  = min(_batch, _records);
+		size_t   const length = count*_record_size;
+
+		Packet_descriptor const p(
+			source.alloc_packet(Packet_descriptor::vector_size(length, count),
+			                    Packet_descriptor::SEGMENT_ALIGN_LOG2),
+			file, Packet_descriptor::READ_V, length,
+			Packet_descriptor::Segments { count });
+
+		Segment *table = p.segment_table(source.packet_content(p));
+		for (unsigned i = 0; i < count; i++)
+			table[i] = Segment { .position = i*stride*_record_size,
+			                     .length   = _record_size };
+
+		source.submit_packet(p);
+
+		Packet_descriptor const ack = source.get_acked_packet();
+
+		char const * const content = source.packet_content(ack);
+		table = ack.segment_table(source.packet_content(ack));
+
+		bool valid = ack.succeeded();
+		for (unsigned i = 0; valid && i < count; i++) {
+
+			valid = (table[i].length == _record_size);
+
+			for (size_t j = 0; valid && j < _record_size; j++)
+				valid = (content[i*_record_size + j] == _pattern(i*stride, j));
+		}
+
+		source.release_packet(ack);
+
+		if (!valid) {
+			error("READ_V returned unexpected content");
+			throw Exception();
+		}
+
+		log("READ_V : validated ", count, " records");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		Dir_handle dir = _fs.dir("/", false);
+
+		File_handle plain = _fs.file(dir, "plain", File_system::READ_WRITE, true);
+		_write_plain(plain);
+		_fs.close(plain);
+
+		File_handle vectored = _fs.file(dir, "vectored", File_system::READ_WRITE, true);
+		_write_vectored(vectored);
+		_validate(vectored);
+		_fs.close(vectored);
+
+		_fs.unlink(dir, "plain");
+		_fs.unlink(dir, "vectored");
+		_fs.close(dir);
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-fs_vectored
+LIBS   = base
+SRC_CC = main.cc
@@ -0,0 +1,165 @@
+/*
+ * \brief  Report of failed writes by the VFS fs plugin
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The test writes small records to a file that the file-system server
+ * refuses to modify. Writes return before the server acknowledges them and
+ * are gathered in WRITE_V packets while the submit queue is congested.
+ * Hence, the failure must be reported by a later write or sync of the
+ * handle.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <file_system_session/file_system_session.h>
+#include <vfs/simple_env.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	typedef Vfs::File_io_service::Write_result Write_result;
+	typedef Vfs::File_io_service::Sync_result  Sync_result;
+
+	enum { RECORD_SIZE = 32, MAX_RECORDS = 4096 };
+
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Vfs::Simple_env _vfs_env { _env, _heap, _config.xml().sub_node("vfs") };
+
+	Vfs::File_system &_root = _vfs_env.root_dir();
+
+	Vfs::Vfs_handle &_handle = _open("/readonly");
+
+	char _record[RECORD_SIZE] { };
+
+	Vfs::Vfs_handle &_open(char const *path)
+	{
+		Vfs::Vfs_handle *handle = nullptr;
+
+		if (_root.open(path, Vfs::Directory_service::OPEN_MODE_WRONLY,
+		               &handle, _heap) != Vfs::Directory_service::OPEN_OK) {
+			error("failed to open ", path);
+			throw Exception();
+		}
+		return *handle;
+	}
+
+	void _wait_for_io() { _env.ep().wait_and_dispatch_one_io_signal(); }
+
+	Write_result _write_record()
+	{
+		for (;;) {
+			try {
+				Vfs::file_size out_count = 0;
+
+				Write_result const result =
+					_handle.fs().write(&_handle, _record, RECORD_SIZE, out_count);
+
+				_handle.advance_seek(out_count);
+				return result;
+			}
+			catch (Vfs::File_io_service::Insufficient_buffer) { _wait_for_io(); }
+		}
+	}
+
+	Sync_result _sync()
+	{
+		while (!_handle.fs().queue_sync(&_handle))
+			_wait_for_io();
+
+		for (;;) {
+			Sync_result const result = _handle.fs().complete_sync(&_handle);
+			if (result != Sync_result::SYNC_QUEUED)
+				return result;
+
+			_wait_for_io();
+		}
+	}
+
+	/**
+	 * Write records until a write reports the failure of a preceding one
+	 */
+	void _test_write()
+	{
+		for (unsigned i = 0; i < MAX_RECORDS; i++) {
+
+			if (_write_record() == Write_result::WRITE_OK)
+				continue;
+
+			if (i == 0) {
+				error("first write failed synchronously");
+				throw Exception();
+			}
+
+			log("write: failure reported after ", i, " writes");
+			return;
+		}
+
+		error("write: failure not reported after ", (unsigned)MAX_RECORDS, " writes");
+		throw Exception();
+	}
+
+	/**
+	 * Fill the submit queue and gather further writes, then sync
+	 */
+	void _test_sync(unsigned num_records)
+	{
+		/* start with no failures left to report */
+		_sync();
+
+		for (unsigned i = 0; i < num_records; i++)
+			if (_write_record() != Write_result::WRITE_OK) {
+				error("sync: write ", i, " failed synchronously");
+				throw Exception();
+			}
+
+		if (_sync() != Sync_result::SYNC_ERR_INVALID) {
+			error("sync: failure of ", num_records, " writes not reported");
+			throw Exception();
+		}
+
+		if (_sync() != Sync_result::SYNC_OK) {
+			error("sync: failure reported twice");
+			throw Exception();
+		}
+
+		log("sync: failure of ", num_records, " writes reported");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		Genode::memset(_record, 'x', RECORD_SIZE);
+
+		_test_write();
+
+		/* with an unused write vector and with gathered writes */
+		_test_sync(1);
+		_test_sync(::File_system::Session::TX_QUEUE_SIZE + 8);
+
+		_handle.close();
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-fs_write_error
+LIBS   = base vfs
+SRC_CC = main.cc
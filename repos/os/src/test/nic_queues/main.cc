@@ -0,0 +1,424 @@
+/*
+ * \brief  Test of NIC sessions with multiple queue pairs
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The test opens a multi-queue NIC session and sends UDP frames of different
+ * flows, each via the queue pair selected by the flow hash. Each frame must
+ * be echoed via the queue pair it was sent with. The number of queue pairs
+ * is requested via the 'queues' config attribute (default 4). The server may
+ * grant fewer queue pairs, except for the loop-back server.
+ *
+ * The 'mode' config attribute selects the role of the component:
+ *
+ * - "loopback" (default) sends the frames to a NIC loop-back server, which
+ *   echoes them as is.
+ * - "client" sends the frames to the 'peer' IP address via the router at
+ *   the 'gateway' IP address and expects the reply of the peer.
+ * - "echo" acts as such a peer and replies to each frame via the queue
+ *   pair it was received with.
+ *
+ * In client and echo mode, the IP address of the component is given by the
+ * 'ip' attribute and ARP requests for it are answered.
+ *
+ * In client mode, the 'rounds' attribute repeats the sending of all flows.
+ * The client then reports the frame rate for the granted queue pairs.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/component.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/log.h>
+#include <base/heap.h>
+#include <base/allocator_avl.h>
+#include <nic_session/connection.h>
+#include <nic/packet_allocator.h>
+#include <timer_session/connection.h>
+#include <net/arp.h>
+#include <net/flow_hash.h>
+#include <net/udp.h>
+
+namespace Test {
+
+	struct Main;
+
+	using namespace Genode;
+	using namespace Net;
+}
+
+
+struct Test::Main
+{
+	enum { MAX_QUEUES  = 4,
+	       NUM_FLOWS   = 64,
+	       ECHO_PORT   = 7,
+	       FRAME_SIZE  = sizeof(Ethernet_frame) + sizeof(Ipv4_packet)
+	                   + sizeof(Udp_packet) + sizeof(unsigned),
+	       ARP_SIZE    = sizeof(Ethernet_frame) + sizeof(Arp_packet),
+	       BUF_SIZE    = Nic::Packet_allocator::DEFAULT_PACKET_SIZE * 128 };
+
+	enum class Mode { LOOPBACK, CLIENT, ECHO };
+
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	static Mode _mode_from_config(Xml_node config)
+	{
+		typedef String<16> Name;
+		Name const name = config.attribute_value("mode", Name("loopback"));
+
+		if (name == "client") return Mode::CLIENT;
+		if (name == "echo")   return Mode::ECHO;
+		return Mode::LOOPBACK;
+	}
+
+	Mode const _mode = _mode_from_config(_config.xml());
+
+	Ipv4_address const _ip      = _config.xml().attribute_value("ip",      Ipv4_address((uint8_t)10));
+	Ipv4_address const _peer    = _config.xml().attribute_value("peer",    Ipv4_address((uint8_t)20));
+	Ipv4_address const _gateway = _config.xml().attribute_value("gateway", Ipv4_address());
+
+	unsigned const _requested_queues =
+		min(max(_config.xml().attribute_value("queues", (unsigned)MAX_QUEUES), 1U),
+		    (unsigned)MAX_QUEUES);
+
+	unsigned const _rounds =
+		max(_config.xml().attribute_value("rounds", 1U), 1U);
+
+	unsigned const _num_frames = NUM_FLOWS*_rounds;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Allocator_avl _tx_block_alloc[MAX_QUEUES] { Allocator_avl(&_heap), Allocator_avl(&_heap),
+	                                            Allocator_avl(&_heap), Allocator_avl(&_heap) };
+
+	Nic::Connection _nic { _env, &_tx_block_alloc[0], BUF_SIZE, BUF_SIZE,
+	                       "", _requested_queues };
+
+	/* queue pairs granted by the server */
+	unsigned const _queues = min(_nic.queues(), _requested_queues);
+
+	Constructible<Nic::Queue_client> _queue[MAX_QUEUES] { };
+
+	/* the frame rate is measured in client mode only */
+	Constructible<Timer::Connection> _timer { };
+
+	uint64_t _start_us = 0;
+
+	Mac_address const _mac = _nic.mac_address();
+
+	/* destination MAC address of the flow frames, known via ARP in client mode */
+	Mac_address _gateway_mac { };
+	bool        _gateway_known = (_mode == Mode::LOOPBACK);
+
+	unsigned _sent = 0, _submitted = 0, _acked = 0, _received = 0;
+	unsigned _per_queue[MAX_QUEUES] { };
+
+	Signal_handler<Main> _nic_handler { _env.ep(), *this, &Main::_handle_nic };
+
+	template <typename... ARGS>
+	static void _abort(ARGS &&... args)
+	{
+		error(args...);
+		class Error : Exception { };
+		throw Error();
+	}
+
+	Nic::Session::Tx::Source &_tx(unsigned q) { return q ? *_queue[q]->tx() : *_nic.tx(); }
+	Nic::Session::Rx::Sink   &_rx(unsigned q) { return q ? *_queue[q]->rx() : *_nic.rx(); }
+
+	Nic::Session::Tx &_tx_channel(unsigned q) { return q ? *_queue[q]->tx_channel() : *_nic.tx_channel(); }
+	Nic::Session::Rx &_rx_channel(unsigned q) { return q ? *_queue[q]->rx_channel() : *_nic.rx_channel(); }
+
+	/**
+	 * Write UDP frame carrying the flow number to 'base'
+	 */
+	static void _write_udp(void *base, unsigned flow,
+	                       Mac_address const &src_mac, Mac_address const &dst_mac,
+	                       Ipv4_address const &src_ip, Ipv4_address const &dst_ip,
+	                       Port src_port, Port dst_port)
+	{
+		Size_guard size_guard(FRAME_SIZE);
+
+		Ethernet_frame &eth = Ethernet_frame::construct_at(base, size_guard);
+		eth.src(src_mac);
+		eth.dst(dst_mac);
+		eth.type(Ethernet_frame::Type::IPV4);
+
+		Ipv4_packet &ip = eth.construct_at_data<Ipv4_packet>(size_guard);
+		ip.header_length(sizeof(Ipv4_packet) / 4);
+		ip.version(4);
+		ip.total_length(FRAME_SIZE - sizeof(Ethernet_frame));
+		ip.time_to_live(64);
+		ip.protocol(Ipv4_packet::Protocol::UDP);
+		ip.src(src_ip);
+		ip.dst(dst_ip);
+
+		Udp_packet &udp = ip.construct_at_data<Udp_packet>(size_guard);
+		udp.length(sizeof(Udp_packet) + sizeof(flow));
+		udp.src_port(src_port);
+		udp.dst_port(dst_port);
+
+		size_guard.consume_head(sizeof(flow));
+		memcpy((char *)base + FRAME_SIZE - sizeof(flow), &flow, sizeof(flow));
+
+		udp.update_checksum(src_ip, dst_ip);
+		ip.update_checksum();
+	}
+
+	/**
+	 * Write request frame of flow to 'base'
+	 */
+	void _write_request(void *base, unsigned flow) const
+	{
+		_write_udp(base, flow, _mac, _gateway_mac, _ip, _peer,
+		           Port((uint16_t)(40000 + flow)), Port(ECHO_PORT));
+	}
+
+	unsigned _queue_of_flow(unsigned flow) const
+	{
+		char frame[FRAME_SIZE];
+		_write_request(frame, flow);
+		return Flow_hash::of_frame(frame, FRAME_SIZE).queue(_queues);
+	}
+
+	void _check_flow_hash()
+	{
+		for (unsigned flow = 0; flow < NUM_FLOWS; flow++) {
+
+			char request[FRAME_SIZE], reply[FRAME_SIZE];
+			_write_request(request, flow);
+			_write_udp(reply, flow, _gateway_mac, _mac, _peer, _ip,
+			           Port(ECHO_PORT), Port((uint16_t)(40000 + flow)));
+
+			if (Flow_hash::of_frame(request, FRAME_SIZE).value() !=
+			    Flow_hash::of_frame(reply,   FRAME_SIZE).value())
+				_abort("flow hash of flow ", flow, " is not symmetric");
+
+			_per_queue[_queue_of_flow(flow)]++;
+		}
+
+		for (unsigned q = 0; q < _queues; q++) {
+			log("queue ", q, ": ", _per_queue[q], " flows");
+			if (!_per_queue[q])
+				_abort("no flow selects queue ", q);
+		}
+	}
+
+	/**
+	 * Submit frame of 'size' bytes written by 'fn(void *)' via queue pair 'q'
+	 *
+	 * \return  false if the queue pair cannot take the frame
+	 */
+	template <typename FN>
+	bool _submit(unsigned q, size_t size, FN const &fn)
+	{
+		Nic::Session::Tx::Source &tx = _tx(q);
+		if (!tx.ready_to_submit())
+			return false;
+
+		Packet_descriptor packet;
+		try { packet = tx.alloc_packet(size); }
+		catch (Nic::Session::Tx::Source::Packet_alloc_failed) { return false; }
+
+		fn(tx.packet_content(packet));
+		tx.submit_packet(packet);
+		_submitted++;
+		return true;
+	}
+
+	void _send_arp(unsigned q, Arp_packet::Opcode opcode,
+	               Mac_address const &dst_mac, Ipv4_address const &dst_ip)
+	{
+		_submit(q, ARP_SIZE, [&] (void *base) {
+
+			Size_guard size_guard(ARP_SIZE);
+
+			Ethernet_frame &eth = Ethernet_frame::construct_at(base, size_guard);
+			eth.src(_mac);
+			eth.dst(opcode == Arp_packet::REQUEST ? Ethernet_frame::broadcast()
+			                                      : dst_mac);
+			eth.type(Ethernet_frame::Type::ARP);
+
+			Arp_packet &arp = eth.construct_at_data<Arp_packet>(size_guard);
+			arp.hardware_address_type(Arp_packet::ETHERNET);
+			arp.protocol_address_type(Arp_packet::IPV4);
+			arp.hardware_address_size(Ethernet_frame::ADDR_LEN);
+			arp.protocol_address_size(Ipv4_packet::ADDR_LEN);
+			arp.opcode(opcode);
+			arp.src_mac(_mac);
+			arp.src_ip(_ip);
+			arp.dst_mac(dst_mac);
+			arp.dst_ip(dst_ip);
+		});
+	}
+
+	void _send()
+	{
+		if (_mode == Mode::ECHO || !_gateway_known)
+			return;
+
+		if (_timer.constructed() && !_sent)
+			_start_us = _timer->elapsed_us();
+
+		while (_sent < _num_frames) {
+
+			unsigned const flow = _sent % NUM_FLOWS;
+
+			if (!_submit(_queue_of_flow(flow), FRAME_SIZE, [&] (void *base) {
+				_write_request(base, flow); }))
+				return;
+
+			_sent++;
+		}
+	}
+
+	void _handle_arp(unsigned q, Ethernet_frame &eth, Size_guard &size_guard)
+	{
+		Arp_packet const &arp = eth.data<Arp_packet>(size_guard);
+		if (!arp.ethernet_ipv4())
+			return;
+
+		if (arp.opcode() == Arp_packet::REQUEST && arp.dst_ip() == _ip)
+			_send_arp(q, Arp_packet::REPLY, arp.src_mac(), arp.src_ip());
+
+		if (arp.opcode() == Arp_packet::REPLY && _mode == Mode::CLIENT
+		 && arp.src_ip() == _gateway && !_gateway_known) {
+			_gateway_mac   = arp.src_mac();
+			_gateway_known = true;
+		}
+	}
+
+	/**
+	 * Handle UDP frame of a flow received via queue pair 'q'
+	 *
+	 * \return  false if the frame must be handled again later
+	 */
+	bool _handle_flow(unsigned q, Ethernet_frame &eth, Size_guard &size_guard)
+	{
+		Ipv4_packet const &ip  = eth.data<Ipv4_packet>(size_guard);
+		Udp_packet  const &udp = ip.data<Udp_packet>(size_guard);
+
+		unsigned flow = 0;
+		memcpy(&flow, (char const *)&eth + FRAME_SIZE - sizeof(flow), sizeof(flow));
+
+		/* the hash is symmetric, so requests and replies share the queue pair */
+		if (flow >= NUM_FLOWS || Flow_hash::of_frame(&eth, FRAME_SIZE).queue(_queues) != q)
+			_abort("flow ", flow, " received via unexpected queue ", q);
+
+		if (_mode != Mode::ECHO) {
+			_received++;
+			return true;
+		}
+
+		return _submit(q, FRAME_SIZE, [&] (void *base) {
+			_write_udp(base, flow, _mac, eth.src(), _ip, ip.src(),
+			           udp.dst_port(), udp.src_port()); });
+	}
+
+	void _log_frame_rate()
+	{
+		uint64_t const us = max(_timer->elapsed_us() - _start_us, (uint64_t)1);
+
+		log("queues=", _queues, " (requested ", _requested_queues, "): ",
+		    _num_frames, " frames in ", us / 1000, " ms, ",
+		    (uint64_t)_num_frames*1000000 / us, " frames/s");
+	}
+
+	void _handle_nic()
+	{
+		for (unsigned q = 0; q < _queues; q++) {
+
+			Nic::Session::Tx::Source &tx = _tx(q);
+			while (tx.ack_avail()) {
+				tx.release_packet(tx.get_acked_packet());
+				_acked++;
+			}
+
+			Nic::Session::Rx::Sink &rx = _rx(q);
+			while (rx.packet_avail() && rx.ready_to_ack()) {
+
+				/* a reply may be needed, so make sure it can be sent */
+				if (_mode != Mode::LOOPBACK && !tx.ready_to_submit())
+					break;
+
+				Packet_descriptor const packet = rx.get_packet();
+				Size_guard size_guard(packet.size());
+
+				try {
+					Ethernet_frame &eth =
+						Ethernet_frame::cast_from(rx.packet_content(packet), size_guard);
+
+					if (eth.type() == Ethernet_frame::Type::ARP)
+						_handle_arp(q, eth, size_guard);
+
+					else if (eth.type() == Ethernet_frame::Type::IPV4) {
+
+						if (packet.size() != FRAME_SIZE)
+							_abort("unexpected size of received packet");
+
+						if (!_handle_flow(q, eth, size_guard))
+							warning("dropped reply to flow packet");
+					}
+				}
+				catch (Size_guard::Exceeded) {
+					warning("malformed packet received"); }
+
+				rx.acknowledge_packet(packet);
+			}
+		}
+
+		_send();
+
+		if (_mode != Mode::ECHO && _received == _num_frames && _acked == _submitted) {
+			if (_timer.constructed())
+				_log_frame_rate();
+
+			log("--- finished NIC queues test ---");
+			_env.parent().exit(0);
+		}
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- NIC queues test ---");
+
+		if (_mode == Mode::LOOPBACK && _queues != _requested_queues)
+			_abort("session provides ", _queues, " instead of ",
+			       _requested_queues, " queue pairs");
+
+		log("session provides ", _queues, " of ", _requested_queues,
+		    " requested queue pairs");
+
+		for (unsigned q = 1; q < _queues; q++)
+			_queue[q].construct(_nic, q, _tx_block_alloc[q], _env.rm());
+
+		for (unsigned q = 0; q < _queues; q++) {
+			_tx_channel(q).sigh_ready_to_submit(_nic_handler);
+			_tx_channel(q).sigh_ack_avail      (_nic_handler);
+			_rx_channel(q).sigh_ready_to_ack   (_nic_handler);
+			_rx_channel(q).sigh_packet_avail   (_nic_handler);
+		}
+
+		if (_mode != Mode::ECHO)
+			_check_flow_hash();
+
+		/* resolve the MAC address of the router */
+		if (_mode == Mode::CLIENT) {
+			_timer.construct(_env);
+			_send_arp(0, Arp_packet::REQUEST, Mac_address(), _gateway);
+		}
+
+		_send();
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-nic_queues
+SRC_CC = main.cc
+LIBS   = base net
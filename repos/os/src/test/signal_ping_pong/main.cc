@@ -0,0 +1,113 @@
+/*
+ * \brief  Round-trip time of signals between two threads
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The entrypoint of the component and a second thread with a signal
+ * receiver of its own bounce a signal back and forth. Each signal takes
+ * the same path as a signal from another component, i.e., via the
+ * signal-delivery mechanism of the kernel or core.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/signal.h>
+#include <base/thread.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Ponger;
+	struct Main;
+}
+
+
+/**
+ * Thread that answers each signal with a signal
+ */
+struct Test::Ponger : Thread
+{
+	enum { STACK_SIZE = 4*1024*sizeof(addr_t) };
+
+	Signal_receiver _receiver { };
+	Signal_context  _context  { };
+
+	Signal_context_capability const _cap = _receiver.manage(&_context);
+
+	Signal_context_capability const _pong;
+
+	unsigned const _rounds;
+
+	void entry() override
+	{
+		for (unsigned i = 0; i < _rounds; ) {
+			i += _receiver.wait_for_signal().num();
+			Signal_transmitter(_pong).submit();
+		}
+	}
+
+	Ponger(Env &env, Signal_context_capability pong, unsigned rounds)
+	:
+		Thread(env, "ponger", STACK_SIZE), _pong(pong), _rounds(rounds)
+	{ }
+
+	~Ponger() { _receiver.dissolve(&_context); }
+
+	Signal_context_capability cap() const { return _cap; }
+};
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection _timer { _env };
+
+	unsigned const _rounds = _config.xml().attribute_value("rounds", 100000U);
+
+	Signal_handler<Main> _pong_handler { _env.ep(), *this, &Main::_handle_pong };
+
+	Ponger _ponger { _env, _pong_handler, _rounds };
+
+	unsigned _completed = 0;
+	uint64_t _start_us  = 0;
+
+	void _handle_pong()
+	{
+		if (++_completed < _rounds) {
+			Signal_transmitter(_ponger.cap()).submit();
+			return;
+		}
+
+		uint64_t const us = _timer.elapsed_us() - _start_us;
+
+		log(_rounds, " round trips in ", us / 1000, " ms, ",
+		    us*1000 / _rounds, " ns per round trip, ",
+		    us ? 2*(uint64_t)_rounds*1000000 / us : 0, " signals/s");
+
+		_ponger.join();
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		_ponger.start();
+
+		_start_us = _timer.elapsed_us();
+		Signal_transmitter(_ponger.cap()).submit();
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-signal_ping_pong
+LIBS   = base
+SRC_CC = main.cc
@@ -0,0 +1,187 @@
+/*
+ * \brief  Aggregate vfs-server throughput with concurrent clients
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * For an increasing number of clients, each client thread opens its own
+ * File_system session and writes and reads a file of its own. The test is
+ * executed twice, once with session labels that are served by the main
+ * entrypoint of the vfs server ("shared_<n>") and once with labels that
+ * the configuration of the server assigns to dedicated workers
+ * ("worker_<n>"). The client threads are spread over the available CPUs.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/allocator_avl.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/thread.h>
+#include <file_system_session/connection.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	using namespace Genode;
+	using File_system::Packet_descriptor;
+	using File_system::File_handle;
+	using File_system::Dir_handle;
+	struct Client;
+	struct Main;
+}
+
+
+struct Test::Client : Thread
+{
+	typedef String<32> Label;
+
+	enum { STACK_SIZE = 16*1024*sizeof(long), DEPTH = 8 };
+
+	Env &_env;
+
+	Label  const _label;
+	size_t const _request_size;
+	size_t const _file_size;
+
+	Heap          _heap  { _env.pd(), _env.rm() };
+	Allocator_avl _alloc { &_heap };
+
+	bool _failed = false;
+
+	void _transfer(File_system::Session::Tx::Source &source, File_handle handle,
+	               Packet_descriptor::Opcode op)
+	{
+		size_t submitted = 0, completed = 0;
+
+		for (unsigned i = 0; i < DEPTH && submitted < _file_size; i++) {
+			source.submit_packet(Packet_descriptor(source.alloc_packet(_request_size),
+			                                       handle, op, _request_size,
+			                                       submitted));
+			submitted += _request_size;
+		}
+
+		while (completed < _file_size) {
+
+			Packet_descriptor const packet = source.get_acked_packet();
+
+			if (!packet.succeeded() || packet.length() != _request_size)
+				_failed = true;
+
+			completed += _request_size;
+
+			/* reuse the packet's buffer for the next request */
+			if (submitted < _file_size) {
+				source.submit_packet(Packet_descriptor(packet, handle, op,
+				                                       _request_size, submitted));
+				submitted += _request_size;
+			} else {
+				source.release_packet(packet);
+			}
+		}
+	}
+
+	void entry() override
+	{
+		File_system::Connection fs { _env, _alloc, _label.string(), "/", true,
+		                             DEPTH*_request_size + 64*1024 };
+
+		Dir_handle  dir  = fs.dir("/", false);
+		File_handle file = fs.file(dir, _label.string(), File_system::READ_WRITE, true);
+
+		_transfer(*fs.tx(), file, Packet_descriptor::WRITE);
+		_transfer(*fs.tx(), file, Packet_descriptor::READ);
+
+		fs.close(file);
+		fs.unlink(dir, _label.string());
+		fs.close(dir);
+	}
+
+	Client(Env &env, Label const &label, Affinity::Location location,
+	       size_t request_size, size_t file_size)
+	:
+		Thread(env, label.string(), STACK_SIZE, location, Weight(), env.cpu()),
+		_env(env), _label(label), _request_size(request_size), _file_size(file_size)
+	{ }
+
+	bool failed() const { return _failed; }
+};
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Heap              _heap  { _env.pd(), _env.rm() };
+	Timer::Connection _timer { _env };
+
+	size_t const _request_size =
+		_config.xml().attribute_value("request_size", Number_of_bytes(64*1024));
+
+	size_t const _file_size =
+		_config.xml().attribute_value("file_size", Number_of_bytes(8*1024*1024));
+
+	unsigned const _max_clients =
+		_config.xml().attribute_value("max_clients", 8U);
+
+	enum { MAX_CLIENTS = 16 };
+
+	void _run(char const *mode, unsigned num_clients)
+	{
+		Constructible<Client> clients[MAX_CLIENTS];
+
+		for (unsigned i = 0; i < num_clients; i++)
+			clients[i].construct(_env, Client::Label(mode, "_", i),
+			                     _env.cpu().affinity_space().location_of_index(i),
+			                     _request_size, _file_size);
+
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < num_clients; i++)
+			clients[i]->start();
+
+		bool failed = false;
+		for (unsigned i = 0; i < num_clients; i++) {
+			clients[i]->join();
+			failed |= clients[i]->failed();
+		}
+
+		uint64_t const us = _timer.elapsed_us() - start_us;
+
+		if (failed) {
+			error(mode, " clients=", num_clients, ": I/O error");
+			throw Exception();
+		}
+
+		/* each client writes and reads its file */
+		uint64_t const kib = 2*(uint64_t)num_clients*_file_size / 1024;
+		uint64_t const kib_per_sec = us ? kib*1000000 / us : 0;
+
+		log(mode, " clients=", num_clients, ": ",
+		    kib_per_sec / 1024, ".", (kib_per_sec % 1024) * 100 / 1024,
+		    " MiB/s aggregate");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		unsigned const max_clients = min(_max_clients, (unsigned)MAX_CLIENTS);
+
+		char const * const modes[] = { "shared", "worker" };
+
+		for (char const *mode : modes)
+			for (unsigned n = 1; n <= max_clients; n *= 2)
+				_run(mode, n);
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-vfs_server_scaling
+LIBS   = base
+SRC_CC = main.cc
@@ -0,0 +1,163 @@
+/*
+ * \brief  Generating large reports with a growing output buffer
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The test generates a report of about 4 MiB in three ways:
+ *
+ * # Into a fixed buffer that is doubled and refilled from scratch whenever
+ *   the generator throws 'Buffer_exceeded'
+ * # Into a 'Buffered_xml', which expands its buffer during the generation
+ * # Via an 'Expanding_reporter', first with a report buffer that is too
+ *   small, then with the report buffer that resulted from the first run
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <os/buffered_xml.h>
+#include <os/reporter.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Heap              _heap  { _env.pd(), _env.rm() };
+	Timer::Connection _timer { _env };
+
+	/* each child node takes about 190 bytes, which amounts to 4 MiB */
+	unsigned const _children =
+		_config.xml().attribute_value("children", 22000U);
+
+	unsigned _num_generated = 0;
+
+	void _generate(Xml_generator &xml)
+	{
+		_num_generated++;
+
+		for (unsigned i = 0; i < _children; i++) {
+			xml.node("child", [&] {
+				xml.attribute("name", String<32>("child_", i));
+				xml.attribute("id",   i);
+				xml.node("ram", [&] {
+					xml.attribute("assigned", "16M");
+					xml.attribute("quota",    "16M");
+					xml.attribute("avail",    "8M"); });
+				xml.node("caps", [&] {
+					xml.attribute("assigned", "300");
+					xml.attribute("quota",    "300");
+					xml.attribute("avail",    "120"); });
+				xml.node("label", [&] {
+					xml.append_content("runtime -> child <", i, ">"); });
+			});
+		}
+	}
+
+	void _log_result(char const *what, uint64_t start_us, size_t size)
+	{
+		uint64_t const us = _timer.elapsed_us() - start_us;
+
+		log(what, ": ", size / 1024, " KiB in ", us / 1000, " ms, ",
+		    _num_generated, " generator passes");
+
+		_num_generated = 0;
+	}
+
+	size_t _retry_with_fixed_buffer()
+	{
+		uint64_t const start_us = _timer.elapsed_us();
+
+		Allocator &alloc = _heap;
+
+		size_t size = 4096, used = 0;
+		for (bool done = false; !done; ) {
+
+			char * const buffer = (char *)alloc.alloc(size);
+			try {
+				Xml_generator xml(buffer, size, "state", [&] {
+					_generate(xml); });
+
+				used = xml.used();
+				done = true;
+			}
+			catch (Xml_generator::Buffer_exceeded) { }
+
+			alloc.free(buffer, size);
+			if (!done)
+				size *= 2;
+		}
+
+		_log_result("fixed buffer      ", start_us, used);
+		return used;
+	}
+
+	size_t _buffered_xml()
+	{
+		uint64_t const start_us = _timer.elapsed_us();
+
+		size_t size = 0;
+		Buffered_xml const buffered(_heap, "state", [&] (Xml_generator &xml) {
+			_generate(xml); });
+
+		buffered.with_xml_node([&] (Xml_node const &node) { size = node.size(); });
+
+		_log_result("Buffered_xml      ", start_us, size);
+		return size;
+	}
+
+	void _expanding_reporter(size_t size)
+	{
+		Expanding_reporter reporter { _env, "state", "state" };
+
+		char const * const runs[] = { "Expanding_reporter", "(buffer fits)     " };
+
+		for (char const *what : runs) {
+
+			uint64_t const start_us = _timer.elapsed_us();
+
+			reporter.generate([&] (Xml_generator &xml) { _generate(xml); });
+
+			_log_result(what, start_us, size);
+		}
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		/*
+		 * In contrast to the size of the node, the used part of the
+		 * generator's buffer includes the trailing newline and null
+		 * character.
+		 */
+		size_t const fixed    = _retry_with_fixed_buffer();
+		size_t const buffered = _buffered_xml();
+
+		if (fixed != buffered + 2) {
+			error("unexpected size of generated XML: ", fixed, " vs. ", buffered);
+			throw Exception();
+		}
+
+		_expanding_reporter(fixed);
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-xml_generator_bench
+LIBS   = base
+SRC_CC = main.cc
@@ -0,0 +1,199 @@
+/*
+ * \brief  Navigating large XML data via Xml_node and Xml_index
+ * \author Johannes Schlatow
+ * \date   2021-03-22
+ *
+ * The test generates a multi-megabyte report that resembles the runtime
+ * state of a large init instance and walks it in two ways: once via
+ * 'Xml_node' and once via an 'Xml_index' created from the raw data. Both
+ * traversals must yield the same result.
+ */
+
+/*
+ * Copyright (C) 2021 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/attached_ram_dataspace.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <timer_session/connection.h>
+#include <util/xml_generator.h>
+#include <util/xml_index.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Result;
+	struct Main;
+}
+
+
+struct Test::Result
+{
+	unsigned nodes      = 0;
+	size_t   name_bytes = 0;
+
+	bool operator != (Result const &other) const {
+		return nodes != other.nodes || name_bytes != other.name_bytes; }
+
+	void print(Output &out) const {
+		Genode::print(out, nodes, " nodes, ", name_bytes, " name bytes"); }
+};
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Heap              _heap  { _env.pd(), _env.rm() };
+	Timer::Connection _timer { _env };
+
+	unsigned const _children =
+		_config.xml().attribute_value("children", 10000U);
+
+	unsigned const _lookups =
+		_config.xml().attribute_value("lookups", 16U);
+
+	size_t const _buffer_size =
+		_config.xml().attribute_value("buffer_size", Number_of_bytes(8*1024*1024));
+
+	Attached_ram_dataspace _buffer_ds { _env.ram(), _env.rm(), _buffer_size };
+
+	char * const _buffer = _buffer_ds.local_addr<char>();
+
+	size_t _report_size = 0;
+
+	void _generate()
+	{
+		Xml_generator xml(_buffer, _buffer_size, "state", [&] {
+			xml.attribute("version", "42");
+
+			for (unsigned i = 0; i < _children; i++) {
+				xml.node("child", [&] {
+					xml.attribute("name",   String<32>("child_", i));
+					xml.attribute("binary", "test-xml_index");
+					xml.attribute("id",     i);
+					xml.node("ram", [&] {
+						xml.attribute("assigned", "16M");
+						xml.attribute("quota",    "16M");
+						xml.attribute("avail",    "8M"); });
+					xml.node("caps", [&] {
+						xml.attribute("assigned", "300");
+						xml.attribute("quota",    "300");
+						xml.attribute("avail",    "120"); });
+					xml.node("route", [&] {
+						char const * const services[] = { "ROM", "PD", "CPU", "LOG" };
+						for (char const *service : services)
+							xml.node("service", [&] {
+								xml.attribute("name", service);
+								xml.node("parent", [&] { }); });
+					});
+				});
+			}
+		});
+
+		_report_size = xml.used();
+	}
+
+	template <typename NODE>
+	static void _walk(NODE const &node, Result &result)
+	{
+		result.nodes++;
+
+		typedef String<64> Name;
+		result.name_bytes += node.attribute_value("name", Name()).length();
+
+		node.for_each_sub_node([&] (NODE const &sub_node) {
+			_walk(sub_node, result); });
+	}
+
+	/**
+	 * Look up children by index, spread over the whole report
+	 */
+	template <typename NODE>
+	void _lookup(NODE const &root, Result &result)
+	{
+		for (unsigned i = 0; i < _lookups; i++) {
+			unsigned const idx = (unsigned)(((uint64_t)_children*(i + 1)) / (_lookups + 1));
+			_walk(root.sub_node(idx), result);
+		}
+	}
+
+	uint64_t _us_since(uint64_t start_us) { return _timer.elapsed_us() - start_us; }
+
+	void _check(char const *what, Result const &expected, Result const &result)
+	{
+		if (expected != result) {
+			error(what, ": ", result, ", expected ", expected);
+			throw Exception();
+		}
+	}
+
+	/*
+	 * Noncopyable
+	 */
+	Main(Main const &);
+	Main &operator = (Main const &);
+
+	Main(Env &env) : _env(env)
+	{
+		_generate();
+		log("report of ", _children, " children, ", _report_size / 1024, " KiB");
+
+		Result walk_node { }, lookup_node { };
+		Result walk_index { }, lookup_index { };
+
+		/* Xml_node */
+		{
+			uint64_t start_us = _timer.elapsed_us();
+			Xml_node const root(_buffer, _report_size);
+			uint64_t const parse_us = _us_since(start_us);
+
+			start_us = _timer.elapsed_us();
+			_walk(root, walk_node);
+			uint64_t const walk_us = _us_since(start_us);
+
+			start_us = _timer.elapsed_us();
+			_lookup(root, lookup_node);
+			uint64_t const lookup_us = _us_since(start_us);
+
+			log("Xml_node:  parse ", parse_us, " us, walk ", walk_us,
+			    " us, ", _lookups, " lookups ", lookup_us, " us");
+		}
+
+		/* Xml_index */
+		{
+			uint64_t start_us = _timer.elapsed_us();
+			Xml_index const index(_heap, _buffer, _report_size);
+			uint64_t const parse_us = _us_since(start_us);
+
+			start_us = _timer.elapsed_us();
+			_walk(index.root(), walk_index);
+			uint64_t const walk_us = _us_since(start_us);
+
+			start_us = _timer.elapsed_us();
+			_lookup(index.root(), lookup_index);
+			uint64_t const lookup_us = _us_since(start_us);
+
+			log("Xml_index: parse ", parse_us, " us, walk ", walk_us,
+			    " us, ", _lookups, " lookups ", lookup_us, " us, ",
+			    index.num_nodes(), " nodes indexed");
+		}
+
+		_check("walk",   walk_node,   walk_index);
+		_check("lookup", lookup_node, lookup_index);
+
+		log("walk: ", walk_index);
+
+		log("--- test finished ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-xml_index
+LIBS   = base
+SRC_CC = main.cc
@@ -16,6 +16,7 @@
 #include <seccomp.h> /* libseccomp */
 #include <asm/signal.h>
 #include <linux/sched.h>
+#include <sys/mman.h>   /* MADV_HUGEPAGE */
 
 class Filter
 {
@@ -144,6 +145,10 @@ class Filter
 						 * but it slould be save as it only uses an already open socket. */
 						_add_allow_rule(SCMP_SYS(mmap2));
 
+						/* The madvise syscall is restricted to the transparent huge-page
+						 * advice, which does not alter the content of the mapping. */
+						_add_allow_rule(SCMP_SYS(madvise), SCMP_CMP32(2, SCMP_CMP_EQ, MADV_HUGEPAGE));
+
 						/* returning from signal handlers is safe */
 						_add_allow_rule(SCMP_SYS(sigreturn));
 					}
@@ -165,6 +170,10 @@ class Filter
 						 * but it slould be save as it only uses an already open socket. */
 						_add_allow_rule(SCMP_SYS(mmap));
 
+						/* The madvise syscall is restricted to the transparent huge-page
+						 * advice, which does not alter the content of the mapping. */
+						_add_allow_rule(SCMP_SYS(madvise), SCMP_CMP64(2, SCMP_CMP_EQ, MADV_HUGEPAGE));
+
 						/* returning from signal handlers is safe */
 						_add_allow_rule(SCMP_SYS(rt_sigreturn));
 
@@ -189,6 +198,10 @@ class Filter
 						 * but it slould be save as it only uses an already open socket. */
 						_add_allow_rule(SCMP_SYS(mmap2));
 
+						/* The madvise syscall is restricted to the transparent huge-page
+						 * advice, which does not alter the content of the mapping. */
+						_add_allow_rule(SCMP_SYS(madvise), SCMP_CMP32(2, SCMP_CMP_EQ, MADV_HUGEPAGE));
+
 						/* This syscall is only used on ARM. */
 						_add_allow_rule(SCMP_SYS(cacheflush));
 